@@ -0,0 +1,114 @@
+#include "SunCalculator.h"
+
+#include <cmath>
+
+const double SunCalculator::sunsetAltitude=-0.833;
+const double SunCalculator::civilTwilightAltitude=-6;
+
+// The Julian date of the J2000 epoch
+static const double j2000=2451545.0;
+
+// M_PI is not available on all platforms
+static const double pi=3.14159265358979323846;
+
+static double toRadians (double degrees) { return degrees*pi/180; }
+static double toDegrees (double radians) { return radians*180/pi; }
+
+// ******************
+// ** Construction **
+// ******************
+
+/**
+ * Creates a calculator for a given location
+ *
+ * @param longitude the longitude of the location
+ * @param latitude the latitude of the location, in degrees; positive values
+ *                 are north
+ */
+SunCalculator::SunCalculator (const Longitude &longitude, double latitude):
+	longitude (longitude), latitude (latitude)
+{
+}
+
+SunCalculator::~SunCalculator ()
+{
+}
+
+
+// *****************
+// ** Calculation **
+// *****************
+
+/**
+ * Calculates the sunset on a given date
+ *
+ * @return the sunset in UTC, or an invalid time if the sun does not set or
+ *         not rise on that date (polar day or night)
+ */
+QTime SunCalculator::sunset (const QDate &date) const
+{
+	return setting (date, sunsetAltitude);
+}
+
+/**
+ * Calculates the end of civil twilight on a given date, that is, the time
+ * when the center of the sun is 6° below the horizon
+ *
+ * @return the end of civil twilight in UTC, or an invalid time if the sun
+ *         does not reach that altitude on that date
+ */
+QTime SunCalculator::civilTwilightEnd (const QDate &date) const
+{
+	return setting (date, civilTwilightAltitude);
+}
+
+/**
+ * Calculates the time in the evening of a given date when the center of the
+ * sun passes a given altitude
+ *
+ * @param date the date
+ * @param altitude the altitude of the center of the sun, in degrees; negative
+ *                 values are below the horizon
+ * @return the time in UTC, or an invalid time if the sun does not pass the
+ *         altitude on that date
+ */
+QTime SunCalculator::setting (const QDate &date, double altitude) const
+{
+	if (!date.isValid () || !longitude.isValid ()) return QTime ();
+
+	// The mean solar noon at the longitude, in days since J2000. The Julian
+	// day number of a date refers to noon UTC.
+	double n=date.toJulianDay ()-j2000+0.0008;
+	double meanNoon=n-longitude.getValue ()/360;
+
+	// The mean anomaly, the equation of the center and the ecliptic
+	// longitude of the sun
+	double m=fmod (357.5291+0.98560028*meanNoon, 360);
+	double c=1.9148*sin (toRadians (m)) + 0.0200*sin (toRadians (2*m)) + 0.0003*sin (toRadians (3*m));
+	double lambda=fmod (m+c+180+102.9372, 360);
+
+	// The solar transit (true solar noon), as a Julian date
+	double transit=j2000+meanNoon+0.0053*sin (toRadians (m))-0.0069*sin (toRadians (2*lambda));
+
+	// The declination of the sun
+	double sinDeclination=sin (toRadians (lambda))*sin (toRadians (23.44));
+	double cosDeclination=cos (asin (sinDeclination));
+
+	// The hour angle at which the sun passes the altitude
+	double phi=toRadians (latitude);
+	double cosHourAngle=
+		(sin (toRadians (altitude))-sin (phi)*sinDeclination)/
+		(cos (phi)*cosDeclination);
+
+	// The sun stays above or below the altitude all day
+	if (cosHourAngle<-1 || cosHourAngle>1) return QTime ();
+
+	double setting=transit+toDegrees (acos (cosHourAngle))/360;
+
+	// Julian dates start at noon. Convert the fraction of the day to seconds
+	// after midnight.
+	double dayFraction=setting+0.5-floor (setting+0.5);
+	int seconds=(int)floor (dayFraction*86400+0.5);
+
+	return QTime (0, 0).addSecs (seconds);
+}
@@ -0,0 +1,50 @@
+/*
+ * SunCalculator.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SUNCALCULATOR_H_
+#define SUNCALCULATOR_H_
+
+#include <QDate>
+#include <QTime>
+
+#include "src/Longitude.h"
+
+/**
+ * Calculates the time of sunset and of the end of civil twilight for a
+ * location
+ *
+ * The calculation uses the sunrise equation with the approximations for the
+ * solar coordinates given by the Astronomical Almanac. The results are
+ * accurate to about one minute for latitudes outside of the polar regions,
+ * which is sufficient for display purposes. The calculation does not perform
+ * any I/O and is cheap enough to be performed for any date whenever it is
+ * required.
+ *
+ * All times are in UTC.
+ */
+class SunCalculator
+{
+	public:
+		// The altitude of the center of the sun, in degrees, at sunset
+		// (including refraction and the radius of the sun) and at the end of
+		// civil twilight
+		static const double sunsetAltitude;
+		static const double civilTwilightAltitude;
+
+		SunCalculator (const Longitude &longitude, double latitude);
+		virtual ~SunCalculator ();
+
+		QTime sunset (const QDate &date) const;
+		QTime civilTwilightEnd (const QDate &date) const;
+
+		QTime setting (const QDate &date, double altitude) const;
+
+	private:
+		Longitude longitude;
+		double latitude; // Degrees, positive values are north
+};
+
+#endif
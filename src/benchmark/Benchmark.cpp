@@ -0,0 +1,286 @@
+#include "Benchmark.h"
+
+#include <iostream>
+
+#include <QTextStream>
+#include <QTime>
+
+#include "src/db/interface/Interface.h"
+#include "src/db/Database.h"
+#include "src/db/Query.h"
+#include "src/db/result/Result.h"
+#include "src/db/cache/Cache.h"
+#include "src/model/Flight.h"
+#include "src/model/flightList/FlightModel.h"
+#include "src/model/objectList/EntityList.h"
+#include "src/model/objectList/ObjectListModel.h"
+#include "src/statistics/PlaneLog.h"
+#include "src/statistics/PilotLog.h"
+#include "src/data/Csv.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+// ******************
+// ** Construction **
+// ******************
+
+Benchmark::Benchmark (Interface &interface, QTextStream &output):
+	interface (interface), output (output)
+{
+	db=new Database (interface);
+	cache=new Cache (*db);
+}
+
+Benchmark::~Benchmark ()
+{
+	delete cache;
+	delete db;
+}
+
+
+// *************
+// ** Running **
+// *************
+
+void Benchmark::result (const QString &name, int iterations, int totalMs, int items)
+{
+	output << qnotr ("benchmark\t%1\t%2\t%3\t%4\t%5")
+		.arg (name).arg (iterations).arg (totalMs)
+		.arg ((double)totalMs/qMax (iterations, 1), 0, 'f', 2)
+		.arg (items) << endl;
+}
+
+/**
+ * Determines the range of dates with flights
+ *
+ * @return true if there are flights
+ */
+bool Benchmark::determineDateRange ()
+{
+	QSharedPointer<Result> range=interface.executeQueryResult (Query (notr (
+		"SELECT MIN(departure_time), MAX(departure_time) FROM flights")));
+	if (range->next ())
+	{
+		firstDate=range->value (0).toDateTime ().date ();
+		lastDate =range->value (1).toDateTime ().date ();
+	}
+
+	if (!firstDate.isValid () || !lastDate.isValid ())
+	{
+		std::cout << notr ("The database contains no flights, run bench:generate first") << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void Benchmark::run ()
+{
+	if (!determineDateRange ()) return;
+
+	std::cout << qnotr ("Benchmarking with flights from %1 to %2")
+		.arg (firstDate.toString (Qt::ISODate), lastDate.toString (Qt::ISODate)) << std::endl;
+
+	benchmarkRefreshAll ();
+	benchmarkGetFlightsDate ();
+	benchmarkGetFlightsRange ();
+	benchmarkLogs ();
+	benchmarkCsvExport ();
+	benchmarkFlightModel ();
+}
+
+
+// ****************
+// ** Benchmarks **
+// ****************
+
+void Benchmark::benchmarkRefreshAll ()
+{
+	QTime timer;
+	timer.start ();
+	cache->refreshAll ();
+	int elapsed=timer.elapsed ();
+
+	int items=cache->getObjects<Person> ().size ()+cache->getObjects<Plane> ().size ()+cache->getFlightsToday ().size ();
+	result (notr ("Cache::refreshAll"), 1, elapsed, items);
+}
+
+void Benchmark::benchmarkGetFlightsDate ()
+{
+	// Every seventh day of the last season
+	QList<QDate> dates;
+	for (QDate date=lastDate.addDays (-180); date<=lastDate; date=date.addDays (7))
+		dates.append (date);
+
+	int items=0;
+	QTime timer;
+	timer.start ();
+	foreach (const QDate &date, dates)
+		items+=db->getFlightsDate (date).size ();
+
+	result (notr ("Database::getFlightsDate"), dates.size (), timer.elapsed (), items);
+}
+
+void Benchmark::benchmarkGetFlightsRange ()
+{
+	// Same as DbManager::getFlights, which cannot be used without a GUI
+	QList<int> rangeDays;
+	rangeDays << 1 << 7 << 31 << 365;
+
+	foreach (int days, rangeDays)
+	{
+		QDate first=lastDate.addDays (-days+1);
+
+		QTime timer;
+		timer.start ();
+		QList<Flight> candidates=db->getObjects<Flight> (Flight::dateRangeSupersetConditions (first, lastDate));
+		QList<Flight> flights=Flight::dateRangeSupersetFilter (candidates, first, lastDate);
+
+		result (qnotr ("DbManager::getFlights (%1 days)").arg (days), 1, timer.elapsed (), flights.size ());
+	}
+}
+
+void Benchmark::benchmarkLogs ()
+{
+	QList<Flight> flights=db->getObjects<Flight> (Flight::dateRangeSupersetConditions (lastDate.addDays (-364), lastDate));
+
+	QTime timer;
+	timer.start ();
+	PlaneLog *planeLog=PlaneLog::createNew (flights, *cache);
+	result (notr ("PlaneLog::createNew (1 year)"), 1, timer.elapsed (), planeLog->rowCount (QModelIndex ()));
+	delete planeLog;
+
+	timer.start ();
+	PilotLog *pilotLog=PilotLog::createNew (flights, *cache);
+	result (notr ("PilotLog::createNew (1 year)"), 1, timer.elapsed (), pilotLog->rowCount (QModelIndex ()));
+	delete pilotLog;
+}
+
+void Benchmark::benchmarkCsvExport ()
+{
+	QList<Flight> flights=db->getObjects<Flight> (Flight::dateRangeSupersetConditions (lastDate.addDays (-364), lastDate));
+
+	// The list and the model are deleted by the ObjectListModel
+	EntityList<Flight> *flightList=new EntityList<Flight> (flights);
+	ObjectListModel<Flight> flightListModel (flightList, true, new FlightModel (*cache), true);
+
+	QTime timer;
+	timer.start ();
+	Csv csv (flightListModel, notr (","));
+	QString text=csv.toString ();
+
+	result (notr ("Csv::toString (1 year)"), 1, timer.elapsed (), text.length ());
+}
+
+void Benchmark::benchmarkFlightModel ()
+{
+	// The flights of the busiest day
+	QSharedPointer<Result> busiest=interface.executeQueryResult (Query (notr (
+		"SELECT DATE(departure_time) AS date, COUNT(*) AS count FROM flights"
+		" GROUP BY DATE(departure_time) ORDER BY count DESC LIMIT 1")));
+	if (!busiest->next ()) return;
+	QDate date=busiest->value (0).toDate ();
+
+	EntityList<Flight> *flightList=new EntityList<Flight> (db->getFlightsDate (date));
+	ObjectListModel<Flight> flightListModel (flightList, true, new FlightModel (*cache), true);
+
+	int rows=flightListModel.rowCount (QModelIndex ());
+	int columns=flightListModel.columnCount (QModelIndex ());
+
+	// Render the table like a view would: display text and background for
+	// every cell
+	const int iterations=10;
+	QTime timer;
+	timer.start ();
+	for (int i=0; i<iterations; ++i)
+	{
+		for (int row=0; row<rows; ++row)
+		{
+			for (int column=0; column<columns; ++column)
+			{
+				QModelIndex index=flightListModel.index (row, column);
+				flightListModel.data (index, Qt::DisplayRole);
+				flightListModel.data (index, Qt::BackgroundRole);
+			}
+		}
+	}
+
+	result (notr ("FlightModel::data (busiest day)"), iterations, timer.elapsed (), rows);
+}
+
+
+// *****************
+// ** Query plans **
+// *****************
+
+/**
+ * Checks that the database uses an index for each of the conditions of the
+ * flight queries used for displaying the flights (the flights of a date and
+ * the prepared flights)
+ *
+ * For each condition, a line in the format
+ *   plan<TAB>name<TAB>index|scan<TAB>details
+ * is written. The plans depend on the data, so this should be run on a
+ * database of realistic size (typically one generated by SyntheticClub).
+ *
+ * @return true if all conditions use an index, false if any of them needs to
+ *         scan the table
+ */
+bool Benchmark::checkQueryPlans ()
+{
+	if (!determineDateRange ()) return false;
+
+	QList<Query> dateConditions=Flight::dateSupersetConditions (lastDate);
+	QList<Query> preparedConditions=Database::preparedFlightsConditions ();
+
+	bool ok=true;
+	for (int i=0; i<dateConditions.size (); ++i)
+		if (!checkQueryPlan (qnotr ("getFlightsDate (condition %1)").arg (i+1), dateConditions.at (i)))
+			ok=false;
+	for (int i=0; i<preparedConditions.size (); ++i)
+		if (!checkQueryPlan (qnotr ("getPreparedFlights (condition %1)").arg (i+1), preparedConditions.at (i)))
+			ok=false;
+
+	return ok;
+}
+
+bool Benchmark::checkQueryPlan (const QString &name, const Query &condition)
+{
+	Query select=Query::select (Flight::dbTableName (), Flight::selectColumnList ())
+		.condition (condition);
+
+	bool usesIndex=true;
+	QStringList details;
+
+	if (interface.isSqlite ())
+	{
+		// The detail is the last column, e. g. "SEARCH TABLE flights USING
+		// INDEX ..." or "SCAN TABLE flights" (a full table scan)
+		QSharedPointer<Result> plan=interface.executeQueryResult (Query (notr ("EXPLAIN QUERY PLAN "))+select);
+		while (plan->next ())
+		{
+			QString detail=plan->value (3).toString ();
+			if (detail.startsWith (notr ("SCAN"))) usesIndex=false;
+			details.append (detail);
+		}
+	}
+	else
+	{
+		// Columns: id, select_type, table, type, possible_keys, key, ...
+		// A type of ALL is a full table scan, a type of index is a full
+		// index scan.
+		QSharedPointer<Result> plan=interface.executeQueryResult (Query (notr ("EXPLAIN "))+select);
+		while (plan->next ())
+		{
+			QString type=plan->value (3).toString ();
+			QString key =plan->value (5).toString ();
+			if (type==notr ("ALL") || type==notr ("index")) usesIndex=false;
+			details.append (qnotr ("type=%1, key=%2").arg (type, key));
+		}
+	}
+
+	output << qnotr ("plan\t%1\t%2\t%3")
+		.arg (name, usesIndex?notr ("index"):notr ("scan"), details.join (notr ("; "))) << endl;
+
+	return usesIndex;
+}
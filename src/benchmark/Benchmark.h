@@ -0,0 +1,64 @@
+/*
+ * Benchmark.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <QString>
+#include <QStringList>
+#include <QDate>
+
+class QTextStream;
+class Interface;
+class Query;
+class Database;
+class Cache;
+
+/**
+ * Times the performance relevant operations of the program on an existing
+ * database (typically one generated by SyntheticClub) without a GUI
+ *
+ * The results are written as tab separated lines in the format
+ *   benchmark<TAB>name<TAB>iterations<TAB>total_ms<TAB>ms_per_iteration<TAB>items
+ * so the results of different runs can be compared by a script. Other output
+ * of the program does not start with "benchmark".
+ *
+ * Additionally, the query plans of the frequent flight queries can be checked
+ * (see #checkQueryPlans).
+ */
+class Benchmark
+{
+	public:
+		Benchmark (Interface &interface, QTextStream &output);
+		virtual ~Benchmark ();
+
+		void run ();
+		bool checkQueryPlans ();
+
+	protected:
+		void result (const QString &name, int iterations, int totalMs, int items);
+		bool determineDateRange ();
+		bool checkQueryPlan (const QString &name, const Query &condition);
+
+		void benchmarkRefreshAll ();
+		void benchmarkGetFlightsDate ();
+		void benchmarkGetFlightsRange ();
+		void benchmarkLogs ();
+		void benchmarkCsvExport ();
+		void benchmarkFlightModel ();
+
+	private:
+		Interface &interface;
+		QTextStream &output;
+
+		Database *db;
+		Cache *cache;
+
+		// The range of dates with flights
+		QDate firstDate, lastDate;
+};
+
+#endif
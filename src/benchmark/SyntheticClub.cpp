@@ -0,0 +1,253 @@
+#include "SyntheticClub.h"
+
+#include <QStringList>
+
+#include "src/db/interface/Interface.h"
+#include "src/db/Database.h"
+#include "src/db/Query.h"
+#include "src/model/Flight.h"
+#include "src/model/Plane.h"
+#include "src/model/Person.h"
+#include "src/model/LaunchMethod.h"
+#include "src/i18n/notr.h"
+
+// ******************
+// ** Construction **
+// ******************
+
+SyntheticClub::SyntheticClub ():
+	numGliders (15), numTowplanes (2), numPeople (150), numYears (3),
+	flightsPerDay (40), airtowPercentage (20), seed (1),
+	endDate (2025, 10, 31),
+	winchId (invalidId), airtowId (invalidId)
+{
+}
+
+SyntheticClub::~SyntheticClub ()
+{
+}
+
+
+// ***********
+// ** Dates **
+// ***********
+
+/**
+ * Returns the first date of the first season
+ */
+QDate SyntheticClub::firstDate () const
+{
+	return QDate (endDate.year ()-numYears+1, 4, 1);
+}
+
+/**
+ * Returns the last date for which flights are generated: the end date, or the
+ * end of the last season if the end date is after the season. If the end date
+ * is before the start of its season, the last season is empty.
+ */
+QDate SyntheticClub::lastDate () const
+{
+	return qMin (endDate, QDate (endDate.year (), 10, 31));
+}
+
+/**
+ * Returns a random number between min and max, inclusive
+ */
+int SyntheticClub::random (int min, int max)
+{
+	return min+qrand ()%(max-min+1);
+}
+
+bool SyntheticClub::isFlyingDay (const QDate &date)
+{
+	// Season only
+	if (date.month ()<4 || date.month ()>10)
+		return false;
+
+	// Every weekend, one in four weekdays
+	if (date.dayOfWeek ()>=6)
+		return true;
+	else
+		return random (0, 3)==0;
+}
+
+
+// ****************
+// ** Generation **
+// ****************
+
+QList<Flight> SyntheticClub::flightsForDay (const QDate &date)
+{
+	QList<Flight> flights;
+
+	// Weekdays have fewer flights than weekends
+	int count=flightsPerDay;
+	if (date.dayOfWeek ()<6) count/=3;
+	count=random (count/2, count+count/2);
+
+	// Flights start at 09:00 UTC and are spread over 9 hours
+	QDateTime dayStart (date, QTime (9, 0), Qt::UTC);
+
+	for (int i=0; i<count; ++i)
+	{
+		Flight flight;
+
+		bool airtow=random (0, 99)<airtowPercentage;
+		bool training=random (0, 3)==0;
+
+		flight.setPlaneId (gliderIds.at (random (0, gliderIds.size ()-1)));
+		flight.setPilotId (personIds.at (random (0, personIds.size ()-1)));
+		if (training)
+			flight.setCopilotId (personIds.at (random (0, personIds.size ()-1)));
+		flight.setType (training?Flight::typeTraining2:Flight::typeNormal);
+		flight.setMode (Flight::modeLocal);
+		flight.setDepartureLocation (notr ("Twiddlethorpe"));
+		flight.setLandingLocation (notr ("Twiddlethorpe"));
+		flight.setNumLandings (1);
+
+		QDateTime departureTime=dayStart.addSecs (i*9*3600/qMax (count, 1)+random (0, 300));
+		flight.setDeparted (true);
+		flight.setDepartureTime (departureTime);
+		flight.setLanded (true);
+		flight.setLandingTime (departureTime.addSecs (airtow?random (30*60, 4*3600):random (5*60, 60*60)));
+
+		if (airtow)
+		{
+			flight.setLaunchMethodId (airtowId);
+			flight.setTowplaneId (towplaneIds.at (random (0, towplaneIds.size ()-1)));
+			flight.setTowpilotId (personIds.at (random (0, personIds.size ()-1)));
+			flight.setTowflightMode (Flight::modeLocal);
+			flight.setTowflightLandingLocation (notr ("Twiddlethorpe"));
+			flight.setTowflightLanded (true);
+			flight.setTowflightLandingTime (departureTime.addSecs (random (8*60, 15*60)));
+		}
+		else
+		{
+			flight.setLaunchMethodId (winchId);
+		}
+
+		flights.append (flight);
+	}
+
+	return flights;
+}
+
+/**
+ * Writes the club data to the database. The database should be empty and have
+ * the current schema.
+ */
+void SyntheticClub::generate (Interface &interface, Database &db, OperationMonitorInterface monitor)
+{
+	qsrand (seed);
+
+	// *** Launch methods
+	monitor.status (notr ("Generating launch methods"));
+
+	LaunchMethod winch;
+	winch.name=notr ("Winch");
+	winch.shortName=notr ("W");
+	winch.logString=notr ("W");
+	winch.keyboardShortcut=notr ("W");
+	winch.type=LaunchMethod::typeWinch;
+	winch.personRequired=true;
+	winchId=db.createObject (winch);
+
+	LaunchMethod airtow;
+	airtow.name=notr ("Airtow");
+	airtow.shortName=notr ("A");
+	airtow.logString=notr ("A");
+	airtow.keyboardShortcut=notr ("A");
+	airtow.type=LaunchMethod::typeAirtow;
+	airtow.personRequired=true;
+	airtowId=db.createObject (airtow);
+
+	LaunchMethod self;
+	self.name=notr ("Self launch");
+	self.shortName=notr ("S");
+	self.logString=notr ("S");
+	self.keyboardShortcut=notr ("S");
+	self.type=LaunchMethod::typeSelf;
+	self.personRequired=true;
+	db.createObject (self);
+
+	// *** Planes
+	monitor.status (notr ("Generating planes"));
+
+	QStringList gliderTypes;
+	gliderTypes << notr ("ASK 21") << notr ("ASK 23") << notr ("LS 4") << notr ("Discus") << notr ("DG 1000");
+
+	gliderIds.clear ();
+	for (int i=0; i<numGliders; ++i)
+	{
+		Plane plane;
+		plane.registration=qnotr ("D-%1").arg (1000+i);
+		plane.callsign=qnotr ("%1").arg (i, 2, 36).toUpper ();
+		plane.type=gliderTypes.at (i%gliderTypes.size ());
+		plane.numSeats=(i%3==0)?2:1;
+		plane.category=Plane::categoryGlider;
+		plane.club=notr ("Twiddlethorpe Gliding Club");
+		gliderIds.append (db.createObject (plane));
+	}
+
+	towplaneIds.clear ();
+	for (int i=0; i<numTowplanes; ++i)
+	{
+		Plane plane;
+		plane.registration=qnotr ("D-E%1").arg (100+i);
+		plane.type=notr ("Robin DR 400");
+		plane.numSeats=4;
+		plane.category=Plane::categoryAirplane;
+		plane.club=notr ("Twiddlethorpe Gliding Club");
+		towplaneIds.append (db.createObject (plane));
+	}
+
+	// *** People
+	QStringList lastNames;
+	lastNames << notr ("Miller") << notr ("Smith") << notr ("Taylor") << notr ("Brown") << notr ("Wilson")
+		<< notr ("Evans") << notr ("Walker") << notr ("Wright") << notr ("Hughes") << notr ("Green");
+
+	personIds.clear ();
+	for (int i=0; i<numPeople; ++i)
+	{
+		monitor.progress (i, numPeople, notr ("Generating people"));
+
+		Person person;
+		person.lastName=lastNames.at (i%lastNames.size ());
+		person.firstName=qnotr ("Pilot %1").arg (i);
+		person.club=notr ("Twiddlethorpe Gliding Club");
+		personIds.append (db.createObject (person));
+	}
+
+	// *** Flights
+	QDate first=firstDate ();
+	QDate last=lastDate ();
+	int numDays=first.daysTo (last)+1;
+
+	for (QDate date=first; date<=last; date=date.addDays (1))
+	{
+		monitor.progress (first.daysTo (date), numDays, qnotr ("Generating flights of %1").arg (date.toString (Qt::ISODate)));
+
+		if (!isFlyingDay (date))
+			continue;
+
+		QList<Flight> flights=flightsForDay (date);
+		if (flights.isEmpty ())
+			continue;
+
+		// Write the flights of the day with a single multi-row insert, which
+		// is much faster than Database::createObjects (one transaction per
+		// flight). The flights are not needed afterwards, so we don't need the
+		// IDs or the events.
+		Query query=Query (notr ("INSERT INTO %1 (%2) VALUES "))
+			.arg (Flight::dbTableName (), Flight::insertColumnList ());
+
+		for (int i=0; i<flights.size (); ++i)
+		{
+			if (i>0) query+=notr (",");
+			query+=qnotr ("(%1)").arg (Flight::insertPlaceholderList ());
+			flights.at (i).bindValues (query);
+		}
+
+		interface.executeQuery (query);
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ * SyntheticClub.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SYNTHETICCLUB_H_
+#define SYNTHETICCLUB_H_
+
+#include <QList>
+#include <QDate>
+
+#include "src/db/dbId.h"
+#include "src/concurrent/monitor/OperationMonitorInterface.h"
+
+class Interface;
+class Database;
+class Flight;
+
+/**
+ * Generates the data of a fictional club (planes, people, launch methods and
+ * several seasons of flights) for benchmarking
+ *
+ * The data is meant to resemble a real club: flights take place on weekends
+ * and on some weekdays during the season (April to October), most flights
+ * are winch launches, and some are airtows with a towplane and towpilot.
+ *
+ * The generated data only depends on the parameters (including the seed and
+ * the end date), so benchmark runs on different machines or versions use the
+ * same data. The end date does not default to the current date for that
+ * reason.
+ */
+class SyntheticClub
+{
+	public:
+		SyntheticClub ();
+		virtual ~SyntheticClub ();
+
+		// Parameters
+		int numGliders;
+		int numTowplanes;
+		int numPeople;
+		int numYears; // Seasons, ending with the year of endDate
+		int flightsPerDay; // Average, on flying days
+		int airtowPercentage;
+		uint seed;
+		QDate endDate; // No flights are generated after this date
+
+		void generate (Interface &interface, Database &db, OperationMonitorInterface monitor=OperationMonitorInterface::null);
+
+		QDate firstDate () const;
+		QDate lastDate () const;
+
+	private:
+		int random (int min, int max);
+		bool isFlyingDay (const QDate &date);
+		QList<Flight> flightsForDay (const QDate &date);
+
+		QList<dbId> gliderIds, towplaneIds, personIds;
+		dbId winchId, airtowId;
+};
+
+#endif
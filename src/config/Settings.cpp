@@ -41,8 +41,9 @@ Settings::Settings ():
 	// readSettings. All settings which are only set by command line have to be
 	// initialized.
 	enableDebug (false), coloredLabels (false), displayQueries (false),
+	shapingBandwidth (0), shapingLatency (0), shapingLoss (0),
 	noFullScreen (false), enableShutdown (false),
-	overrideDatabaseName (false)
+	overrideDatabaseName (false), overrideSqlite (false)
 {
 	readSettings ();
 }
@@ -72,12 +73,23 @@ QStringList Settings::readArgs (const QStringList &args)
 
 			if (arg==notr ("-q"))
 				displayQueries=true;
+			else if (arg==notr ("--shape-bandwidth") && !unprocessed.empty ())
+				shapingBandwidth=unprocessed.takeFirst ().toInt ();
+			else if (arg==notr ("--shape-latency") && !unprocessed.empty ())
+				shapingLatency=unprocessed.takeFirst ().toInt ();
+			else if (arg==notr ("--shape-loss") && !unprocessed.empty ())
+				shapingLoss=unprocessed.takeFirst ().toInt ();
 			else if (arg==notr ("--colored-labels"))
 				coloredLabels=true;
 			else if (arg==notr ("--no-full-screen"))
 				noFullScreen=true;
 			else if (arg==notr ("--enable-shutdown"))
 				enableShutdown=true;
+			else if (arg==notr ("--sqlite"))
+			{
+				overrideSqlite=true;
+				databaseInfo.type=DatabaseInfo::typeSqlite;
+			}
 			else if (arg==notr ("--database-name"))
 			{
 				if (!unprocessed.empty ())
@@ -204,6 +216,8 @@ void Settings::readSettings ()
 	// be written back.
 	if (overrideDatabaseName)
 		databaseInfo.database=overrideDatabaseNameValue;
+	if (overrideSqlite)
+		databaseInfo.type=DatabaseInfo::typeSqlite;
 
 	// *** Settings
 	// UI
@@ -214,6 +228,7 @@ void Settings::readSettings ()
 	location      =s.value (notr ("location")      , tr ("Twiddlethorpe")).toString ();
 	recordTowpilot=s.value (notr ("recordTowpilot"), true            ).toBool ();
 	checkMedicals =s.value (notr ("checkMedicals") , true            ).toBool ();
+	optimisticUpdates=s.value (notr ("optimisticUpdates"), true).toBool ();
 	// Permissions
 	protectSettings      =s.value (notr ("protectSettings"      ), false).toBool ();
 	protectLaunchMethods =s.value (notr ("protectLaunchMethods" ), false).toBool ();
@@ -224,6 +239,9 @@ void Settings::readSettings ()
 	// Diagnostics
 	enableDebug=s.value (notr ("enableDebug"), false       ).toBool ();
 	diagCommand=s.value (notr ("diagCommand"), notr ("./script/netztest_xterm")).toString (); // xterm -e ./netztest &
+	slowQueryThreshold=s.value (notr ("slowQueryThreshold"), 1000).toInt ();
+	printSlowQueries  =s.value (notr ("printSlowQueries"  ), false).toBool ();
+	explainSlowQueries=s.value (notr ("explainSlowQueries"), false).toBool ();
 
 	// *** Plugins - Weather
 	// Weather plugin
@@ -271,8 +289,9 @@ void Settings::writeSettings ()
 	s.beginGroup (notr ("settings"));
 
 	// *** Database
-	// If the database name has been overridden, don't store the settings
-	if (!overrideDatabaseName)
+	// If the database name or type has been overridden, don't store the
+	// settings
+	if (!overrideDatabaseName && !overrideSqlite)
 	{
 		s.beginGroup (notr ("database"));
 		databaseInfo.save (s); // Connection
@@ -288,6 +307,7 @@ void Settings::writeSettings ()
 	s.setValue (notr ("location")      , location      );
 	s.setValue (notr ("recordTowpilot"), recordTowpilot);
 	s.setValue (notr ("checkMedicals") , checkMedicals );
+	s.setValue (notr ("optimisticUpdates"), optimisticUpdates);
 	// Permissions
 	s.setValue (notr ("protectSettings"      ), protectSettings      );
 	s.setValue (notr ("protectLaunchMethods" ), protectLaunchMethods );
@@ -298,6 +318,9 @@ void Settings::writeSettings ()
 	// Diagnostics
 	s.setValue (notr ("enableDebug"), enableDebug);
 	s.setValue (notr ("diagCommand"), diagCommand);
+	s.setValue (notr ("slowQueryThreshold"), slowQueryThreshold);
+	s.setValue (notr ("printSlowQueries"  ), printSlowQueries  );
+	s.setValue (notr ("explainSlowQueries"), explainSlowQueries);
 
 
 	// *** Plugins - Weather
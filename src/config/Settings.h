@@ -49,6 +49,7 @@ class Settings: public QObject
 		QString location;
 		bool recordTowpilot;
 		bool checkMedicals;
+		bool optimisticUpdates;
 		// Permissions
 		bool protectSettings;
 		bool protectLaunchMethods;
@@ -59,8 +60,12 @@ class Settings: public QObject
 		// Diagnostics
 		bool enableDebug;
 		QString diagCommand;
+		int slowQueryThreshold; // in milliseconds, 0 to disable
+		bool printSlowQueries;
+		bool explainSlowQueries;
 		bool coloredLabels;
 		bool displayQueries;
+		int shapingBandwidth, shapingLatency, shapingLoss; // See TcpProxy::Shaping
 		bool noFullScreen;
 		bool enableShutdown;
 
@@ -94,6 +99,7 @@ class Settings: public QObject
 		// in the GUI, though.
 		bool overrideDatabaseName;
 		QString overrideDatabaseNameValue;
+		bool overrideSqlite;
 
 	protected:
 		void readSettings ();
@@ -20,6 +20,7 @@
 #include <cassert>
 
 #include <QDateTime>
+#include <QSet>
 
 #include "src/model/Person.h"
 #include "src/model/Plane.h"
@@ -32,6 +33,14 @@
 #include "src/util/qDate.h" // TODO remove
 #include "src/i18n/notr.h"
 
+// ***************
+// ** Constants **
+// ***************
+
+const QString Database::deletionsTableName   =notr ("deletions");
+const QString Database::creationKeysTableName=notr ("creation_keys");
+
+
 // ******************
 // ** Construction **
 // ******************
@@ -68,6 +77,60 @@ template<class T> QList<T> Database::getObjects (const Query &condition)
 	return T::createListFromResult (*interface.executeQueryResult (query));
 }
 
+/**
+ * Retrieves the objects matching any of the conditions
+ *
+ * The conditions are combined with UNION ALL rather than with OR, so the
+ * database can use a different index for each condition. Objects matching
+ * more than one condition are only returned once; still, the conditions
+ * should be disjoint if possible, so no duplicates are transferred.
+ */
+template<class T> QList<T> Database::getObjects (const QList<Query> &conditions)
+{
+	Query query=anyConditionQuery<T> (conditions);
+	if (query.isEmpty ()) return QList<T> ();
+
+	return uniqueObjects (T::createListFromResult (*interface.executeQueryResult (query)));
+}
+
+/**
+ * Creates the query for the objects matching any of the conditions, see
+ * #getObjects (const QList<Query> &)
+ *
+ * @return the query, or an empty query if there are no conditions
+ */
+template<class T> Query Database::anyConditionQuery (const QList<Query> &conditions)
+{
+	Query query;
+	foreach (const Query &condition, conditions)
+	{
+		if (!query.isEmpty ()) query+=notr (" UNION ALL ");
+		query+=Query::select (T::dbTableName (), T::selectColumnList ())
+			.condition (condition);
+	}
+
+	return query;
+}
+
+/**
+ * Removes the objects with an ID that occurred before from a list of objects
+ */
+template<class T> QList<T> Database::uniqueObjects (const QList<T> &objects)
+{
+	QSet<dbId> ids;
+	QList<T> result;
+	foreach (const T &object, objects)
+	{
+		if (!ids.contains (object.getId ()))
+		{
+			ids.insert (object.getId ());
+			result.append (object);
+		}
+	}
+
+	return result;
+}
+
 template<class T> int Database::countObjects (const Query &condition)
 {
 	Query query=Query::count (T::dbTableName ()).condition (condition);
@@ -107,6 +170,7 @@ template<class T> bool Database::deleteObject (dbId id)
 	// Wrap the operation into a transaction, see top of file
 	interface.transaction ();
 	QSharedPointer<Result> result=interface.executeQueryResult (query);
+	recordDeletions<T> (QList<dbId> () << id);
 	interface.commit ();
 
 	emit dbEvent (DbEvent::deleted<T> (id));
@@ -128,10 +192,13 @@ template<class T> int Database::deleteObjects (const QList<dbId> &ids)
 	// Wrap the operation into a transaction, see top of file
 	interface.transaction ();
 	QSharedPointer<Result> result=interface.executeQueryResult (query);
+	recordDeletions<T> (ids);
 	interface.commit ();
 
+	QList<DbEvent> events;
 	foreach (dbId id, ids)
-		emit dbEvent (DbEvent::deleted<T> (id));
+		events.append (DbEvent::deleted<T> (id));
+	emit dbEvent (DbEvent::batch<T> (events));
 
 	return result->numRowsAffected ()>0;
 }
@@ -140,9 +207,14 @@ template<class T> int Database::deleteObjects (const QList<dbId> &ids)
  * The id of the object is ignored and overwritten.
  *
  * @param object
+ * @param creationKey a key identifying this creation, or an empty string. If
+ *                    it is not empty, it is recorded in the transaction of
+ *                    the creation, so the object can be found by
+ *                    #createdObjectId if the result of the creation is not
+ *                    known (e. g. because the connection was lost).
  * @return
  */
-template<class T> dbId Database::createObject (T &object)
+template<class T> dbId Database::createObject (T &object, const QString &creationKey)
 {
 	Query query=Query (notr ("INSERT INTO %1 (%2) values (%3)"))
 		.arg (T::dbTableName (), T::insertColumnList (), T::insertPlaceholderList ());
@@ -151,9 +223,12 @@ template<class T> dbId Database::createObject (T &object)
 	// Wrap the operation into a transaction, see top of file
 	interface.transaction ();
 	QSharedPointer<Result> result=interface.executeQueryResult (query);
+	dbId id=result->lastInsertId ().toLongLong ();
+	if (!creationKey.isEmpty ())
+		recordCreationKey<T> (creationKey, id);
 	interface.commit ();
 
-	object.setId (result->lastInsertId ().toLongLong ());
+	object.setId (id);
 
 	if (idValid (object.getId ()))
 		emit dbEvent (DbEvent::added (object));
@@ -203,6 +278,267 @@ template<class T> int Database::countObjects ()
 }
 
 
+// *************
+// ** Changes **
+// *************
+
+// The objects (except flights) have an updated_at column which is set by the
+// database on every change, and the IDs of deleted objects are recorded in
+// the deletions table. Note that deletions by other programs accessing the
+// database are not recorded.
+
+/**
+ * Reads the objects created, changed or deleted since a given time
+ *
+ * The changes are read in a transaction, so they are consistent.
+ *
+ * Some of the changes may have been read before because changes are read
+ * again for a short time (see changesOverlap), so the caller should ignore
+ * objects that did not change.
+ *
+ * @param since the value returned by the previous call; if it is null, all
+ *              objects are returned. If the changes since then are no longer
+ *              available (see #changesExpired), all objects are returned as
+ *              well.
+ * @param changedObjects set to the objects created or changed since the
+ *                       given time
+ * @param deletedIds set to the IDs of the objects deleted since the given
+ *                   time
+ * @return the time to pass to the next call
+ */
+template<class T> QDateTime Database::getChanges (const QDateTime &since, QList<T> &changedObjects, QList<dbId> &deletedIds)
+{
+	QDateTime timestamp;
+
+	interface.transaction ();
+	try
+	{
+		timestamp=getChangesImpl (since, changedObjects, deletedIds);
+		interface.commit ();
+	}
+	catch (...)
+	{
+		interface.rollback ();
+		throw;
+	}
+
+	return timestamp;
+}
+
+/**
+ * Reads the objects created or changed since a given time, or all objects if
+ * since is null; see #getChanges
+ */
+template<class T> QList<T> Database::getChangedObjects (const QDateTime &since)
+{
+	return T::createListFromResult (*interface.executeQueryResult (changedObjectsQuery<T> (since)));
+}
+
+/**
+ * Creates the query for #getChangedObjects
+ *
+ * @param allIfExpired if true, the query returns all objects if the changes
+ *                     since the given time have expired at the time the query
+ *                     is executed (see #changesExpired). This is used if the
+ *                     query is sent before the current time is known.
+ */
+template<class T> Query Database::changedObjectsQuery (const QDateTime &since, bool allIfExpired)
+{
+	Query query=Query::select (T::dbTableName (), T::selectColumnList ());
+	if (since.isNull ())
+		return query;
+
+	QString sinceString=timestampToDb (since.addSecs (-changesOverlap));
+	if (!allIfExpired)
+		return query.condition (Query (notr ("updated_at>=?")).bind (sinceString));
+
+	// Equivalent to changesExpired; the database can still use a range on
+	// updated_at because the second part is constant.
+	QString expiredString=timestampToDb (since.addSecs (deletionsRetention-changesOverlap));
+	return query.condition (Query (notr ("(updated_at>=? OR CURRENT_TIMESTAMP>?)"))
+		.bind (sinceString).bind (expiredString));
+}
+
+/**
+ * Reads the IDs of the objects of several tables deleted since a given time
+ * with a single query; see #getChanges
+ *
+ * @return the IDs of the deleted objects, by table name
+ */
+QHash<QString, QList<dbId> > Database::getDeletedIds (const QDateTime &since, const QStringList &tables)
+{
+	QSharedPointer<Result> result=interface.executeQueryResult (deletedIdsQuery (since, tables));
+	return deletedIdsFromResult (*result);
+}
+
+/**
+ * Creates the query for #getDeletedIds
+ */
+Query Database::deletedIdsQuery (const QDateTime &since, const QStringList &tables)
+{
+	QList<QVariant> tableValues;
+	foreach (const QString &table, tables)
+		tableValues.append (table);
+
+	QString sinceString=timestampToDb (since.addSecs (-changesOverlap));
+	return Query::select (deletionsTableName, notr ("table_name,object_id"))
+		.condition (
+			Query::valueInListCondition (notr ("table_name"), tableValues)
+			+Query (notr (" AND deleted_at>=?")).bind (sinceString));
+}
+
+QHash<QString, QList<dbId> > Database::deletedIdsFromResult (Result &result)
+{
+	QHash<QString, QList<dbId> > deletedIds;
+
+	while (result.next ())
+		deletedIds[result.value (0).toString ()].append (result.value (1).toLongLong ());
+
+	return deletedIds;
+}
+
+/**
+ * Determines whether the changes since a given time are no longer available
+ * because the tombstones of deleted objects may have been removed (see
+ * deletionsRetention). In this case, #getChanges returns all objects.
+ *
+ * @param since the time passed to #getChanges
+ * @param timestamp the time returned by #getChanges
+ */
+bool Database::changesExpired (const QDateTime &since, const QDateTime &timestamp)
+{
+	if (since.isNull () || timestamp.isNull ()) return false;
+	return since.secsTo (timestamp)>deletionsRetention-changesOverlap;
+}
+
+/**
+ * Implementation of #getChanges, without a transaction
+ */
+template<class T> QDateTime Database::getChangesImpl (const QDateTime &since, QList<T> &changedObjects, QList<dbId> &deletedIds)
+{
+	// Read the time first, so changes made while we are reading will be read
+	// again next time
+	QDateTime timestamp=currentTimestamp ();
+
+	QDateTime effectiveSince=since;
+	if (changesExpired (since, timestamp))
+		effectiveSince=QDateTime ();
+
+	changedObjects=getChangedObjects<T> (effectiveSince);
+
+	if (effectiveSince.isNull ())
+		deletedIds.clear ();
+	else
+		deletedIds=getDeletedIds (effectiveSince, QStringList () << T::dbTableName ()).value (T::dbTableName ());
+
+	return timestamp;
+}
+
+/**
+ * Writes the tombstones of deleted objects; must be called in the transaction
+ * of the deletion
+ *
+ * Tombstones older than deletionsRetention are removed, so the table does not
+ * grow without bounds. Clients which last read the changes before that do a
+ * full read (see #changesExpired).
+ */
+template<class T> void Database::recordDeletions (const QList<dbId> &ids)
+{
+	if (ids.isEmpty ())
+		return;
+
+	QStringList placeholders;
+	for (int i=0; i<ids.size (); ++i)
+		placeholders.append (notr ("(?,?)"));
+
+	Query query=Query (notr ("INSERT INTO %1 (table_name,object_id) VALUES %2"))
+		.arg (deletionsTableName, placeholders.join (notr (",")));
+	foreach (dbId id, ids)
+		query.bind (T::dbTableName ()).bind (id);
+
+	interface.executeQuery (query);
+
+	QString pruneBefore=timestampToDb (currentTimestamp ().addSecs (-deletionsRetention));
+	interface.executeQuery (
+		Query (notr ("DELETE FROM %1 WHERE deleted_at<?"))
+		.arg (deletionsTableName).bind (pruneBefore));
+}
+
+template<> void Database::recordDeletions<Flight> (const QList<dbId> &ids)
+{
+	// Flights are not tracked
+	(void)ids;
+}
+
+/**
+ * Writes the creation key of a created object; must be called in the
+ * transaction of the creation
+ *
+ * Keys older than deletionsRetention are removed; a journal which has not
+ * been written for that long may create objects twice.
+ */
+template<class T> void Database::recordCreationKey (const QString &creationKey, dbId id)
+{
+	interface.executeQuery (
+		Query (notr ("INSERT INTO %1 (client_key,table_name,object_id) VALUES (?,?,?)"))
+		.arg (creationKeysTableName).bind (creationKey).bind (T::dbTableName ()).bind (id));
+
+	QString pruneBefore=timestampToDb (currentTimestamp ().addSecs (-deletionsRetention));
+	interface.executeQuery (
+		Query (notr ("DELETE FROM %1 WHERE created_at<?"))
+		.arg (creationKeysTableName).bind (pruneBefore));
+}
+
+/**
+ * Determines the ID of the object created with a given creation key (see
+ * #createObject)
+ *
+ * @return the ID of the object, or invalidId if no object has been created
+ *         with this key
+ */
+dbId Database::createdObjectId (const QString &creationKey)
+{
+	QSharedPointer<Result> result=interface.executeQueryResult (
+		Query::select (creationKeysTableName, notr ("object_id"))
+		.condition (Query (notr ("client_key=?")).bind (creationKey)));
+
+	if (!result->next ()) return invalidId;
+	return result->value (0).toLongLong ();
+}
+
+/**
+ * Determines the current time of the database server. We use the server's
+ * time rather than the local time so the clocks need not be synchronized.
+ */
+QDateTime Database::currentTimestamp ()
+{
+	QSharedPointer<Result> result=interface.executeQueryResult (Query (notr ("SELECT CURRENT_TIMESTAMP")));
+	if (!result->next ()) return QDateTime ();
+	return timestampFromDb (result->value (0));
+}
+
+/**
+ * Formats a timestamp for comparing it with a timestamp column
+ *
+ * We don't bind the QDateTime directly because the SQLite driver would bind
+ * it in ISO format ("T" separator), and SQLite compares timestamps as
+ * strings.
+ */
+QString Database::timestampToDb (const QDateTime &timestamp)
+{
+	return timestamp.toString (notr ("yyyy-MM-dd hh:mm:ss"));
+}
+
+QDateTime Database::timestampFromDb (const QVariant &value)
+{
+	// MySQL returns a QDateTime, SQLite returns a string
+	if (value.type ()==QVariant::DateTime)
+		return value.toDateTime ();
+	else
+		return QDateTime::fromString (value.toString (), notr ("yyyy-MM-dd hh:mm:ss"));
+}
+
+
 // *******************
 // ** Very specific **
 // *******************
@@ -240,7 +576,11 @@ QStringList Database::listPlaneTypes ()
 }
 
 
-QList<Flight> Database::getPreparedFlights ()
+/**
+ * Returns the conditions for the prepared flights, to be combined with UNION
+ * ALL (see #getObjects)
+ */
+QList<Query> Database::preparedFlightsConditions ()
 {
 	// The correct criterion for prepared flights is:
 	// !(happened)
@@ -260,27 +600,293 @@ QList<Flight> Database::getPreparedFlights ()
 	// Note that we test for =0 or !=0 explicitly rather than evaluating the
 	// values as booleans (i. e. 'where departed=0' instead of 'where
 	// departed') because evaluating as booleans prevents using the index
+	//
+	// The database cannot use an index for the negated clauses, so we split
+	// the condition by mode into disjoint conditions, each of which can use
+	// one of the indexes mode_status_index (mode, departed, landed) and
+	// mode_landed_index (mode, landed):
+	//   (local and !departed and !landed)
+	//   (leaving and !departed)
+	//   (coming and !landed)
+	//   (other or no mode)
+	// Flights with other modes (or no mode) are invalid, but they are
+	// included (like before), so they are displayed and can be fixed. "mode
+	// NOT IN (...)" cannot use an index, so we select the ranges between the
+	// valid modes instead, and no mode separately.
 
 	// TODO to Flight
-	// TODO multi-bind
-	Query condition (notr ("!(mode=? AND !(departed=0 AND landed=0)) AND !(mode=? AND departed!=0) AND !(mode=? AND landed!=0)"));
-	condition.bind (Flight::modeToDb (Flight::modeLocal  ));
-	condition.bind (Flight::modeToDb (Flight::modeLeaving));
-	condition.bind (Flight::modeToDb (Flight::modeComing ));
+	QString local  =Flight::modeToDb (Flight::modeLocal  );
+	QString leaving=Flight::modeToDb (Flight::modeLeaving);
+	QString coming =Flight::modeToDb (Flight::modeComing );
+
+	QList<Query> conditions;
+	conditions << Query (notr ("mode=? AND departed=0 AND landed=0")).bind (local);
+	conditions << Query (notr ("mode=? AND departed=0"              )).bind (leaving);
+	conditions << Query (notr ("mode=? AND landed=0"                )).bind (coming);
+
+	QStringList modes;
+	modes << local << leaving << coming;
+	modes.sort ();
+	conditions << Query (notr ("mode IS NULL"));
+	conditions << Query (notr ("mode<?")).bind (modes.first ());
+	for (int i=0; i+1<modes.size (); ++i)
+		conditions << Query (notr ("mode>? AND mode<?")).bind (modes.at (i)).bind (modes.at (i+1));
+	conditions << Query (notr ("mode>?")).bind (modes.last ());
+
+	return conditions;
+}
 
-	return getObjects<Flight> (condition);
+QList<Flight> Database::getPreparedFlights ()
+{
+	return getObjects<Flight> (preparedFlightsConditions ());
 }
 
 QList<Flight> Database::getFlightsDate (QDate date)
 {
-	Query condition=Flight::dateSupersetCondition (date);
+	QList<Query> conditions=Flight::dateSupersetConditions (date);
 
-	QList<Flight> candidates=getObjects<Flight> (condition);
+	QList<Flight> candidates=getObjects<Flight> (conditions);
 	QList<Flight> flights=Flight::dateSupersetFilter (candidates, date);
 
 	return flights;
 }
 
+// **************
+// ** Snapshot **
+// **************
+
+Database::Snapshot::Snapshot ()
+{
+}
+
+Database::Snapshot::~Snapshot ()
+{
+}
+
+/**
+ * Reads all data required by the Cache in a single transaction
+ *
+ * With InnoDB (and SQLite), all reads in a transaction see the same snapshot
+ * of the database, so the data is consistent even if other stations write to
+ * the database at the same time (e. g. there are no flights referencing a
+ * person created after the people were read).
+ *
+ * To reduce the number of round trips, the flights of both dates and the
+ * prepared flights are read with a single query and separated afterwards,
+ * and the locations and accounting notes are also read with a single query.
+ * The timestamp is read only once, and the deletions of all three object
+ * types are read with a single query.
+ *
+ * On MySQL, all statements, including the transaction, are sent as a single
+ * multi-statement query, so the snapshot takes one round trip (see
+ * #readSnapshotBatch). On SQLite, which does not support this (and does not
+ * need it), the statements are executed one after the other (see
+ * #readSnapshotSequential).
+ *
+ * @param otherDate the date of the other flights; may be null
+ * @param since if valid, only the planes, people and launch methods changed
+ *              since then are read (see #getChanges); pass the timestamp of
+ *              the previous snapshot. If the changes are no longer available,
+ *              all objects are read and the changedSince of the snapshot is
+ *              null.
+ */
+void Database::getSnapshot (Snapshot &snapshot, const QDate &todayDate, const QDate &otherDate, const QDateTime &since, OperationMonitorInterface monitor)
+{
+	// Set to null if the changes are no longer available
+	QDateTime changedSince=since;
+
+	// Flights: the union of the superset conditions, separated by the
+	// filters afterwards
+	QList<Query> flightConditions=Flight::dateSupersetConditions (todayDate);
+	if (!otherDate.isNull ())
+		flightConditions+=Flight::dateSupersetConditions (otherDate);
+	flightConditions+=preparedFlightsConditions ();
+	Query flightsQuery=anyConditionQuery<Flight> (flightConditions);
+
+	// Value lists, with the list number in the first column
+	Query locationsQuery=Query::selectDistinctColumns (
+		Flight::dbTableName (),
+		QStringList () << notr ("departure_location") << notr ("landing_location") << notr ("towflight_landing_location"),
+		true);
+	Query accountingNotesQuery=Query::selectDistinctColumns (
+		Flight::dbTableName (),
+		notr ("accounting_notes"),
+		true);
+	Query valuesQuery=
+		Query (notr ("SELECT 0, locations.* FROM ("))+locationsQuery+notr (") AS locations")+
+		notr (" UNION ALL ")+
+		Query (notr ("SELECT 1, accounting_notes.* FROM ("))+accountingNotesQuery+notr (") AS accounting_notes");
+
+	QList<Flight> flights;
+	snapshot.locations.clear ();
+	snapshot.accountingNotes.clear ();
+	snapshot.deletedPlaneIds       .clear ();
+	snapshot.deletedPersonIds      .clear ();
+	snapshot.deletedLaunchMethodIds.clear ();
+
+	if (interface.isSqlite ())
+		readSnapshotSequential (snapshot, changedSince, flights, flightsQuery, valuesQuery, monitor);
+	else
+		readSnapshotBatch (snapshot, changedSince, flights, flightsQuery, valuesQuery, monitor);
+
+	snapshot.changedSince=changedSince;
+	snapshot.todayDate=todayDate;
+	snapshot.otherDate=otherDate;
+	snapshot.flightsToday=Flight::dateSupersetFilter (flights, todayDate);
+	if (!otherDate.isNull ())
+		snapshot.flightsOther=Flight::dateSupersetFilter (flights, otherDate);
+	foreach (const Flight &flight, flights)
+		if (flight.isPrepared ())
+			snapshot.preparedFlights.append (flight);
+
+	monitor.progress (5, 5);
+}
+
+/**
+ * Reads the data of #getSnapshot with one query per statement
+ *
+ * @param changedSince set to null if the changes have expired
+ */
+void Database::readSnapshotSequential (Snapshot &snapshot, QDateTime &changedSince, QList<Flight> &flights, const Query &flightsQuery, const Query &valuesQuery, OperationMonitorInterface monitor)
+{
+	interface.transaction ();
+	try
+	{
+		// Read the time first, so changes made while we are reading will be
+		// read again next time (see #getChangesImpl)
+		snapshot.timestamp=currentTimestamp ();
+		if (changesExpired (changedSince, snapshot.timestamp))
+			changedSince=QDateTime ();
+
+		monitor.progress (0, 5, tr ("Retrieving %1").arg (Plane::objectTypeDescriptionPlural ()));
+		snapshot.planes=getChangedObjects<Plane> (changedSince);
+
+		monitor.progress (1, 5, tr ("Retrieving %1").arg (Person::objectTypeDescriptionPlural ()));
+		snapshot.people=getChangedObjects<Person> (changedSince);
+
+		monitor.progress (2, 5, tr ("Retrieving %1").arg (LaunchMethod::objectTypeDescriptionPlural ()));
+		snapshot.launchMethods=getChangedObjects<LaunchMethod> (changedSince);
+
+		if (!changedSince.isNull ())
+			setSnapshotDeletedIds (snapshot, getDeletedIds (changedSince, snapshotTables ()));
+
+		monitor.progress (3, 5, tr ("Retrieving %1").arg (Flight::objectTypeDescriptionPlural ()));
+		flights=uniqueObjects (Flight::createListFromResult (*interface.executeQueryResult (flightsQuery)));
+
+		monitor.progress (4, 5, tr ("Retrieving locations and accounting notes"));
+		setSnapshotValues (snapshot, *interface.executeQueryResult (valuesQuery));
+
+		interface.commit ();
+	}
+	catch (...)
+	{
+		interface.rollback ();
+		throw;
+	}
+}
+
+/**
+ * Reads the data of #getSnapshot with a single multi-statement query
+ *
+ * The bind values are inlined (see Interface::multiStatementQuery). All
+ * values are generated by the program (dates, timestamps, table names and
+ * flight modes).
+ *
+ * If a statement fails, the following statements are not executed. As the
+ * transaction may still be open in this case, it is rolled back.
+ *
+ * The changes are read before the current time is known, so the queries
+ * return all objects if the changes have expired (see #changedObjectsQuery).
+ *
+ * @param changedSince set to null if the changes have expired
+ */
+void Database::readSnapshotBatch (Snapshot &snapshot, QDateTime &changedSince, QList<Flight> &flights, const Query &flightsQuery, const Query &valuesQuery, OperationMonitorInterface monitor)
+{
+	bool readDeletions=!changedSince.isNull ();
+
+	QList<Query> queries;
+	queries << Query (notr ("START TRANSACTION WITH CONSISTENT SNAPSHOT"));
+	// Read the time first, so changes made while we are reading will be read
+	// again next time (see #getChangesImpl)
+	queries << Query (notr ("SELECT CURRENT_TIMESTAMP"));
+	queries << changedObjectsQuery<Plane       > (changedSince, true);
+	queries << changedObjectsQuery<Person      > (changedSince, true);
+	queries << changedObjectsQuery<LaunchMethod> (changedSince, true);
+	if (readDeletions)
+		queries << deletedIdsQuery (changedSince, snapshotTables ());
+	queries << flightsQuery;
+	queries << valuesQuery;
+	queries << Query (notr ("COMMIT"));
+
+	Query batch=Interface::multiStatementQuery (queries);
+
+	monitor.progress (0, 5, tr ("Retrieving data"));
+
+	try
+	{
+		QSharedPointer<Result> result=interface.executeQueryResult (batch);
+		int resultCount=queries.size ();
+
+		// The first result set is the one of START TRANSACTION
+		Interface::nextResultSet (*result, batch, resultCount);
+		if (result->next ()) snapshot.timestamp=timestampFromDb (result->value (0));
+		if (changesExpired (changedSince, snapshot.timestamp))
+			changedSince=QDateTime ();
+
+		Interface::nextResultSet (*result, batch, resultCount);
+		snapshot.planes=Plane::createListFromResult (*result);
+		Interface::nextResultSet (*result, batch, resultCount);
+		snapshot.people=Person::createListFromResult (*result);
+		Interface::nextResultSet (*result, batch, resultCount);
+		snapshot.launchMethods=LaunchMethod::createListFromResult (*result);
+
+		if (readDeletions)
+		{
+			Interface::nextResultSet (*result, batch, resultCount);
+			// If the changes have expired, all objects have been read
+			if (!changedSince.isNull ())
+				setSnapshotDeletedIds (snapshot, deletedIdsFromResult (*result));
+		}
+
+		Interface::nextResultSet (*result, batch, resultCount);
+		flights=uniqueObjects (Flight::createListFromResult (*result));
+
+		Interface::nextResultSet (*result, batch, resultCount);
+		setSnapshotValues (snapshot, *result);
+
+		// Make sure that the COMMIT has been executed
+		Interface::nextResultSet (*result, batch, resultCount);
+	}
+	catch (...)
+	{
+		interface.rollback ();
+		throw;
+	}
+}
+
+QStringList Database::snapshotTables ()
+{
+	return QStringList () << Plane::dbTableName () << Person::dbTableName () << LaunchMethod::dbTableName ();
+}
+
+void Database::setSnapshotDeletedIds (Snapshot &snapshot, const QHash<QString, QList<dbId> > &deletedIds)
+{
+	snapshot.deletedPlaneIds       =deletedIds.value (Plane       ::dbTableName ());
+	snapshot.deletedPersonIds      =deletedIds.value (Person      ::dbTableName ());
+	snapshot.deletedLaunchMethodIds=deletedIds.value (LaunchMethod::dbTableName ());
+}
+
+void Database::setSnapshotValues (Snapshot &snapshot, Result &result)
+{
+	while (result.next ())
+	{
+		if (result.value (0).toInt ()==0)
+			snapshot.locations.append (result.value (1).toString ());
+		else
+			snapshot.accountingNotes.append (result.value (1).toString ());
+	}
+}
+
 template<class T> bool Database::objectUsed (dbId id)
 {
 	(void)id;
@@ -290,8 +896,8 @@ template<class T> bool Database::objectUsed (dbId id)
 
 template<> bool Database::objectUsed<Person> (dbId id)
 {
-	// ATTENTION: make sure that DbManager::mergePeople correspondents to this
-	// method
+	// ATTENTION: make sure that DbManager::mergePeople and usedObjects<Person>
+	// correspondent to this method
 
 	// A person may be referenced by a flight
 	if (objectExists<Flight> (Flight::referencesPersonCondition (id))) return true;
@@ -329,6 +935,88 @@ template<> bool Database::objectUsed<Flight> (dbId id)
 }
 
 
+/**
+ * Determines which of the given IDs occur in any of the given columns of a
+ * table, using one query (a UNION of the columns) per chunk of IDs
+ */
+QSet<dbId> Database::referencedIds (const QString &table, const QStringList &columns, const QList<dbId> &ids)
+{
+	QSet<dbId> result;
+
+	for (int first=0; first<ids.size (); first+=maxIdsPerQuery)
+	{
+		QList<QVariant> chunk=convertType<QVariant> (ids.mid (first, maxIdsPerQuery));
+
+		Query query;
+		foreach (const QString &column, columns)
+		{
+			if (!query.isEmpty ())
+				query+=Query (notr (" UNION "));
+
+			query+=Query::selectDistinctColumns (table, column)
+				+Query (notr (" WHERE "))
+				+Query::valueInListCondition (column, chunk);
+		}
+
+		QSharedPointer<Result> queryResult=interface.executeQueryResult (query);
+		while (queryResult->next ())
+			result.insert (queryResult->value (0).toLongLong ());
+	}
+
+	return result;
+}
+
+/**
+ * Determines which of the given objects are in use, with one query per
+ * referencing table instead of one query per object and table
+ *
+ * This is equivalent to calling objectUsed for each ID.
+ *
+ * @return the subset of ids that are in use
+ */
+template<class T> QSet<dbId> Database::usedObjects (const QList<dbId> &ids)
+{
+	// Return all IDs for safety; specialize for specific classes
+	return ids.toSet ();
+}
+
+template<> QSet<dbId> Database::usedObjects<Person> (const QList<dbId> &ids)
+{
+	// ATTENTION: make sure that objectUsed<Person> correspondents to this
+	// method
+
+	// People may be referenced by flights
+	QSet<dbId> result=referencedIds (Flight::dbTableName (),
+		QStringList () << notr ("pilot_id") << notr ("copilot_id") << notr ("towpilot_id"), ids);
+
+	// People may be referenced by users (although we don't have a user model
+	// here, only in sk_web)
+	result.unite (referencedIds (notr ("users"), QStringList (notr ("person_id")), ids));
+
+	return result;
+}
+
+template<> QSet<dbId> Database::usedObjects<Plane> (const QList<dbId> &ids)
+{
+	// Planes may be referenced by flights
+	return referencedIds (Flight::dbTableName (), QStringList () << notr ("plane_id") << notr ("towplane_id"), ids);
+}
+
+template<> QSet<dbId> Database::usedObjects<LaunchMethod> (const QList<dbId> &ids)
+{
+	// Launch methods may be referenced by flights
+	return referencedIds (Flight::dbTableName (), QStringList (notr ("launch_method_id")), ids);
+}
+
+template<> QSet<dbId> Database::usedObjects<Flight> (const QList<dbId> &ids)
+{
+	(void)ids;
+
+	// Flights are never used
+	return QSet<dbId> ();
+}
+
+
 // **********
 // ** Misc **
 // **********
@@ -355,17 +1043,24 @@ void Database::emitDbEvent (DbEvent event)
 
 #define INSTANTIATE_TEMPLATES(T) \
 	template QList<T> Database::getObjects       (const Query &condition); \
+	template QList<T> Database::getObjects       (const QList<Query> &conditions); \
 	template int      Database::countObjects<T>  (const Query &condition); \
 	template bool     Database::objectExists<T>  (dbId id); \
 	template T        Database::getObject        (dbId id); \
 	template bool     Database::deleteObject<T>  (dbId id); \
 	template int      Database::deleteObjects<T> (const QList<dbId> &id); \
-	template dbId     Database::createObject     (T &object); \
+	template dbId     Database::createObject     (T &object, const QString &creationKey); \
 	template void     Database::createObjects    (QList<T> &objects, OperationMonitorInterface monitor); \
 	template bool     Database::updateObject     (const T &object); \
 	template QList<T> Database::getObjects  <T>  (); \
 	template int      Database::countObjects<T>  (); \
-	template bool     Database::objectUsed<T>    (dbId id);
+	template bool     Database::objectUsed<T>    (dbId id); \
+	template QSet<dbId> Database::usedObjects<T> (const QList<dbId> &ids);
+
+	// Empty line
+
+#define INSTANTIATE_TRACKED_TEMPLATES(T) \
+	template QDateTime Database::getChanges (const QDateTime &since, QList<T> &changedObjects, QList<dbId> &deletedIds);
 
 	// Empty line
 
@@ -374,4 +1069,9 @@ INSTANTIATE_TEMPLATES (Plane       )
 INSTANTIATE_TEMPLATES (Flight      )
 INSTANTIATE_TEMPLATES (LaunchMethod)
 
+INSTANTIATE_TRACKED_TEMPLATES (Person      )
+INSTANTIATE_TRACKED_TEMPLATES (Plane       )
+INSTANTIATE_TRACKED_TEMPLATES (LaunchMethod)
+
 #undef INSTANTIATE_TEMPLATES
+#undef INSTANTIATE_TRACKED_TEMPLATES
@@ -5,9 +5,12 @@
 #include <QList>
 #include <QtSql>
 #include <QHash>
+#include <QSet>
 #include <QStringList>
 #include <QSqlError>
 #include <QObject>
+#include <QDate>
+#include <QDateTime>
 
 #include "src/db/dbId.h"
 #include "src/db/interface/Interface.h"
@@ -15,6 +18,9 @@
 #include "src/concurrent/monitor/OperationMonitorInterface.h"
 
 class Flight;
+class Person;
+class Plane;
+class LaunchMethod;
 
 
 /**
@@ -49,6 +55,45 @@ class Database: public QObject
 		// *** Data types
 		class NotFoundException {};
 
+		// *** Constants
+		static const QString deletionsTableName;
+		static const QString creationKeysTableName;
+
+		/**
+		 * The data required by the Cache, read at a single point in time (see
+		 * #getSnapshot)
+		 */
+		class Snapshot
+		{
+			public:
+				Snapshot ();
+				~Snapshot ();
+
+				// If changedSince is valid, the object lists only contain the
+				// objects changed since then (see #getChanges)
+				QDateTime changedSince;
+				QDateTime timestamp;
+
+				QList<Plane> planes;
+				QList<Person> people;
+				QList<LaunchMethod> launchMethods;
+				QList<dbId> deletedPlaneIds;
+				QList<dbId> deletedPersonIds;
+				QList<dbId> deletedLaunchMethodIds;
+
+				QDate todayDate, otherDate;
+				QList<Flight> flightsToday;
+				QList<Flight> flightsOther;
+				QList<Flight> preparedFlights;
+
+				QStringList locations;
+				QStringList accountingNotes;
+
+			private:
+				Snapshot (const Snapshot &other);
+				Snapshot &operator= (const Snapshot &other);
+		};
+
 		// *** Construction
 		Database (Interface &interface);
 		virtual ~Database ();
@@ -56,15 +101,17 @@ class Database: public QObject
 		// *** ORM
 		// Template functions, instantiated for the relevant classes
 		template<class T> QList<T> getObjects (const Query &condition);
+		template<class T> QList<T> getObjects (const QList<Query> &conditions);
 		template<class T> int countObjects (const Query &condition);
 		template<class T> bool objectExists (const Query &condition);
 		template<class T> bool objectExists (dbId id);
 		template<class T> T getObject (dbId id);
 		template<class T> bool deleteObject (dbId id);
 		template<class T> int deleteObjects (const QList<dbId> &ids);
-		template<class T> dbId createObject (T &object);
+		template<class T> dbId createObject (T &object, const QString &creationKey=QString ());
 		template<class T> void createObjects (QList<T> &objects, OperationMonitorInterface monitor=OperationMonitorInterface::null);
 		template<class T> bool updateObject (const T &object);
+		dbId createdObjectId (const QString &creationKey);
 
 		// We could use a default parameter for the corresponding methods
 		// taking a Query&, but that would require files using this method
@@ -72,9 +119,16 @@ class Database: public QObject
 		template<class T> QList<T> getObjects ();
 		template<class T> int countObjects ();
 
+		// *** Changes
+		// Only for the classes with modification tracking (not Flight)
+		template<class T> QDateTime getChanges (const QDateTime &since, QList<T> &changedObjects, QList<dbId> &deletedIds);
+		static bool changesExpired (const QDateTime &since, const QDateTime &timestamp);
+
 		// *** Selection frontends
+		static QList<Query> preparedFlightsConditions ();
 		virtual QList<Flight> getPreparedFlights ();
 		virtual QList<Flight> getFlightsDate (QDate date);
+		virtual void getSnapshot (Snapshot &snapshot, const QDate &todayDate, const QDate &otherDate, const QDateTime &changedSince=QDateTime (), OperationMonitorInterface monitor=OperationMonitorInterface::null);
 
 		// *** Value lists
 		virtual QStringList listLocations ();
@@ -84,6 +138,7 @@ class Database: public QObject
 
 		// *** Additional properties
 		template<class T> bool objectUsed (dbId id);
+		template<class T> QSet<dbId> usedObjects (const QList<dbId> &ids);
 
 	public slots:
 		void cancelConnection ();
@@ -94,7 +149,54 @@ class Database: public QObject
 	protected:
 		void emitDbEvent (DbEvent event);
 
+
+		// *** Changes
+		template<class T> QDateTime getChangesImpl (const QDateTime &since, QList<T> &changedObjects, QList<dbId> &deletedIds);
+		template<class T> QList<T> getChangedObjects (const QDateTime &since);
+		template<class T> Query changedObjectsQuery (const QDateTime &since, bool allIfExpired=false);
+		QHash<QString, QList<dbId> > getDeletedIds (const QDateTime &since, const QStringList &tables);
+		Query deletedIdsQuery (const QDateTime &since, const QStringList &tables);
+		static QHash<QString, QList<dbId> > deletedIdsFromResult (Result &result);
+		template<class T> void recordDeletions (const QList<dbId> &ids);
+		template<class T> void recordCreationKey (const QString &creationKey, dbId id);
+		QDateTime currentTimestamp ();
+		static QString timestampToDb (const QDateTime &timestamp);
+		static QDateTime timestampFromDb (const QVariant &value);
+
+		// *** ORM
+		template<class T> Query anyConditionQuery (const QList<Query> &conditions);
+		template<class T> static QList<T> uniqueObjects (const QList<T> &objects);
+
+		// *** Snapshot
+		void readSnapshotSequential (Snapshot &snapshot, QDateTime &changedSince, QList<Flight> &flights, const Query &flightsQuery, const Query &valuesQuery, OperationMonitorInterface monitor);
+		void readSnapshotBatch (Snapshot &snapshot, QDateTime &changedSince, QList<Flight> &flights, const Query &flightsQuery, const Query &valuesQuery, OperationMonitorInterface monitor);
+		static QStringList snapshotTables ();
+		static void setSnapshotDeletedIds (Snapshot &snapshot, const QHash<QString, QList<dbId> > &deletedIds);
+		static void setSnapshotValues (Snapshot &snapshot, Result &result);
+
+		// *** Additional properties
+		QSet<dbId> referencedIds (const QString &table, const QStringList &columns, const QList<dbId> &ids);
+
 	private:
+		// Changes are read again for this time (in seconds) to account for
+		// the resolution of the timestamps and for writes that were not yet
+		// committed. This is a limit: a change committed more than this time
+		// after its updated_at timestamp was set (i. e. in a transaction
+		// running longer than that) is not read by an incremental refresh,
+		// only by the next full read. Our own writes are short transactions;
+		// other programs writing to the database must not keep transactions
+		// open for longer.
+		static const int changesOverlap=10;
+
+		// Tombstones are kept for this time (in seconds). Changes since an
+		// older time are not available; all objects are read instead (see
+		// #changesExpired). Creation keys are kept for the same time.
+		static const int deletionsRetention=7*24*3600;
+
+		// The number of IDs in an IN list; SQLite allows at most 999 bound
+		// values per query
+		static const int maxIdsPerQuery=250;
+
 		Interface &interface;
 };
 
@@ -1,13 +1,16 @@
 #include "DatabaseInfo.h"
 
 #include <QSettings>
+#include <QDir>
+#include <QFileInfo>
+#include <QDesktopServices>
 
 #include <iostream>
 
 #include "src/i18n/notr.h"
 
 DatabaseInfo::DatabaseInfo ():
-	defaultPort (true), port (0)
+	type (typeMysql), defaultPort (true), port (0)
 {
 }
 
@@ -16,7 +19,7 @@ DatabaseInfo::~DatabaseInfo ()
 }
 
 DatabaseInfo::DatabaseInfo (QSettings &settings):
-	defaultPort (true), port (0)
+	type (typeMysql), defaultPort (true), port (0)
 {
 	load (settings);
 }
@@ -24,7 +27,10 @@ DatabaseInfo::DatabaseInfo (QSettings &settings):
 
 QString DatabaseInfo::toString () const
 {
-	return qnotr ("%1@%2:%3").arg (username, server, database);
+	if (type==typeSqlite)
+		return qnotr ("sqlite:%1").arg (sqliteFileName ());
+	else
+		return qnotr ("%1@%2:%3").arg (username, server, database);
 }
 
 DatabaseInfo::operator QString () const
@@ -34,14 +40,33 @@ DatabaseInfo::operator QString () const
 
 QString DatabaseInfo::serverText () const
 {
-	if (defaultPort)
+	if (type==typeSqlite)
+		return sqliteFileName ();
+	else if (defaultPort)
 		return server;
 	else
 		return qnotr ("%1:%2").arg (server).arg (port);
 }
 
+/**
+ * Determines the file name of an SQLite database
+ *
+ * If the database name is an absolute path, it is used as file name.
+ * Otherwise, the file is located in the data directory of the program and the
+ * extension ".sqlite" is appended.
+ */
+QString DatabaseInfo::sqliteFileName () const
+{
+	if (QFileInfo (database).isAbsolute ())
+		return database;
+
+	QString directory=QDesktopServices::storageLocation (QDesktopServices::DataLocation);
+	return QDir (directory).filePath (database+notr (".sqlite"));
+}
+
 void DatabaseInfo::load (QSettings &settings)
 {
+	type       =typeFromDb (settings.value (notr ("type"), notr ("mysql")).toString ());
 	server     =settings.value (notr ("server")     , notr ("localhost")  ).toString ();
 	defaultPort=settings.value (notr ("defaultPort"), true                ).toBool   ();
 	port       =settings.value (notr ("port")       , 3306                ).toInt    ();
@@ -52,6 +77,7 @@ void DatabaseInfo::load (QSettings &settings)
 
 void DatabaseInfo::save (QSettings &settings)
 {
+	settings.setValue (notr ("type")       , typeToDb (type));
 	settings.setValue (notr ("server")     , server     );
 	settings.setValue (notr ("defaultPort"), defaultPort);
 	settings.setValue (notr ("port")       , port       );
@@ -73,6 +99,12 @@ void DatabaseInfo::save (QSettings &settings)
  */
 bool DatabaseInfo::different (const DatabaseInfo &other)
 {
+	if (type!=other.type) return true;
+
+	// For SQLite, only the file is relevant
+	if (type==typeSqlite)
+		return sqliteFileName ()!=other.sqliteFileName ();
+
 	if (server          !=other.server          ) return true;
 	if (effectivePort ()!=other.effectivePort ()) return true;
 	if (username        !=other.username        ) return true;
@@ -81,3 +113,22 @@ bool DatabaseInfo::different (const DatabaseInfo &other)
 
 	return false;
 }
+
+
+QString DatabaseInfo::typeToDb (Type type)
+{
+	switch (type)
+	{
+		case typeMysql : return notr ("mysql");
+		case typeSqlite: return notr ("sqlite");
+		// no default
+	}
+
+	return notr ("mysql");
+}
+
+DatabaseInfo::Type DatabaseInfo::typeFromDb (const QString &type)
+{
+	if (type==notr ("sqlite")) return typeSqlite;
+	else return typeMysql;
+}
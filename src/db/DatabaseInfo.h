@@ -5,9 +5,17 @@
 
 class QSettings;
 
+/**
+ * The parameters for accessing a database
+ *
+ * For an SQLite database, only the database name is used. It specifies the
+ * file name of the database, see #sqliteFileName.
+ */
 class DatabaseInfo
 {
 	public:
+		enum Type { typeMysql, typeSqlite };
+
 		DatabaseInfo ();
 		DatabaseInfo (QSettings &settings);
 		virtual ~DatabaseInfo ();
@@ -20,10 +28,15 @@ class DatabaseInfo
 		virtual void save (QSettings &settings);
 
 		virtual int effectivePort () const { return defaultPort ? 3306 : port; }
+		virtual QString sqliteFileName () const;
+
+		static QString typeToDb (Type type);
+		static Type typeFromDb (const QString &type);
 
 		virtual bool different (const DatabaseInfo &other);
 
 		// Update: toString, serverText, load, save, different
+		Type type;
 		QString server;
 		bool defaultPort;
 		int port;
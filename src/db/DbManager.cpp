@@ -12,6 +12,7 @@
 
 #include <QObject>
 #include <QInputDialog>
+#include <QUuid>
 
 #include "src/concurrent/monitor/SignalOperationMonitor.h"
 #include "src/gui/windows/MonitorDialog.h"
@@ -29,16 +30,49 @@
 #include "src/model/Flight.h"
 #include "src/config/Settings.h"
 #include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
 
 #include "src/concurrent/DefaultQThread.h" //remove
 
+/**
+ * An update written in the background by updateFlightOptimistic
+ */
+class DbManager::OptimisticUpdate
+{
+	public:
+		OptimisticUpdate (const Flight &flight):
+			flight (flight)
+		{
+		}
+
+		// The flight to write; accessed by the worker
+		Flight flight;
+
+		Returner<bool> returner;
+		SignalOperationMonitor monitor;
+};
+
+/**
+ * A replay of the write journal in the background, see
+ * replayJournalInBackground
+ */
+class DbManager::JournalReplay
+{
+	public:
+		Returner<QStringList> returner;
+		SignalOperationMonitor monitor;
+};
+
 DbManager::DbManager (const DatabaseInfo &info):
-	state (stateDisconnected),
+	state (stateDisconnected), linkDown (false),
 	interface (info, 5000, 2000), db (interface), cache (db),
-	interfaceWorker (interface), dbWorker (db), migratorWorker (interface), cacheWorker (cache)
+	interfaceWorker (interface), dbWorker (db), migratorWorker (interface), cacheWorker (cache),
+	journal (journalInfo (info)), journalAvailable (false),
+	journalReplay (NULL)
 {
-	QObject::connect (&interface, SIGNAL (readTimeout ()), this, SIGNAL (readTimeout ()));
-	QObject::connect (&interface, SIGNAL (readResumed ()), this, SIGNAL (readResumed ()));
+	QObject::connect (&interface, SIGNAL (readTimeout ()), this, SLOT (interfaceReadTimeout ()));
+	QObject::connect (&interface, SIGNAL (readResumed ()), this, SLOT (interfaceReadResumed ()));
+	QObject::connect (&journal, SIGNAL (dbEvent (DbEvent)), &cache, SLOT (dbChanged (DbEvent)));
 	QObject::connect (&Settings::instance (), SIGNAL (changed ()), this, SLOT (settingsChanged ()));
 
 	QObject::connect (&migratorWorker, SIGNAL (migrationStarted ()), this, SIGNAL (migrationStarted ()));
@@ -48,7 +82,9 @@ DbManager::DbManager (const DatabaseInfo &info):
 DbManager::DbManager (const DbManager &other):
 	QObject (),
 	interface (other.interface.getInfo ()), db (interface), cache (db),
-	interfaceWorker (interface), dbWorker (db), migratorWorker (interface), cacheWorker (cache)
+	interfaceWorker (interface), dbWorker (db), migratorWorker (interface), cacheWorker (cache),
+	journal (journalInfo (other.interface.getInfo ())),
+	journalReplay (NULL)
 {
 	assert (!notr ("DbManager copied"));
 }
@@ -387,6 +423,9 @@ void DbManager::connectImpl (QWidget *parent)
 		openInterface (parent);
 		checkVersion (parent);
 
+		openJournal ();
+		replayJournal (parent);
+
 		clearCache ();
 		refreshCache (parent);
 	}
@@ -400,6 +439,8 @@ void DbManager::connectImpl (QWidget *parent)
 
 bool DbManager::connect (QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::connect");
+
 	setState (stateConnecting);
 
 	try
@@ -467,6 +508,8 @@ void DbManager::clearCache ()
 
 void DbManager::refreshCache (QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::refreshCache");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -483,6 +526,8 @@ void DbManager::refreshCache (QWidget *parent)
  */
 void DbManager::fetchFlights (QDate date, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::fetchFlights");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -491,6 +536,36 @@ void DbManager::fetchFlights (QDate date, QWidget *parent)
 	returner.wait ();
 }
 
+/**
+ * Prefetches the flights of the dates around a date in the background, so
+ * browsing the dates does not have to wait for the database
+ *
+ * The previous and the next day are fetched first, then the rest of the week
+ * (Monday to Sunday). Dates after today are not fetched.
+ */
+void DbManager::prefetchFlights (const QDate &date)
+{
+	if (date.isNull ()) return;
+
+	// Don't add load to a connection which is not responding
+	if (linkDown) return;
+
+	QDate today=QDate::currentDate ();
+
+	QList<QDate> candidates;
+	candidates << date.addDays (-1) << date.addDays (1);
+	QDate monday=date.addDays (1-date.dayOfWeek ());
+	for (int i=0; i<7; ++i)
+		candidates << monday.addDays (i);
+
+	QList<QDate> dates;
+	foreach (const QDate &candidate, candidates)
+		if (candidate!=date && candidate<=today && !dates.contains (candidate))
+			dates.append (candidate);
+
+	cacheWorker.prefetchFlights (dates);
+}
+
 /**
  * Gets and returns the flights of a date range
  *
@@ -504,13 +579,15 @@ void DbManager::fetchFlights (QDate date, QWidget *parent)
 // query selection (and potentially the after filter) outside of this method
 QList<Flight> DbManager::getFlights (const QDate &first, const QDate &last, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::getFlights");
+
 	Returner<QList<Flight> > returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
 	// FIXME make sure that not dbWorker method is called with a temporary as
 	// a reference
-	Query condition=Flight::dateRangeSupersetCondition (first, last);
-	dbWorker.getObjects<Flight> (returner, monitor, condition);
+	QList<Query> conditions=Flight::dateRangeSupersetConditions (first, last);
+	dbWorker.getObjects<Flight> (returner, monitor, conditions);
 	MonitorDialog::monitor (monitor, tr ("Retrieving flights"), parent);
 	QList<Flight> candidates=returner.returnedValue ();
 	return Flight::dateRangeSupersetFilter (candidates, first, last);
@@ -518,6 +595,8 @@ QList<Flight> DbManager::getFlights (const QDate &first, const QDate &last, QWid
 
 template<class T> void DbManager::refreshObjects (QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::refreshObjects");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -528,6 +607,8 @@ template<class T> void DbManager::refreshObjects (QWidget *parent)
 
 template<class T> bool DbManager::objectUsed (dbId id, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::objectUsed");
+
 	Returner<bool> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -536,50 +617,471 @@ template<class T> bool DbManager::objectUsed (dbId id, QWidget *parent)
 	return returner.returnedValue ();
 }
 
+/**
+ * Determines which of the given objects are in use, with one query per
+ * referencing table
+ *
+ * @return the subset of ids that are in use
+ */
+template<class T> QSet<dbId> DbManager::usedObjects (const QList<dbId> &ids, QWidget *parent)
+{
+	TRACE_SPAN ("DbManager::usedObjects");
+
+	if (ids.isEmpty ())
+		return QSet<dbId> ();
+
+	Returner<QSet<dbId> > returner;
+	SignalOperationMonitor monitor;
+	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	dbWorker.usedObjects<T> (returner, monitor, ids);
+	MonitorDialog::monitor (monitor, tr ("Checking %1").arg (T::objectTypeDescriptionPlural ()), parent);
+	return returner.returnedValue ();
+}
+
 // Improvement: atomic used check and delete
 template<class T> void DbManager::deleteObject (dbId id, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::deleteObject");
+
+	if (useJournal (id))
+	{
+		T *base=cache.getNewObject<T> (id);
+		journal.recordDelete<T> (id, base);
+		delete base;
+		return;
+	}
+
 	Returner<bool> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	cancelOnReadTimeout (monitor);
 	dbWorker.deleteObject<T> (returner, monitor, id);
 	MonitorDialog::monitor (monitor, tr ("Deleting %1").arg (T::objectTypeDescription ()), parent);
-	returner.wait ();
+
+	try
+	{
+		returner.wait ();
+	}
+	catch (...)
+	{
+		if (!journalAfterTimeout ()) throw;
+
+		T *base=cache.getNewObject<T> (id);
+		journal.recordDelete<T> (id, base);
+		delete base;
+	}
 }
 
 // Improvement: atomic used check and delete
 template<class T> void DbManager::deleteObjects (const QList<dbId> &ids, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::deleteObjects");
+
+	if (useJournal ())
+	{
+		foreach (dbId id, ids)
+		{
+			T *base=cache.getNewObject<T> (id);
+			journal.recordDelete<T> (id, base);
+			delete base;
+		}
+		return;
+	}
+
 	Returner<int> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	cancelOnReadTimeout (monitor);
 	dbWorker.deleteObjects<T> (returner, monitor, ids);
 	MonitorDialog::monitor (monitor, tr ("Deleting %1").arg (T::objectTypeDescriptionPlural ()), parent);
-	returner.wait ();
+
+	try
+	{
+		returner.wait ();
+	}
+	catch (...)
+	{
+		if (!journalAfterTimeout ()) throw;
+
+		foreach (dbId id, ids)
+		{
+			T *base=cache.getNewObject<T> (id);
+			journal.recordDelete<T> (id, base);
+			delete base;
+		}
+	}
 }
 
 template<class T> dbId DbManager::createObject (T &object, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::createObject");
+
+	// If the creation is journaled, the journal uses the key to determine
+	// whether the object has already been created (see WriteJournal)
+	QString creationKey;
+	if (journalAvailable)
+		creationKey=QUuid::createUuid ().toString ();
+
+	if (useJournal ())
+		return journal.recordCreate (object, creationKey);
+
 	Returner<dbId> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
-	dbWorker.createObject (returner, monitor, object);
+	cancelOnReadTimeout (monitor);
+	dbWorker.createObject (returner, monitor, object, creationKey);
 	MonitorDialog::monitor (monitor, tr ("Creating %1").arg (T::objectTypeDescription ()), parent);
-	return returner.returnedValue ();
+
+	try
+	{
+		return returner.returnedValue ();
+	}
+	catch (...)
+	{
+		if (!journalAfterTimeout ()) throw;
+	}
+
+	return journal.recordCreate (object, creationKey);
 }
 
 template<class T> int DbManager::updateObject (const T &object, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::updateObject");
+
+	if (useJournal (object.getId ()))
+	{
+		T *base=cache.getNewObject<T> (object.getId ());
+		journal.recordUpdate (object, base);
+		delete base;
+		return true;
+	}
+
 	Returner<bool> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	cancelOnReadTimeout (monitor);
 	dbWorker.updateObject (returner, monitor, object);
 	MonitorDialog::monitor (monitor, tr ("Updating %1").arg (T::objectTypeDescription ()), parent);
-	return returner.returnedValue ();
+
+	try
+	{
+		return returner.returnedValue ();
+	}
+	catch (...)
+	{
+		if (!journalAfterTimeout ()) throw;
+	}
+
+	T *base=cache.getNewObject<T> (object.getId ());
+	journal.recordUpdate (object, base);
+	delete base;
+	return true;
+}
+
+// *******************
+// ** Write journal **
+// *******************
+
+/**
+ * The journal is stored in a local SQLite database named after the database
+ * it belongs to
+ */
+DatabaseInfo DbManager::journalInfo (const DatabaseInfo &info)
+{
+	DatabaseInfo result;
+	result.type=DatabaseInfo::typeSqlite;
+	result.database=notr ("journal_")+info.database;
+	return result;
+}
+
+/**
+ * Opens the journal if it is not open yet. If the journal cannot be opened,
+ * writes are always performed directly.
+ */
+void DbManager::openJournal ()
+{
+	// An SQLite database has no connection that could be lost
+	if (interface.getInfo ().type==DatabaseInfo::typeSqlite)
+	{
+		journalAvailable=false;
+		return;
+	}
+
+	try
+	{
+		journal.open ();
+		journalAvailable=true;
+	}
+	catch (SqlException &ex)
+	{
+		std::cout << notr ("Write journal not available: ") << ex.toString () << std::endl;
+		journalAvailable=false;
+	}
+}
+
+/**
+ * Determines whether a write operation should be recorded in the journal
+ * rather than being written to the database
+ *
+ * This is the case if the connection is known to be down, or if there are
+ * still journaled operations (which have to be written before any later
+ * operation, in order to preserve the order of operations). Objects with a
+ * temporary ID only exist in the journal.
+ */
+bool DbManager::useJournal (dbId id)
+{
+	if (!journalAvailable) return false;
+	return linkDown || !journal.isEmpty () || WriteJournal::isTemporaryId (id);
+}
+
+/**
+ * Cancels a write operation if the connection times out while it is in
+ * progress, so the write can be recorded in the journal instead of blocking
+ * until the connection returns (see #journalAfterTimeout)
+ */
+void DbManager::cancelOnReadTimeout (SignalOperationMonitor &monitor)
+{
+	if (journalAvailable)
+		QObject::connect (this, SIGNAL (readTimeout ()), &monitor, SLOT (cancel ()));
+}
+
+/**
+ * Determines whether a write operation which failed should be recorded in
+ * the journal; this is the case if the connection has been lost
+ *
+ * The write may or may not have been performed. Updates and deletes can
+ * safely be written again when replaying. A create is identified by its
+ * creation key, so it is not written again if it has been performed (see
+ * #createObject).
+ */
+bool DbManager::journalAfterTimeout ()
+{
+	if (!journalAvailable || !linkDown) return false;
+
+	std::cout << notr ("Connection lost while writing, recording the write in the journal") << std::endl;
+	return true;
+}
+
+/**
+ * Writes the operations recorded in the journal to the database. Conflicts
+ * with changes by other users are displayed.
+ */
+void DbManager::replayJournal (QWidget *parent)
+{
+	TRACE_SPAN ("DbManager::replayJournal");
+
+	if (!journalAvailable || journal.isEmpty ()) return;
+
+	Returner<QStringList> returner;
+	SignalOperationMonitor monitor;
+	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	dbWorker.replayJournal (returner, monitor, journal);
+	MonitorDialog::monitor (monitor, tr ("Writing pending changes"), parent);
+	QStringList conflicts=returner.returnedValue ();
+
+	if (!conflicts.isEmpty ())
+		showWarning (tr ("Conflicting changes"),
+			tr ("Some of the changes made while the connection was down conflict"
+			" with changes by other users:\n\n%1").arg (conflicts.join (notr ("\n"))),
+			parent);
+}
+
+/**
+ * Writes the operations recorded in the journal to the database without
+ * blocking the GUI
+ *
+ * This is used when the connection returns, which may happen while another
+ * operation is being monitored; it therefore does not show a dialog.
+ * Operations recorded while the replay is running are written by the same
+ * replay. Conflicts are reported by the journalConflicts signal.
+ */
+void DbManager::replayJournalInBackground ()
+{
+	if (!journalAvailable || journal.isEmpty ()) return;
+
+	// Already replaying
+	if (journalReplay) return;
+
+	journalReplay=new JournalReplay ();
+
+	// The monitor ends in the worker thread, so this is a queued connection
+	QObject::connect (&journalReplay->monitor, SIGNAL (ended ()), this, SLOT (journalReplayEnded ()));
+	QObject::connect (&journalReplay->monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	// If the connection is lost again, stop replaying and keep the rest of
+	// the journal for later
+	QObject::connect (this, SIGNAL (readTimeout ()), &journalReplay->monitor, SLOT (cancel ()));
+	dbWorker.replayJournal (journalReplay->returner, journalReplay->monitor, journal);
+}
+
+void DbManager::journalReplayEnded ()
+{
+	if (!journalReplay) return;
+
+	try
+	{
+		QStringList conflicts=journalReplay->returner.returnedValue ();
+		if (!conflicts.isEmpty ())
+			emit journalConflicts (conflicts);
+	}
+	catch (...)
+	{
+		// The remaining operations are still in the journal and will be
+		// written the next time the connection returns.
+		std::cout << notr ("Writing the journal failed") << std::endl;
+	}
+
+	delete journalReplay;
+	journalReplay=NULL;
+}
+
+void DbManager::interfaceReadTimeout ()
+{
+	linkDown=true;
+
+	// Discard the dates which have not been prefetched yet
+	cacheWorker.prefetchFlights (QList<QDate> ());
+	emit readTimeout ();
+}
+
+void DbManager::interfaceReadResumed ()
+{
+	linkDown=false;
+	emit readResumed ();
+}
+
+/**
+ * Updates a flight without waiting for the database
+ *
+ * The change is applied to the cache immediately and the flight is marked as
+ * pending (see Cache::WriteState). The flight is written to the database in
+ * the background. If writing succeeds, the mark is removed. If the connection
+ * is lost while writing, the change is recorded in the journal. Otherwise, if
+ * writing fails, the change is reverted in the cache and the flight is marked
+ * as conflicting until the conflict is resolved (see
+ * #resolveFlightConflict).
+ *
+ * There may be several pending updates of the same flight. Each of them is
+ * applied on top of the previous ones, which have not been confirmed yet, so
+ * the flight is not reverted to the version before the failed update, but to
+ * the last version which has been written successfully (or which was in the
+ * cache before the first pending update).
+ *
+ * This is intended for frequent operations which are performed on a single
+ * flight and where the user does not want to wait, i. e. departing and
+ * landing.
+ */
+void DbManager::updateFlightOptimistic (const Flight &flight)
+{
+	// Journaled writes don't wait for the database anyway
+	if (useJournal (flight.getId ()))
+	{
+		Flight *base=cache.getNewObject<Flight> (flight.getId ());
+		journal.recordUpdate (flight, base);
+		delete base;
+		return;
+	}
+
+	dbId id=flight.getId ();
+	if (!pendingFlightUpdates.contains (id))
+	{
+		Flight *confirmed=cache.getNewObject<Flight> (id);
+		if (confirmed) confirmedFlights.insert (id, *confirmed);
+		delete confirmed;
+	}
+
+	OptimisticUpdate *update=new OptimisticUpdate (flight);
+	optimisticUpdates.insert (&update->monitor, update);
+	++pendingFlightUpdates[id];
+
+	cache.setFlightWriteState (id, Cache::writePending);
+	cache.applyLocalChange (DbEvent::changed (flight));
+
+	// The monitor ends in the worker thread, so this is a queued connection
+	QObject::connect (&update->monitor, SIGNAL (ended ()), this, SLOT (optimisticUpdateEnded ()));
+	QObject::connect (&update->monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
+	cancelOnReadTimeout (update->monitor);
+	dbWorker.updateObject (update->returner, update->monitor, update->flight);
+}
+
+void DbManager::optimisticUpdateEnded ()
+{
+	OptimisticUpdate *update=optimisticUpdates.take (sender ());
+	if (!update) return;
+
+	dbId id=update->flight.getId ();
+
+	// If there are later updates of the same flight, they determine the state
+	// of the flight
+	bool last=(--pendingFlightUpdates[id]<=0);
+	if (last) pendingFlightUpdates.remove (id);
+
+	// The updates of a flight are written in order, so the version in the
+	// database is the one of the last successful update
+	bool hasConfirmed=confirmedFlights.contains (id);
+	Flight confirmed=confirmedFlights.value (id);
+
+	try
+	{
+		update->returner.returnedValue ();
+
+		confirmed=update->flight;
+		hasConfirmed=true;
+		if (!last) confirmedFlights.insert (id, confirmed);
+
+		if (last)
+			cache.setFlightWriteState (id, Cache::writeConfirmed);
+	}
+	catch (StorableException &)
+	{
+		if (journalAfterTimeout ())
+		{
+			// The journal applies the change to the cache again
+			journal.recordUpdate (update->flight, hasConfirmed?&confirmed:NULL);
+
+			if (last)
+				cache.setFlightWriteState (id, Cache::writeConfirmed);
+		}
+		else if (last)
+		{
+			// If there are earlier updates which failed, this update contains
+			// their changes
+			std::cout << qnotr ("Writing flight %1 failed, reverting the change").arg (id) << std::endl;
+
+			if (hasConfirmed)
+				cache.applyLocalChange (DbEvent::changed (confirmed));
+
+			cache.setFlightConflict (update->flight);
+		}
+	}
+
+	if (last)
+		confirmedFlights.remove (id);
+
+	delete update;
+}
+
+/**
+ * Resolves the write conflict of a flight (see updateFlightOptimistic)
+ *
+ * @param writeLocal true to write the local version of the flight again,
+ *                   false to discard it and keep the version from the
+ *                   database
+ */
+void DbManager::resolveFlightConflict (dbId id, bool writeLocal)
+{
+	Flight localFlight;
+	if (!cache.getFlightConflict (id, &localFlight)) return;
+
+	if (writeLocal)
+		updateFlightOptimistic (localFlight);
+	else
+		cache.setFlightWriteState (id, Cache::writeConfirmed);
 }
 
 void DbManager::executeQuery (const Query &query, const QString &statusText, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::executeQuery");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -590,6 +1092,8 @@ void DbManager::executeQuery (const Query &query, const QString &statusText, QWi
 
 void DbManager::transaction (QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::transaction");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -600,6 +1104,8 @@ void DbManager::transaction (QWidget *parent)
 
 void DbManager::commit (QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::commit");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -610,6 +1116,8 @@ void DbManager::commit (QWidget *parent)
 
 void DbManager::rollback (QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::rollback");
+
 	Returner<void> returner;
 	SignalOperationMonitor monitor;
 	QObject::connect (&monitor, SIGNAL (canceled ()), &interface, SLOT (cancelConnection ()), Qt::DirectConnection);
@@ -666,6 +1174,8 @@ QString DbManager::mergeDeleteWarningText (int notDeletedCount, int deletedCount
  */
 void DbManager::mergePeople (const Person &correctPerson, const QList<Person> &wrongPeople, QWidget *parent)
 {
+	TRACE_SPAN ("DbManager::mergePeople");
+
 	// Determine the ID of the correct person
 	dbId correctId=correctPerson.getId ();
 
@@ -687,8 +1197,10 @@ void DbManager::mergePeople (const Person &correctPerson, const QList<Person> &w
 
 		// Emit the corresponding events
 
-		// Make the Database emit a dbEvent for each affected flight (and user, if
-		// we had a User class) so the cache and GUI will be updated
+		// Make the Database emit a dbEvent for the affected flights (and users,
+		// if we had a User class) so the cache and GUI will be updated. The
+		// changes are sent as a single batch event.
+		QList<DbEvent> events;
 		foreach (Flight flight, cache.getAllKnownFlights ().getList ())
 		{
 			bool flightChanged=false;
@@ -698,8 +1210,11 @@ void DbManager::mergePeople (const Person &correctPerson, const QList<Person> &w
 			if (wrongIds.contains (flight.getTowpilotId ())) { flight.setTowpilotId (correctId); flightChanged=true; }
 
 			if (flightChanged)
-				db.emitDbEvent (DbEvent::changed<Flight> (flight));
+				events.append (DbEvent::changed<Flight> (flight));
 		}
+
+		if (!events.isEmpty ())
+			db.emitDbEvent (DbEvent::batch<Flight> (events));
 		// Users are not handled because we don't have users
 	}
 	catch (OperationCanceledException &)
@@ -718,8 +1233,13 @@ void DbManager::mergePeople (const Person &correctPerson, const QList<Person> &w
 	QList<dbId> idsToDelete;
 	try
 	{
+		QList<dbId> ids;
+		foreach (const Person &person, wrongPeople)
+			ids.append (person.getId ());
+
+		QSet<dbId> usedIds=usedObjects<Person> (ids, parent);
 		foreach (const Person &person, wrongPeople)
-			if (!objectUsed<Person> (person.getId (), parent))
+			if (!usedIds.contains (person.getId ()))
 				idsToDelete.append (person.getId ());
 	}
 	catch (OperationCanceledException &)
@@ -767,7 +1287,9 @@ void DbManager::settingsChanged ()
 
 #	define INSTANTIATE_TEMPLATES(T) \
 		template bool DbManager::objectUsed  <T> (dbId id        , QWidget *parent); \
+		template QSet<dbId> DbManager::usedObjects<T> (const QList<dbId> &ids, QWidget *parent); \
 		template void DbManager::deleteObject<T> (dbId id        , QWidget *parent); \
+		template void DbManager::deleteObjects<T> (const QList<dbId> &ids, QWidget *parent); \
 		template dbId DbManager::createObject<T> (T &object      , QWidget *parent); \
 		template int  DbManager::updateObject<T> (const T &object, QWidget *parent); \
 		template void DbManager::refreshObjects<T> (QWidget *parent);
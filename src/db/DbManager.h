@@ -22,8 +22,10 @@
 #include "src/db/cache/CacheWorker.h"
 #include "src/db/dbId.h"
 #include "src/db/interface/InterfaceWorker.h"
+#include "src/db/journal/WriteJournal.h"
 
 class QWidget;
+class SignalOperationMonitor;
 
 /**
  * Contains the database related objects required in the GUI:
@@ -83,6 +85,7 @@ class DbManager: public QObject
 		virtual MigratorWorker
 		                       &getMigratorWorker () { return migratorWorker; }
 		virtual CacheWorker    &getCacheWorker    () { return cacheWorker;    }
+		virtual WriteJournal   &getJournal        () { return journal;        }
 
 		virtual State getState () { return state; }
 
@@ -109,9 +112,11 @@ class DbManager: public QObject
 		void clearCache ();
 		void refreshCache (QWidget *parent);
 		void fetchFlights (QDate date, QWidget *parent);
+		void prefetchFlights (const QDate &date);
 		template<class T> void refreshObjects (QWidget *parent);
 
 		template<class T> bool objectUsed    (dbId id               , QWidget *parent);
+		template<class T> QSet<dbId> usedObjects (const QList<dbId> &ids, QWidget *parent);
 		template<class T> void deleteObject  (dbId id               , QWidget *parent);
 		template<class T> void deleteObjects (const QList<dbId> &ids, QWidget *parent);
 		template<class T> dbId createObject  (      T &object       , QWidget *parent);
@@ -119,6 +124,13 @@ class DbManager: public QObject
 
 		QList<Flight> getFlights (const QDate &first, const QDate &last, QWidget *parent);
 
+		void updateFlightOptimistic (const Flight &flight);
+		void resolveFlightConflict (dbId id, bool writeLocal);
+
+		// *** Write journal
+		void replayJournal (QWidget *parent);
+		void replayJournalInBackground ();
+
 
 		// *** Database updates
 		void mergePeople (const Person &correctPerson, const QList<Person> &wrongPeople, QWidget *parent);
@@ -126,6 +138,7 @@ class DbManager: public QObject
 	signals:
 		void readTimeout ();
 		void readResumed ();
+		void journalConflicts (QStringList conflicts);
 		void stateChanged (DbManager::State state);
 		void migrationStarted ();
 		void migrationEnded ();
@@ -141,6 +154,10 @@ class DbManager: public QObject
 
 	protected slots:
 		void settingsChanged ();
+		void interfaceReadTimeout ();
+		void interfaceReadResumed ();
+		void optimisticUpdateEnded ();
+		void journalReplayEnded ();
 
 	private:
 		DbManager (const DbManager &other);
@@ -149,7 +166,14 @@ class DbManager: public QObject
 		QString mergeDeleteWarningTitle (int notDeletedCount, int deletedCount);
 		QString mergeDeleteWarningText (int notDeletedCount, int deletedCount);
 
+		static DatabaseInfo journalInfo (const DatabaseInfo &info);
+		void openJournal ();
+		bool useJournal (dbId id=invalidId);
+		void cancelOnReadTimeout (SignalOperationMonitor &monitor);
+		bool journalAfterTimeout ();
+
 		State state;
+		bool linkDown;
 
 		ThreadSafeInterface interface;
 		Database db;
@@ -160,6 +184,20 @@ class DbManager: public QObject
 		MigratorWorker migratorWorker;
 		CacheWorker cacheWorker;
 
+		WriteJournal journal;
+		bool journalAvailable;
+		class JournalReplay;
+		JournalReplay *journalReplay;
+
+		// Optimistic updates, by monitor, and the number of optimistic
+		// updates per flight
+		class OptimisticUpdate;
+		QHash<QObject *, OptimisticUpdate *> optimisticUpdates;
+		QHash<dbId, int> pendingFlightUpdates;
+		// The last version of each flight with pending updates which is known
+		// to be in the database
+		QHash<dbId, Flight> confirmedFlights;
+
 		void doOpenInterface (InterfaceWorker &worker, QWidget *parent);
 };
 
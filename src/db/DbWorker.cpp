@@ -3,12 +3,14 @@
 #include <iostream>
 
 #include "src/db/Database.h"
+#include "src/db/journal/WriteJournal.h"
 
 #include "src/model/Person.h"
 #include "src/model/LaunchMethod.h"
 #include "src/model/Plane.h"
 #include "src/model/Flight.h"
 #include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
 
 /*
  * Now, the implementation of this here worker class is a bit more complicated
@@ -47,11 +49,31 @@ template<class T> class GetObjectsTask: public DbWorker::Task
 		}
 };
 
+template<class T> class GetObjectsUnionTask: public DbWorker::Task
+{
+	public:
+		GetObjectsUnionTask (Returner<QList<T> > *returner, const QList<Query> &conditions):
+			returner (returner), conditions (conditions)
+		{
+		}
+
+		virtual ~GetObjectsUnionTask () {}
+
+		Returner<QList <T> > *returner;
+		QList<Query> conditions;
+
+		virtual void run (Database &db, OperationMonitor *monitor)
+		{
+			OperationMonitorInterface interface=monitor->interface ();
+			returnOrException (returner, db.getObjects<T> (conditions));
+		}
+};
+
 template<class T> class CreateObjectTask: public DbWorker::Task
 {
 	public:
-		CreateObjectTask (Returner<dbId> *returner, T &object):
-			returner (returner), object (object)
+		CreateObjectTask (Returner<dbId> *returner, T &object, const QString &creationKey):
+			returner (returner), object (object), creationKey (creationKey)
 		{
 		}
 
@@ -59,11 +81,12 @@ template<class T> class CreateObjectTask: public DbWorker::Task
 
 		Returner<dbId> *returner;
 		T &object;
+		QString creationKey;
 
 		virtual void run (Database &db, OperationMonitor *monitor)
 		{
 			OperationMonitorInterface interface=monitor->interface ();
-			returnOrException (returner, db.createObject (object));
+			returnOrException (returner, db.createObject (object, creationKey));
 		}
 };
 
@@ -166,6 +189,44 @@ template<class T> class ObjectUsedTask: public DbWorker::Task
 		}
 };
 
+template<class T> class UsedObjectsTask: public DbWorker::Task
+{
+	public:
+		UsedObjectsTask (Returner<QSet<dbId> > *returner, const QList<dbId> &ids):
+			returner (returner), ids (ids)
+		{
+		}
+
+		virtual ~UsedObjectsTask () {}
+
+		Returner<QSet<dbId> > *returner;
+		const QList<dbId> &ids;
+
+		virtual void run (Database &db, OperationMonitor *monitor)
+		{
+			OperationMonitorInterface interface=monitor->interface ();
+			returnOrException (returner, db.usedObjects<T> (ids));
+		}
+};
+
+class ReplayJournalTask: public DbWorker::Task
+{
+	public:
+		ReplayJournalTask (Returner<QStringList> *returner, WriteJournal &journal):
+			returner (returner), journal (journal)
+		{
+		}
+
+		virtual ~ReplayJournalTask () {}
+
+		Returner<QStringList> *returner;
+		WriteJournal &journal;
+
+		virtual void run (Database &db, OperationMonitor *monitor)
+		{
+			returnOrException (returner, journal.replay (db, monitor->interface ()));
+		}
+};
 
 
 // ******************
@@ -179,6 +240,7 @@ DbWorker::DbWorker (Database &db):
 	CONNECT (executeAndDeleteTask (OperationMonitor *, Task *));
 #undef CONNECT
 
+	thread.setObjectName (notr ("DbWorker"));
 	moveToThread (&thread);
 	thread.start ();
 }
@@ -201,9 +263,14 @@ template<class T> void DbWorker::getObjects (Returner<QList<T> > &returner, Oper
 	executeAndDeleteTask (&monitor, new GetObjectsTask<T> (&returner, condition));
 }
 
-template<class T> void DbWorker::createObject (Returner<dbId> &returner, OperationMonitor &monitor, T &object)
+template<class T> void DbWorker::getObjects (Returner<QList<T> > &returner, OperationMonitor &monitor, const QList<Query> &conditions)
+{
+	executeAndDeleteTask (&monitor, new GetObjectsUnionTask<T> (&returner, conditions));
+}
+
+template<class T> void DbWorker::createObject (Returner<dbId> &returner, OperationMonitor &monitor, T &object, const QString &creationKey)
 {
-	executeAndDeleteTask (&monitor, new CreateObjectTask<T> (&returner, object));
+	executeAndDeleteTask (&monitor, new CreateObjectTask<T> (&returner, object, creationKey));
 }
 
 template<class T> void DbWorker::createObjects (Returner<void> &returner, OperationMonitor &monitor, QList<T> &objects)
@@ -231,8 +298,19 @@ template<class T> void DbWorker::objectUsed (Returner<bool> &returner, Operation
 	executeAndDeleteTask (&monitor, new ObjectUsedTask<T> (&returner, id));
 }
 
+template<class T> void DbWorker::usedObjects (Returner<QSet<dbId> > &returner, OperationMonitor &monitor, const QList<dbId> &ids)
+{
+	executeAndDeleteTask (&monitor, new UsedObjectsTask<T> (&returner, ids));
+}
+
+void DbWorker::replayJournal (Returner<QStringList> &returner, OperationMonitor &monitor, WriteJournal &journal)
+{
+	executeAndDeleteTask (&monitor, new ReplayJournalTask (&returner, journal));
+}
+
 void DbWorker::executeAndDeleteTask (OperationMonitor *monitor, DbWorker::Task *task)
 {
+	TRACE_ENQUEUE (task, "DbWorker::executeAndDeleteTask");
 	emit sig_executeAndDeleteTask (monitor, task);
 }
 
@@ -243,6 +321,8 @@ void DbWorker::executeAndDeleteTask (OperationMonitor *monitor, DbWorker::Task *
 
 void DbWorker::slot_executeAndDeleteTask (OperationMonitor *monitor, DbWorker::Task *task)
 {
+	TRACE_SPAN ("DbWorker::executeAndDeleteTask");
+	TRACE_DEQUEUE (task);
 	task->run (db, monitor);
 	delete task;
 }
@@ -251,12 +331,14 @@ void DbWorker::slot_executeAndDeleteTask (OperationMonitor *monitor, DbWorker::T
 #define INSTANTIATE_TEMPLATES(T) \
 	template class CreateObjectTask<T>; \
 	template void DbWorker::getObjects    <T> (Returner<QList <T> > &returner, OperationMonitor &monitor, const Query &condition); \
-	template void DbWorker::createObject  <T> (Returner<dbId>       &returner, OperationMonitor &monitor, T &object); \
+	template void DbWorker::getObjects    <T> (Returner<QList <T> > &returner, OperationMonitor &monitor, const QList<Query> &conditions); \
+	template void DbWorker::createObject  <T> (Returner<dbId>       &returner, OperationMonitor &monitor, T &object, const QString &creationKey); \
 	template void DbWorker::createObjects <T> (Returner<void>       &returner, OperationMonitor &monitor, QList<T> &object); \
 	template void DbWorker::deleteObject  <T> (Returner<bool>       &returner, OperationMonitor &monitor, dbId id); \
 	template void DbWorker::deleteObjects <T> (Returner<int >       &returner, OperationMonitor &monitor, const QList<dbId> &ids); \
 	template void DbWorker::updateObject  <T> (Returner<bool>       &returner, OperationMonitor &monitor, const T &object); \
 	template void DbWorker::objectUsed    <T> (Returner<bool>       &returner, OperationMonitor &monitor, dbId id); \
+	template void DbWorker::usedObjects   <T> (Returner<QSet<dbId> > &returner, OperationMonitor &monitor, const QList<dbId> &ids); \
 	// Empty line
 
 INSTANTIATE_TEMPLATES (Person      )
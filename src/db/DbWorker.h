@@ -11,6 +11,8 @@
 #include <QObject>
 #include <QThread>
 #include <QList>
+#include <QSet>
+#include <QStringList>
 
 #include "src/db/dbId.h"
 #include "src/db/Query.h"
@@ -20,6 +22,7 @@
 
 
 class Database;
+class WriteJournal;
 
 /**
  * This class is thread safe.
@@ -46,12 +49,16 @@ class DbWorker: QObject
 		virtual ~DbWorker ();
 
 		template<class T> void getObjects    (Returner<QList<T> > &returner, OperationMonitor &monitor, const Query &condition);
-		template<class T> void createObject  (Returner<dbId     > &returner, OperationMonitor &monitor, T &object);
+		template<class T> void getObjects    (Returner<QList<T> > &returner, OperationMonitor &monitor, const QList<Query> &conditions);
+		template<class T> void createObject  (Returner<dbId     > &returner, OperationMonitor &monitor, T &object, const QString &creationKey=QString ());
 		template<class T> void createObjects (Returner<void     > &returner, OperationMonitor &monitor, QList<T> &objects);
 		template<class T> void deleteObject  (Returner<bool     > &returner, OperationMonitor &monitor, dbId id);
 		template<class T> void deleteObjects (Returner<int      > &returner, OperationMonitor &monitor, const QList<dbId> &ids);
 		template<class T> void updateObject  (Returner<bool     > &returner, OperationMonitor &monitor, const T &object);
 		template<class T> void objectUsed    (Returner<bool     > &returner, OperationMonitor &monitor, dbId id);
+		template<class T> void usedObjects   (Returner<QSet<dbId> > &returner, OperationMonitor &monitor, const QList<dbId> &ids);
+
+		void replayJournal (Returner<QStringList> &returner, OperationMonitor &monitor, WriteJournal &journal);
 
 	protected:
 		virtual void executeAndDeleteTask (OperationMonitor *monitor, Task *task);
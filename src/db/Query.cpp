@@ -6,6 +6,7 @@
 #include <QSqlQuery>
 #include <QStringList>
 #include <QString>
+#include <QDateTime>
 
 #include "src/io/AnsiColors.h"
 #include "src/text.h"
@@ -58,6 +59,11 @@ QString Query::getQueryString () const
 	return queryString;
 }
 
+QList<QVariant> Query::getBindValues () const
+{
+	return bindValues;
+}
+
 bool Query::isEmpty () const
 {
 	return queryString.isEmpty ();
@@ -308,6 +314,84 @@ Query &Query::bind (const QVariant &v)
 	return *this;
 }
 
+/**
+ * Returns a copy of this query with the bind values written into the query
+ * string as literals (see #literal)
+ *
+ * A query without bind values is executed without preparing, so several
+ * inlined queries can be sent as one multi-statement query (MySQL only).
+ * This is intended for values generated by the program, like dates, IDs and
+ * constants; values entered by the user should still be bound.
+ *
+ * Placeholders in quoted strings are not replaced.
+ */
+Query Query::inlined () const
+{
+	QString result;
+	int valueIndex=0;
+	QChar quote;
+
+	foreach (const QChar &c, queryString)
+	{
+		if (!quote.isNull ())
+		{
+			// In a quoted string
+			if (c==quote) quote=QChar ();
+			result+=c;
+		}
+		else if (c==QChar ('\'') || c==QChar ('"') || c==QChar ('`'))
+		{
+			quote=c;
+			result+=c;
+		}
+		else if (c==QChar ('?') && valueIndex<bindValues.size ())
+		{
+			result+=literal (bindValues.at (valueIndex++));
+		}
+		else
+		{
+			result+=c;
+		}
+	}
+
+	return Query (result);
+}
+
+/**
+ * Formats a value as an SQL literal in MySQL syntax
+ *
+ * Date/time values are formatted like Database::timestampToDb; strings are
+ * quoted, with quotes and backslashes escaped.
+ */
+QString Query::literal (const QVariant &value)
+{
+	if (value.isNull ())
+		return notr ("NULL");
+
+	switch (value.type ())
+	{
+		case QVariant::Bool:
+			return value.toBool ()?notr ("1"):notr ("0");
+		case QVariant::Int: case QVariant::UInt:
+		case QVariant::LongLong: case QVariant::ULongLong:
+		case QVariant::Double:
+			return value.toString ();
+		case QVariant::Date:
+			return qnotr ("'%1'").arg (value.toDate ().toString (notr ("yyyy-MM-dd")));
+		case QVariant::Time:
+			return qnotr ("'%1'").arg (value.toTime ().toString (notr ("hh:mm:ss")));
+		case QVariant::DateTime:
+			return qnotr ("'%1'").arg (value.toDateTime ().toString (notr ("yyyy-MM-dd hh:mm:ss")));
+		default:
+		{
+			QString string=value.toString ();
+			string.replace (notr ("\\"), notr ("\\\\"));
+			string.replace (notr ("'"), notr ("\\'"));
+			return qnotr ("'%1'").arg (string);
+		}
+	}
+}
+
 
 // *************************
 // ** QSqlQuery interface **
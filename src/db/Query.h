@@ -32,6 +32,7 @@ class Query
 		QString toString () const;
 		QString colorizedString () const;
 		QString getQueryString () const;
+		QList<QVariant> getBindValues () const;
 
 		// *** Generation
 		static Query selectDistinctColumns (const QString     &table , const QString     &column , bool excludeEmpty=false);
@@ -82,6 +83,8 @@ class Query
 
 		// *** Bind
 		Query &bind (const QVariant &v);
+		Query inlined () const;
+		static QString literal (const QVariant &value);
 
 		// *** QSqlQuery interface
 		bool prepare (QSqlQuery &query) const;
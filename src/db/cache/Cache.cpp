@@ -35,16 +35,19 @@
 #include "src/model/Person.h"
 #include "src/model/Plane.h"
 #include "src/db/Database.h"
+#include "src/db/Query.h"
 #include "src/concurrent/synchronized.h"
 #include "src/util/qString.h"
 #include "src/container/SortedSet_impl.h"
+#include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
 
 // ******************
 // ** Construction **
 // ******************
 
 Cache::Cache (Database &db):
-	db (db), dataMutex (QMutex::Recursive)
+	db (db), flightFetches (0), dataMutex (QMutex::Recursive)
 {
 	connect (&db, SIGNAL (dbEvent (DbEvent)), this, SLOT (dbChanged (DbEvent)));
 }
@@ -53,6 +56,12 @@ Cache::~Cache ()
 {
 }
 
+Cache::DateStatistics::DateStatistics ():
+	hits (0), misses (0), prefetches (0), prefetchHits (0),
+	prefetchFailures (0)
+{
+}
+
 
 // ****************
 // ** Properties **
@@ -98,13 +107,94 @@ template<> QHash<dbId, LaunchMethod> &Cache::objectsByIdHash<LaunchMethod> () {
 // ** Generic refreshing **
 // ************************
 
+/**
+ * Determines whether two objects have the same values in the database
+ */
+template<class T> static bool sameDbValues (const T &object1, const T &object2)
+{
+	Query query1, query2;
+	object1.bindValues (query1);
+	object2.bindValues (query2);
+	return query1.getBindValues ()==query2.getBindValues ();
+}
+
+/**
+ * Refreshes the objects of a type
+ *
+ * After the first refresh, only the objects changed since the previous
+ * refresh are read from the database (see Database#getChanges), and the
+ * changed signal is emitted for each actual change.
+ */
 template<class T> void Cache::refreshObjects (OperationMonitorInterface monitor)
 {
+	TRACE_SPAN ("Cache::refreshObjects");
+
 	monitor.status (tr ("Retrieving %1").arg (T::objectTypeDescriptionPlural ()));
 
-	// Get the list from the database
-	QList<T> newObjects=db.getObjects<T> ();
+	QDateTime since;
+	synchronized (dataMutex) since=changesTimestamps.value (T::dbTableName ());
+
+	// Get the changes from the database
+	QList<T> changedObjects;
+	QList<dbId> deletedIds;
+	QDateTime timestamp=db.getChanges<T> (since, changedObjects, deletedIds);
+
+	if (since.isNull () || Database::changesExpired (since, timestamp))
+		setObjects<T> (changedObjects);
+	else
+		applyChanges<T> (changedObjects, deletedIds);
+
+	synchronized (dataMutex) changesTimestamps.insert (T::dbTableName (), timestamp);
+}
+
+/**
+ * Applies changes read from the database to the objects of a type. Objects
+ * which did not actually change are ignored.
+ */
+template<class T> void Cache::applyChanges (const QList<T> &changedObjects, const QList<dbId> &deletedIds)
+{
+	TRACE_SPAN ("Cache::applyChanges");
+
+	QList<DbEvent> events;
 
+	synchronized (dataMutex)
+	{
+		const QHash<dbId, T> &byIdHash=objectsByIdHash<T> ();
+
+		foreach (const T &object, changedObjects)
+		{
+			if (!byIdHash.contains (object.getId ()))
+			{
+				objectAdded (object);
+				events.append (DbEvent::added (object));
+			}
+			else if (!sameDbValues (byIdHash.value (object.getId ()), object))
+			{
+				objectUpdated (object);
+				events.append (DbEvent::changed (object));
+			}
+		}
+
+		foreach (dbId id, deletedIds)
+		{
+			if (byIdHash.contains (id))
+			{
+				objectDeleted<T> (id);
+				events.append (DbEvent::deleted<T> (id));
+			}
+		}
+	}
+
+	// Emit the events after the cache has been changed, without holding the
+	// lock
+	if (events.size ()==1)
+		emit changed (events.first ());
+	else if (!events.isEmpty ())
+		emit changed (DbEvent::batch<T> (events));
+}
+
+template<class T> void Cache::setObjects (const QList<T> &newObjects)
+{
 	synchronized (dataMutex)
 	{
 		// Store the object list
@@ -153,6 +243,12 @@ void Cache::refreshFlightsOf (const QString &description, const QDate &date,
 	else
 		newFlights=db.getFlightsDate (date);
 
+	setFlights (newFlights, date, targetList, targetDate);
+}
+
+void Cache::setFlights (const QList<Flight> &newFlights, const QDate &date,
+	EntityList<Flight> &targetList, QDate *targetDate)
+{
 	synchronized (dataMutex)
 	{
 		// Remove the old flights from the hashes
@@ -181,18 +277,154 @@ void Cache::refreshFlightsToday (OperationMonitorInterface monitor)
 		QDate::currentDate (), flightsToday, &todayDate, monitor);
 }
 
+/**
+ * Refreshes the flights of the current other date. The other resident dates
+ * are discarded, so they will be fetched again when they are used.
+ */
 void Cache::refreshFlightsOther (OperationMonitorInterface monitor)
 {
-	if (otherDate.isNull ()) return;
-	refreshFlightsOf (tr ("flights of %1").arg (otherDate.toString (Qt::LocaleDate)),
-		otherDate, flightsOther, NULL, monitor);
+	QDate date;
+	synchronized (dataMutex)
+	{
+		date=otherDate;
+		discardOtherDates ();
+	}
+
+	fetchFlightsOther (date, monitor);
 }
 
+/**
+ * Fetches the flights of a date from the database and makes it the current
+ * other date
+ *
+ * The flights of the previous other dates are kept, so they can be selected
+ * later without accessing the database (see #selectOtherDate), until they are
+ * evicted (see #evictOtherDates).
+ */
 void Cache::fetchFlightsOther (QDate date, OperationMonitorInterface monitor)
 {
+	TRACE_SPAN ("Cache::fetchFlightsOther");
+
 	if (date.isNull ()) return;
-	refreshFlightsOf (tr ("flights of %1").arg (date.toString (Qt::LocaleDate)),
-		date, flightsOther, &otherDate, monitor);
+
+	monitor.status (tr ("Retrieving %1").arg (tr ("flights of %1").arg (date.toString (Qt::LocaleDate))));
+
+	int fetchStart=beginFlightFetch ();
+	QList<Flight> newFlights;
+	try
+	{
+		newFlights=db.getFlightsDate (date);
+	}
+	catch (...)
+	{
+		endFlightFetch (fetchStart);
+		throw;
+	}
+
+	synchronized (dataMutex)
+	{
+		setOtherDateFlights (newFlights, date);
+		reapplyFlightEvents (endFlightFetch (fetchStart));
+	}
+}
+
+/**
+ * Makes a resident date the current other date, without accessing the
+ * database
+ *
+ * @return true if the date is resident, false if the flights of the date have
+ *         to be fetched (see #fetchFlightsOther)
+ */
+bool Cache::selectOtherDate (const QDate &date)
+{
+	synchronized (dataMutex)
+	{
+		if (!otherDateFlights.contains (date))
+		{
+			++dateStatistics.misses;
+			return false;
+		}
+
+		++dateStatistics.hits;
+		if (prefetchedDates.remove (date))
+			++dateStatistics.prefetchHits;
+
+		otherDate=date;
+		useOtherDate (date);
+		return true;
+	}
+
+	// Not reached
+	return false;
+}
+
+/**
+ * Fetches the flights of a date from the database, if the date is not
+ * resident, without changing the current other date
+ *
+ * The date is made the least recently used date, so a prefetched date which
+ * is never selected is evicted before any date which has been selected.
+ * Consequently, nothing is prefetched if the maximum number of dates is
+ * resident.
+ *
+ * Today and the null date are ignored.
+ */
+void Cache::prefetchFlightsOther (const QDate &date, OperationMonitorInterface monitor)
+{
+	TRACE_SPAN ("Cache::prefetchFlightsOther");
+
+	if (date.isNull ()) return;
+
+	synchronized (dataMutex)
+	{
+		if (date==todayDate || otherDateFlights.contains (date))
+			return;
+
+		// The date would be evicted right away
+		if (otherDatesByUse.size ()>=maxOtherDates)
+			return;
+	}
+
+	monitor.status (tr ("Retrieving %1").arg (tr ("flights of %1").arg (date.toString (Qt::LocaleDate))));
+
+	int fetchStart=beginFlightFetch ();
+	QList<Flight> newFlights;
+	try
+	{
+		newFlights=db.getFlightsDate (date);
+	}
+	catch (...)
+	{
+		synchronized (dataMutex) ++dateStatistics.prefetchFailures;
+		endFlightFetch (fetchStart);
+		throw;
+	}
+
+	synchronized (dataMutex)
+	{
+		QList<DbEvent> events=endFlightFetch (fetchStart);
+
+		// The date may have been fetched or become today in the meantime
+		if (date!=todayDate && !otherDateFlights.contains (date))
+		{
+			otherDateFlights.insert (date, EntityList<Flight> (newFlights));
+			foreach (const Flight &flight, newFlights)
+			{
+				flightsById.insert (flight.getId (), flight);
+				updateHashesObjectAdded<Flight> (flight);
+			}
+
+			// Least recently used
+			otherDatesByUse.removeAll (date);
+			otherDatesByUse.prepend (date);
+
+			prefetchedDates.insert (date);
+			++dateStatistics.prefetches;
+
+			reapplyFlightEvents (events);
+			evictOtherDates ();
+		}
+	}
 }
 
 void Cache::refreshPreparedFlights (OperationMonitorInterface monitor)
@@ -217,32 +449,151 @@ void Cache::refreshAccountingNotes (OperationMonitorInterface monitor)
 	synchronized (dataMutex) accountingNotes=newAccountingNotes;
 }
 
+/**
+ * Refreshes all data from a consistent snapshot of the database (see
+ * Database#getSnapshot)
+ *
+ * The new data, including the hashes, is built in a separate cache without
+ * holding the lock of this cache, and then replaced as a whole, so other
+ * threads can access the cache while it is refreshed and will never see
+ * partially refreshed data.
+ *
+ * If all planes, people and launch methods have been read before, only the
+ * changes are read and applied to the current objects.
+ */
 void Cache::refreshAll (OperationMonitorInterface monitor)
 {
-	// The other hashes will be cleared by the refresh methods
-	clearMultiTypeHashes ();
-	clearHashes<Flight> ();
+	TRACE_SPAN ("Cache::refreshAll");
 
-	// Refresh planes and people before refreshing flights!
-	monitor.progress (0, 8); refreshPlanes          (monitor);
-	monitor.progress (1, 8); refreshPeople          (monitor);
-	monitor.progress (2, 8); refreshLaunchMethods   (monitor);
-	monitor.progress (3, 8); refreshFlightsToday    (monitor);
-	monitor.progress (4, 8); refreshFlightsOther    (monitor);
-	monitor.progress (5, 8); refreshPreparedFlights (monitor);
-	monitor.progress (6, 8); refreshLocations       (monitor);
-	monitor.progress (7, 8); refreshAccountingNotes (monitor);
-	monitor.progress (8, 8, tr ("Finished"));
+	QDate newOtherDate;
+	QDateTime changedSince;
+	QList<Plane> currentPlanes;
+	QList<Person> currentPeople;
+	QList<LaunchMethod> currentLaunchMethods;
+
+	synchronized (dataMutex)
+	{
+		newOtherDate=otherDate;
+
+		QDateTime planesSince       =changesTimestamps.value (Plane       ::dbTableName ());
+		QDateTime peopleSince       =changesTimestamps.value (Person      ::dbTableName ());
+		QDateTime launchMethodsSince=changesTimestamps.value (LaunchMethod::dbTableName ());
+		if (!planesSince.isNull () && !peopleSince.isNull () && !launchMethodsSince.isNull ())
+		{
+			changedSince=qMin (planesSince, qMin (peopleSince, launchMethodsSince));
+			currentPlanes       =planes       .getList ();
+			currentPeople       =people       .getList ();
+			currentLaunchMethods=launchMethods.getList ();
+		}
+	}
+
+	Database::Snapshot snapshot;
+	db.getSnapshot (snapshot, QDate::currentDate (), newOtherDate, changedSince, monitor);
+
+	monitor.status (tr ("Building cache"));
+
+	// The staging cache is never accessed by anyone else, so it must not
+	// receive database events
+	Cache staging (db);
+	QObject::disconnect (&db, NULL, &staging, NULL);
+
+	// Planes and people before flights (locations are taken from the
+	// snapshot, not from the flights)
+	if (snapshot.changedSince.isNull ())
+	{
+		staging.setObjects<Plane       > (snapshot.planes       );
+		staging.setObjects<Person      > (snapshot.people       );
+		staging.setObjects<LaunchMethod> (snapshot.launchMethods);
+	}
+	else
+	{
+		staging.setObjects<Plane       > (currentPlanes       );
+		staging.setObjects<Person      > (currentPeople       );
+		staging.setObjects<LaunchMethod> (currentLaunchMethods);
+		staging.applyChanges<Plane       > (snapshot.planes       , snapshot.deletedPlaneIds       );
+		staging.applyChanges<Person      > (snapshot.people       , snapshot.deletedPersonIds      );
+		staging.applyChanges<LaunchMethod> (snapshot.launchMethods, snapshot.deletedLaunchMethodIds);
+	}
+	staging.changesTimestamps.insert (Plane       ::dbTableName (), snapshot.timestamp);
+	staging.changesTimestamps.insert (Person      ::dbTableName (), snapshot.timestamp);
+	staging.changesTimestamps.insert (LaunchMethod::dbTableName (), snapshot.timestamp);
+	staging.setFlights (snapshot.flightsToday, snapshot.todayDate, staging.flightsToday, &staging.todayDate);
+	// Only the current other date is read, the other resident dates are
+	// discarded
+	if (!snapshot.otherDate.isNull ())
+		staging.setOtherDateFlights (snapshot.flightsOther, snapshot.otherDate);
+	staging.setFlights (snapshot.preparedFlights, QDate (), staging.preparedFlights, NULL);
+	staging.locations=snapshot.locations;
+	staging.accountingNotes=snapshot.accountingNotes;
+
+	// Replace the data. This is cheap because the containers are implicitly
+	// shared.
+	synchronized (dataMutex) takeData (staging);
+	clearFlightConflicts ();
+
+	monitor.progress (1, 1, tr ("Finished"));
+}
+
+/**
+ * Replaces the data of this cache with the data of another cache. The write
+ * states are not replaced. The other cache should be discarded afterwards.
+ */
+void Cache::takeData (Cache &other)
+{
+	synchronized (dataMutex)
+	{
+		// Object lists
+		planes       =other.planes;
+		people       =other.people;
+		launchMethods=other.launchMethods;
+
+		// Flight lists
+		flightsToday   .replaceList (other.flightsToday   .getList ()); todayDate=other.todayDate;
+		preparedFlights.replaceList (other.preparedFlights.getList ());
+		otherDateFlights=other.otherDateFlights;
+		otherDatesByUse =other.otherDatesByUse;
+		otherDate       =other.otherDate;
+		prefetchedDates =other.prefetchedDates;
+
+		// String lists
+		locations         =other.locations;
+		accountingNotes   =other.accountingNotes;
+		clubs             =other.clubs;
+		planeTypes        =other.planeTypes;
+		planeRegistrations=other.planeRegistrations;
+		personLastNames   =other.personLastNames;
+		personFirstNames  =other.personFirstNames;
+
+		// By-ID hashes
+		planesById       =other.planesById;
+		peopleById       =other.peopleById;
+		launchMethodsById=other.launchMethodsById;
+		flightsById      =other.flightsById;
+
+		// Specific hashes
+		planeIdsByRegistration=other.planeIdsByRegistration;
+		launchMethodIdsByType =other.launchMethodIdsByType;
+		lastNamesByFirstName  =other.lastNamesByFirstName;
+		firstNamesByLastName  =other.firstNamesByLastName;
+		personIdsByLastName   =other.personIdsByLastName;
+		personIdsByFirstName  =other.personIdsByFirstName;
+		personIdsByName       =other.personIdsByName;
+
+		changesTimestamps=other.changesTimestamps;
+	}
 }
 
 void Cache::refreshFlights (OperationMonitorInterface monitor)
 {
+	TRACE_SPAN ("Cache::refreshFlights");
+
 	clearHashes<Flight> ();
 
 	// Refresh planes and people before refreshing flights!
 	monitor.progress (0, 3); refreshFlightsToday    (monitor);
 	monitor.progress (1, 3); refreshFlightsOther    (monitor);
 	monitor.progress (2, 3); refreshPreparedFlights (monitor);
+	clearFlightConflicts ();
 	monitor.progress (3, 3, tr ("Finished"));
 }
 
@@ -271,21 +622,13 @@ template<> void Cache::objectAdded<Flight> (const Flight &flight)
 {
 	synchronized (dataMutex)
 	{
-		bool interested=true;
-
-		if (flight.isPrepared ())
-			preparedFlights.append (flight);
-		else if (flight.effdatum ()==todayDate)
-			flightsToday.append (flight);
-		else if (flight.effdatum ()==otherDate)
-			// If otherDate is the same as today, this is not reached.
-			flightsOther.append (flight);
-		else
-			// We're not interested in this flight
-			interested=false;
+		// If the list is NULL, we're not interested in this flight
+		EntityList<Flight> *list=flightListFor (flight);
 
-		if (interested)
+		if (list)
 		{
+			list->append (flight);
+
 			// By-ID and specific hashes
 			objectsByIdHash<Flight> ().insert (flight.getId (), flight);
 			updateHashesObjectAdded<Flight> (flight);
@@ -319,7 +662,8 @@ template<> void Cache::objectDeleted<Flight> (dbId id)
 		// If any of the lists contain this flight, remove it
 		preparedFlights.removeById (id);
 		flightsToday.removeById (id);
-		flightsOther.removeById (id);
+		for (QMap<QDate, EntityList<Flight> >::iterator it=otherDateFlights.begin (); it!=otherDateFlights.end (); ++it)
+			it.value ().removeById (id);
 
 		// By-ID and specific hashes
 		objectsByIdHash<Flight> ().remove (id);
@@ -360,40 +704,22 @@ template<> void Cache::objectUpdated<Flight> (const Flight &flight)
 
 	synchronized (dataMutex)
 	{
-		bool interested=true;
-
 		const Flight *old=getNewObject<Flight> (flight.getId ());
 
-		if (flight.isPrepared ())
-		{
-			preparedFlights.replaceOrAdd (flight.getId (), flight);
-			flightsToday.removeById (flight.getId ());
-			flightsOther.removeById (flight.getId ());
-		}
-		else if (flight.effdatum ()==todayDate)
-		{
-			preparedFlights.removeById (flight.getId ());
-			flightsToday.replaceOrAdd (flight.getId (), flight);
-			flightsOther.removeById (flight.getId ());
-		}
-		else if (flight.effdatum ()==otherDate)
-		{
-			// If otherDate is the same as today, this is not reached.
-			preparedFlights.removeById (flight.getId ());
-			flightsToday.removeById (flight.getId ());
-			flightsOther.replaceOrAdd (flight.getId (), flight);
-		}
-		else
-		{
-			// The flight should not be on any list - remove it from all lists
-			preparedFlights.removeById (flight.getId ());
-			flightsToday.removeById (flight.getId ());
-			flightsOther.removeById (flight.getId ());
-			interested=false;
-		}
+		// If the list is NULL, the flight should not be on any list
+		EntityList<Flight> *list=flightListFor (flight);
 
-		if (interested)
+		// Remove the flight from all other lists
+		if (list!=&preparedFlights) preparedFlights.removeById (flight.getId ());
+		if (list!=&flightsToday   ) flightsToday   .removeById (flight.getId ());
+		for (QMap<QDate, EntityList<Flight> >::iterator it=otherDateFlights.begin (); it!=otherDateFlights.end (); ++it)
+			if (list!=&it.value ())
+				it.value ().removeById (flight.getId ());
+
+		if (list)
 		{
+			list->replaceOrAdd (flight.getId (), flight);
+
 			// By-ID and specific hashes
 			objectsByIdHash<Flight> ().insert (flight.getId (), flight);
 			updateHashesObjectUpdated<Flight> (flight, old);
@@ -408,12 +734,50 @@ template<class T> void Cache::handleDbChanged (const DbEvent &event)
 		case DbEvent::typeAdd   : objectAdded      (event.getValue<T> ()); break;
 		case DbEvent::typeChange: objectUpdated    (event.getValue<T> ()); break;
 		case DbEvent::typeDelete: objectDeleted<T> (event.getId       ()); break;
+		case DbEvent::typeBatch:
+			// Apply all changes of the batch under a single lock
+			synchronized (dataMutex)
+				foreach (const DbEvent &batchEvent, event.getEvents ())
+					handleDbChanged<T> (batchEvent);
+			break;
 		// no default
 	}
 }
 
+/**
+ * Handles a change in the database. A change of a flight resolves a write
+ * conflict of the flight: the version in the database is the current one.
+ */
 void Cache::dbChanged (DbEvent event)
 {
+	TRACE_SPAN ("Cache::dbChanged");
+
+	if (event.getTable ()==DbEvent::tableFlights)
+	{
+		synchronized (dataMutex)
+		{
+			if (flightWriteStates.value (event.getId (), writeConfirmed)==writeConflict)
+			{
+				flightWriteStates.remove (event.getId ());
+				conflictingFlights.remove (event.getId ());
+			}
+		}
+	}
+
+	applyChange (event);
+}
+
+void Cache::applyChange (const DbEvent &event)
+{
+	if (event.getTable ()==DbEvent::tableFlights)
+	{
+		synchronized (dataMutex)
+		{
+			if (flightFetches>0)
+				flightEventsDuringFetch.append (event);
+		}
+	}
+
 	switch (event.getTable ())
 	{
 		case DbEvent::tableFlights       : handleDbChanged<Flight>       (event); break;
@@ -428,6 +792,218 @@ void Cache::dbChanged (DbEvent event)
 }
 
 
+// ****************************
+// ** Flights of other dates **
+// ****************************
+
+// These methods must be called with the mutex locked
+
+/**
+ * Determines the list a flight belongs to
+ *
+ * @return the prepared flights, the flights of today or the flights of a
+ *         resident other date, or NULL if the flight does not belong to any
+ *         list
+ */
+EntityList<Flight> *Cache::flightListFor (const Flight &flight)
+{
+	if (flight.isPrepared ())
+		return &preparedFlights;
+	else if (flight.effdatum ()==todayDate)
+		return &flightsToday;
+	else if (otherDateFlights.contains (flight.effdatum ()))
+		// If the date is today, this is not reached.
+		return &otherDateFlights[flight.effdatum ()];
+	else
+		return NULL;
+}
+
+/**
+ * Starts fetching flights from the database without holding the lock
+ *
+ * Changes of flights made while the flights are being fetched may not be
+ * included in the result, and they are not applied to the cache if the
+ * flights are not on any list yet. Therefore, flight events are recorded
+ * until endFlightFetch is called and must be applied again (see
+ * #reapplyFlightEvents) after the fetched flights have been stored.
+ *
+ * @return a value to pass to endFlightFetch
+ */
+int Cache::beginFlightFetch ()
+{
+	synchronized (dataMutex)
+	{
+		++flightFetches;
+		return flightEventsDuringFetch.size ();
+	}
+
+	// Not reached
+	return 0;
+}
+
+/**
+ * Ends fetching flights, see #beginFlightFetch
+ *
+ * @param start the value returned by beginFlightFetch
+ * @return the flight events received since beginFlightFetch was called
+ */
+QList<DbEvent> Cache::endFlightFetch (int start)
+{
+	synchronized (dataMutex)
+	{
+		QList<DbEvent> events=flightEventsDuringFetch.mid (start);
+
+		if (--flightFetches==0)
+			flightEventsDuringFetch.clear ();
+
+		return events;
+	}
+
+	// Not reached
+	return QList<DbEvent> ();
+}
+
+/**
+ * Applies flight events again after fetched flights have been stored; must
+ * be called with the mutex locked
+ *
+ * Added and changed flights are handled as updates, so flights which are
+ * already in the fetched data are not added twice.
+ */
+void Cache::reapplyFlightEvents (const QList<DbEvent> &events)
+{
+	foreach (const DbEvent &event, events)
+	{
+		switch (event.getType ())
+		{
+			case DbEvent::typeAdd   : objectUpdated         (event.getValue<Flight> ()); break;
+			case DbEvent::typeChange: objectUpdated         (event.getValue<Flight> ()); break;
+			case DbEvent::typeDelete: objectDeleted<Flight> (event.getId ()); break;
+			case DbEvent::typeBatch : reapplyFlightEvents   (event.getEvents ()); break;
+			// no default
+		}
+	}
+}
+
+/**
+ * Stores the flights of an other date, replacing the flights of the date if
+ * it is resident, and makes it the current other date
+ */
+void Cache::setOtherDateFlights (const QList<Flight> &newFlights, const QDate &date)
+{
+	synchronized (dataMutex)
+	{
+		// Remove the old flights of the date
+		if (otherDateFlights.contains (date))
+			removeOtherDate (date);
+
+		otherDateFlights.insert (date, EntityList<Flight> (newFlights));
+		foreach (const Flight &flight, newFlights)
+		{
+			flightsById.insert (flight.getId (), flight);
+			updateHashesObjectAdded<Flight> (flight);
+		}
+
+		otherDate=date;
+		useOtherDate (date);
+		evictOtherDates ();
+	}
+}
+
+/**
+ * Marks a date as the most recently used one
+ */
+void Cache::useOtherDate (const QDate &date)
+{
+	otherDatesByUse.removeAll (date);
+	otherDatesByUse.append (date);
+}
+
+/**
+ * Removes the least recently used other dates until the number of dates and
+ * the number of flights are within the limits (maxOtherDates and
+ * maxOtherDateFlights). The current other date is never removed.
+ */
+void Cache::evictOtherDates ()
+{
+	int numFlights=0;
+	foreach (const EntityList<Flight> &list, otherDateFlights)
+		numFlights+=list.size ();
+
+	// The current other date is the most recently used one, so it is last
+	while (otherDatesByUse.size ()>1 &&
+		(otherDatesByUse.size ()>maxOtherDates || numFlights>maxOtherDateFlights))
+	{
+		numFlights-=removeOtherDate (otherDatesByUse.first ());
+	}
+}
+
+/**
+ * Removes all other dates except for the current one
+ */
+void Cache::discardOtherDates ()
+{
+	foreach (const QDate &date, otherDatesByUse)
+		if (date!=otherDate)
+			removeOtherDate (date);
+}
+
+/**
+ * Removes a resident other date, including its flights
+ *
+ * @return the number of flights removed
+ */
+int Cache::removeOtherDate (const QDate &date)
+{
+	EntityList<Flight> list=otherDateFlights.take (date);
+	otherDatesByUse.removeAll (date);
+	prefetchedDates.remove (date);
+
+	foreach (const Flight &flight, list.getList ())
+	{
+		// A flight may also be on the list of today or the prepared flights
+		// (e. g. a flight landing after midnight)
+		if (flightsToday.findById (flight.getId ())<0 && preparedFlights.findById (flight.getId ())<0)
+		{
+			flightsById.remove (flight.getId ());
+			updateHashesObjectDeleted<Flight> (flight.getId (), &flight);
+		}
+	}
+
+	return list.size ();
+}
+
+
+// ****************
+// ** Statistics **
+// ****************
+
+Cache::DateStatistics Cache::getDateStatistics () const
+{
+	synchronizedReturn (dataMutex, dateStatistics);
+}
+
+void Cache::resetDateStatistics ()
+{
+	synchronized (dataMutex)
+		dateStatistics=DateStatistics ();
+}
+
+QString Cache::DateStatistics::toString () const
+{
+	int selected=hits+misses;
+	return qnotr (
+		"Displayed dates: %1 selected, %2 cached (%3%), %4 fetched; "
+		"%5 prefetched, %6 used (%7%), %8 failed")
+		.arg (selected).arg (hits)
+		.arg (selected==0?0:100*hits/selected)
+		.arg (misses)
+		.arg (prefetches).arg (prefetchHits)
+		.arg (prefetches==0?0:100*prefetchHits/prefetches)
+		.arg (prefetchFailures);
+}
+
+
 // **********
 // ** Misc **
 // **********
@@ -442,8 +1018,11 @@ void Cache::clear ()
 		launchMethods.clear ();
 
 		flightsToday.clear (); todayDate=QDate ();
-		flightsOther.clear (); otherDate=QDate ();
 		preparedFlights.clear ();
+		otherDateFlights.clear ();
+		otherDatesByUse.clear ();
+		otherDate=QDate ();
+		prefetchedDates.clear ();
 
 		// By-ID hashes
 		planesById        .clear ();
@@ -457,6 +1036,118 @@ void Cache::clear ()
 		clearHashes<Person> ();
 		clearHashes<LaunchMethod> ();
 		clearHashes<Flight> ();
+
+		flightWriteStates.clear ();
+		conflictingFlights.clear ();
+		changesTimestamps.clear ();
+	}
+}
+
+
+// *******************
+// ** Local changes **
+// *******************
+
+/**
+ * Applies a change to the cache which has not (yet) been written to the
+ * database. The change is handled like a change in the database, including
+ * emitting the changed signal.
+ *
+ * If the change is not written to the database, the caller is responsible for
+ * reverting it.
+ */
+void Cache::applyLocalChange (DbEvent event)
+{
+	applyChange (event);
+}
+
+/**
+ * Sets the write state of a flight
+ *
+ * If the state changes and the flight is in the cache, a change event is
+ * emitted for the flight so views can update the display of the flight.
+ */
+void Cache::setFlightWriteState (dbId id, WriteState state)
+{
+	Flight *flight=NULL;
+
+	synchronized (dataMutex)
+	{
+		if (state!=writeConflict)
+			conflictingFlights.remove (id);
+
+		if (flightWriteStates.value (id, writeConfirmed)!=state)
+		{
+			if (state==writeConfirmed)
+				flightWriteStates.remove (id);
+			else
+				flightWriteStates.insert (id, state);
+
+			if (flightsById.contains (id))
+				flight=new Flight (flightsById.value (id));
+		}
+	}
+
+	// Emit the signal outside of the lock
+	if (flight)
+	{
+		emit changed (DbEvent::changed (*flight));
+		delete flight;
+	}
+}
+
+Cache::WriteState Cache::getFlightWriteState (dbId id) const
+{
+	synchronizedReturn (dataMutex, flightWriteStates.value (id, writeConfirmed));
+}
+
+/**
+ * Sets a flight to writeConflict state and stores the local version of the
+ * flight, which could not be written to the database
+ *
+ * The conflict is cleared when the state of the flight is set again, when
+ * the flight is changed in the database and when the flights are refreshed.
+ */
+void Cache::setFlightConflict (const Flight &localFlight)
+{
+	synchronized (dataMutex)
+		conflictingFlights.insert (localFlight.getId (), localFlight);
+
+	setFlightWriteState (localFlight.getId (), writeConflict);
+}
+
+/**
+ * Retrieves the local version of a flight in writeConflict state
+ *
+ * @return true if the flight is in writeConflict state
+ */
+bool Cache::getFlightConflict (dbId id, Flight *localFlight) const
+{
+	synchronized (dataMutex)
+	{
+		if (!conflictingFlights.contains (id)) return false;
+		if (localFlight) *localFlight=conflictingFlights.value (id);
+	}
+
+	return true;
+}
+
+/**
+ * Removes all write conflicts after the flights have been read from the
+ * database
+ *
+ * No events are emitted; the views are updated after a refresh anyway.
+ */
+void Cache::clearFlightConflicts ()
+{
+	synchronized (dataMutex)
+	{
+		QMutableHashIterator<dbId, WriteState> it (flightWriteStates);
+		while (it.hasNext ())
+			if (it.next ().value ()==writeConflict)
+				it.remove ();
+
+		conflictingFlights.clear ();
 	}
 }
 
@@ -10,10 +10,12 @@
 
 #include <QObject>
 #include <QDate>
+#include <QDateTime>
 #include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QHash>
+#include <QSet>
 
 #include "src/db/dbId.h"
 #include "src/model/LaunchMethod.h" // Required for LaunchMethod::Type
@@ -70,6 +72,35 @@ class Cache: public QObject
 				dbId id;
 		};
 
+		/**
+		 * The state of a flight which has been changed in the cache before
+		 * it has been written to the database (see
+		 * DbManager#updateFlightOptimistic)
+		 *
+		 * writeConflict means that writing failed and the change has been
+		 * reverted. The local version is kept (see #getFlightConflict) until
+		 * the user resolves the conflict or the flight is written or
+		 * refreshed.
+		 */
+		enum WriteState { writeConfirmed, writePending, writeConflict };
+
+		/**
+		 * Counters for selecting other dates (see #selectOtherDate) and for
+		 * prefetching (see #prefetchFlightsOther)
+		 */
+		class DateStatistics
+		{
+			public:
+				DateStatistics ();
+				QString toString () const;
+
+				int hits;         // Selected dates which were resident
+				int misses;       // Selected dates which had to be fetched
+				int prefetches;   // Dates prefetched
+				int prefetchHits; // Prefetched dates which were selected later
+				int prefetchFailures;
+		};
+
 		// *** Construction
 		Cache (Database &db);
 		virtual ~Cache ();
@@ -93,10 +124,23 @@ class Cache: public QObject
 
 		void refreshFlights (OperationMonitorInterface monitor=OperationMonitorInterface::null);
 		void fetchFlightsOther (QDate date, OperationMonitorInterface monitor=OperationMonitorInterface::null);
+		bool selectOtherDate (const QDate &date);
+		void prefetchFlightsOther (const QDate &date, OperationMonitorInterface monitor=OperationMonitorInterface::null);
+
+		// *** Statistics
+		DateStatistics getDateStatistics () const;
+		void resetDateStatistics ();
 
 		// *** Misc
 		void clear ();
 
+		// *** Local changes
+		void applyLocalChange (DbEvent event);
+		void setFlightWriteState (dbId id, WriteState state);
+		WriteState getFlightWriteState (dbId id) const;
+		void setFlightConflict (const Flight &localFlight);
+		bool getFlightConflict (dbId id, Flight *localFlight) const;
+
 		// ***** Lookup (implemented in Cache_lookup.cpp)
 
 		// *** Object lists
@@ -154,8 +198,25 @@ class Cache: public QObject
 
 		// *** Generic refreshing
 		void refreshFlightsOf (const QString &description, const QDate &date, EntityList<Flight> &targetList, QDate *targetDate, OperationMonitorInterface monitor);
+		template<class T> void setObjects (const QList<T> &newObjects);
+		template<class T> void applyChanges (const QList<T> &changedObjects, const QList<dbId> &deletedIds);
+		void setFlights (const QList<Flight> &newFlights, const QDate &date, EntityList<Flight> &targetList, QDate *targetDate);
+		void takeData (Cache &other);
+		void clearFlightConflicts ();
+
+		// *** Flights of other dates
+		EntityList<Flight> *flightListFor (const Flight &flight);
+		int beginFlightFetch ();
+		QList<DbEvent> endFlightFetch (int start);
+		void reapplyFlightEvents (const QList<DbEvent> &events);
+		void setOtherDateFlights (const QList<Flight> &newFlights, const QDate &date);
+		void useOtherDate (const QDate &date);
+		void evictOtherDates ();
+		void discardOtherDates ();
+		int removeOtherDate (const QDate &date);
 
 		// *** Change handling - generic
+		void applyChange (const DbEvent &event);
 		template<class T> void handleDbChanged (const DbEvent &event);
 
 		template<class T> void objectAdded (const T &object);
@@ -187,7 +248,7 @@ class Cache: public QObject
 
 		// *** Data
 		// Note: when adding something here, also handle it in the
-		// methods defined in Cache_hashUpdates.
+		// methods defined in Cache_hashUpdates and in takeData.
 
 		// Object lists - could also use AutomaticEntityList (but
 		// updating methods would have to be changed)
@@ -200,10 +261,19 @@ class Cache: public QObject
 		// stores a date)
 		EntityList<Flight> flightsToday;
 		QDate todayDate;
-		EntityList<Flight> flightsOther;
-		QDate otherDate;
 		EntityList<Flight> preparedFlights;
 
+		// Flights of other dates than today, by date. Several dates are kept
+		// so switching between dates does not access the database. The least
+		// recently used dates are evicted (see #evictOtherDates); otherDate,
+		// the current other date, is always resident (unless it is null).
+		QMap<QDate, EntityList<Flight> > otherDateFlights;
+		QList<QDate> otherDatesByUse; // Most recently used last
+		QDate otherDate;
+		// Prefetched dates which have not been selected yet
+		QSet<QDate> prefetchedDates;
+		DateStatistics dateStatistics;
+
 		// String lists
 		// Clubs and plane types are generated from other data.
 		// Locations and accounting notes are retrieved directly from
@@ -245,10 +315,31 @@ class Cache: public QObject
 		QMultiHash<QString, dbId> personIdsByFirstName; // key is lower case
 		QMultiHash<QPair<QString, QString>, dbId> personIdsByName; // key is lower case
 
+		// The timestamps for reading the changes of the planes, people and
+		// launch methods (see Database#getChanges), by table name. Objects
+		// which have not been read yet have no entry.
+		QHash<QString, QDateTime> changesTimestamps;
+
+		// Write state of flights which have not been confirmed by the
+		// database. Flights without an entry are writeConfirmed.
+		QHash<dbId, WriteState> flightWriteStates;
+		// The local versions of the flights in writeConflict state
+		QHash<dbId, Flight> conflictingFlights;
+
+		// Flight events received while flights are being fetched from the
+		// database without holding the lock (see #beginFlightFetch)
+		int flightFetches;
+		QList<DbEvent> flightEventsDuringFetch;
+
 		// Concurrency
 		// Improvement: use rw mutex and separate locks for flights, people...
 		/** Locks accesses to data of this Cache */
 		mutable QMutex dataMutex;
+
+		// Limits for the flights of other dates. A flight takes about 1 KB,
+		// including the hashes.
+		static const int maxOtherDates=31;
+		static const int maxOtherDateFlights=5000;
 };
 
 #endif
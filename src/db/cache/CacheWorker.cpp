@@ -6,10 +6,15 @@
 #include "src/concurrent/monitor/OperationMonitorInterface.h"
 #include "src/db/cache/Cache.h"
 #include "src/concurrent/Returner.h"
+#include "src/concurrent/synchronized.h"
+#include "src/util/qString.h"
 #include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
+#include "src/logging/messages.h"
+#include "src/db/interface/exceptions/SqlException.h"
 
 CacheWorker::CacheWorker (Cache &cache):
-	cache (cache)
+	cache (cache), prefetchScheduled (false)
 {
 #define CONNECT(definition) connect (this, SIGNAL (sig_ ## definition), this, SLOT (slot_ ## definition))
 	CONNECT (refreshAll           (Returner<void>            *, OperationMonitor *));
@@ -20,6 +25,12 @@ CacheWorker::CacheWorker (Cache &cache):
 	CONNECT (refreshLaunchMethods (Returner<void>            *, OperationMonitor *));
 #undef CONNECT
 
+	// The signal is emitted on the worker thread, so it has to be queued
+	// explicitly. This way, requests which are already queued are handled
+	// before the next date is prefetched.
+	connect (this, SIGNAL (sig_prefetchNext ()), this, SLOT (slot_prefetchNext ()), Qt::QueuedConnection);
+
+	thread.setObjectName (notr ("CacheWorker"));
 	moveToThread (&thread);
 	thread.start ();
 }
@@ -43,6 +54,7 @@ CacheWorker::~CacheWorker ()
  */
 void CacheWorker::refreshAll (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "CacheWorker::refreshAll");
 	emit sig_refreshAll (&returner, &monitor);
 }
 
@@ -51,29 +63,58 @@ void CacheWorker::refreshAll (Returner<void> &returner, OperationMonitor &monito
  */
 void CacheWorker::fetchFlightsOther (Returner<void> &returner, OperationMonitor &monitor, const QDate &date)
 {
+	TRACE_ENQUEUE (&returner, "CacheWorker::fetchFlightsOther");
 	emit sig_fetchFlightsOther (&returner, &monitor, date);
 }
 
 void CacheWorker::refreshPeople (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "CacheWorker::refreshPeople");
 	emit sig_refreshPeople (&returner, &monitor);
 }
 
 void CacheWorker::refreshPlanes (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "CacheWorker::refreshPlanes");
 	emit sig_refreshPlanes (&returner, &monitor);
 }
 
 void CacheWorker::refreshFlights (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "CacheWorker::refreshFlights");
 	emit sig_refreshFlights (&returner, &monitor);
 }
 
 void CacheWorker::refreshLaunchMethods (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "CacheWorker::refreshLaunchMethods");
 	emit sig_refreshLaunchMethods (&returner, &monitor);
 }
 
+/**
+ * Prefetches the flights of the given dates in the background (see
+ * Cache#prefetchFlightsOther)
+ *
+ * Prefetching has a lower priority than the other operations: only one date
+ * is fetched at a time, and other operations requested in the meantime are
+ * performed before the next date. Dates still pending from a previous call are
+ * discarded. There is no result, errors are only logged.
+ */
+void CacheWorker::prefetchFlights (const QList<QDate> &dates)
+{
+	bool schedule=false;
+
+	synchronized (prefetchMutex)
+	{
+		prefetchDates=dates;
+		schedule=!prefetchScheduled && !prefetchDates.isEmpty ();
+		if (schedule) prefetchScheduled=true;
+	}
+
+	if (schedule)
+		emit sig_prefetchNext ();
+}
+
 
 // ********************
 // ** Back-end slots **
@@ -81,34 +122,79 @@ void CacheWorker::refreshLaunchMethods (Returner<void> &returner, OperationMonit
 
 void CacheWorker::slot_refreshAll (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("CacheWorker::refreshAll");
+	TRACE_DEQUEUE (returner);
 	returnVoidOrException (returner, cache.refreshAll (monitor->interface ()));
 }
 
 void CacheWorker::slot_fetchFlightsOther (Returner<void> *returner, OperationMonitor *monitor, QDate date)
 {
+	TRACE_SPAN ("CacheWorker::fetchFlightsOther");
+	TRACE_DEQUEUE (returner);
 	returnVoidOrException (returner, cache.fetchFlightsOther (date, monitor->interface ()));
 }
 
 void CacheWorker::slot_refreshPeople (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("CacheWorker::refreshPeople");
+	TRACE_DEQUEUE (returner);
 	returnVoidOrException (returner, cache.refreshPeople (monitor->interface ()));
 }
 
 void CacheWorker::slot_refreshPlanes (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("CacheWorker::refreshPlanes");
+	TRACE_DEQUEUE (returner);
 	returnVoidOrException (returner, cache.refreshPlanes (monitor->interface ()));
 }
 
 void CacheWorker::slot_refreshFlights (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("CacheWorker::refreshFlights");
+	TRACE_DEQUEUE (returner);
 	returnVoidOrException (returner, cache.refreshFlights (monitor->interface ()));
 }
 
 void CacheWorker::slot_refreshLaunchMethods (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("CacheWorker::refreshLaunchMethods");
+	TRACE_DEQUEUE (returner);
 	returnVoidOrException (returner, cache.refreshLaunchMethods (monitor->interface ()));
 }
 
+void CacheWorker::slot_prefetchNext ()
+{
+	QDate date;
+	synchronized (prefetchMutex)
+	{
+		if (prefetchDates.isEmpty ())
+			prefetchScheduled=false;
+		else
+			date=prefetchDates.takeFirst ();
+	}
+
+	if (date.isNull ()) return;
+
+	try
+	{
+		cache.prefetchFlightsOther (date);
+	}
+	catch (SqlException &ex)
+	{
+		// Prefetching is optional, the date will be fetched when it is
+		// displayed. Failures are counted in the date statistics.
+		log_error (qnotr ("Prefetching the flights of %1 failed: %2")
+			.arg (date.toString (Qt::ISODate), ex.toString ()));
+	}
+	catch (...)
+	{
+		log_error (qnotr ("Prefetching the flights of %1 failed")
+			.arg (date.toString (Qt::ISODate)));
+	}
+
+	emit sig_prefetchNext ();
+}
+
 
 // *****************************
 // ** Template specialization **
@@ -11,6 +11,8 @@
 #include <QObject>
 #include <QThread>
 #include <QDate>
+#include <QList>
+#include <QMutex>
 
 template<typename T> class Returner;
 class OperationMonitor;
@@ -28,6 +30,9 @@ class Cache;
  *
  * This class is thread safe.
  *
+ * Additionally, flights of other dates can be prefetched (see
+ * #prefetchFlights).
+ *
  * See doc/internal/worker.txt
  */
 class CacheWorker: public QObject
@@ -47,6 +52,8 @@ class CacheWorker: public QObject
 
 		template<class T> void refreshObjects (Returner<void> &returner, OperationMonitor &monitor);
 
+		void prefetchFlights (const QList<QDate> &dates);
+
 	signals:
 		void sig_refreshAll           (Returner<void> *returner, OperationMonitor *monitor);
 		void sig_fetchFlightsOther    (Returner<void> *returner, OperationMonitor *monitor, QDate date);
@@ -54,6 +61,7 @@ class CacheWorker: public QObject
 		void sig_refreshPlanes        (Returner<void> *returner, OperationMonitor *monitor);
 		void sig_refreshFlights       (Returner<void> *returner, OperationMonitor *monitor);
 		void sig_refreshLaunchMethods (Returner<void> *returner, OperationMonitor *monitor);
+		void sig_prefetchNext ();
 
 	protected slots:
 		virtual void slot_refreshAll           (Returner<void> *returner, OperationMonitor *monitor);
@@ -62,10 +70,15 @@ class CacheWorker: public QObject
 		virtual void slot_refreshPlanes        (Returner<void> *returner, OperationMonitor *monitor);
 		virtual void slot_refreshFlights       (Returner<void> *returner, OperationMonitor *monitor);
 		virtual void slot_refreshLaunchMethods (Returner<void> *returner, OperationMonitor *monitor);
+		virtual void slot_prefetchNext ();
 
 	private:
 		QThread thread;
 		Cache &cache;
+
+		QMutex prefetchMutex;
+		QList<QDate> prefetchDates;
+		bool prefetchScheduled;
 };
 
 #endif
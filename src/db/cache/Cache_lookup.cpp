@@ -55,7 +55,7 @@ EntityList<Flight> Cache::getFlightsToday ()
 
 EntityList<Flight> Cache::getFlightsOther ()
 {
-	synchronizedReturn (dataMutex, flightsOther);
+	synchronizedReturn (dataMutex, otherDateFlights.value (otherDate));
 }
 
 EntityList<Flight> Cache::getPreparedFlights ()
@@ -75,7 +75,16 @@ QDate Cache::getOtherDate ()
 
 EntityList<Flight> Cache::getAllKnownFlights ()
 {
-	synchronizedReturn (dataMutex, flightsToday+flightsOther+preparedFlights);
+	synchronized (dataMutex)
+	{
+		EntityList<Flight> flights=flightsToday+preparedFlights;
+		foreach (const EntityList<Flight> &list, otherDateFlights)
+			flights=flights+list;
+		return flights;
+	}
+
+	// Not reached
+	return EntityList<Flight> ();
 }
 
 
@@ -44,6 +44,10 @@ DbEvent::DbEvent (Type type, Table table, dbId id, const QVariant &value):
 
 QString DbEvent::toString () const
 {
+	if (type==typeBatch)
+		return qnotr ("db_event (type: %1, table: %2, events: %3)")
+			.arg (typeString (type), tableString (table)).arg (events.size ());
+
 	return qnotr ("db_event (type: %1, table: %2, id: %3)")
 		.arg (typeString (type), tableString (table)).arg (id);
 }
@@ -55,6 +59,7 @@ QString DbEvent::typeString (DbEvent::Type type)
 		case typeAdd    : return notr ("add");
 		case typeDelete : return notr ("delete");
 		case typeChange : return notr ("change");
+		case typeBatch  : return notr ("batch");
 		// no default
 	}
 
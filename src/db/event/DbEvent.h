@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QVariant>
+#include <QList>
 
 #include "src/db/dbId.h"
 
@@ -11,13 +12,19 @@
  *
  * This is implemented with an Table Enum rather than as a template because it
  * is sent as a parameter for a signal and signals can't be templates.
+ *
+ * A batch event (see #batch) carries several changes of the same table. It is
+ * used where many objects change at once (e. g. deleting multiple objects or
+ * merging people), so the event is only sent and handled once. Receivers can
+ * apply the changes together, for example with a single range signal of a
+ * model instead of one signal per object.
  */
 class DbEvent
 {
 	public:
 		// ** Types
 		enum Table { tablePeople, tableFlights, tableLaunchMethods, tablePlanes };
-		enum Type { typeAdd, typeDelete, typeChange };
+		enum Type { typeAdd, typeDelete, typeChange, typeBatch };
 
 		// ** Construction
 		DbEvent ();
@@ -49,6 +56,13 @@ class DbEvent
 			return DbEvent (typeDelete, getTable<T> (), id, QVariant ());
 		}
 
+		template<class T> static DbEvent batch (const QList<DbEvent> &events)
+		{
+			DbEvent event (typeBatch, getTable<T> (), invalidId, QVariant ());
+			event.events=events;
+			return event;
+		}
+
 
 		// ** Formatting
 		QString toString () const;
@@ -62,6 +76,7 @@ class DbEvent
 		QVariant getValue () const { return type ; }
 
 		template <class T> T getValue () const { return value.value<T> (); }
+		const QList<DbEvent> &getEvents () const { return events; }
 
 		// ** Table methods
 		template<class T> bool hasTable () const { return table==getTable<T> (); }
@@ -72,6 +87,7 @@ class DbEvent
 		Table table;
 		dbId id;
 		QVariant value;
+		QList<DbEvent> events; // For batch events
 };
 
 #endif
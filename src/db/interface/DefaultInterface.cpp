@@ -39,9 +39,9 @@
  *     connection. The use will have to cancel again in this case.
  *
  * On Reconnect:
- *   - Test case: start, connect; low limit (30 Bytes/s) in ThrottleProxy;
- *     disconnect in ThrottleProxy; refresh (connection must be reopened);
- *     cancel (must cancel immediately)
+ *   - Test case: start with --shape-bandwidth 30, connect; disconnect the
+ *     network; refresh (connection must be reopened); cancel (must cancel
+ *     immediately)
  */
 #include "DefaultInterface.h"
 
@@ -50,6 +50,9 @@
 
 #include <QVariant>
 #include <QThread>
+#include <QTime>
+#include <QSqlRecord>
+#include <QMetaObject>
 
 // FIXME on windows, can we use mysql/... here? or ... on linux?
 #include <errmsg.h>
@@ -68,6 +71,8 @@
 #include "src/config/Settings.h"
 #include "src/concurrent/DefaultQThread.h"
 #include "src/i18n/notr.h"
+#include "src/db/interface/QueryProfiler.h"
+#include "src/net/LinkHealth.h"
 
 QAtomicInt DefaultInterface::freeNumber=0;
 
@@ -85,6 +90,21 @@ DefaultInterface::DefaultInterface (const DatabaseInfo &dbInfo, int readTimeout)
 	connect (proxy, SIGNAL (readTimeout ()), this, SIGNAL (readTimeout ()), Qt::DirectConnection);
 	connect (proxy, SIGNAL (readResumed ()), this, SIGNAL (readResumed ()), Qt::DirectConnection);
 
+	QueryProfiler::instance ().setSlowQueryThreshold (Settings::instance ().slowQueryThreshold);
+	QueryProfiler::instance ().setPrintSlowQueries (Settings::instance ().printSlowQueries);
+	QueryProfiler::instance ().setExplainSlowQueries (Settings::instance ().explainSlowQueries);
+
+	// Link simulation for testing
+	Settings &s=Settings::instance ();
+	TcpProxy::Shaping shaping;
+	shaping.bandwidth=s.shapingBandwidth;
+	shaping.latency  =s.shapingLatency;
+	shaping.loss     =s.shapingLoss;
+	proxy->setShaping (shaping);
+	if (shaping.isEnabled ())
+		std::cout << qnotr ("Simulating a slow link: %1 bytes/s, %2 ms latency, %3% loss")
+			.arg (shaping.bandwidth).arg (shaping.latency).arg (shaping.loss) << std::endl;
+
 	QString name=qnotr ("startkladde_defaultInterface_%1").arg (getFreeNumber ());
 	//std::cout << "Create db " << name << std::endl;
 
@@ -148,6 +168,9 @@ bool DefaultInterface::open ()
 	db.setPort         (proxyPort);
 	db.setDatabaseName (info.database);
 
+	// The driver always sets CLIENT_MULTI_STATEMENTS (there is no connect
+	// option for it), so queries without bind values may consist of several
+	// statements (see Interface::multiStatementQuery).
 	db.setConnectOptions (notr ("CLIENT_COMPRESS"));
 
 
@@ -169,6 +192,7 @@ void DefaultInterface::openImpl ()
 		if (db.open ())
 		{
 			std::cout << notr ("OK") << std::endl;
+			LinkHealth::instance ().recordConnect ();
 			return;
 		}
 		else
@@ -432,6 +456,10 @@ QSqlQuery DefaultInterface::doExecuteQuery (const Query &query, bool forwardOnly
 		std::cout.flush ();
 	}
 
+	QTime timer;
+	timer.start ();
+	qint64 bytesBefore=proxy->getBytesFromServer ();
+
 	QSqlQuery sqlQuery (db);
 	sqlQuery.setForwardOnly (forwardOnly);
 
@@ -495,10 +523,106 @@ QSqlQuery DefaultInterface::doExecuteQuery (const Query &query, bool forwardOnly
 					notr ("%1 rows affected")) << std::endl;
 		}
 
+		profileQuery (query, sqlQuery, timer.elapsed (), proxy->getBytesFromServer ()-bytesBefore);
+
 		return sqlQuery;
 	}
 }
 
+/**
+ * Records a successfully executed query with the QueryProfiler and, if the
+ * query was slow, writes it to the slow query log
+ *
+ * If the profiler requests the EXPLAIN output for the query (only if enabled,
+ * and only once per statement shape), it is determined after the current
+ * call has returned, from the event loop of the interface thread (see
+ * #explainPendingQueries), so the caller does not wait for it.
+ *
+ * @param duration the wall time in milliseconds
+ * @param bytes the number of bytes received from the server
+ */
+void DefaultInterface::profileQuery (const Query &query, const QSqlQuery &sqlQuery, int duration, qint64 bytes)
+{
+	QueryProfiler &profiler=QueryProfiler::instance ();
+
+	int rows=sqlQuery.isSelect ()?sqlQuery.size ():sqlQuery.numRowsAffected ();
+	profiler.record (query.getQueryString (), duration, rows, bytes);
+
+	if (profiler.isSlow (duration))
+	{
+		QueryProfiler::SlowQuery slowQuery;
+		slowQuery.time=QDateTime::currentDateTime ();
+		slowQuery.query=query.toString ();
+		slowQuery.shape=QueryProfiler::statementShape (query.getQueryString ());
+		slowQuery.duration=duration;
+		slowQuery.rows=rows;
+		slowQuery.bytes=bytes;
+		profiler.recordSlowQuery (slowQuery);
+
+		// Only SELECT statements can be explained (in MySQL 5.1)
+		if (sqlQuery.isSelect () && profiler.beginExplain (slowQuery.shape))
+		{
+			if (pendingExplains.isEmpty ())
+				QMetaObject::invokeMethod (this, "explainPendingQueries", Qt::QueuedConnection);
+			pendingExplains.append (query);
+		}
+	}
+}
+
+/**
+ * Determines the EXPLAIN output of the queries queued by #profileQuery and
+ * records it with the QueryProfiler
+ */
+void DefaultInterface::explainPendingQueries ()
+{
+	QList<Query> queries=pendingExplains;
+	pendingExplains.clear ();
+
+	foreach (const Query &query, queries)
+		QueryProfiler::instance ().recordExplain (
+			QueryProfiler::statementShape (query.getQueryString ()),
+			explainQuery (query));
+}
+
+/**
+ * Executes EXPLAIN for a query and returns the result as text, one line per
+ * row. The EXPLAIN query is not profiled, retried or logged; if it fails, the
+ * error message is returned.
+ */
+QString DefaultInterface::explainQuery (const Query &query)
+{
+	Query explain=Query (notr ("EXPLAIN "))+query;
+
+	QSqlQuery sqlQuery (db);
+	sqlQuery.setForwardOnly (true);
+
+	if (!explain.prepare (sqlQuery))
+		return sqlQuery.lastError ().databaseText ();
+
+	explain.bindTo (sqlQuery);
+
+	if (!explain.exec (sqlQuery))
+		return sqlQuery.lastError ().databaseText ();
+
+	QStringList lines;
+
+	QSqlRecord record=sqlQuery.record ();
+	QStringList header;
+	for (int i=0; i<record.count (); ++i)
+		header.append (record.fieldName (i));
+	lines.append (header.join (notr (" | ")));
+
+	while (sqlQuery.next ())
+	{
+		QStringList values;
+		for (int i=0; i<record.count (); ++i)
+			values.append (sqlQuery.value (i).toString ());
+		lines.append (values.join (notr (" | ")));
+	}
+
+	return lines.join (notr ("\n"));
+}
+
 void DefaultInterface::ping ()
 {
 	verifyThread ();
@@ -70,6 +70,9 @@ class DefaultInterface: public QObject, public Interface
 	protected:
 		void verifyThread () const;
 
+	private slots:
+		void explainPendingQueries ();
+
 	private:
 		// TODO: when accessing db, we want to check the thread. Make a wrapper
 		// around db that does this, or better, move db to common base class
@@ -78,6 +81,7 @@ class DefaultInterface: public QObject, public Interface
 		QAtomicInt canceled; // There is no QAtomicBool. 0=false, others=true
 		bool displayQueries;
 		Qt::HANDLE threadId; // The thread ID db was created on
+		QList<Query> pendingExplains; // See profileQuery
 
 		static QAtomicInt freeNumber;
 		static int getFreeNumber () { return freeNumber.fetchAndAddOrdered (1); }
@@ -86,6 +90,8 @@ class DefaultInterface: public QObject, public Interface
 
 		virtual QSqlQuery executeQueryImpl (const Query &query, bool forwardOnly=true);
 		virtual QSqlQuery doExecuteQuery (const Query &query, bool forwardOnly=true);
+		virtual void profileQuery (const Query &query, const QSqlQuery &sqlQuery, int duration, qint64 bytes);
+		virtual QString explainQuery (const Query &query);
 
 		virtual void transactionStatementImpl (TransactionStatement statement);
 		virtual bool doTransactionStatement (TransactionStatement statement);
@@ -12,6 +12,7 @@
 #include <QCryptographicHash>
 #include <QString>
 #include <QSqlError>
+#include <QRegExp>
 
 // TODO should go to DefaultInterface/MySQLInterface
 #include <errmsg.h>
@@ -39,6 +40,94 @@ Interface::~Interface ()
 }
 
 
+// *************
+// ** Dialect **
+// *************
+
+/**
+ * Whether the database is an SQLite database
+ *
+ * The schema manipulation methods use this to generate SQLite statements
+ * instead of MySQL statements where the dialects differ. This depends on the
+ * database info rather than on the Interface implementation, so it works
+ * with a ThreadSafeInterface as well.
+ */
+bool Interface::isSqlite () const
+{
+	return getInfo ().type==DatabaseInfo::typeSqlite;
+}
+
+
+// *****************************
+// ** Multi-statement queries **
+// *****************************
+
+/*
+ * The MySQL driver of Qt always enables multiple statements per query (for
+ * stored procedures), but only for queries without bind values, because
+ * prepared statements must consist of a single statement. SQLite executes
+ * only the first statement of a query.
+ *
+ * The result sets of the statements are accessed with Result#nextResult. If a
+ * statement fails, the following statements are not executed and there are
+ * no more result sets; the error is not reported otherwise.
+ */
+
+/**
+ * Combines queries into a single multi-statement query
+ *
+ * The bind values are inlined (see Query#inlined), so this may only be used
+ * for values generated by the program.
+ */
+Query Interface::multiStatementQuery (const QList<Query> &queries)
+{
+	Query result;
+
+	foreach (const Query &query, queries)
+	{
+		if (!result.isEmpty ()) result+=notr (";");
+		result+=query.inlined ();
+	}
+
+	return result;
+}
+
+/**
+ * Advances the result of a multi-statement query to the next result set
+ *
+ * @param query the multi-statement query, for the exception
+ * @param statementCount the number of statements of the query, for the
+ *                       exception
+ * @throw QueryFailedException if there is no next result set because one of
+ *        the statements failed
+ */
+void Interface::nextResultSet (Result &result, const Query &query, int statementCount)
+{
+	if (!result.nextResult ())
+		throw QueryFailedException::execute (QSqlError (
+			qnotr ("A statement of a multi-statement query with %1 statements failed").arg (statementCount),
+			QString (), QSqlError::StatementError), query);
+}
+
+/**
+ * Executes queries as a single multi-statement query (one round trip) and
+ * makes sure that all of them have been executed
+ *
+ * @throw QueryFailedException if one of the statements failed
+ */
+void Interface::executeMultiStatement (const QList<Query> &queries)
+{
+	if (queries.isEmpty ()) return;
+
+	Query query=multiStatementQuery (queries);
+	QSharedPointer<Result> result=executeQueryResult (query);
+
+	// The result of the first statement is current
+	for (int i=1; i<queries.size (); ++i)
+		nextResultSet (*result, query, queries.size ());
+}
+
+
 // ****************
 // ** Data types **
 // ****************
@@ -67,6 +156,9 @@ QString Interface::dataTypeId        () { return dataTypeInteger (); }
 
 void Interface::grantAll (const QString &database, const QString &username, const QString &password)
 {
+	// SQLite does not have users
+	if (isSqlite ()) return;
+
 	Query query=Query (notr ("GRANT ALL ON %1.* TO '%2'@'%'"))
 		.arg (database).arg (username);
 
@@ -97,10 +189,30 @@ void Interface::createDatabase (const QString &name, bool skipIfExists)
 		.arg (name, skipIfExists?notr (" if it does not exist"):"")
 		<< std::endl;
 
+	// The SQLite database file is created when it is opened
+	if (isSqlite ()) return;
+
 	executeQuery (Query (notr ("CREATE DATABASE %1 %2"))
 		.arg (skipIfExists?notr ("IF NOT EXISTS"):"").arg (name));
 }
 
+void Interface::dropDatabase (const QString &name)
+{
+	std::cout << qnotr ("Dropping database %1").arg (name) << std::endl;
+
+	if (isSqlite ())
+	{
+		// The database file is open, so we cannot delete it. Drop all tables
+		// instead.
+		foreach (const QString &table, showTables ())
+			dropTable (table);
+	}
+	else
+	{
+		executeQuery (Query (notr ("DROP DATABASE %1")).arg (name));
+	}
+}
+
 /**
  * Creates a table with an ID column
  *
@@ -118,18 +230,7 @@ void Interface::createTable (const QString &name, bool skipIfExists)
 
 void Interface::createTable (const QString &name, const QList<ColumnSpec> &columns, bool skipIfExists)
 {
-	if (skipIfExists)
-		std::cout << qnotr ("Creating table %1 if it does not exist").arg (name) << std::endl;
-	else
-		std::cout << qnotr ("Creating table %1").arg (name) << std::endl;
-
-	// TODO CreateTableQuery
-	executeQuery (Query (notr (
-		"CREATE TABLE %1 %2 ("
-		"%3"
-		") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_unicode_ci"
-		))
-		.arg (skipIfExists?notr ("IF NOT EXISTS"):"", name, ColumnSpec::createClause (columns)));
+	createTable (name, columns, QList<IndexSpec> (), skipIfExists);
 }
 
 void Interface::createTable (const QString &name, const QList<ColumnSpec> &columns, const QList<IndexSpec> &indexes, bool skipIfExists)
@@ -139,6 +240,37 @@ void Interface::createTable (const QString &name, const QList<ColumnSpec> &colum
 	else
 		std::cout << qnotr ("Creating table %1").arg (name) << std::endl;
 
+	foreach (const Query &query, createTableQueries (name, columns, indexes, skipIfExists))
+		executeQuery (query);
+}
+
+/**
+ * Generates the queries for creating a table, including its indexes (and, for
+ * SQLite, the triggers required by the columns), without executing them
+ *
+ * For MySQL, this is a single query. This can be used for executing several
+ * schema changes as a batch (see Migrator#loadSchema).
+ */
+QList<Query> Interface::createTableQueries (const QString &name, const QList<ColumnSpec> &columns, const QList<IndexSpec> &indexes, bool skipIfExists)
+{
+	QList<Query> queries;
+
+	if (isSqlite ())
+	{
+		// SQLite does not support index definitions in CREATE TABLE
+		queries << Query (notr ("CREATE TABLE %1 %2 (%3)"))
+			.arg (skipIfExists?notr ("IF NOT EXISTS"):"", name, ColumnSpec::sqliteCreateClause (columns));
+
+		foreach (const IndexSpec &index, indexes)
+			queries << sqliteCreateIndexQuery (index, skipIfExists);
+
+		foreach (const ColumnSpec &column, columns)
+			if (column.isAutoUpdated ())
+				queries << sqliteCreateUpdateTriggerQuery (name, column.getName ());
+
+		return queries;
+	}
+
 	QString createColumnsClause=ColumnSpec::createClause (columns);
 
 	QString createIndexesClause;
@@ -146,12 +278,14 @@ void Interface::createTable (const QString &name, const QList<ColumnSpec> &colum
 		createIndexesClause=qnotr (", %1").arg (IndexSpec::createClause (indexes));
 
 	// TODO CreateTableQuery
-	executeQuery (Query (notr (
+	queries << Query (notr (
 		"CREATE TABLE %1 %2 ("
 		"%3%4"
 		") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_unicode_ci"
 		))
-		.arg (skipIfExists?notr ("IF NOT EXISTS"):"", name, createColumnsClause, createIndexesClause));
+		.arg (skipIfExists?notr ("IF NOT EXISTS"):"", name, createColumnsClause, createIndexesClause);
+
+	return queries;
 }
 
 
@@ -163,6 +297,20 @@ void Interface::createTableLike (const QString &like, const QString &name, bool
 	else
 		std::cout << qnotr ("Creating table %1 like %2").arg (name, like) << std::endl;
 
+	if (isSqlite ())
+	{
+		// SQLite has no CREATE TABLE ... LIKE, so we recreate the table
+		// definition from the columns and indexes
+		if (skipIfExists && tableExists (name)) return;
+
+		QList<IndexSpec> indexes;
+		foreach (const IndexSpec &index, showIndexes (like))
+			indexes.append (IndexSpec (name, index.getName (), index.getColumns ()));
+
+		createTable (name, sqliteColumns (like), indexes);
+		return;
+	}
+
 	// TODO CreateTableLikeQuery
 	executeQuery (Query (notr ("CREATE TABLE %1 %2 LIKE %3"))
 		.arg (skipIfExists?notr ("IF NOT EXISTS"):"", name, like));
@@ -179,23 +327,38 @@ void Interface::renameTable (const QString &oldName, const QString &newName)
 {
 	std::cout << qnotr ("Renaming table %1 to %2").arg (oldName, newName) << std::endl;
 
-	executeQuery (Query (notr ("RENAME TABLE %1 TO %2")).arg (oldName, newName));
+	if (isSqlite ())
+		executeQuery (Query (notr ("ALTER TABLE %1 RENAME TO %2")).arg (oldName, newName));
+	else
+		executeQuery (Query (notr ("RENAME TABLE %1 TO %2")).arg (oldName, newName));
 }
 
 bool Interface::tableExists ()
 {
-	return queryHasResult (Query (notr ("SHOW TABLES")));
+	if (isSqlite ())
+		return queryHasResult (Query (notr (
+			"SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%'")));
+	else
+		return queryHasResult (Query (notr ("SHOW TABLES")));
 }
 
 bool Interface::tableExists (const QString &name)
 {
+	if (isSqlite ())
+		return queryHasResult (Query (notr (
+			"SELECT name FROM sqlite_master WHERE type='table' AND name=?")).bind (name));
+
 	// Using addBindValue does not seem to work here
 	return queryHasResult (Query (notr ("SHOW TABLES LIKE '%1'")).arg (name));
 }
 
 QStringList Interface::showTables ()
 {
-	return listStrings (notr ("SHOW TABLES"));
+	if (isSqlite ())
+		return listStrings (Query (notr (
+			"SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%'")));
+	else
+		return listStrings (notr ("SHOW TABLES"));
 }
 
 void Interface::addColumn (const QString &table, const QString &name, const QString &type, const QString &extraSpecification, bool skipIfExists)
@@ -208,6 +371,23 @@ void Interface::addColumn (const QString &table, const QString &name, const QStr
 
 	std::cout << qnotr ("Adding column %1.%2").arg (table, name) << std::endl;
 
+	if (isSqlite ())
+	{
+		ColumnSpec column (name, type, extraSpecification);
+
+		// SQLite cannot add a column with a non-constant default value
+		if (extraSpecification.contains (notr ("CURRENT_TIMESTAMP"), Qt::CaseInsensitive))
+			sqliteRebuildTable (table, QString (), &column);
+		else
+			executeQuery (Query (notr ("ALTER TABLE %1 ADD COLUMN %2"))
+				.arg (table, column.sqliteCreateClause ()));
+
+		if (column.isAutoUpdated ())
+			sqliteCreateUpdateTrigger (table, name);
+
+		return;
+	}
+
 	executeQuery (Query (notr ("ALTER TABLE %1 ADD COLUMN %2 %3 %4"))
 		.arg (table, name, type, extraSpecification));
 }
@@ -217,6 +397,13 @@ void Interface::changeColumnType (const QString &table, const QString &name, con
 	std::cout << qnotr ("Changing column %1.%2 type to %3")
 		.arg (table, name, type) << std::endl;
 
+	if (isSqlite ())
+	{
+		ColumnSpec column (name, type, extraSpecification);
+		sqliteRebuildTable (table, name, &column);
+		return;
+	}
+
 	executeQuery (Query (notr ("ALTER TABLE %1 MODIFY %2 %3 %4"))
 		.arg (table, name, type, extraSpecification));
 }
@@ -233,6 +420,12 @@ void Interface::dropColumn (const QString &table, const QString &name, bool skip
 	std::cout << qnotr ("Dropping column %1.%2")
 		.arg (table, name) << std::endl;
 
+	if (isSqlite ())
+	{
+		sqliteRebuildTable (table, name, NULL);
+		return;
+	}
+
 	executeQuery (Query (notr ("ALTER TABLE %1 DROP COLUMN %2"))
 		.arg (table, name));
 }
@@ -242,6 +435,13 @@ void Interface::renameColumn (const QString &table, const QString &oldName, cons
 	std::cout << qnotr ("Renaming column %1.%2 to %3")
 		.arg (table, oldName, newName) << std::endl;
 
+	if (isSqlite ())
+	{
+		ColumnSpec column (newName, type, extraSpecification);
+		sqliteRebuildTable (table, oldName, &column);
+		return;
+	}
+
 	executeQuery (
 		Query (notr ("ALTER TABLE %1 CHANGE %2 %3 %4 %5"))
 		.arg (table, oldName, newName, type, extraSpecification));
@@ -249,6 +449,14 @@ void Interface::renameColumn (const QString &table, const QString &oldName, cons
 
 bool Interface::columnExists (const QString &table, const QString &name)
 {
+	if (isSqlite ())
+	{
+		foreach (const ColumnSpec &column, sqliteColumns (table))
+			if (column.getName ()==name)
+				return true;
+
+		return false;
+	}
 
 	return queryHasResult (
 		Query (notr ("SHOW COLUMNS FROM %1 LIKE '%2'"))
@@ -260,6 +468,34 @@ QList<IndexSpec> Interface::showIndexes (const QString &table)
 {
 	QList<IndexSpec> indexes;
 
+	if (isSqlite ())
+	{
+		// Automatic indexes (for primary keys) have no SQL
+		QStringList names=listStrings (Query (notr (
+			"SELECT name FROM sqlite_master WHERE type='index' AND tbl_name=? AND sql IS NOT NULL"))
+			.bind (table));
+
+		QString prefix=sqliteIndexName (table, "");
+
+		foreach (const QString &name, names)
+		{
+			// The columns are returned in index order. The column name is the
+			// third column (seqno, cid, name).
+			QStringList columnList;
+			QSharedPointer<Result> result=executeQueryResult (Query (notr ("PRAGMA index_info(%1)")).arg (name));
+			while (result->next ())
+				columnList.append (result->value (2).toString ());
+
+			QString indexName=name;
+			if (indexName.startsWith (prefix))
+				indexName=indexName.mid (prefix.length ());
+
+			indexes.append (IndexSpec (table, indexName, columnList.join (notr (","))));
+		}
+
+		return indexes;
+	}
+
 	Query query=Query (notr ("SHOW INDEXES FROM %1")).arg (table);
 	QSharedPointer<Result> result=executeQueryResult (query);
 
@@ -314,6 +550,12 @@ void Interface::createIndex (const IndexSpec &index, bool skipIfExists)
 	else
 		std::cout << qnotr ("Creating index %1.%2").arg (index.getTable (), index.getName ()) << std::endl;
 
+	if (isSqlite ())
+	{
+		executeQuery (sqliteCreateIndexQuery (index, skipIfExists));
+		return;
+	}
+
 	// TODO: the MySQL specific stuff should not be here
 	try
 	{
@@ -340,6 +582,13 @@ void Interface::dropIndex (const QString &table, const QString &name, bool skipI
 	else
 		std::cout << qnotr ("Dropping index %1.%2").arg (table, name) << std::endl;
 
+	if (isSqlite ())
+	{
+		executeQuery (qnotr ("DROP INDEX %1 %2")
+			.arg (skipIfNotExists?notr ("IF EXISTS"):"", sqliteIndexName (table, name)));
+		return;
+	}
+
 	try
 	{
 		executeQuery (qnotr ("DROP INDEX %1 ON %2").arg (name, table));
@@ -393,6 +642,182 @@ int Interface::countQuery (const Query &query)
 }
 
 
+// ************
+// ** SQLite **
+// ************
+
+/**
+ * In SQLite, index names are unique per database rather than per table, so we
+ * prefix them with the table name
+ */
+QString Interface::sqliteIndexName (const QString &table, const QString &name)
+{
+	return qnotr ("%1_%2").arg (table, name);
+}
+
+/**
+ * Determines the columns of an SQLite table, including the column
+ * constraints
+ */
+QList<ColumnSpec> Interface::sqliteColumns (const QString &table)
+{
+	QList<ColumnSpec> columns;
+
+	// Columns: cid, name, type, notnull, dflt_value, pk
+	QSharedPointer<Result> result=executeQueryResult (Query (notr ("PRAGMA table_info(%1)")).arg (table));
+
+	while (result->next ())
+	{
+		QString name=result->value (1).toString ();
+		QString type=result->value (2).toString ();
+
+		QStringList extra;
+		if (result->value (5).toBool ())
+		{
+			if (type.compare (notr ("integer"), Qt::CaseInsensitive)==0)
+				extra << notr ("auto_increment");
+			else
+				extra << notr ("NOT NULL PRIMARY KEY");
+		}
+		else
+		{
+			if (result->value (3).toBool ())
+				extra << notr ("NOT NULL");
+			if (!result->isNull (4))
+				extra << qnotr ("DEFAULT %1").arg (result->value (4).toString ());
+		}
+
+		columns.append (ColumnSpec (name, type, extra.join (notr (" "))));
+	}
+
+	return columns;
+}
+
+/**
+ * Changes, drops or adds a column of an SQLite table
+ *
+ * SQLite's ALTER TABLE can neither change nor drop columns, so we create a new
+ * table with the changed columns, copy the data, and replace the old table.
+ * The indexes and triggers are recreated, except for those containing a
+ * dropped column.
+ *
+ * The rebuild is performed in a transaction (SQLite supports transactional
+ * schema changes), so the table is not lost if it fails. Must not be called
+ * while a transaction is active.
+ *
+ * @param table the table to change
+ * @param column the name of the column to change or drop, or an empty string
+ *               to add newColumn (the rows get the default value)
+ * @param newColumn the new specification of the column, or NULL to drop it
+ */
+void Interface::sqliteRebuildTable (const QString &table, const QString &column, const ColumnSpec *newColumn)
+{
+	QList<IndexSpec> indexes=showIndexes (table);
+
+	// Triggers don't have a specification class, so we keep their SQL. The
+	// update trigger of the changed column is recreated from the new column.
+	QStringList triggers=listStrings (Query (notr (
+		"SELECT sql FROM sqlite_master WHERE type='trigger' AND tbl_name=? AND name<>?"))
+		.bind (table).bind (sqliteUpdateTriggerName (table, column)));
+
+	QList<ColumnSpec> newColumns;
+	QStringList oldNames, newNames;
+	foreach (const ColumnSpec &oldColumn, sqliteColumns (table))
+	{
+		if (oldColumn.getName ()!=column)
+		{
+			newColumns.append (oldColumn);
+			oldNames.append (oldColumn.getName ());
+			newNames.append (oldColumn.getName ());
+		}
+		else if (newColumn)
+		{
+			newColumns.append (*newColumn);
+			oldNames.append (oldColumn.getName ());
+			newNames.append (newColumn->getName ());
+		}
+	}
+
+	if (column.isEmpty () && newColumn)
+		newColumns.append (*newColumn);
+
+	QString newTable=qnotr ("%1_rebuild").arg (table);
+
+	transaction ();
+	try
+	{
+		executeQuery (Query (notr ("CREATE TABLE %1 (%2)"))
+			.arg (newTable, ColumnSpec::sqliteCreateClause (newColumns)));
+		executeQuery (Query (notr ("INSERT INTO %1 (%2) SELECT %3 FROM %4"))
+			.arg (newTable, newNames.join (notr (",")), oldNames.join (notr (",")), table));
+		// This also drops the indexes
+		executeQuery (Query (notr ("DROP TABLE %1")).arg (table));
+		executeQuery (Query (notr ("ALTER TABLE %1 RENAME TO %2")).arg (newTable, table));
+
+		foreach (const IndexSpec &index, indexes)
+		{
+			QStringList indexColumns=index.getColumns ().split (notr (","));
+			for (int i=0; i<indexColumns.size (); ++i)
+				indexColumns[i]=indexColumns[i].trimmed ();
+
+			if (indexColumns.contains (column))
+			{
+				if (!newColumn) continue;
+				indexColumns.replaceInStrings (QRegExp (qnotr ("^%1$").arg (column)), newColumn->getName ());
+			}
+
+			createIndex (IndexSpec (table, index.getName (), indexColumns.join (notr (","))));
+		}
+
+		foreach (const QString &trigger, triggers)
+			executeQuery (Query (trigger));
+
+		if (newColumn && newColumn->isAutoUpdated ())
+			sqliteCreateUpdateTrigger (table, newColumn->getName ());
+
+		commit ();
+	}
+	catch (...)
+	{
+		rollback ();
+		throw;
+	}
+}
+
+QString Interface::sqliteUpdateTriggerName (const QString &table, const QString &column)
+{
+	return qnotr ("%1_%2_on_update").arg (table, column);
+}
+
+/**
+ * Emulates "ON UPDATE CURRENT_TIMESTAMP" for a column of an SQLite table
+ *
+ * The trigger only sets the column if it has not been set explicitly by the
+ * update. Recursive triggers are disabled by default, so the trigger's own
+ * update does not invoke it again.
+ */
+void Interface::sqliteCreateUpdateTrigger (const QString &table, const QString &column)
+{
+	executeQuery (sqliteCreateUpdateTriggerQuery (table, column));
+}
+
+Query Interface::sqliteCreateUpdateTriggerQuery (const QString &table, const QString &column)
+{
+	return Query (notr (
+		"CREATE TRIGGER IF NOT EXISTS %1 AFTER UPDATE ON %2 FOR EACH ROW"
+		" WHEN NEW.%3 IS OLD.%3"
+		" BEGIN UPDATE %2 SET %3=CURRENT_TIMESTAMP WHERE rowid=NEW.rowid; END"))
+		.arg (sqliteUpdateTriggerName (table, column), table, column);
+}
+
+Query Interface::sqliteCreateIndexQuery (const IndexSpec &index, bool skipIfExists)
+{
+	return Query (notr ("CREATE INDEX %1 %2 ON %3 (%4)"))
+		.arg (skipIfExists?notr ("IF NOT EXISTS"):"")
+		.arg (sqliteIndexName (index.getTable (), index.getName ()), index.getTable (), index.getColumns ());
+}
+
+
 // **********
 // ** Misc **
 // **********
@@ -25,6 +25,10 @@ class IndexSpec;
  * For further information about the Interface class hierarchy see,
  * doc/interal/databaseArchitecture.txt
  *
+ * The schema manipulation methods support MySQL and SQLite (see #isSqlite).
+ * The data types are the same for both because SQLite accepts the MySQL type
+ * names.
+ *
  * Note: the methods of this class are used by the migrations. If any if the
  * methods are changed, the migrations have to be updated to retain their
  * original functionality.
@@ -36,6 +40,14 @@ class Interface: public AbstractInterface
 		Interface (const DatabaseInfo &dbInfo);
 		virtual ~Interface ();
 
+		// *** Dialect
+		bool isSqlite () const;
+
+		// *** Multi-statement queries (MySQL)
+		static Query multiStatementQuery (const QList<Query> &queries);
+		static void nextResultSet (Result &result, const Query &query, int statementCount);
+		void executeMultiStatement (const QList<Query> &queries);
+
 		// *** Data types
 		// Data type names like in Rails (use for sk_web) (for MySQL)
 		// Not implemented as static constants in order to avoid the static
@@ -61,9 +73,11 @@ class Interface: public AbstractInterface
 
 		// *** Schema manipulation
 		void createDatabase (const QString &name, bool skipIfExists=false);
+		void dropDatabase (const QString &name);
 		void createTable (const QString &name, bool skipIfExists=false);
 		void createTable (const QString &name, const QList<ColumnSpec> &columns, bool skipIfExists=false);
 		void createTable (const QString &name, const QList<ColumnSpec> &columns, const QList<IndexSpec> &indexes, bool skipIfExists=false);
+		QList<Query> createTableQueries (const QString &name, const QList<ColumnSpec> &columns, const QList<IndexSpec> &indexes, bool skipIfExists=false);
 		void createTableLike (const QString &like, const QString &name, bool skipIfExists=false);
 		void dropTable (const QString &name);
 		void renameTable (const QString &oldName, const QString &newName);
@@ -89,6 +103,16 @@ class Interface: public AbstractInterface
 
 		// *** Misc
 		QString mysqlPasswordHash (const QString &password);
+
+	private:
+		// *** SQLite
+		QString sqliteIndexName (const QString &table, const QString &name);
+		QList<ColumnSpec> sqliteColumns (const QString &table);
+		void sqliteRebuildTable (const QString &table, const QString &column, const ColumnSpec *newColumn);
+		QString sqliteUpdateTriggerName (const QString &table, const QString &column);
+		void sqliteCreateUpdateTrigger (const QString &table, const QString &column);
+		Query sqliteCreateIndexQuery (const IndexSpec &index, bool skipIfExists);
+		Query sqliteCreateUpdateTriggerQuery (const QString &table, const QString &column);
 };
 
 #endif
@@ -14,6 +14,7 @@
 #include "src/concurrent/Returner.h"
 #include "src/util/qString.h"
 #include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
 
 InterfaceWorker::InterfaceWorker (ThreadSafeInterface &interface):
 	interface (interface)
@@ -28,6 +29,7 @@ InterfaceWorker::InterfaceWorker (ThreadSafeInterface &interface):
 	CONNECT (executeQuery   (Returner<void> *, OperationMonitor *, Query));
 #undef CONNECT
 
+	thread.setObjectName (notr ("InterfaceWorker"));
 	moveToThread (&thread);
 	thread.start ();
 }
@@ -48,36 +50,43 @@ InterfaceWorker::~InterfaceWorker ()
 
 void InterfaceWorker::open (Returner<bool> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::open");
 	emit sig_open (&returner, &monitor);
 }
 
 void InterfaceWorker::transaction (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::transaction");
 	emit sig_transaction (&returner, &monitor);
 }
 
 void InterfaceWorker::commit (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::commit");
 	emit sig_commit (&returner, &monitor);
 }
 
 void InterfaceWorker::rollback (Returner<void> &returner, OperationMonitor &monitor)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::rollback");
 	emit sig_rollback (&returner, &monitor);
 }
 
 void InterfaceWorker::createDatabase (Returner<void> &returner, OperationMonitor &monitor, const QString &name, bool skipIfExists)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::createDatabase");
 	emit sig_createDatabase (&returner, &monitor, name, skipIfExists);
 }
 
 void InterfaceWorker::grantAll (Returner<void> &returner, OperationMonitor &monitor, const QString &database, const QString &username, const QString &password)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::grantAll");
 	emit sig_grantAll (&returner, &monitor, database, username, password);
 }
 
 void InterfaceWorker::executeQuery (Returner<void> &returner, OperationMonitor &monitor, const Query &query)
 {
+	TRACE_ENQUEUE (&returner, "InterfaceWorker::executeQuery");
 	emit sig_executeQuery (&returner, &monitor, query);
 }
 
@@ -88,6 +97,8 @@ void InterfaceWorker::executeQuery (Returner<void> &returner, OperationMonitor &
 
 void InterfaceWorker::slot_open (Returner<bool> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("InterfaceWorker::open");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	monitorInterface.status (tr ("Connecting to %1").arg (interface.getInfo ().serverText ()));
 	returnOrException (returner, interface.open ());
@@ -95,6 +106,8 @@ void InterfaceWorker::slot_open (Returner<bool> *returner, OperationMonitor *mon
 
 void InterfaceWorker::slot_transaction (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("InterfaceWorker::transaction");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	monitorInterface.status (tr ("Beginning transaction"));
 	returnVoidOrException (returner, interface.transaction ());
@@ -102,6 +115,8 @@ void InterfaceWorker::slot_transaction (Returner<void> *returner, OperationMonit
 
 void InterfaceWorker::slot_commit (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("InterfaceWorker::commit");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	monitorInterface.status (tr ("Committing transaction"));
 	returnVoidOrException (returner, interface.commit ());
@@ -109,6 +124,8 @@ void InterfaceWorker::slot_commit (Returner<void> *returner, OperationMonitor *m
 
 void InterfaceWorker::slot_rollback (Returner<void> *returner, OperationMonitor *monitor)
 {
+	TRACE_SPAN ("InterfaceWorker::rollback");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	monitorInterface.status (tr ("Rolling back transaction"));
 	returnVoidOrException (returner, interface.rollback ());
@@ -116,18 +133,24 @@ void InterfaceWorker::slot_rollback (Returner<void> *returner, OperationMonitor
 
 void InterfaceWorker::slot_createDatabase (Returner<void> *returner, OperationMonitor *monitor, QString name, bool skipIfExists)
 {
+	TRACE_SPAN ("InterfaceWorker::createDatabase");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	returnVoidOrException (returner, interface.createDatabase (name, skipIfExists));
 }
 
 void InterfaceWorker::slot_grantAll (Returner<void> *returner, OperationMonitor *monitor, QString database, QString username, QString password)
 {
+	TRACE_SPAN ("InterfaceWorker::grantAll");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	returnVoidOrException (returner, interface.grantAll (database, username, password));
 }
 
 void InterfaceWorker::slot_executeQuery (Returner<void> *returner, OperationMonitor *monitor, Query query)
 {
+	TRACE_SPAN ("InterfaceWorker::executeQuery");
+	TRACE_DEQUEUE (returner);
 	OperationMonitorInterface monitorInterface=monitor->interface ();
 	returnVoidOrException (returner, interface.executeQuery (query));
 }
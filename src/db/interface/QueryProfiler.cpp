@@ -0,0 +1,303 @@
+#include "QueryProfiler.h"
+
+#include <iostream>
+
+#include <QRegExp>
+#include <QPair>
+#include <QtAlgorithms>
+
+#include "src/concurrent/synchronized.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+// Statically allocated so it exists before any interface threads are started
+QueryProfiler QueryProfiler::theInstance;
+
+const int QueryProfiler::bucketLimits[numBuckets-1]={ 1, 10, 100, 1000, 10000 };
+
+// ******************
+// ** Construction **
+// ******************
+
+QueryProfiler::ShapeStatistics::ShapeStatistics ():
+	count (0), totalTime (0), maxTime (0), totalRows (0), totalBytes (0)
+{
+	for (int i=0; i<numBuckets; ++i)
+		histogram[i]=0;
+}
+
+QueryProfiler::QueryProfiler ():
+	slowQueryThreshold (1000), printSlowQueries (false), explainSlowQueries (false)
+{
+}
+
+QueryProfiler::~QueryProfiler ()
+{
+}
+
+QueryProfiler &QueryProfiler::instance ()
+{
+	return theInstance;
+}
+
+
+// ***************
+// ** Recording **
+// ***************
+
+/**
+ * Determines the shape of a statement by replacing string and numeric literals
+ * with placeholders and collapsing value lists, so that queries differing
+ * only in their values are grouped together.
+ */
+QString QueryProfiler::statementShape (const QString &queryString)
+{
+	QString shape=queryString.simplified ();
+
+	// String literals, including escaped quotes
+	shape.replace (QRegExp (notr ("'([^'\\\\]|\\\\.)*'")), notr ("?"));
+	shape.replace (QRegExp (notr ("\"([^\"\\\\]|\\\\.)*\"")), notr ("?"));
+
+	// Numeric literals (not part of an identifier)
+	shape.replace (QRegExp (notr ("\\b\\d+(\\.\\d+)?\\b")), notr ("?"));
+
+	// Value lists, e. g. "IN (?, ?, ?)"
+	shape.replace (QRegExp (notr ("\\(\\?(\\s*,\\s*\\?)*\\)")), notr ("(...)"));
+
+	return shape;
+}
+
+/**
+ * Records the execution of a query
+ *
+ * @param queryString the query string, used for determining the statement
+ *                    shape
+ * @param duration the wall time of the query, in milliseconds
+ * @param rows the number of rows returned or affected
+ * @param bytes the number of bytes received from the server
+ */
+void QueryProfiler::record (const QString &queryString, int duration, int rows, qint64 bytes)
+{
+	QString shape=statementShape (queryString);
+
+	int bucket=0;
+	while (bucket<numBuckets-1 && duration>=bucketLimits[bucket])
+		++bucket;
+
+	synchronized (mutex)
+	{
+		ShapeStatistics &stats=statistics[shape];
+		++stats.count;
+		stats.totalTime+=duration;
+		if (duration>stats.maxTime) stats.maxTime=duration;
+		if (rows>0) stats.totalRows+=rows;
+		stats.totalBytes+=bytes;
+		++stats.histogram[bucket];
+	}
+}
+
+bool QueryProfiler::isSlow (int duration) const
+{
+	synchronizedReturn (mutex, slowQueryThreshold>0 && duration>=slowQueryThreshold);
+}
+
+/**
+ * Adds a query to the slow query log
+ *
+ * If the statement shape of the query has already been explained, the
+ * explanation is added to the entry.
+ */
+void QueryProfiler::recordSlowQuery (const SlowQuery &slowQuery)
+{
+	synchronized (mutex)
+	{
+		SlowQuery entry=slowQuery;
+		if (entry.explain.isEmpty ())
+			entry.explain=explanations.value (entry.shape);
+
+		if (printSlowQueries)
+			std::cout << notr ("Slow query: ") << entry.toString () << std::endl;
+
+		slowQueries.append (entry);
+		while (slowQueries.size ()>maxSlowQueries)
+			slowQueries.removeFirst ();
+	}
+}
+
+/**
+ * Determines whether the caller should determine the EXPLAIN output for a
+ * slow query
+ *
+ * This is only the case if explaining is enabled (see
+ * #setExplainSlowQueries) and the statement shape has not been explained
+ * before. If true is returned, the caller must call #recordExplain for this
+ * shape.
+ */
+bool QueryProfiler::beginExplain (const QString &shape)
+{
+	synchronized (mutex)
+	{
+		if (!explainSlowQueries || explanations.contains (shape))
+			return false;
+
+		explanations.insert (shape, QString ());
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Records the EXPLAIN output for a statement shape and adds it to the
+ * entries of the slow query log with this shape
+ */
+void QueryProfiler::recordExplain (const QString &shape, const QString &explain)
+{
+	synchronized (mutex)
+	{
+		explanations.insert (shape, explain);
+
+		for (int i=0; i<slowQueries.size (); ++i)
+			if (slowQueries[i].shape==shape && slowQueries[i].explain.isEmpty ())
+				slowQueries[i].explain=explain;
+
+		if (printSlowQueries)
+			std::cout << notr ("Explain for ") << shape << notr (":\n") << explain << std::endl;
+	}
+}
+
+QString QueryProfiler::SlowQuery::toString () const
+{
+	QString result=qnotr ("[%1] %2 ms, %3 rows, %4 bytes: %5")
+		.arg (time.toString (notr ("yyyy-MM-dd hh:mm:ss")))
+		.arg (duration).arg (rows).arg (bytes).arg (query);
+
+	if (!explain.isEmpty ())
+		result+=notr ("\n")+explain;
+
+	return result;
+}
+
+
+// *******************
+// ** Configuration **
+// *******************
+
+/**
+ * Sets the minimum duration of a query to be written to the slow query log
+ *
+ * @param threshold the threshold in milliseconds; 0 disables the slow query
+ *                  log
+ */
+void QueryProfiler::setSlowQueryThreshold (int threshold)
+{
+	synchronized (mutex) slowQueryThreshold=threshold;
+}
+
+int QueryProfiler::getSlowQueryThreshold () const
+{
+	synchronizedReturn (mutex, slowQueryThreshold);
+}
+
+/**
+ * Sets whether slow queries are also written to standard output; they are
+ * always recorded in the slow query log
+ */
+void QueryProfiler::setPrintSlowQueries (bool print)
+{
+	synchronized (mutex) printSlowQueries=print;
+}
+
+/**
+ * Sets whether the output of EXPLAIN is added to the slow query log. EXPLAIN
+ * is an additional query, so this is disabled by default.
+ */
+void QueryProfiler::setExplainSlowQueries (bool explain)
+{
+	synchronized (mutex) explainSlowQueries=explain;
+}
+
+
+// ************
+// ** Access **
+// ************
+
+QHash<QString, QueryProfiler::ShapeStatistics> QueryProfiler::getStatistics () const
+{
+	synchronizedReturn (mutex, statistics);
+}
+
+QList<QueryProfiler::SlowQuery> QueryProfiler::getSlowQueries () const
+{
+	synchronizedReturn (mutex, slowQueries);
+}
+
+static bool totalTimeGreaterThan (const QPair<QString, QueryProfiler::ShapeStatistics> &a, const QPair<QString, QueryProfiler::ShapeStatistics> &b)
+{
+	return a.second.totalTime > b.second.totalTime;
+}
+
+/**
+ * Generates a plain text report of the statement shapes, ordered by total
+ * time, and the slow query log
+ */
+QString QueryProfiler::report () const
+{
+	QHash<QString, ShapeStatistics> statistics=getStatistics ();
+	QList<SlowQuery> slowQueries=getSlowQueries ();
+
+	QList<QPair<QString, ShapeStatistics> > shapes;
+	QHashIterator<QString, ShapeStatistics> it (statistics);
+	while (it.hasNext ())
+	{
+		it.next ();
+		shapes.append (qMakePair (it.key (), it.value ()));
+	}
+	qSort (shapes.begin (), shapes.end (), totalTimeGreaterThan);
+
+	QStringList lines;
+
+	QStringList bucketNames;
+	for (int i=0; i<numBuckets-1; ++i)
+		bucketNames.append (qnotr ("<%1").arg (bucketLimits[i]));
+	bucketNames.append (qnotr (">=%1").arg (bucketLimits[numBuckets-2]));
+
+	lines.append (qnotr ("Statement shapes by total time (histogram buckets in ms: %1)")
+		.arg (bucketNames.join (notr (" "))));
+
+	for (int i=0; i<shapes.size (); ++i)
+	{
+		const ShapeStatistics &stats=shapes.at (i).second;
+
+		QStringList histogram;
+		for (int bucket=0; bucket<numBuckets; ++bucket)
+			histogram.append (QString::number (stats.histogram[bucket]));
+
+		lines.append (qnotr ("%1x, total %2 ms, avg %3 ms, max %4 ms, %5 rows, %6 bytes, histogram %7: %8")
+			.arg (stats.count)
+			.arg (stats.totalTime)
+			.arg (stats.totalTime/stats.count)
+			.arg (stats.maxTime)
+			.arg (stats.totalRows)
+			.arg (stats.totalBytes)
+			.arg (histogram.join (notr ("/")))
+			.arg (shapes.at (i).first));
+	}
+
+	lines.append (QString ());
+	lines.append (qnotr ("Slow queries (threshold %1 ms)").arg (getSlowQueryThreshold ()));
+	foreach (const SlowQuery &slowQuery, slowQueries)
+		lines.append (slowQuery.toString ());
+
+	return lines.join (notr ("\n"));
+}
+
+void QueryProfiler::reset ()
+{
+	synchronized (mutex)
+	{
+		statistics.clear ();
+		slowQueries.clear ();
+		explanations.clear ();
+	}
+}
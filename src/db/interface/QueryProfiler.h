@@ -0,0 +1,113 @@
+/*
+ * QueryProfiler.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef QUERYPROFILER_H_
+#define QUERYPROFILER_H_
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QDateTime>
+
+/**
+ * Collects timing information about the queries executed by the
+ * DefaultInterface
+ *
+ * For each query, the wall time, the number of rows returned or affected and
+ * the number of bytes received from the server are recorded. The queries are
+ * grouped by statement shape (the query string with literal values replaced
+ * by placeholders), and a histogram of the execution times is kept for each
+ * shape.
+ *
+ * Queries taking longer than the slow query threshold are additionally
+ * written to the slow query log. If enabled, the output of EXPLAIN is added
+ * to the log. It is determined only once per statement shape, and by the
+ * caller because the profiler has no access to the database (see
+ * #beginExplain and #recordExplain).
+ *
+ * There is only one profiler for all interfaces, see #instance. This class is
+ * thread safe.
+ */
+class QueryProfiler
+{
+	public:
+		// The upper bounds of the histogram buckets, in milliseconds. The last
+		// bucket has no upper bound.
+		static const int numBuckets=6;
+		static const int bucketLimits[numBuckets-1];
+
+		/** The statistics for one statement shape */
+		class ShapeStatistics
+		{
+			public:
+				ShapeStatistics ();
+
+				int count;
+				qint64 totalTime; // ms
+				int maxTime; // ms
+				qint64 totalRows;
+				qint64 totalBytes;
+				int histogram[numBuckets];
+		};
+
+		/** An entry in the slow query log */
+		class SlowQuery
+		{
+			public:
+				QDateTime time;
+				QString query;
+				QString shape;
+				int duration; // ms
+				int rows;
+				qint64 bytes;
+				QString explain;
+
+				QString toString () const;
+		};
+
+		static QueryProfiler &instance ();
+		virtual ~QueryProfiler ();
+
+		static QString statementShape (const QString &queryString);
+
+		// *** Recording
+		void record (const QString &queryString, int duration, int rows, qint64 bytes);
+		bool isSlow (int duration) const;
+		void recordSlowQuery (const SlowQuery &slowQuery);
+		bool beginExplain (const QString &shape);
+		void recordExplain (const QString &shape, const QString &explain);
+
+		// *** Configuration
+		void setSlowQueryThreshold (int threshold);
+		int getSlowQueryThreshold () const;
+		void setPrintSlowQueries (bool print);
+		void setExplainSlowQueries (bool explain);
+
+		// *** Access
+		QHash<QString, ShapeStatistics> getStatistics () const;
+		QList<SlowQuery> getSlowQueries () const;
+		QString report () const;
+		void reset ();
+
+	private:
+		QueryProfiler ();
+		static QueryProfiler theInstance;
+
+		mutable QMutex mutex;
+
+		int slowQueryThreshold; // ms
+		bool printSlowQueries;
+		bool explainSlowQueries;
+		QHash<QString, ShapeStatistics> statistics;
+		// The EXPLAIN output by statement shape; null while it is determined
+		QHash<QString, QString> explanations;
+		QList<SlowQuery> slowQueries; // Most recent last
+		static const int maxSlowQueries=50;
+};
+
+#endif
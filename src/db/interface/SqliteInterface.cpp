@@ -0,0 +1,292 @@
+/*
+ * Improvements:
+ *   - Transactions don't emit an executingQuery signal (like DefaultInterface)
+ *   - Canceling is not supported. This is not a problem as long as the
+ *     database is on a local disk.
+ */
+#include "SqliteInterface.h"
+
+#include <iostream>
+
+#include <QVariant>
+#include <QTime>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include "src/util/qString.h"
+#include "src/db/result/DefaultResult.h"
+#include "src/text.h"
+#include "src/db/interface/exceptions/QueryFailedException.h"
+#include "src/db/interface/exceptions/ConnectionFailedException.h"
+#include "src/db/interface/exceptions/TransactionFailedException.h"
+#include "src/db/interface/QueryProfiler.h"
+#include "src/config/Settings.h"
+#include "src/i18n/notr.h"
+
+QAtomicInt SqliteInterface::freeNumber=0;
+
+// ******************
+// ** Construction **
+// ******************
+
+SqliteInterface::SqliteInterface (const DatabaseInfo &dbInfo):
+	Interface (dbInfo),
+	displayQueries (Settings::instance ().displayQueries)
+{
+	QString name=qnotr ("startkladde_sqliteInterface_%1").arg (getFreeNumber ());
+	db=QSqlDatabase::addDatabase (notr ("QSQLITE"), name);
+
+	QueryProfiler::instance ().setSlowQueryThreshold (Settings::instance ().slowQueryThreshold);
+	QueryProfiler::instance ().setPrintSlowQueries (Settings::instance ().printSlowQueries);
+}
+
+SqliteInterface::~SqliteInterface ()
+{
+	if (db.isOpen ()) db.close ();
+
+	QString name=db.connectionName ();
+
+	// Make sure the QSqlDatabase instance is destroyed before removing it
+	db=QSqlDatabase ();
+	QSqlDatabase::removeDatabase (name);
+}
+
+
+// *******************************
+// ** AbstractInterface methods **
+// *******************************
+
+/**
+ * Opens the database file, creating it if it does not exist
+ *
+ * @return true on success
+ * @throw ConnectionFailedException if the file cannot be opened
+ */
+bool SqliteInterface::open ()
+{
+	QString fileName=getInfo ().sqliteFileName ();
+
+	// SQLite creates the file, but not the directory
+	QDir ().mkpath (QFileInfo (fileName).absolutePath ());
+
+	db.setDatabaseName (fileName);
+
+	// Wait for a lock held by another process (e. g. a second instance of
+	// the program) instead of failing immediately
+	db.setConnectOptions (notr ("QSQLITE_BUSY_TIMEOUT=5000"));
+
+	openImpl ();
+
+	return true;
+}
+
+void SqliteInterface::openImpl ()
+{
+	std::cout << qnotr ("%1 opening %2...")
+		.arg (db.connectionName (), db.databaseName ()) << std::flush;
+
+	if (!db.open ())
+	{
+		QSqlError error=db.lastError ();
+		std::cout << error.databaseText () << std::endl;
+		emit databaseError (error.number (), error.databaseText ());
+		throw ConnectionFailedException (error);
+	}
+
+	std::cout << notr ("OK") << std::endl;
+
+	// With a write-ahead log, a commit only appends to the log instead of
+	// rewriting the database pages, and readers don't block the writer. With
+	// synchronous=NORMAL, the log is only synced at checkpoints, which is
+	// still safe against corruption (but a power loss may lose the last
+	// transactions).
+	executePragma (notr ("journal_mode=WAL"));
+	executePragma (notr ("synchronous=NORMAL"));
+}
+
+/**
+ * Executes a PRAGMA statement. Pragmas are not profiled and not logged.
+ */
+void SqliteInterface::executePragma (const QString &pragma)
+{
+	Query query (qnotr ("PRAGMA %1").arg (pragma));
+
+	QSqlQuery sqlQuery (db);
+	if (!sqlQuery.exec (query.toString ()))
+		throw QueryFailedException::execute (sqlQuery.lastError (), query);
+}
+
+void SqliteInterface::close ()
+{
+	std::cout << notr ("Closing database ") << getInfo ().toString () << std::endl;
+
+	db.close ();
+}
+
+QSqlError SqliteInterface::lastError () const
+{
+	return db.lastError ();
+}
+
+/**
+ * Does nothing: the database is on a local disk, so there are no operations
+ * waiting for a network connection.
+ */
+void SqliteInterface::cancelConnection ()
+{
+}
+
+void SqliteInterface::transaction ()
+{
+	transactionStatementImpl (transactionBegin);
+}
+
+void SqliteInterface::commit ()
+{
+	transactionStatementImpl (transactionCommit);
+}
+
+void SqliteInterface::rollback ()
+{
+	transactionStatementImpl (transactionRollback);
+}
+
+void SqliteInterface::transactionStatementImpl (AbstractInterface::TransactionStatement statement)
+{
+	if (!db.isOpen ()) openImpl ();
+
+	if (displayQueries) std::cout << transactionStatementString (statement) << notr ("...") << std::flush;
+
+	bool result=false;
+	switch (statement)
+	{
+		case transactionBegin   : result=db.transaction (); break;
+		case transactionCommit  : result=db.commit      (); break;
+		case transactionRollback: result=db.rollback    (); break;
+		// no default
+	}
+
+	if (result)
+	{
+		if (displayQueries) std::cout << notr ("OK") << std::endl;
+	}
+	else
+	{
+		QSqlError error=db.lastError ();
+		if (displayQueries) std::cout << error.databaseText () << std::endl;
+		emit databaseError (error.number (), error.databaseText ());
+
+		throw TransactionFailedException (error, statement);
+	}
+}
+
+/**
+ * Executes a query
+ *
+ * @throw QueryFailedException if the query fails
+ */
+void SqliteInterface::executeQuery (const Query &query)
+{
+	executeQueryImpl (query);
+}
+
+/**
+ * Executes a query and returns the result
+ *
+ * @return a QSharedPointer to a DefaultResult encapsulating the QSqlQuery
+ * @throw QueryFailedException if the query fails
+ */
+QSharedPointer<Result> SqliteInterface::executeQueryResult (const Query &query, bool forwardOnly)
+{
+	QSqlQuery sqlQuery=executeQueryImpl (query, forwardOnly);
+
+	return QSharedPointer<Result> (
+		new DefaultResult (sqlQuery));
+}
+
+/**
+ * Executes a query and returns whether the query had a result (i. e. the
+ * result set is not empty)
+ *
+ * The SQLite driver cannot determine the size of a result, so we have to try
+ * to retrieve the first row.
+ */
+bool SqliteInterface::queryHasResult (const Query &query)
+{
+	return executeQueryImpl (query, true).next ();
+}
+
+QSqlQuery SqliteInterface::executeQueryImpl (const Query &query, bool forwardOnly)
+{
+	if (!db.isOpen ()) openImpl ();
+
+	if (displayQueries)
+		std::cout << query.colorizedString () << notr ("...") << std::flush;
+
+	QTime timer;
+	timer.start ();
+
+	QSqlQuery sqlQuery (db);
+	sqlQuery.setForwardOnly (forwardOnly);
+
+	emit executingQuery (query);
+
+	if (!query.prepare (sqlQuery))
+	{
+		QSqlError error=sqlQuery.lastError ();
+		if (displayQueries) std::cout << error.databaseText () << std::endl;
+		emit databaseError (error.number (), error.databaseText ());
+
+		throw QueryFailedException::prepare (error, query);
+	}
+
+	query.bindTo (sqlQuery);
+
+	if (!query.exec (sqlQuery))
+	{
+		QSqlError error=sqlQuery.lastError ();
+		if (displayQueries) std::cout << error.databaseText () << std::endl;
+		emit databaseError (error.number (), error.databaseText ());
+
+		throw QueryFailedException::execute (error, query);
+	}
+
+	// The number of rows returned is not known for a SELECT query
+	int rows=sqlQuery.isSelect ()?-1:sqlQuery.numRowsAffected ();
+	if (displayQueries)
+	{
+		if (sqlQuery.isSelect ())
+			std::cout << notr ("OK") << std::endl;
+		else
+			std::cout << countText (rows,
+				notr ("1 row affected"),
+				notr ("%1 rows affected")) << std::endl;
+	}
+
+	// No bytes are transferred over the network
+	int duration=timer.elapsed ();
+	QueryProfiler &profiler=QueryProfiler::instance ();
+	profiler.record (query.getQueryString (), duration, rows, 0);
+	if (profiler.isSlow (duration))
+	{
+		QueryProfiler::SlowQuery slowQuery;
+		slowQuery.time=QDateTime::currentDateTime ();
+		slowQuery.query=query.toString ();
+		slowQuery.duration=duration;
+		slowQuery.rows=rows;
+		slowQuery.bytes=0;
+		profiler.recordSlowQuery (slowQuery);
+	}
+
+	return sqlQuery;
+}
+
+/**
+ * Only makes sure that the database is open, there is no connection to keep
+ * alive.
+ */
+void SqliteInterface::ping ()
+{
+	if (!db.isOpen ()) openImpl ();
+}
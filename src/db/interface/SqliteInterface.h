@@ -0,0 +1,86 @@
+/*
+ * SqliteInterface.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SQLITEINTERFACE_H_
+#define SQLITEINTERFACE_H_
+
+#include <QObject>
+#include <QString>
+#include <QSqlError>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QAtomicInt>
+
+#include "src/db/interface/Interface.h"
+#include "src/db/DatabaseInfo.h"
+#include "src/db/Query.h"
+
+/**
+ * An Interface implementation using an embedded SQLite database
+ *
+ * This is intended for single station installations where the database is
+ * only accessed by one computer. There is no network connection, so queries
+ * are much faster than with a MySQL server, and the program can be used
+ * without a server.
+ *
+ * The database is opened in WAL (write-ahead logging) mode, which allows
+ * reading while writing and is faster than the default rollback journal for
+ * the many small transactions written by the program.
+ *
+ * The differences between the SQL dialects are handled by Interface (see
+ * Interface#isSqlite); this class only handles the connection and query
+ * execution.
+ *
+ * Like DefaultInterface, this class may only be used on the thread where it
+ * was created (Qt restriction). For a thread safe Interface, see
+ * ThreadSafeInterface.
+ */
+class SqliteInterface: public QObject, public Interface
+{
+	Q_OBJECT
+
+	public:
+		// *** Construction
+		SqliteInterface (const DatabaseInfo &dbInfo);
+		virtual ~SqliteInterface ();
+
+		// *** AbstractInterface methods
+		virtual bool open ();
+		virtual void close ();
+		virtual QSqlError lastError () const;
+		virtual void cancelConnection ();
+		virtual void transaction ();
+		virtual void commit ();
+		virtual void rollback ();
+		virtual void executeQuery (const Query &query);
+		virtual QSharedPointer<Result> executeQueryResult (const Query &query, bool forwardOnly=true);
+		virtual bool queryHasResult (const Query &query);
+		virtual void ping ();
+
+	signals:
+		// Same signals as DefaultInterface. readTimeout and readResumed are
+		// never emitted.
+		void executingQuery (Query query);
+		void databaseError (int number, QString message);
+
+		void readTimeout ();
+		void readResumed ();
+
+	private:
+		QSqlDatabase db;
+		bool displayQueries;
+
+		static QAtomicInt freeNumber;
+		static int getFreeNumber () { return freeNumber.fetchAndAddOrdered (1); }
+
+		virtual void openImpl ();
+		virtual void executePragma (const QString &pragma);
+
+		virtual QSqlQuery executeQueryImpl (const Query &query, bool forwardOnly=true);
+		virtual void transactionStatementImpl (TransactionStatement statement);
+};
+
+#endif
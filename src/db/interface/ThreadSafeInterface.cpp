@@ -14,10 +14,13 @@
 #include "src/db/result/Result.h"
 #include "src/concurrent/Returner.h"
 #include "src/db/interface/DefaultInterface.h"
+#include "src/db/interface/SqliteInterface.h"
 #include "src/db/result/CopiedResult.h"
 #include "src/concurrent/monitor/OperationCanceledException.h"
 #include "src/db/interface/exceptions/PingFailedException.h"
+#include "src/net/LinkHealth.h"
 #include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
 
 // ******************
 // ** Construction **
@@ -58,6 +61,7 @@ ThreadSafeInterface::ThreadSafeInterface (const DatabaseInfo &info, int readTime
 	keepaliveTimer.moveToThread (&thread);
 	connect (&keepaliveTimer, SIGNAL (timeout ()), this, SLOT (keepaliveTimer_timeout ()));
 
+	thread.setObjectName (notr ("ThreadSafeInterface"));
 	moveToThread (&thread);
 	thread.start ();
 }
@@ -66,16 +70,28 @@ void ThreadSafeInterface::slot_createInterface ()
 {
 	// Note that the interface is created on the background thread
 
-	// For connecting the signals, we need to know that it's a
-	// DefaultInterface. Afterwards, we assign it to the
+	// For connecting the signals, we need the QObject. Both implementations
+	// have the same signals. Afterwards, we assign it to the
 	// AbstractInterface *interface. TODO shouldn't the signal be declared
 	// in AbstractInterface?
-	DefaultInterface *defaultInterface=new DefaultInterface (getInfo (), readTimeoutSeconds);
-	connect (defaultInterface, SIGNAL (databaseError (int, QString)), this, SIGNAL (databaseError (int, QString)));
-	connect (defaultInterface, SIGNAL (executingQuery (Query)), this, SIGNAL (executingQuery (Query)));
-	connect (defaultInterface, SIGNAL (readTimeout ()), this, SIGNAL (readTimeout ()), Qt::DirectConnection);
-	connect (defaultInterface, SIGNAL (readResumed ()), this, SIGNAL (readResumed ()), Qt::DirectConnection);
-	interface=defaultInterface;
+	QObject *object;
+	if (getInfo ().type==DatabaseInfo::typeSqlite)
+	{
+		SqliteInterface *sqliteInterface=new SqliteInterface (getInfo ());
+		object=sqliteInterface;
+		interface=sqliteInterface;
+	}
+	else
+	{
+		DefaultInterface *defaultInterface=new DefaultInterface (getInfo (), readTimeoutSeconds);
+		object=defaultInterface;
+		interface=defaultInterface;
+	}
+
+	connect (object, SIGNAL (databaseError (int, QString)), this, SIGNAL (databaseError (int, QString)));
+	connect (object, SIGNAL (executingQuery (Query)), this, SIGNAL (executingQuery (Query)));
+	connect (object, SIGNAL (readTimeout ()), this, SIGNAL (readTimeout ()), Qt::DirectConnection);
+	connect (object, SIGNAL (readResumed ()), this, SIGNAL (readResumed ()), Qt::DirectConnection);
 }
 
 ThreadSafeInterface::~ThreadSafeInterface ()
@@ -96,7 +112,9 @@ ThreadSafeInterface::~ThreadSafeInterface ()
 
 void ThreadSafeInterface::setInfo (const DatabaseInfo &info)
 {
+	TRACE_SPAN ("ThreadSafeInterface::setInfo");
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::setInfo");
 	emit sig_setInfo (&returner, info);
 	returner.wait ();
 
@@ -105,75 +123,96 @@ void ThreadSafeInterface::setInfo (const DatabaseInfo &info)
 
 bool ThreadSafeInterface::open ()
 {
+	TRACE_SPAN ("ThreadSafeInterface::open");
 	Returner<bool> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::open");
 	emit sig_open (&returner);
 	return returner.returnedValue ();
 }
 
 void ThreadSafeInterface::close ()
 {
+	TRACE_SPAN ("ThreadSafeInterface::close");
+
 	// Hack: The thread may currently be blocked in a non-responding keepalive,
 	// so the event won't be delivered. TODO: keepalive should be a
 	// functionality of DefaultInterface (?), and remove this.
 	cancelConnection ();
 
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::close");
 	emit sig_close (&returner);
 	returner.wait ();
 }
 
 QSqlError ThreadSafeInterface::lastError () const
 {
+	TRACE_SPAN ("ThreadSafeInterface::lastError");
 	Returner<QSqlError> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::lastError");
 	emit sig_lastError (&returner);
 	return returner.returnedValue ();
 }
 
 void ThreadSafeInterface::transaction ()
 {
+	TRACE_SPAN ("ThreadSafeInterface::transaction");
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::transaction");
 	emit sig_transaction (&returner);
 	returner.wait ();
 }
 
 void ThreadSafeInterface::commit ()
 {
+	TRACE_SPAN ("ThreadSafeInterface::commit");
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::commit");
 	emit sig_commit (&returner);
 	returner.wait ();
 }
 
 void ThreadSafeInterface::rollback ()
 {
+	TRACE_SPAN ("ThreadSafeInterface::rollback");
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::rollback");
 	emit sig_rollback (&returner);
 	returner.wait ();
 }
 
 void ThreadSafeInterface::executeQuery (const Query &query)
 {
+	TRACE_SPAN ("ThreadSafeInterface::executeQuery");
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::executeQuery");
 	emit sig_executeQuery (&returner, query);
 	returner.wait ();
 }
 
 QSharedPointer<Result> ThreadSafeInterface::executeQueryResult (const Query &query, bool forwardOnly)
 {
+	TRACE_SPAN ("ThreadSafeInterface::executeQueryResult");
 	Returner<QSharedPointer<Result> > returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::executeQueryResult");
 	emit sig_executeQueryResult (&returner, query, forwardOnly);
 	return returner.returnedValue ();
 }
 
 bool ThreadSafeInterface::queryHasResult (const Query &query)
 {
+	TRACE_SPAN ("ThreadSafeInterface::queryHasResult");
 	Returner<bool> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::queryHasResult");
 	emit sig_queryHasResult (&returner, query);
 	return returner.returnedValue ();
 }
 
 void ThreadSafeInterface::ping ()
 {
+	TRACE_SPAN ("ThreadSafeInterface::ping");
 	Returner<void> returner;
+	TRACE_ENQUEUE (&returner, "ThreadSafeInterface::ping");
 	emit sig_ping (&returner);
 	returner.wait ();
 }
@@ -185,48 +224,76 @@ void ThreadSafeInterface::ping ()
 
 void ThreadSafeInterface::slot_setInfo (Returner<void> *returner, DatabaseInfo info)
 {
+	TRACE_SPAN ("ThreadSafeInterface::setInfo");
+	TRACE_DEQUEUE (returner);
+
+	// If the database type changes, we need a different implementation
+	if (info.type!=interface->getInfo ().type)
+	{
+		delete interface;
+		AbstractInterface::setInfo (info);
+		slot_createInterface ();
+	}
+
 	dontReturnVoidOrException (returner, interface->setInfo (info));
 }
 
 void ThreadSafeInterface::slot_open (Returner<bool> *returner)
 {
+	TRACE_SPAN ("ThreadSafeInterface::open");
+	TRACE_DEQUEUE (returner);
 	dontReturnOrException (returner, interface->open ());
 	isOpen=true;
 }
 
 void ThreadSafeInterface::slot_close (Returner<void> *returner)
 {
+	TRACE_SPAN ("ThreadSafeInterface::close");
+	TRACE_DEQUEUE (returner);
 	isOpen=false;
 	dontReturnVoidOrException (returner, interface->close ());
 }
 
 void ThreadSafeInterface::slot_lastError (Returner<QSqlError> *returner) const
 {
+	TRACE_SPAN ("ThreadSafeInterface::lastError");
+	TRACE_DEQUEUE (returner);
 	dontReturnOrException (returner, interface->lastError ());
 }
 
 void ThreadSafeInterface::slot_transaction (Returner<void> *returner)
 {
+	TRACE_SPAN ("ThreadSafeInterface::transaction");
+	TRACE_DEQUEUE (returner);
 	dontReturnVoidOrException (returner, interface->transaction ());
 }
 
 void ThreadSafeInterface::slot_commit (Returner<void> *returner)
 {
+	TRACE_SPAN ("ThreadSafeInterface::commit");
+	TRACE_DEQUEUE (returner);
 	dontReturnVoidOrException (returner, interface->commit ());
 }
 
 void ThreadSafeInterface::slot_rollback (Returner<void> *returner)
 {
+	TRACE_SPAN ("ThreadSafeInterface::rollback");
+	TRACE_DEQUEUE (returner);
 	dontReturnVoidOrException (returner, interface->rollback ());
 }
 
 void ThreadSafeInterface::slot_executeQuery (Returner<void> *returner, Query query)
 {
+	TRACE_SPAN ("ThreadSafeInterface::executeQuery");
+	TRACE_DEQUEUE (returner);
 	dontReturnVoidOrException (returner, interface->executeQuery (query));
 }
 
 void ThreadSafeInterface::slot_executeQueryResult (Returner<QSharedPointer<Result> > *returner, Query query, bool forwardOnly)
 {
+	TRACE_SPAN ("ThreadSafeInterface::executeQueryResult");
+	TRACE_DEQUEUE (returner);
+
 	// Option 1: copy the DefaultResult (is it allowed to access the
 	// QSqlQuery from the other thread? It seems to work.)
 //		dontReturnOrException (returner, interface->executeQueryResult (query, forwardOnly));
@@ -243,11 +310,15 @@ void ThreadSafeInterface::slot_executeQueryResult (Returner<QSharedPointer<Resul
 
 void ThreadSafeInterface::slot_queryHasResult (Returner<bool> *returner, Query query)
 {
+	TRACE_SPAN ("ThreadSafeInterface::queryHasResult");
+	TRACE_DEQUEUE (returner);
 	dontReturnOrException (returner, interface->queryHasResult (query));
 }
 
 void ThreadSafeInterface::slot_ping (Returner<void> *returner)
 {
+	TRACE_SPAN ("ThreadSafeInterface::ping");
+	TRACE_DEQUEUE (returner);
 	dontReturnVoidOrException (returner, interface->ping ());
 }
 
@@ -287,10 +358,15 @@ void ThreadSafeInterface::keepaliveTimer_timeout ()
 	keepalive ();
 }
 
+/**
+ * Starts the keepalive timer. The keepalive interval is adapted to the link
+ * (see LinkHealth#pingInterval); the configured interval is used until enough
+ * round trip times have been measured.
+ */
 void ThreadSafeInterface::startKeepaliveTimer ()
 {
 	if (isOpen && keepaliveEnabled && keepaliveInterval>0)
-		keepaliveTimer.start (keepaliveInterval);
+		keepaliveTimer.start (LinkHealth::instance ().pingInterval (keepaliveInterval));
 }
 
 void ThreadSafeInterface::stopKeepaliveTimer ()
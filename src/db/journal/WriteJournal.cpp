@@ -0,0 +1,678 @@
+/*
+ * Notes:
+ *   - The journal is replayed by DbManager when connecting (which happens
+ *     when the program starts, so a journal left over from a previous run is
+ *     written then) and when the connection resumes.
+ *   - Writes which are in progress when the connection is lost are
+ *     journaled by DbManager. Creates are identified by their creation key,
+ *     so they are not performed twice. A creation key is only kept by the
+ *     database for Database::deletionsRetention.
+ */
+#include "WriteJournal.h"
+
+#include <iostream>
+
+#include <QCryptographicHash>
+#include <QVariant>
+
+#include "src/model/Person.h"
+#include "src/model/Plane.h"
+#include "src/model/Flight.h"
+#include "src/model/LaunchMethod.h"
+#include "src/db/Query.h"
+#include "src/db/result/Result.h"
+#include "src/db/migration/Migrator.h"
+#include "src/db/schema/spec/ColumnSpec.h"
+#include "src/concurrent/synchronized.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+// ***************
+// ** Constants **
+// ***************
+
+const QString WriteJournal::entriesTableName=notr ("journal_entries");
+const QString WriteJournal::idsTableName    =notr ("journal_ids");
+
+
+// ******************
+// ** Construction **
+// ******************
+
+/**
+ * Creates a journal stored in the SQLite database specified by info. The
+ * journal has to be opened (see #open) before it can be used.
+ */
+WriteJournal::WriteJournal (const DatabaseInfo &info):
+	interface (info), journalDb (interface),
+	isOpen (false), numEntries (0), nextTemporaryId (firstTemporaryId),
+	replaying (false)
+{
+}
+
+WriteJournal::~WriteJournal ()
+{
+}
+
+bool WriteJournal::isTemporaryId (dbId id)
+{
+	return id>=firstTemporaryId;
+}
+
+/**
+ * Opens the journal database, creating the schema if necessary, and reads
+ * the state of the journal
+ *
+ * The journal database contains the regular tables (with the objects as
+ * they have been changed locally) and two additional tables: the journal
+ * entries and the IDs assigned to objects created from the journal.
+ */
+void WriteJournal::open ()
+{
+	synchronized (mutex)
+	{
+		if (isOpen) return;
+
+		interface.open ();
+
+		Migrator migrator (interface);
+		if (!interface.tableExists (entriesTableName))
+		{
+			migrator.loadSchema ();
+
+			QList<ColumnSpec> entryColumns;
+			entryColumns << interface.idColumn ();
+			entryColumns << ColumnSpec (notr ("operation" ), Interface::dataTypeString  ());
+			entryColumns << ColumnSpec (notr ("table_name"), Interface::dataTypeString  ());
+			entryColumns << ColumnSpec (notr ("object_id" ), Interface::dataTypeId      ());
+			entryColumns << ColumnSpec (notr ("base_hash" ), Interface::dataTypeString  ());
+			entryColumns << ColumnSpec (notr ("creation_key"), Interface::dataTypeString ());
+			interface.createTable (entriesTableName, entryColumns, true);
+
+			QList<ColumnSpec> idColumns;
+			idColumns << ColumnSpec (notr ("temporary_id"), Interface::dataTypeId (), notr ("NOT NULL PRIMARY KEY"));
+			idColumns << ColumnSpec (notr ("id"          ), Interface::dataTypeId ());
+			interface.createTable (idsTableName, idColumns, true);
+		}
+		else
+		{
+			if (!migrator.isCurrent ())
+			{
+				// The journal was written by an older version
+				std::cout << notr ("Migrating the write journal") << std::endl;
+				migrator.migrate ();
+			}
+
+			// Entries written by an older version have no creation key
+			if (!interface.columnExists (entriesTableName, notr ("creation_key")))
+				interface.addColumn (entriesTableName, notr ("creation_key"), Interface::dataTypeString ());
+		}
+
+		numEntries=interface.countQuery (Query::count (entriesTableName));
+
+		// Continue after the largest temporary ID in use. The IDs of objects
+		// which have already been written are kept because the GUI may still
+		// refer to an object by its temporary ID.
+		QSharedPointer<Result> result=interface.executeQueryResult (
+			Query (notr ("SELECT MAX(object_id) FROM %1")).arg (entriesTableName));
+		if (result->next () && !result->isNull (0))
+			nextTemporaryId=qMax ((dbId)result->value (0).toLongLong ()+1, nextTemporaryId);
+
+		result=interface.executeQueryResult (
+			Query (notr ("SELECT MAX(temporary_id) FROM %1")).arg (idsTableName));
+		if (result->next () && !result->isNull (0))
+			nextTemporaryId=qMax ((dbId)result->value (0).toLongLong ()+1, nextTemporaryId);
+
+		if (numEntries>0)
+			std::cout << qnotr ("Write journal contains %1 pending operations").arg (numEntries) << std::endl;
+
+		isOpen=true;
+	}
+}
+
+bool WriteJournal::isEmpty ()
+{
+	return size ()==0;
+}
+
+int WriteJournal::size ()
+{
+	synchronizedReturn (mutex, numEntries);
+}
+
+
+// *************
+// ** Helpers **
+// *************
+
+QString WriteJournal::operationToDb (Operation operation)
+{
+	switch (operation)
+	{
+		case operationCreate: return notr ("create");
+		case operationUpdate: return notr ("update");
+		case operationDelete: return notr ("delete");
+		// no default
+	}
+
+	return notr ("?");
+}
+
+WriteJournal::Operation WriteJournal::operationFromDb (const QString &operation)
+{
+	if      (operation==notr ("create")) return operationCreate;
+	else if (operation==notr ("delete")) return operationDelete;
+	else                                 return operationUpdate;
+}
+
+/**
+ * Calculates a hash of the values of an object, for determining whether an
+ * object has been changed in the database
+ */
+template<class T> QString WriteJournal::hash (const T &object)
+{
+	Query query;
+	object.bindValues (query);
+
+	QStringList values;
+	foreach (const QVariant &value, query.getBindValues ())
+		values.append (value.toString ());
+
+	QByteArray data=values.join (QString (QChar (0x1F))).toUtf8 ();
+	return QString (QCryptographicHash::hash (data, QCryptographicHash::Md5).toHex ());
+}
+
+
+// *************
+// ** Entries **
+// *************
+
+// Note that the entries are accessed by the methods below with the mutex
+// locked (by the caller)
+
+QList<WriteJournal::Entry> WriteJournal::readEntries ()
+{
+	QList<Entry> entries;
+
+	QSharedPointer<Result> result=interface.executeQueryResult (
+		Query (notr ("SELECT id,operation,table_name,object_id,base_hash,creation_key FROM %1 ORDER BY id"))
+		.arg (entriesTableName));
+
+	while (result->next ())
+	{
+		Entry entry;
+		entry.sequence   =result->value (0).toLongLong ();
+		entry.operation  =operationFromDb (result->value (1).toString ());
+		entry.table      =result->value (2).toString ();
+		entry.objectId   =result->value (3).toLongLong ();
+		entry.baseHash   =result->value (4).toString ();
+		entry.creationKey=result->value (5).toString ();
+		entries.append (entry);
+	}
+
+	return entries;
+}
+
+bool WriteJournal::readEntry (dbId sequence, Entry *entry)
+{
+	QSharedPointer<Result> result=interface.executeQueryResult (
+		Query (notr ("SELECT operation,table_name,object_id,base_hash,creation_key FROM %1 WHERE id=?"))
+		.arg (entriesTableName).bind (sequence));
+
+	if (!result->next ()) return false;
+
+	entry->sequence   =sequence;
+	entry->operation  =operationFromDb (result->value (0).toString ());
+	entry->table      =result->value (1).toString ();
+	entry->objectId   =result->value (2).toLongLong ();
+	entry->baseHash   =result->value (3).toString ();
+	entry->creationKey=result->value (4).toString ();
+	return true;
+}
+
+/**
+ * Determines whether the creation of the specified object is currently being
+ * written by #replay. Further operations on the object cannot have a base
+ * version from the database.
+ */
+bool WriteJournal::isReplayingCreate (const QString &table, dbId objectId)
+{
+	return replaying
+		&& replayingEntry.operation==operationCreate
+		&& replayingEntry.table==table
+		&& replayingEntry.objectId==objectId;
+}
+
+/**
+ * Finds the entry for an object
+ *
+ * The entry currently being written by #replay is not considered because it
+ * will be removed after it has been written. Operations on the object are
+ * recorded in a new entry instead.
+ */
+bool WriteJournal::findEntry (const QString &table, dbId objectId, Entry *entry)
+{
+	dbId replayingSequence=replaying?replayingEntry.sequence:invalidId;
+
+	QSharedPointer<Result> result=interface.executeQueryResult (
+		Query (notr ("SELECT id,operation,base_hash,creation_key FROM %1 WHERE table_name=? AND object_id=? AND id<>?"))
+		.arg (entriesTableName).bind (table).bind (objectId).bind (replayingSequence));
+
+	if (!result->next ()) return false;
+
+	entry->sequence   =result->value (0).toLongLong ();
+	entry->operation  =operationFromDb (result->value (1).toString ());
+	entry->table      =table;
+	entry->objectId   =objectId;
+	entry->baseHash   =result->value (2).toString ();
+	entry->creationKey=result->value (3).toString ();
+	return true;
+}
+
+void WriteJournal::addEntry (Operation operation, const QString &table, dbId objectId, const QString &baseHash, const QString &creationKey)
+{
+	interface.executeQuery (
+		Query (notr ("INSERT INTO %1 (operation,table_name,object_id,base_hash,creation_key) VALUES (?,?,?,?,?)"))
+		.arg (entriesTableName)
+		.bind (operationToDb (operation)).bind (table).bind (objectId).bind (baseHash).bind (creationKey));
+
+	++numEntries;
+}
+
+void WriteJournal::setEntryOperation (dbId sequence, Operation operation)
+{
+	interface.executeQuery (
+		Query (notr ("UPDATE %1 SET operation=? WHERE id=?"))
+		.arg (entriesTableName).bind (operationToDb (operation)).bind (sequence));
+}
+
+void WriteJournal::removeEntry (dbId sequence)
+{
+	interface.executeQuery (
+		Query (notr ("DELETE FROM %1 WHERE id=?"))
+		.arg (entriesTableName).bind (sequence));
+
+	--numEntries;
+}
+
+/**
+ * Removes all objects after the journal has been replayed completely
+ */
+void WriteJournal::clear ()
+{
+	interface.executeQuery (Query (notr ("DELETE FROM %1")).arg (Flight      ::dbTableName ()));
+	interface.executeQuery (Query (notr ("DELETE FROM %1")).arg (Person      ::dbTableName ()));
+	interface.executeQuery (Query (notr ("DELETE FROM %1")).arg (Plane       ::dbTableName ()));
+	interface.executeQuery (Query (notr ("DELETE FROM %1")).arg (LaunchMethod::dbTableName ()));
+	interface.executeQuery (Query (notr ("DELETE FROM %1")).arg (Database::deletionsTableName));
+}
+
+QHash<dbId, dbId> WriteJournal::readIds ()
+{
+	QHash<dbId, dbId> ids;
+
+	QSharedPointer<Result> result=interface.executeQueryResult (
+		Query (notr ("SELECT temporary_id,id FROM %1")).arg (idsTableName));
+
+	while (result->next ())
+		ids.insert (result->value (0).toLongLong (), result->value (1).toLongLong ());
+
+	return ids;
+}
+
+void WriteJournal::addId (dbId temporaryId, dbId id)
+{
+	interface.executeQuery (
+		Query (notr ("INSERT INTO %1 (temporary_id,id) VALUES (?,?)"))
+		.arg (idsTableName).bind (temporaryId).bind (id));
+}
+
+
+// ***************
+// ** Recording **
+// ***************
+
+/**
+ * Records the creation of an object
+ *
+ * The object gets a temporary ID, which is also returned.
+ *
+ * @param creationKey the key identifying the creation in the database, see
+ *                    Database::createObject; if the creation may already have
+ *                    been sent to the database, this must be the key used
+ *                    for that
+ */
+template<class T> dbId WriteJournal::recordCreate (T &object, const QString &creationKey)
+{
+	synchronized (mutex)
+	{
+		object.setId (nextTemporaryId++);
+
+		journalDb.updateObject (object);
+		addEntry (operationCreate, T::dbTableName (), object.getId (), QString (), creationKey);
+	}
+
+	emit dbEvent (DbEvent::added (object));
+
+	return object.getId ();
+}
+
+/**
+ * Records the change of an object
+ *
+ * @param base the object before the change (i. e. as it is in the database),
+ *             or NULL if it is not known. If it is NULL, conflicts cannot be
+ *             detected.
+ */
+template<class T> void WriteJournal::recordUpdate (const T &object, const T *base)
+{
+	synchronized (mutex)
+	{
+		journalDb.updateObject (object);
+
+		// If there is already an entry for this object, it will write the
+		// current version of the object. The base is the one of the existing
+		// entry.
+		Entry entry;
+		if (!findEntry (T::dbTableName (), object.getId (), &entry))
+		{
+			QString baseHash;
+			if (base && !isReplayingCreate (T::dbTableName (), object.getId ()))
+				baseHash=hash (*base);
+
+			addEntry (operationUpdate, T::dbTableName (), object.getId (), baseHash);
+		}
+	}
+
+	emit dbEvent (DbEvent::changed (object));
+}
+
+/**
+ * Records the deletion of an object
+ *
+ * @param base see #recordUpdate
+ */
+template<class T> void WriteJournal::recordDelete (dbId id, const T *base)
+{
+	synchronized (mutex)
+	{
+		journalDb.deleteObject<T> (id);
+
+		Entry entry;
+		if (!findEntry (T::dbTableName (), id, &entry))
+		{
+			// No entry yet
+			QString baseHash;
+			if (base && !isReplayingCreate (T::dbTableName (), id))
+				baseHash=hash (*base);
+
+			addEntry (operationDelete, T::dbTableName (), id, baseHash);
+		}
+		else if (entry.operation==operationCreate)
+			// The object has only been created locally, there is no need to
+			// write it at all
+			removeEntry (entry.sequence);
+		else
+			// The object has been changed locally - delete it instead
+			setEntryOperation (entry.sequence, operationDelete);
+	}
+
+	emit dbEvent (DbEvent::deleted<T> (id));
+}
+
+
+// ***************
+// ** Replaying **
+// ***************
+
+/**
+ * Replaces the temporary IDs of referenced objects. Only flights reference
+ * other objects.
+ */
+template<class T> static void mapReferences (T &object, const QHash<dbId, dbId> &ids)
+{
+	(void)object;
+	(void)ids;
+}
+
+template<> void mapReferences<Flight> (Flight &flight, const QHash<dbId, dbId> &ids)
+{
+	flight.setPlaneId        (ids.value (flight.getPlaneId        (), flight.getPlaneId        ()));
+	flight.setPilotId        (ids.value (flight.getPilotId        (), flight.getPilotId        ()));
+	flight.setCopilotId      (ids.value (flight.getCopilotId      (), flight.getCopilotId      ()));
+	flight.setLaunchMethodId (ids.value (flight.getLaunchMethodId (), flight.getLaunchMethodId ()));
+	flight.setTowplaneId     (ids.value (flight.getTowplaneId     (), flight.getTowplaneId     ()));
+	flight.setTowpilotId     (ids.value (flight.getTowpilotId     (), flight.getTowpilotId     ()));
+}
+
+template<class T> void WriteJournal::replayEntry (Database &db, const Entry &entry, const QHash<dbId, dbId> &ids, QStringList &conflicts)
+{
+	// The ID of the object in the database. For objects created from the
+	// journal, this is different from the ID in the journal.
+	dbId id=ids.value (entry.objectId, entry.objectId);
+	QString description=qnotr ("%1 %2").arg (T::objectTypeDescription ()).arg (id);
+
+	switch (entry.operation)
+	{
+		case operationCreate:
+		{
+			// If the replay was interrupted after the object was written, it
+			// must not be created again.
+			if (ids.contains (entry.objectId)) break;
+
+			T object;
+			try
+			{
+				object=journalDb.getObject<T> (entry.objectId);
+			}
+			catch (Database::NotFoundException &)
+			{
+				// Deleted locally while replaying; the deletion has been
+				// recorded in a new entry.
+				break;
+			}
+			mapReferences (object, ids);
+
+			// Remove the object with the temporary ID from the cache; the
+			// created object will be added by the database
+			emit dbEvent (DbEvent::deleted<T> (entry.objectId));
+
+			// The object may already have been created, either by the write
+			// which was journaled after the connection was lost, or by a
+			// previous replay which was interrupted before the entry was
+			// removed. In this case, write the local version (which may have
+			// been changed since) to the existing object.
+			dbId createdId=invalidId;
+			if (!entry.creationKey.isEmpty ())
+				createdId=db.createdObjectId (entry.creationKey);
+
+			if (idValid (createdId))
+			{
+				object.setId (createdId);
+				db.updateObject (object);
+			}
+			else
+			{
+				createdId=db.createObject (object, entry.creationKey);
+			}
+
+			synchronized (mutex) addId (entry.objectId, createdId);
+		} break;
+		case operationUpdate:
+		{
+			T object;
+			try
+			{
+				object=journalDb.getObject<T> (entry.objectId);
+			}
+			catch (Database::NotFoundException &)
+			{
+				// Deleted locally while replaying, see above
+				break;
+			}
+			object.setId (id);
+			mapReferences (object, ids);
+
+			if (!entry.baseHash.isEmpty ())
+			{
+				try
+				{
+					if (hash (db.getObject<T> (id))!=entry.baseHash)
+						conflicts << tr ("The %1 has been changed by another user. The local changes have been saved.").arg (description);
+				}
+				catch (Database::NotFoundException &)
+				{
+					conflicts << tr ("The %1 has been deleted by another user. It has been recreated.").arg (description);
+				}
+			}
+
+			// Creates the object if it does not exist
+			db.updateObject (object);
+		} break;
+		case operationDelete:
+		{
+			// The object was deleted locally while it was being created, and
+			// the creation was not written
+			if (isTemporaryId (id)) break;
+
+			if (!entry.baseHash.isEmpty ())
+			{
+				try
+				{
+					T current=db.getObject<T> (id);
+					if (hash (current)!=entry.baseHash)
+					{
+						conflicts << tr ("The %1 has been changed by another user. It has not been deleted.").arg (description);
+
+						// Restore the object in the cache
+						emit dbEvent (DbEvent::added (current));
+						break;
+					}
+				}
+				catch (Database::NotFoundException &)
+				{
+					// Already deleted
+					break;
+				}
+			}
+
+			db.deleteObject<T> (id);
+		} break;
+		// no default
+	}
+}
+
+void WriteJournal::replayEntry (Database &db, const Entry &entry, const QHash<dbId, dbId> &ids, QStringList &conflicts)
+{
+	if      (entry.table==Flight      ::dbTableName ()) replayEntry<Flight      > (db, entry, ids, conflicts);
+	else if (entry.table==Person      ::dbTableName ()) replayEntry<Person      > (db, entry, ids, conflicts);
+	else if (entry.table==Plane       ::dbTableName ()) replayEntry<Plane       > (db, entry, ids, conflicts);
+	else if (entry.table==LaunchMethod::dbTableName ()) replayEntry<LaunchMethod> (db, entry, ids, conflicts);
+	else std::cout << notr ("Unknown table in write journal: ") << entry.table << std::endl;
+}
+
+/**
+ * Writes the journaled operations to the database, in the order they were
+ * recorded
+ *
+ * Each entry is removed from the journal after it has been written, so if the
+ * replay is interrupted (for example, because the connection is lost again),
+ * it can be resumed later.
+ *
+ * The mutex is only held while accessing the journal, not while writing to
+ * the database, so operations can be recorded (and the state of the journal
+ * can be queried) while the replay is running. Operations recorded during
+ * the replay are written as well.
+ *
+ * @param db the database to write to
+ * @return a list of conflicts, as messages for the user
+ */
+QStringList WriteJournal::replay (Database &db, OperationMonitorInterface monitor)
+{
+	QStringList conflicts;
+
+	// Note that break and continue cannot be used inside synchronized
+	bool done=false;
+	while (!done)
+	{
+		QList<Entry> entries;
+		QHash<dbId, dbId> ids;
+
+		synchronized (mutex)
+		{
+			if (numEntries==0)
+			{
+				clear ();
+				done=true;
+			}
+			else
+			{
+				std::cout << qnotr ("Replaying %1 journaled operations").arg (numEntries) << std::endl;
+
+				entries=readEntries ();
+				ids=readIds ();
+			}
+		}
+
+		int progress=0;
+		foreach (const Entry &listedEntry, entries)
+		{
+			monitor.progress (progress++, entries.size (), tr ("Writing pending changes"));
+
+			// The entry may have been changed or removed since the list was
+			// read
+			Entry entry;
+			bool found=false;
+			synchronized (mutex)
+			{
+				found=readEntry (listedEntry.sequence, &entry);
+				replaying=found;
+				replayingEntry=entry;
+			}
+			if (!found) continue;
+
+			try
+			{
+				replayEntry (db, entry, ids, conflicts);
+			}
+			catch (...)
+			{
+				synchronized (mutex) replaying=false;
+				throw;
+			}
+
+			synchronized (mutex)
+			{
+				removeEntry (entry.sequence);
+				replaying=false;
+
+				// Created objects may be referenced by later entries
+				if (entry.operation==operationCreate)
+					ids=readIds ();
+			}
+		}
+	}
+
+	foreach (const QString &conflict, conflicts)
+		std::cout << notr ("Write journal conflict: ") << conflict << std::endl;
+
+	return conflicts;
+}
+
+
+// ***************************
+// ** Method instantiations **
+// ***************************
+
+#define INSTANTIATE_TEMPLATES(T) \
+	template dbId WriteJournal::recordCreate    (T &object, const QString &creationKey); \
+	template void WriteJournal::recordUpdate    (const T &object, const T *base); \
+	template void WriteJournal::recordDelete<T> (dbId id, const T *base); \
+	// Empty line
+
+INSTANTIATE_TEMPLATES (Person      )
+INSTANTIATE_TEMPLATES (Plane       )
+INSTANTIATE_TEMPLATES (Flight      )
+INSTANTIATE_TEMPLATES (LaunchMethod)
+
+#undef INSTANTIATE_TEMPLATES
@@ -0,0 +1,136 @@
+/*
+ * WriteJournal.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef WRITEJOURNAL_H_
+#define WRITEJOURNAL_H_
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+#include "src/db/dbId.h"
+#include "src/db/DatabaseInfo.h"
+#include "src/db/interface/ThreadSafeInterface.h"
+#include "src/db/Database.h"
+#include "src/db/event/DbEvent.h"
+#include "src/concurrent/monitor/OperationMonitorInterface.h"
+
+/**
+ * A local journal of write operations that could not be written to the
+ * database because the connection was down
+ *
+ * When the connection to the database server is lost, creating, updating and
+ * deleting objects would block until the connection returns. Instead, the
+ * operations are recorded in the journal, which is stored in a local SQLite
+ * database, so the journal survives a restart of the program. The changes are
+ * applied to the cache immediately (via the dbEvent signal). When the
+ * connection returns, the journal is replayed to the database (see #replay).
+ *
+ * Created objects get a temporary ID (see #isTemporaryId) until they are
+ * written to the database, where they get their actual ID. References to
+ * temporary IDs (e. g. the pilot of a flight created while the connection was
+ * down) are replaced when replaying.
+ *
+ * A create may also be recorded after it has been sent to the database, if
+ * the connection was lost before the result was received; the object may or
+ * may not have been created. Therefore, each create has a creation key, which
+ * the database records together with the created object (see
+ * Database::createObject). Before replaying a create, the journal looks up
+ * the key; if the object has already been created, it is updated instead of
+ * being created again.
+ *
+ * There is at most one journal entry per object; subsequent operations on the
+ * same object are merged into the existing entry. For updates and deletes,
+ * the journal stores a hash of the object as it was before the change (the
+ * base version). If the object has been changed in the database in the
+ * meantime (i. e. by another station), this is reported as a conflict:
+ *   - for updates, the local version is written anyway
+ *   - for deletes, the object is not deleted
+ *
+ * This class is thread safe. The mutex is not held while writing to the
+ * database, so operations can be recorded while the journal is being
+ * replayed.
+ */
+class WriteJournal: public QObject
+{
+	Q_OBJECT
+
+	public:
+		enum Operation { operationCreate, operationUpdate, operationDelete };
+
+		// Temporary IDs are outside of the range used by the database (which
+		// uses signed 32 bit integers).
+		static const dbId firstTemporaryId=0x80000000u;
+		static bool isTemporaryId (dbId id);
+
+		WriteJournal (const DatabaseInfo &info);
+		virtual ~WriteJournal ();
+
+		void open ();
+		bool isEmpty ();
+		int size ();
+
+		// *** Recording
+		template<class T> dbId recordCreate (T &object, const QString &creationKey);
+		template<class T> void recordUpdate (const T &object, const T *base);
+		template<class T> void recordDelete (dbId id, const T *base);
+
+		// *** Replaying
+		QStringList replay (Database &db, OperationMonitorInterface monitor=OperationMonitorInterface::null);
+
+	signals:
+		void dbEvent (DbEvent event);
+
+	private:
+		class Entry
+		{
+			public:
+				dbId sequence;
+				Operation operation;
+				QString table;
+				dbId objectId;
+				QString baseHash;
+				QString creationKey; // Only for creates
+		};
+
+		static const QString entriesTableName;
+		static const QString idsTableName;
+
+		static QString operationToDb (Operation operation);
+		static Operation operationFromDb (const QString &operation);
+		template<class T> static QString hash (const T &object);
+
+		QList<Entry> readEntries ();
+		bool readEntry (dbId sequence, Entry *entry);
+		bool isReplayingCreate (const QString &table, dbId objectId);
+		bool findEntry (const QString &table, dbId objectId, Entry *entry);
+		void addEntry (Operation operation, const QString &table, dbId objectId, const QString &baseHash, const QString &creationKey=QString ());
+		void setEntryOperation (dbId sequence, Operation operation);
+		void removeEntry (dbId sequence);
+		void clear ();
+
+		QHash<dbId, dbId> readIds ();
+		void addId (dbId temporaryId, dbId id);
+
+		template<class T> void replayEntry (Database &db, const Entry &entry, const QHash<dbId, dbId> &ids, QStringList &conflicts);
+		void replayEntry (Database &db, const Entry &entry, const QHash<dbId, dbId> &ids, QStringList &conflicts);
+
+		ThreadSafeInterface interface;
+		Database journalDb;
+		QMutex mutex;
+		bool isOpen;
+		int numEntries;
+		dbId nextTemporaryId;
+
+		// The entry currently being written by #replay, if any
+		bool replaying;
+		Entry replayingEntry;
+};
+
+#endif
@@ -7,8 +7,17 @@
 
 #include "Migration.h"
 
+#include <iostream>
+
+#include <QApplication>
+
 #include "src/db/Database.h"
 #include "src/db/result/Result.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+// If this is changed, interrupted backfills will start over.
+const QString Migration::backfillProgressTableName=notr ("migration_progress");
 
 QString Migration::dataTypeBinary    () { return Interface::dataTypeBinary    (); }
 QString Migration::dataTypeBoolean   () { return Interface::dataTypeBoolean   (); }
@@ -26,7 +35,7 @@ QString Migration::dataTypeCharacter () { return Interface::dataTypeCharacter ()
 QString Migration::dataTypeId        () { return Interface::dataTypeId        (); }
 
 Migration::Migration (Interface &interface):
-	interface (interface)
+	interface (interface), monitor (OperationMonitorInterface::null)
 {
 
 }
@@ -35,6 +44,15 @@ Migration::~Migration ()
 {
 }
 
+/**
+ * Sets the monitor used for reporting the progress of chunked data changes
+ * (see #backfill). This is called by the Migrator.
+ */
+void Migration::setMonitor (OperationMonitorInterface monitor)
+{
+	this->monitor=monitor;
+}
+
 /** Forwards to interface#transaction */
 void Migration::transaction ()
 {
@@ -149,3 +167,271 @@ void Migration::updateColumnValues (const QString &tableName, const QString &col
 {
 	interface.updateColumnValues (tableName, columnName, oldValue, newValue);
 }
+
+
+// **************************
+// ** Chunked data changes **
+// **************************
+
+/**
+ * Updates all rows of a table in chunks, each in a separate transaction
+ *
+ * The rows are processed in ranges of chunkSize IDs, so other clients are
+ * only blocked for the duration of a single chunk. The progress is reported
+ * to the monitor, and the migration can be canceled between chunks.
+ *
+ * The last completed chunk is saved in the checkpoint table. If the backfill
+ * is interrupted, it continues after the last completed chunk the next time.
+ * Rows inserted while the backfill is running are included, as long as they
+ * are inserted before the last chunk. Rows written by clients during the
+ * backfill, but after their chunk, are not updated again, so the other
+ * clients must write the new values themselves (for example, by writing both
+ * the old and the shadow column) or must not write to the table during the
+ * migration.
+ *
+ * @param table the table to update; it must have an integer id column
+ * @param assignments the SET clause of the update, e. g. "a_new=a". The
+ *                    table and the assignments identify the checkpoint.
+ * @param chunkSize the number of IDs per chunk
+ */
+void Migration::backfill (const QString &table, const QString &assignments, int chunkSize)
+{
+	processChunks (table,
+		qnotr ("%1: %2").arg (table, assignments),
+		Query (notr ("UPDATE %1 SET %2 WHERE id>? AND id<=?")).arg (table, assignments),
+		qApp->translate ("Migration", "Updating %1").arg (table),
+		chunkSize);
+}
+
+/**
+ * Changes the type of a column without locking the table for the time it
+ * takes to rewrite all rows
+ *
+ * On MySQL, any ALTER TABLE on a populated table copies the whole table and
+ * blocks writes until it is finished (before MySQL 5.6). Instead, a shadow
+ * table with the new column type is created (CREATE TABLE ... LIKE and an
+ * ALTER TABLE of the empty shadow table), the rows are copied in chunks by
+ * ranges of the ID, each chunk in a separate transaction with a checkpoint
+ * (see #processChunks), and the shadow table replaces the original table with
+ * a single, atomic RENAME TABLE. The original table is dropped afterwards.
+ *
+ * Rows written by other clients during the copy are copied to the shadow
+ * table by triggers on the original table, so no changes are lost. Creating
+ * triggers requires the TRIGGER privilege (MySQL 5.1.6 and later) or the
+ * SUPER privilege (MySQL 5.0, and with binary logging enabled). The original
+ * table must not have triggers of its own, because MySQL before 5.7 allows
+ * only one trigger per event and table.
+ *
+ * If the copy is interrupted, it continues after the last completed chunk
+ * when the migration is run again.
+ *
+ * SQLite databases are local and only used by one client, so the column is
+ * changed by rebuilding the table in a single transaction (see
+ * Interface::sqliteRebuildTable).
+ *
+ * @param table the table to change; it must have an integer id column
+ * @param name the name of the column to change
+ * @param type the new type of the column
+ * @param extraSpecification the new specification of the column
+ * @param chunkSize the number of IDs per chunk
+ */
+void Migration::changeColumnTypeChunked (const QString &table, const QString &name, const QString &type, const QString &extraSpecification, int chunkSize)
+{
+	if (interface.isSqlite ())
+	{
+		changeColumnType (table, name, type, extraSpecification);
+		return;
+	}
+
+	QString shadowTable=qnotr ("%1_shadow").arg (table);
+	QString oldTable   =qnotr ("%1_old"   ).arg (table);
+
+	// If the migration was interrupted after the swap, only dropping the
+	// original table is left to do
+	if (interface.tableExists (oldTable) && !interface.tableExists (shadowTable))
+	{
+		dropTable (oldTable);
+		return;
+	}
+
+	if (!interface.tableExists (shadowTable))
+	{
+		// The shadow table is empty, so changing the column is fast
+		createTableLike (table, shadowTable, false);
+		changeColumnType (shadowTable, name, type, extraSpecification);
+	}
+
+	// The triggers are (re)created even if the migration is resumed, as the
+	// connection may have been lost while creating them
+	QStringList columns=columnNames (table);
+	createShadowTriggers (table, shadowTable, columns);
+
+	// REPLACE rather than INSERT because the triggers may already have copied
+	// some of the rows. The rows are read from the original table, so they
+	// are always current.
+	QString columnList=columns.join (notr (","));
+	processChunks (table,
+		qnotr ("%1: %2 to %3").arg (table, name, type),
+		Query (notr ("REPLACE INTO %1 (%2) SELECT %2 FROM %3 WHERE id>? AND id<=?"))
+			.arg (shadowTable, columnList, table),
+		qApp->translate ("Migration", "Copying %1").arg (table),
+		chunkSize);
+
+	// Swap the tables atomically; clients never see a missing table. The
+	// triggers are moved with the original table and dropped with it.
+	std::cout << qnotr ("Replacing table %1 with %2").arg (table, shadowTable) << std::endl;
+	executeQuery (Query (notr ("RENAME TABLE %1 TO %2, %3 TO %1"))
+		.arg (table, oldTable, shadowTable));
+
+	dropTable (oldTable);
+}
+
+/**
+ * Creates the triggers which copy the changes of a table to its shadow table
+ * while the rows are being copied (see #changeColumnTypeChunked)
+ */
+void Migration::createShadowTriggers (const QString &table, const QString &shadowTable, const QStringList &columns)
+{
+	QStringList newValues;
+	foreach (const QString &column, columns)
+		newValues.append (qnotr ("NEW.%1").arg (column));
+
+	QString replace=qnotr ("REPLACE INTO %1 (%2) VALUES (%3)")
+		.arg (shadowTable, columns.join (notr (",")), newValues.join (notr (",")));
+
+	QStringList events;
+	events << notr ("insert") << notr ("update") << notr ("delete");
+
+	foreach (const QString &event, events)
+	{
+		QString trigger=qnotr ("%1_%2").arg (shadowTable, event);
+
+		QString statement;
+		if (event==notr ("delete"))
+			statement=qnotr ("DELETE FROM %1 WHERE id=OLD.id").arg (shadowTable);
+		else
+			statement=replace;
+
+		executeQuery (Query (notr ("DROP TRIGGER IF EXISTS %1")).arg (trigger));
+		executeQuery (Query (notr ("CREATE TRIGGER %1 AFTER %2 ON %3 FOR EACH ROW %4"))
+			.arg (trigger, event.toUpper (), table, statement));
+	}
+}
+
+/**
+ * Executes a statement for all rows of a table in chunks, each in a separate
+ * transaction
+ *
+ * The statement must contain the condition "id>? AND id<=?" (without bind
+ * values), which is bound to the range of IDs of each chunk. The last
+ * completed chunk is saved in the checkpoint table in the transaction of the
+ * chunk. If the operation is interrupted, it continues after the last
+ * completed chunk the next time it is performed with the same key. Rows
+ * inserted while the chunks are processed are included, as long as they are
+ * inserted before the last chunk.
+ *
+ * @param table the table to process
+ * @param key identifies the checkpoint of the operation
+ * @param statement the statement to execute for each chunk
+ * @param status the status to display
+ * @param chunkSize the number of IDs per chunk
+ */
+void Migration::processChunks (const QString &table, const QString &key, const Query &statement, const QString &status, int chunkSize)
+{
+	createTable (backfillProgressTableName, QList<ColumnSpec> ()
+		<< ColumnSpec (notr ("name"   ), dataTypeString  (), notr ("NOT NULL PRIMARY KEY"))
+		<< ColumnSpec (notr ("last_id"), dataTypeInteger (), notr ("NOT NULL")),
+		true);
+
+	quint64 lastId=readCheckpoint (key);
+	quint64 last=maxId (table);
+
+	if (lastId>0)
+		std::cout << qnotr ("Resuming %1 after ID %2").arg (key).arg (lastId) << std::endl;
+	else
+		std::cout << qnotr ("Processing %1 in chunks").arg (key) << std::endl;
+
+	while (lastId<last)
+	{
+		quint64 chunkEnd=qMin (lastId+chunkSize, last);
+
+		transaction ();
+		try
+		{
+			executeQuery (Query (statement).bind (lastId).bind (chunkEnd));
+			writeCheckpoint (key, chunkEnd);
+			commit ();
+		}
+		catch (...)
+		{
+			rollback ();
+			throw;
+		}
+
+		lastId=chunkEnd;
+
+		// Include the rows inserted in the meantime
+		if (lastId>=last)
+			last=maxId (table);
+
+		// Throws OperationCanceledException if canceled, after the chunk has
+		// been committed
+		monitor.progress ((int)lastId, (int)last, status);
+	}
+
+	removeCheckpoint (key);
+}
+
+/**
+ * Determines the names of the columns of a MySQL table, in table order
+ */
+QStringList Migration::columnNames (const QString &table)
+{
+	QStringList names;
+
+	// The first column of SHOW COLUMNS is the name
+	QSharedPointer<Result> result=executeQueryResult (
+		Query (notr ("SHOW COLUMNS FROM %1")).arg (table));
+	while (result->next ())
+		names.append (result->value (0).toString ());
+
+	return names;
+}
+
+quint64 Migration::maxId (const QString &table)
+{
+	QSharedPointer<Result> result=executeQueryResult (
+		Query (notr ("SELECT MAX(id) FROM %1")).arg (table));
+
+	if (!result->next ()) return 0;
+	return result->value (0).toULongLong ();
+}
+
+quint64 Migration::readCheckpoint (const QString &key)
+{
+	QSharedPointer<Result> result=executeQueryResult (
+		Query (notr ("SELECT last_id FROM %1 WHERE name=?")).arg (backfillProgressTableName).bind (key));
+
+	if (!result->next ()) return 0;
+	return result->value (0).toULongLong ();
+}
+
+void Migration::writeCheckpoint (const QString &key, quint64 lastId)
+{
+	// Both MySQL and SQLite support REPLACE
+	executeQuery (Query (notr ("REPLACE INTO %1 (name, last_id) VALUES (?, ?)"))
+		.arg (backfillProgressTableName).bind (key).bind (lastId));
+}
+
+/**
+ * Removes the checkpoint of a completed backfill. The checkpoint table is
+ * dropped if it is empty, so it only exists while a backfill is incomplete.
+ */
+void Migration::removeCheckpoint (const QString &key)
+{
+	executeQuery (Query (notr ("DELETE FROM %1 WHERE name=?"))
+		.arg (backfillProgressTableName).bind (key));
+
+	if (interface.countQuery (Query (notr ("SELECT COUNT(*) FROM %1")).arg (backfillProgressTableName))==0)
+		dropTable (backfillProgressTableName);
+}
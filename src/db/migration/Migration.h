@@ -2,6 +2,7 @@
 #define MIGRATION_H_
 
 #include <QString>
+#include <QStringList>
 #include <QVariant>
 #include <QSharedPointer>
 
@@ -44,11 +45,32 @@ class Interface;
  *   - do not include Interface.h. Use the forwarder methods provided
  *     by this class instead. Add forwarder methods if required.
  *
- * Note that the monitor is not required for cancelation, since the only long
- * operations the migrations do are queries, and queries can be canceled by
- * using the interface's cancelConnection method. We also don't do progress
- * reporting (except currentSchema) because that would only make sense with
- * suboperations, which are not implemented, so we don't use a monitor at all.
+ * Note that the monitor is not required for cancelation of single queries,
+ * since queries can be canceled by using the interface's cancelConnection
+ * method. The monitor (see #setMonitor) is only used by the chunked data
+ * changes (see #backfill), which report their progress and can be canceled
+ * between chunks.
+ *
+ * Chunked data changes:
+ * Changing all rows of a large table with a single query (e. g. a single
+ * UPDATE, or an ALTER TABLE that copies the data) locks the table for all
+ * clients until the query is finished. #backfill instead changes the rows in
+ * chunks by ranges of the primary key, each chunk in a separate transaction.
+ * The last completed chunk is saved in a checkpoint table
+ * (#backfillProgressTableName) in the same transaction, so a backfill that
+ * has been interrupted (e. g. canceled or by a connection failure) continues
+ * after the last completed chunk when the migration is run again. Therefore,
+ * the migration must be written such that it can be run again after an
+ * interruption (use the skipIfExists parameters). For changing the type of a
+ * column, see #changeColumnTypeChunked, which copies the table to a shadow
+ * table in chunks instead of altering it.
+ *
+ * Limitations of the chunked data changes:
+ *   - other schema changes (adding, dropping and renaming columns) are still
+ *     single statements. MySQL versions before 5.6 copy the table for any
+ *     ALTER TABLE, so these lock the table until it has been rewritten.
+ *   - no migration uses them yet. The chunked column change is tested by
+ *     the MySQL tests in test/.
  */
 class Migration
 {
@@ -76,12 +98,17 @@ class Migration
     	static QString dataTypeId        ();
 
 
+		static const QString backfillProgressTableName;
+
+
 		Migration (Interface &interface);
 		virtual ~Migration ();
 
 		virtual void up ()=0;
 		virtual void down ()=0;
 
+		void setMonitor (OperationMonitorInterface monitor);
+
 	protected:
 		void transaction ();
 		void commit ();
@@ -108,8 +135,24 @@ class Migration
 
 		void updateColumnValues (const QString &tableName, const QString &columnName, const QVariant &oldValue, const QVariant &newValue);
 
+		// *** Chunked data changes
+		void backfill (const QString &table, const QString &assignments, int chunkSize=defaultChunkSize);
+		void changeColumnTypeChunked (const QString &table, const QString &name, const QString &type, const QString &extraSpecification="", int chunkSize=defaultChunkSize);
+
 	private:
+		static const int defaultChunkSize=1000;
+
+		void processChunks (const QString &table, const QString &key, const Query &statement, const QString &status, int chunkSize);
+		void createShadowTriggers (const QString &table, const QString &shadowTable, const QStringList &columns);
+		QStringList columnNames (const QString &table);
+
+		quint64 maxId (const QString &table);
+		quint64 readCheckpoint (const QString &key);
+		void writeCheckpoint (const QString &key, quint64 lastId);
+		void removeCheckpoint (const QString &key);
+
 		Interface &interface;
+		OperationMonitorInterface monitor;
 };
 
 #endif
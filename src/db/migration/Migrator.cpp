@@ -4,12 +4,16 @@
 
 #include <QApplication>
 #include <QSharedPointer>
+#include <QTime>
 
 #include "src/db/interface/Interface.h"
 #include "src/db/migration/MigrationFactory.h"
 #include "src/db/schema/CurrentSchema.h"
 #include "src/util/qString.h"
 #include "src/db/result/Result.h"
+#include "src/db/schema/spec/ColumnSpec.h"
+#include "src/db/schema/spec/TableSpec.h"
+#include "src/db/Query.h"
 #include "src/concurrent/monitor/OperationMonitor.h"
 #include "src/i18n/notr.h"
 
@@ -47,6 +51,7 @@ void Migrator::runMigration (quint64 version, Migration::Direction direction, Op
 	{
 		migration   =MigrationFactory::instance ().createMigration (interface, version);
 		QString name=MigrationFactory::instance ().migrationName (version);
+		migration->setMonitor (monitor);
 
 		switch (direction)
 		{
@@ -76,7 +81,7 @@ void Migrator::runMigration (quint64 version, Migration::Direction direction, Op
 }
 
 /** Migrates one step up */
-void Migrator::up ()
+void Migrator::up (OperationMonitorInterface monitor)
 {
 	quint64 version=nextMigration ();
 
@@ -86,17 +91,17 @@ void Migrator::up ()
 		return;
 	}
 
-	runMigration (version, Migration::dirUp);
+	runMigration (version, Migration::dirUp, monitor);
 }
 
 /** Migrates one step down */
-void Migrator::down ()
+void Migrator::down (OperationMonitorInterface monitor)
 {
 	quint64 version=currentVersion ();
 
 	if (version==0) return;
 
-	runMigration (currentVersion (), Migration::dirDown);
+	runMigration (currentVersion (), Migration::dirDown, monitor);
 }
 
 /** Migrates to the latest version (runs pending migrations) */
@@ -124,6 +129,9 @@ void Migrator::loadSchema (OperationMonitorInterface monitor)
 {
 	std::cout << notr ("== Loading schema =============================================================") << std::endl;
 
+	QTime timer;
+	timer.start ();
+
 	CurrentSchema schema (interface);
 
 	// Create the migrations table before loading the schema so we can
@@ -139,27 +147,74 @@ void Migrator::loadSchema (OperationMonitorInterface monitor)
 	// wrong, so using or migrating the database would fail.
 	clearMigrationsTable ();
 
+	// Create all tables (with their indexes) and save the version in one
+	// batch rather than table by table and index by index (a single query
+	// for MySQL, a single transaction for SQLite)
+	QList<Query> script;
+	foreach (const TableSpec &table, schema.getTables ())
+		script+=interface.createTableQueries (table.getName (), table.getColumns (), table.getIndexes (), true);
+	script.append (assumeMigratedQuery (schema.getVersions ()));
+
 	monitor.status (qApp->translate ("Migrator", "Loading schema"));
-	schema.up (monitor);
+	executeScript (script, monitor);
 
-	monitor.status (qApp->translate ("Migrator", "Saving version"));
-	assumeMigrated (schema.getVersions ());
+	std::cout << qnotr ("Schema loaded: %1 tables, %2 statements in %3 ms")
+		.arg (schema.getTables ().size ()).arg (script.size ()).arg (timer.elapsed ()) << std::endl;
 
 	std::cout << notr ("== Version is now ") << currentVersion () << notr (" ") << QString (79-19-14, '=') << std::endl << std::endl;
 }
 
+/**
+ * Executes a list of schema queries
+ *
+ * For SQLite, the queries are executed in a single transaction (SQLite
+ * supports transactional schema changes), so the database file is only
+ * synced once, and the script is either executed completely or not at all.
+ *
+ * For MySQL, the queries are sent as a single multi-statement query, so the
+ * script takes one round trip (see Interface#executeMultiStatement). MySQL
+ * implicitly commits each schema change, so a failed script may leave a
+ * partial schema; this is detected by #getRequiredAction.
+ */
+void Migrator::executeScript (const QList<Query> &script, OperationMonitorInterface monitor)
+{
+	if (!interface.isSqlite ())
+	{
+		monitor.progress (0, 1);
+		interface.executeMultiStatement (script);
+		monitor.progress (1, 1);
+		return;
+	}
+
+	interface.transaction ();
+
+	try
+	{
+		for (int i=0; i<script.size (); ++i)
+		{
+			monitor.progress (i, script.size ());
+			interface.executeQuery (script.at (i));
+		}
+
+		interface.commit ();
+	}
+	catch (...)
+	{
+		interface.rollback ();
+		throw;
+	}
+
+	monitor.progress (script.size (), script.size ());
+}
+
 void Migrator::drop ()
 {
-	// TODO create and use db method
-	QString databaseName=interface.getInfo ().database;
-	interface.executeQuery (qnotr ("DROP DATABASE %1").arg (databaseName));
+	interface.dropDatabase (interface.getInfo ().database);
 }
 
 void Migrator::create ()
 {
-	// TODO use db method
-	QString databaseName=interface.getInfo ().database;
-	interface.executeQuery (qnotr ("CREATE DATABASE %1").arg (databaseName));
+	interface.createDatabase (interface.getInfo ().database);
 }
 
 void Migrator::clear ()
@@ -321,13 +376,10 @@ quint64 Migrator::currentVersion ()
 
 void Migrator::createMigrationsTable ()
 {
-	// TODO use interface.createTable
-	interface.executeQuery (
-		qnotr (
-			"CREATE TABLE IF NOT EXISTS %1 (%2 VARCHAR(255) NOT NULL PRIMARY KEY)"
-			" ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_unicode_ci"
-		).arg (migrationsTableName, migrationsColumnName)
-	);
+	QList<ColumnSpec> columns;
+	columns << ColumnSpec (migrationsColumnName, Interface::dataTypeString (), notr ("NOT NULL PRIMARY KEY"));
+
+	interface.createTable (migrationsTableName, columns, true);
 }
 
 void Migrator::clearMigrationsTable ()
@@ -398,8 +450,11 @@ QList<quint64> Migrator::appliedMigrations ()
  */
 void Migrator::assumeMigrated (QList<quint64> versions)
 {
-	// Add all migrations
+	interface.executeQuery (assumeMigratedQuery (versions));
+}
 
+Query Migrator::assumeMigratedQuery (const QList<quint64> &versions)
+{
 	// Add all migrations in one single query because the database would be
 	// inconsistent if the process was interrupted with only some migrations
 	// inserted.
@@ -415,5 +470,5 @@ void Migrator::assumeMigrated (QList<quint64> versions)
 	foreach (quint64 version, versions)
 		query.bind (version);
 
-	interface.executeQuery (query);
+	return query;
 }
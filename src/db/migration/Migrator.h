@@ -8,6 +8,7 @@
 
 class Interface;
 class MigrationFactory;
+class Query;
 
 /**
  * A controller for managing migrations on a database.
@@ -34,8 +35,8 @@ class Migrator
 		virtual ~Migrator ();
 
 		// *** Migration
-		void up ();
-		void down ();
+		void up (OperationMonitorInterface monitor=OperationMonitorInterface::null);
+		void down (OperationMonitorInterface monitor=OperationMonitorInterface::null);
 		void migrate (OperationMonitorInterface monitor=OperationMonitorInterface::null);
 
 		// *** Schema
@@ -65,12 +66,16 @@ class Migrator
 		// *** Migration
 		void runMigration (quint64 version, Migration::Direction direction, OperationMonitorInterface monitor=OperationMonitorInterface::null);
 
+		// *** Schema
+		void executeScript (const QList<Query> &script, OperationMonitorInterface monitor=OperationMonitorInterface::null);
+
 		// *** Migrations table
 		void addMigration (quint64 version);
 		void removeMigration (quint64 version);
 		void createMigrationsTable ();
 		void clearMigrationsTable ();
 		void assumeMigrated (QList<quint64> versions);
+		Query assumeMigratedQuery (const QList<quint64> &versions);
 
 	private:
 		Interface &interface;
@@ -0,0 +1,54 @@
+#include "Migration_20261018120000_add_modification_tracking.h"
+
+#include <QList>
+
+REGISTER_MIGRATION (20261018120000, add_modification_tracking)
+
+Migration_20261018120000_add_modification_tracking::Migration_20261018120000_add_modification_tracking (Interface &interface):
+	Migration (interface)
+{
+}
+
+Migration_20261018120000_add_modification_tracking::~Migration_20261018120000_add_modification_tracking ()
+{
+}
+
+void Migration_20261018120000_add_modification_tracking::up ()
+{
+	addUpdatedAt ("planes"        );
+	addUpdatedAt ("people"        );
+	addUpdatedAt ("launch_methods");
+
+	QList<ColumnSpec> columns;
+	columns << idColumn ();
+	columns << ColumnSpec ("table_name", dataTypeString (), "NOT NULL");
+	columns << ColumnSpec ("object_id" , dataTypeId     (), "NOT NULL");
+	columns << ColumnSpec ("deleted_at", "timestamp"      , "NOT NULL DEFAULT CURRENT_TIMESTAMP");
+
+	QList<IndexSpec> indexes;
+	indexes << IndexSpec ("deletions", "deleted_at_index", "deleted_at");
+
+	createTable ("deletions", columns, indexes);
+}
+
+void Migration_20261018120000_add_modification_tracking::down ()
+{
+	dropTable ("deletions");
+
+	dropUpdatedAt ("planes"        );
+	dropUpdatedAt ("people"        );
+	dropUpdatedAt ("launch_methods");
+}
+
+void Migration_20261018120000_add_modification_tracking::addUpdatedAt (const QString &table)
+{
+	// Existing rows get the current time
+	addColumn (table, "updated_at", "timestamp", "NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP");
+	createIndex (IndexSpec (table, "updated_at_index", "updated_at"));
+}
+
+void Migration_20261018120000_add_modification_tracking::dropUpdatedAt (const QString &table)
+{
+	dropIndex (table, "updated_at_index");
+	dropColumn (table, "updated_at");
+}
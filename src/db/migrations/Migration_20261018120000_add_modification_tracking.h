@@ -0,0 +1,31 @@
+#ifndef MIGRATION_20261018120000_ADD_MODIFICATION_TRACKING_H_
+#define MIGRATION_20261018120000_ADD_MODIFICATION_TRACKING_H_
+
+#include <QString>
+
+#include "src/db/migration/Migration.h"
+
+/**
+ * Adds an updated_at column to the planes, people and launch methods, and the
+ * deletions table (tombstones of deleted objects)
+ *
+ * The updated_at column is set by the database on every insert and update.
+ * Together with the deletions, which are written by Database, this allows
+ * reading only the objects changed since a given time (see
+ * Database#getChanges).
+ */
+class Migration_20261018120000_add_modification_tracking: public Migration
+{
+	public:
+		Migration_20261018120000_add_modification_tracking (Interface &interface);
+		virtual ~Migration_20261018120000_add_modification_tracking ();
+
+		virtual void up ();
+		virtual void down ();
+
+	private:
+		void addUpdatedAt (const QString &table);
+		void dropUpdatedAt (const QString &table);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "Migration_20261018130000_flight_query_indexes.h"
+
+REGISTER_MIGRATION (20261018130000, flight_query_indexes)
+
+Migration_20261018130000_flight_query_indexes::Migration_20261018130000_flight_query_indexes (Interface &interface):
+	Migration (interface)
+{
+}
+
+Migration_20261018130000_flight_query_indexes::~Migration_20261018130000_flight_query_indexes ()
+{
+}
+
+void Migration_20261018130000_flight_query_indexes::up ()
+{
+	handleIndexes (Migration::dirUp);
+}
+
+void Migration_20261018130000_flight_query_indexes::down ()
+{
+	handleIndexes (Migration::dirDown);
+}
+
+void Migration_20261018130000_flight_query_indexes::handleIndexes (Migration::Direction direction)
+{
+	Migration::Direction reverse=(direction==dirUp)?dirDown:dirUp;
+
+	// New indexes for the prepared flights, one for each mode: local flights
+	// and leaving flights use mode_status_index (leaving flights only the
+	// mode and departed), coming flights use mode_landed_index
+	handleIndex (direction, "flights", "mode_status_index", "mode,departed,landed");
+	handleIndex (direction, "flights", "mode_landed_index", "mode,landed"         );
+
+	// Unused indexes on columns with few distinct values
+	handleIndex (reverse, "flights", "mode_index"            , "mode"                           );
+	handleIndex (reverse, "flights", "departed_index"        , "departed"                       );
+	handleIndex (reverse, "flights", "landed_index"          , "landed"                         );
+	handleIndex (reverse, "flights", "towflight_landed_index", "towflight_landed"               );
+	handleIndex (reverse, "flights", "status_index"          , "departed,landed,towflight_landed");
+	handleIndex (reverse, "flights", "type_index"            , "type"                           );
+	handleIndex (reverse, "flights", "towflight_mode_index"  , "towflight_mode"                 );
+}
+
+void Migration_20261018130000_flight_query_indexes::handleIndex (Migration::Direction direction, const QString &table, const QString &name, const QString &columns)
+{
+	switch (direction)
+	{
+		case dirUp:   createIndex (IndexSpec (table, name, columns)); break;
+		case dirDown: dropIndex              (table, name)          ; break;
+	}
+}
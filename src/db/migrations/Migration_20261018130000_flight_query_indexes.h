@@ -0,0 +1,30 @@
+#ifndef MIGRATION_20261018130000_FLIGHT_QUERY_INDEXES_H_
+#define MIGRATION_20261018130000_FLIGHT_QUERY_INDEXES_H_
+
+#include <QString>
+
+#include "src/db/migration/Migration.h"
+
+/**
+ * Replaces the single-column indexes on the low-cardinality flight columns
+ * (mode, status flags, type) by composite indexes for the prepared flights
+ * query (see Database#preparedFlightsConditions)
+ *
+ * The dropped indexes are not used by any query, but slow down every write to
+ * the flights table.
+ */
+class Migration_20261018130000_flight_query_indexes: public Migration
+{
+	public:
+		Migration_20261018130000_flight_query_indexes (Interface &interface);
+		virtual ~Migration_20261018130000_flight_query_indexes ();
+
+		virtual void up ();
+		virtual void down ();
+
+	private:
+		void handleIndexes (Migration::Direction direction);
+		void handleIndex (Migration::Direction direction, const QString &table, const QString &name, const QString &columns);
+};
+
+#endif
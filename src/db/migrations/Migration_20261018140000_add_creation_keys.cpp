@@ -0,0 +1,33 @@
+#include "Migration_20261018140000_add_creation_keys.h"
+
+#include <QList>
+
+REGISTER_MIGRATION (20261018140000, add_creation_keys)
+
+Migration_20261018140000_add_creation_keys::Migration_20261018140000_add_creation_keys (Interface &interface):
+	Migration (interface)
+{
+}
+
+Migration_20261018140000_add_creation_keys::~Migration_20261018140000_add_creation_keys ()
+{
+}
+
+void Migration_20261018140000_add_creation_keys::up ()
+{
+	QList<ColumnSpec> columns;
+	columns << ColumnSpec ("client_key", dataTypeString (), "NOT NULL PRIMARY KEY");
+	columns << ColumnSpec ("table_name", dataTypeString (), "NOT NULL");
+	columns << ColumnSpec ("object_id" , dataTypeId     (), "NOT NULL");
+	columns << ColumnSpec ("created_at", "timestamp"      , "NOT NULL DEFAULT CURRENT_TIMESTAMP");
+
+	QList<IndexSpec> indexes;
+	indexes << IndexSpec ("creation_keys", "created_at_index", "created_at");
+
+	createTable ("creation_keys", columns, indexes);
+}
+
+void Migration_20261018140000_add_creation_keys::down ()
+{
+	dropTable ("creation_keys");
+}
@@ -0,0 +1,24 @@
+#ifndef MIGRATION_20261018140000_ADD_CREATION_KEYS_H_
+#define MIGRATION_20261018140000_ADD_CREATION_KEYS_H_
+
+#include "src/db/migration/Migration.h"
+
+/**
+ * Adds the creation_keys table, which records the key assigned by the client
+ * to each created object
+ *
+ * The key is written in the transaction of the creation, so a client which
+ * lost the connection while creating an object can determine whether the
+ * object has been created (see Database#createdObjectId and WriteJournal).
+ */
+class Migration_20261018140000_add_creation_keys: public Migration
+{
+	public:
+		Migration_20261018140000_add_creation_keys (Interface &interface);
+		virtual ~Migration_20261018140000_add_creation_keys ();
+
+		virtual void up ();
+		virtual void down ();
+};
+
+#endif
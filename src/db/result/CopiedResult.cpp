@@ -6,6 +6,9 @@
 /**
  * Copies the data from the given Result
  *
+ * The following result sets of a multi-statement query are copied as well
+ * and can be accessed with #nextResult.
+ *
  * @result the Result to copy the data from; the data will be copied
  *         starting at the current position of result and the current
  *         position of result will not be reset.
@@ -20,6 +23,14 @@ CopiedResult::CopiedResult (Result &result)
 	_numRowsAffected=result.numRowsAffected ();
 	_lastInsertId=result.lastInsertId ();
 
+	while (result.nextResult ())
+	{
+		QList<QSqlRecord> resultRecords;
+		while (result.next ())
+			resultRecords.append (result.record ());
+		nextRecords.append (resultRecords);
+	}
+
 	current=QSql::BeforeFirstRow;
 }
 
@@ -90,6 +101,16 @@ bool CopiedResult::next ()
 	}
 }
 
+bool CopiedResult::nextResult ()
+{
+	if (nextRecords.isEmpty ())
+		return false;
+
+	records=nextRecords.takeFirst ();
+	current=QSql::BeforeFirstRow;
+	return true;
+}
+
 int CopiedResult::numRowsAffected () const
 {
 	return _numRowsAffected;
@@ -37,6 +37,7 @@ class CopiedResult: public Result
 		virtual QVariant lastInsertId () const;
 		virtual QString lastQuery () const;
 		virtual bool next ();
+		virtual bool nextResult ();
 		virtual int numRowsAffected () const;
 		virtual bool previous ();
 		virtual QSqlRecord record () const;
@@ -48,6 +49,8 @@ class CopiedResult: public Result
 
 	private:
 		QList<QSqlRecord> records;
+		// The records of the following result sets of a multi-statement query
+		QList<QList<QSqlRecord> > nextRecords;
 		QString _lastQuery;
 		int _numRowsAffected;
 		QVariant _lastInsertId;
@@ -19,6 +19,7 @@ bool       DefaultResult::last            ()                         { return qu
 QVariant   DefaultResult::lastInsertId    ()          const          { return query.lastInsertId    ();                }
 QString    DefaultResult::lastQuery       ()          const          { return query.lastQuery       ();                }
 bool       DefaultResult::next            ()                         { return query.next            ();                }
+bool       DefaultResult::nextResult      ()                         { return query.nextResult      ();                }
 int        DefaultResult::numRowsAffected ()          const          { return query.numRowsAffected ();                }
 bool       DefaultResult::previous        ()                         { return query.previous        ();                }
 QSqlRecord DefaultResult::record          ()          const          { return query.record          ();                }
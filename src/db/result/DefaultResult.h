@@ -42,6 +42,7 @@ class DefaultResult: public Result
 		virtual QVariant lastInsertId () const;
 		virtual QString lastQuery () const;
 		virtual bool next ();
+		virtual bool nextResult ();
 		virtual int numRowsAffected () const;
 		virtual bool previous ();
 		virtual QSqlRecord record () const;
@@ -22,6 +22,7 @@ class Result
 		virtual QVariant lastInsertId () const=0;
 		virtual QString lastQuery () const=0;
 		virtual bool next ()=0;
+		virtual bool nextResult ()=0;
 		virtual int numRowsAffected () const=0;
 		virtual bool previous ()=0;
 		virtual QSqlRecord record () const=0;
@@ -22,6 +22,7 @@ class CurrentSchema: public Schema
 		virtual void up (OperationMonitorInterface monitor);
 		virtual void down (OperationMonitorInterface monitor);
 
+		virtual QList<TableSpec> getTables ();
 		virtual QList<quint64> getVersions ();
 };
 
@@ -5,12 +5,15 @@
 
 #include <QList>
 
+#include "src/db/schema/spec/TableSpec.h"
+
 class Schema: public Migration
 {
 	public:
 		Schema (Interface &interface);
 		virtual ~Schema ();
 
+		virtual QList<TableSpec> getTables ()=0;
 		virtual QList<quint64> getVersions ()=0;
 };
 
@@ -93,6 +93,7 @@ void SchemaDumper::dumpColumns (QStringList &output, const QString &table)
 	int nullIndex =record.indexOf (notr ("Null" ));
 	int keyIndex  =record.indexOf (notr ("Key"  ));
 	int extraIndex=record.indexOf (notr ("Extra"));
+	int defaultIndex=record.indexOf (notr ("Default"));
 
 	while (result->next ())
 	{
@@ -102,6 +103,14 @@ void SchemaDumper::dumpColumns (QStringList &output, const QString &table)
 		QString key=result->value (keyIndex).toString ();
 		QString extra=result->value (extraIndex).toString ();
 
+		// A non-constant default is required for creating the column, but it
+		// is not part of the extra information. Newer MySQL versions mark it
+		// as DEFAULT_GENERATED.
+		extra.remove (notr ("DEFAULT_GENERATED"));
+		if (result->value (defaultIndex).toString ()==notr ("CURRENT_TIMESTAMP"))
+			extra=qnotr ("DEFAULT CURRENT_TIMESTAMP %1").arg (extra.trimmed ());
+		extra=extra.trimmed ();
+
 		dumpColumn (output, name, type, null, key, extra);
 	}
 }
@@ -31,3 +31,46 @@ QString ColumnSpec::createClause (const QList<ColumnSpec> &list)
 
 	return createClauses.join (notr (", "));
 }
+
+/**
+ * Whether the column is set to the current time when the row is changed
+ * ("ON UPDATE CURRENT_TIMESTAMP")
+ */
+bool ColumnSpec::isAutoUpdated () const
+{
+	return extra.contains (notr ("ON UPDATE CURRENT_TIMESTAMP"), Qt::CaseInsensitive);
+}
+
+/**
+ * Like #createClause, but for SQLite
+ *
+ * In SQLite, an auto increment column must be declared as "integer PRIMARY KEY
+ * AUTOINCREMENT" (the other data types are accepted as they are).
+ *
+ * SQLite does not support "ON UPDATE CURRENT_TIMESTAMP", so it is removed; it
+ * is emulated by a trigger (see Interface#createTable).
+ */
+QString ColumnSpec::sqliteCreateClause () const
+{
+	if (extra.contains (notr ("auto_increment"), Qt::CaseInsensitive))
+		return qnotr ("%1 integer PRIMARY KEY AUTOINCREMENT").arg (name);
+
+	if (isAutoUpdated ())
+	{
+		QString sqliteExtra=extra;
+		sqliteExtra.remove (notr ("ON UPDATE CURRENT_TIMESTAMP"), Qt::CaseInsensitive);
+		return ColumnSpec (name, type, sqliteExtra.simplified ()).createClause ();
+	}
+
+	return createClause ();
+}
+
+QString ColumnSpec::sqliteCreateClause (const QList<ColumnSpec> &list)
+{
+	QStringList createClauses;
+
+	foreach (const ColumnSpec &columnSpec, list)
+		createClauses.append (columnSpec.sqliteCreateClause ());
+
+	return createClauses.join (notr (", "));
+}
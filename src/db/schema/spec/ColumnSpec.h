@@ -18,8 +18,15 @@ class ColumnSpec
 		ColumnSpec (const QString &name, const QString &type, const QString &extra=QString ());
 		virtual ~ColumnSpec ();
 
+		const QString &getName  () const { return name ; }
+		const QString &getType  () const { return type ; }
+		const QString &getExtra () const { return extra; }
+		bool isAutoUpdated () const;
+
 		virtual QString createClause () const;
 		static QString createClause (const QList<ColumnSpec> &list);
+		virtual QString sqliteCreateClause () const;
+		static QString sqliteCreateClause (const QList<ColumnSpec> &list);
 
 	private:
 		QString name;
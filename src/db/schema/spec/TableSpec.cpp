@@ -0,0 +1,10 @@
+#include "TableSpec.h"
+
+TableSpec::TableSpec (const QString &name, const QList<ColumnSpec> &columns, const QList<IndexSpec> &indexes):
+	name (name), columns (columns), indexes (indexes)
+{
+}
+
+TableSpec::~TableSpec ()
+{
+}
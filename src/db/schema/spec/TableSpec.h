@@ -0,0 +1,32 @@
+/*
+ * TableSpec.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef TABLESPEC_H_
+#define TABLESPEC_H_
+
+#include <QString>
+#include <QList>
+
+#include "src/db/schema/spec/ColumnSpec.h"
+#include "src/db/schema/spec/IndexSpec.h"
+
+class TableSpec
+{
+	public:
+		TableSpec (const QString &name, const QList<ColumnSpec> &columns, const QList<IndexSpec> &indexes);
+		virtual ~TableSpec ();
+
+		const QString           &getName    () const { return name   ; }
+		const QList<ColumnSpec> &getColumns () const { return columns; }
+		const QList<IndexSpec>  &getIndexes () const { return indexes; }
+
+	private:
+		QString name;
+		QList<ColumnSpec> columns;
+		QList<IndexSpec> indexes;
+};
+
+#endif
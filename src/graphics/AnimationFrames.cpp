@@ -0,0 +1,55 @@
+#include "AnimationFrames.h"
+
+// ******************
+// ** Construction **
+// ******************
+
+AnimationFrames::AnimationFrames ()
+{
+}
+
+AnimationFrames::~AnimationFrames ()
+{
+}
+
+
+// ****************
+// ** Properties **
+// ****************
+
+/**
+ * Returns the approximate amount of memory used by the frames, in bytes
+ */
+int AnimationFrames::byteCount () const
+{
+	int count=0;
+
+	foreach (const QImage &image, images)
+		count+=image.byteCount ();
+
+	foreach (const QPixmap &pixmap, pixmaps)
+		count+=pixmap.width ()*pixmap.height ()*pixmap.depth ()/8;
+
+	return count;
+}
+
+
+// ****************
+// ** Conversion **
+// ****************
+
+/**
+ * Converts the images to pixmaps and releases the images
+ *
+ * This may only be called on the GUI thread.
+ */
+void AnimationFrames::convertToPixmaps ()
+{
+	pixmaps.clear ();
+	pixmaps.reserve (images.size ());
+
+	foreach (const QImage &image, images)
+		pixmaps.append (QPixmap::fromImage (image));
+
+	images.clear ();
+}
@@ -0,0 +1,43 @@
+/*
+ * AnimationFrames.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef ANIMATIONFRAMES_H_
+#define ANIMATIONFRAMES_H_
+
+#include <QVector>
+#include <QImage>
+#include <QPixmap>
+#include <QMetaType>
+
+/**
+ * The decoded frames of an animation, scaled to a given size
+ *
+ * The frames are created as QImages (see FrameScaler), which can be used on
+ * any thread. For display, they are converted to QPixmaps once (see
+ * #convertToPixmaps), which may only be done on the GUI thread.
+ *
+ * Copying is fast, the frames are shared between copies.
+ */
+class AnimationFrames
+{
+	public:
+		AnimationFrames ();
+		virtual ~AnimationFrames ();
+
+		int size () const { return delays.size (); }
+		bool isEmpty () const { return delays.isEmpty (); }
+		int byteCount () const;
+
+		void convertToPixmaps ();
+
+		QVector<QImage> images;
+		QVector<QPixmap> pixmaps;
+		QVector<int> delays; // Milliseconds
+};
+
+Q_DECLARE_METATYPE (AnimationFrames);
+
+#endif
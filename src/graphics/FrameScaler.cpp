@@ -0,0 +1,99 @@
+#include "FrameScaler.h"
+
+#include <iostream>
+
+#include <QImageReader>
+
+#include "src/i18n/notr.h"
+
+// ******************
+// ** Construction **
+// ******************
+
+FrameScaler::FrameScaler ():
+	currentRequest (0)
+{
+	connect (this, SIGNAL (sig_scale (int, QString, QSize)), this, SLOT (slot_scale (int, QString, QSize)));
+
+	moveToThread (&thread);
+	thread.start ();
+}
+
+FrameScaler::~FrameScaler ()
+{
+	// Cancel any scaling in progress
+	currentRequest.fetchAndAddOrdered (1);
+
+	thread.quit ();
+
+	std::cout << notr ("Waiting for frame scaler thread to terminate...") << std::flush;
+	if (thread.wait (1000)) std::cout << notr ("OK")      << std::endl;
+	else                    std::cout << notr ("Timeout") << std::endl;
+}
+
+
+// *************
+// ** Scaling **
+// *************
+
+/**
+ * Starts scaling the frames of an animation file in the background
+ *
+ * This method returns immediately. Any previous scaling which is still in
+ * progress is canceled.
+ *
+ * @param fileName the animation file; it must not be deleted before the
+ *                 scaling has finished
+ * @param size the size to scale the frames to; the aspect ratio is not
+ *             preserved
+ */
+void FrameScaler::scale (const QString &fileName, const QSize &size)
+{
+	int request=currentRequest.fetchAndAddOrdered (1)+1;
+	emit sig_scale (request, fileName, size);
+}
+
+bool FrameScaler::isCurrent (int request) const
+{
+	return request==(int)currentRequest;
+}
+
+/**
+ * Performs the scaling on the background thread
+ */
+void FrameScaler::slot_scale (int request, QString fileName, QSize size)
+{
+	// Skip requests which have been superseded while they were queued
+	if (!isCurrent (request)) return;
+
+	QImageReader reader (fileName);
+	AnimationFrames frames;
+	int bytes=0;
+
+	QImage image;
+	while (reader.read (&image))
+	{
+		// Stop if the request has been superseded while we were working
+		if (!isCurrent (request)) return;
+
+		// Use the same transformation as QLabel with scaled contents
+		QImage scaled=image.scaled (size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+		bytes+=scaled.byteCount ();
+		if (bytes>maxBytes)
+		{
+			emit scalingFailed (fileName, size);
+			return;
+		}
+
+		frames.images.append (scaled);
+		frames.delays.append (reader.nextImageDelay ());
+
+		if (!reader.canRead ()) break;
+	}
+
+	if (frames.isEmpty ())
+		emit scalingFailed (fileName, size);
+	else
+		emit framesScaled (fileName, size, frames);
+}
@@ -0,0 +1,59 @@
+/*
+ * FrameScaler.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef FRAMESCALER_H_
+#define FRAMESCALER_H_
+
+#include <QObject>
+#include <QThread>
+#include <QString>
+#include <QSize>
+#include <QAtomicInt>
+
+#include "src/graphics/AnimationFrames.h"
+
+/**
+ * Decodes all frames of an animation file and scales them to a given size on
+ * a background thread
+ *
+ * Call #scale to start scaling; the result is reported by the framesScaled or
+ * scalingFailed signal. A new call to #scale cancels any scaling still in
+ * progress, so only the result of the last call is reported. Scaling fails if
+ * the frames would use more than maxBytes of memory.
+ *
+ * Each FrameScaler runs its own thread, which is stopped when the FrameScaler
+ * is deleted.
+ */
+class FrameScaler: public QObject
+{
+	Q_OBJECT
+
+	public:
+		// The maximum memory used by the frames of one animation, in bytes
+		static const int maxBytes=32*1024*1024;
+
+		FrameScaler ();
+		virtual ~FrameScaler ();
+
+		void scale (const QString &fileName, const QSize &size);
+
+	signals:
+		void framesScaled (QString fileName, QSize size, AnimationFrames frames);
+		void scalingFailed (QString fileName, QSize size);
+
+		void sig_scale (int request, QString fileName, QSize size);
+
+	private slots:
+		void slot_scale (int request, QString fileName, QSize size);
+
+	private:
+		bool isCurrent (int request) const;
+
+		QThread thread;
+		QAtomicInt currentRequest;
+};
+
+#endif
@@ -49,3 +49,15 @@ SkMovie::SkMovie (const QString &fileName, const QByteArray &format)
 SkMovie::~SkMovie ()
 {
 }
+
+/**
+ * Returns the name of the temporary file containing the data, or an empty
+ * string if this SkMovie is empty
+ *
+ * The file exists as long as any copy of this SkMovie exists.
+ */
+QString SkMovie::getFileName () const
+{
+	if (!tempFile) return QString ();
+	return tempFile->fileName ();
+}
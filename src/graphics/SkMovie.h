@@ -30,7 +30,9 @@ class SkMovie
 
 		// Not a QSharedPointer because it may not be used after the SkMovie
 		// has been deleted.
-		QMovie *getMovie () { return movie.data (); }
+		QMovie *getMovie () const { return movie.data (); }
+
+		QString getFileName () const;
 
 	private:
 		QSharedPointer<QTemporaryFile> tempFile;
@@ -75,6 +75,7 @@
 #include "src/util/io.h" // remove
 #include "src/gui/views/SkItemDelegate.h"
 #include "src/i18n/notr.h"
+#include "src/logging/Trace.h"
 
 #include <iostream>
 #include <cassert>
@@ -411,6 +412,16 @@ void SkTableView::mousePressEvent (QMouseEvent *event)
 	//updateWidgetFocus (selectionModel ()->selectedIndexes ());
 }
 
+/**
+ * Paints the table; the span includes the data requests to the model for all
+ * visible cells
+ */
+void SkTableView::paintEvent (QPaintEvent *event)
+{
+	TRACE_SPAN ("SkTableView::paintEvent");
+	QTableView::paintEvent (event);
+}
+
 /**
  * Reads the column widths from the settings or uses defaults from a columnInfo
  *
@@ -75,6 +75,7 @@ class SkTableView: public QTableView
 		virtual void mouseDoubleClickEvent (QMouseEvent *event);
 		virtual void mousePressEvent (QMouseEvent *event);
 		virtual void keyPressEvent (QKeyEvent *e);
+		virtual void paintEvent (QPaintEvent *event);
 		void scrollLeft ();
 		void scrollRight ();
 
@@ -6,13 +6,20 @@
 #include <QPainter>
 #include <QRegExp>
 #include <QResizeEvent>
+#include <QTimer>
 
+#include "src/graphics/FrameScaler.h"
 #include "src/config/Settings.h" // TODO remove dependency, set from MainWindow
 #include "src/i18n/notr.h"
 
 
 WeatherWidget::WeatherWidget (QWidget *parent):
-	SkLabel (parent)
+	SkLabel (parent),
+	frameScaler (new FrameScaler ()),
+	frameTimer (new QTimer (this)),
+	resizeTimer (new QTimer (this)),
+	frameCache (maxCacheCost),
+	currentFrame (0)
 {
 	if (Settings::instance ().coloredLabels)
 	{
@@ -24,14 +31,28 @@ WeatherWidget::WeatherWidget (QWidget *parent):
 	setWordWrap (true);
 	setScaledContents (true);
 	setTextFormat (Qt::RichText);
+
+	frameTimer->setSingleShot (true);
+	connect (frameTimer, SIGNAL (timeout ()), this, SLOT (nextFrame ()));
+
+	// Don't create the frames for each intermediate size while the widget is
+	// being resized
+	resizeTimer->setSingleShot (true);
+	resizeTimer->setInterval (250);
+	connect (resizeTimer, SIGNAL (timeout ()), this, SLOT (requestFrames ()));
+
+	connect (frameScaler, SIGNAL (framesScaled (QString, QSize, AnimationFrames)),
+		this, SLOT (framesScaled (QString, QSize, AnimationFrames)));
 }
 
 WeatherWidget::~WeatherWidget ()
 {
+	delete frameScaler;
 }
 
 void WeatherWidget::setImage (const QImage &image)
 {
+	stopFrames ();
 	setWordWrap (false);
 	QPixmap pixmap=QPixmap::fromImage (image);
 	setPixmap (pixmap);
@@ -42,6 +63,7 @@ void WeatherWidget::setImage (const QImage &image)
 
 void WeatherWidget::setText (const QString &text)
 {
+	stopFrames ();
 	setWordWrap (true);
 	QLabel::setText (text);
 	adjustSize ();
@@ -66,6 +88,10 @@ void WeatherWidget::setMovie (SkMovie &movie)
 	// this SkMovie have been deleted. If there is an old file, this will
 	// probably happen right now.
 	newMovie=movie;
+
+	// The cached frames belong to the old movie
+	frameCache.clear ();
+	requestFrames ();
 }
 
 void WeatherWidget::mouseDoubleClickEvent (QMouseEvent *e)
@@ -77,5 +103,143 @@ void WeatherWidget::mouseDoubleClickEvent (QMouseEvent *e)
 void WeatherWidget::resizeEvent (QResizeEvent *e)
 {
 	QLabel::resizeEvent (e);
+
+	if (showingFrames ())
+	{
+		// Let QLabel scale the frames until the frames for the new size are
+		// available
+		setScaledContents (true);
+		resizeTimer->start ();
+	}
+	else if (showingMovie ())
+	{
+		resizeTimer->start ();
+	}
+
 	emit sizeChanged (e->size ());
 }
+
+
+// ******************
+// ** Frame replay **
+// ******************
+
+QString WeatherWidget::cacheKey (const QSize &size)
+{
+	return qnotr ("%1x%2").arg (size.width ()).arg (size.height ());
+}
+
+/**
+ * Determines whether the label currently displays the movie
+ *
+ * The contents of the label may have been replaced by a call to one of the
+ * QLabel or SkLabel methods.
+ */
+bool WeatherWidget::showingMovie () const
+{
+	return newMovie.getMovie () && movie ()==newMovie.getMovie ();
+}
+
+/**
+ * Determines whether the label currently displays one of the frames
+ */
+bool WeatherWidget::showingFrames () const
+{
+	if (frames.isEmpty () || !pixmap ()) return false;
+	return pixmap ()->cacheKey ()==frames.pixmaps[currentFrame].cacheKey ();
+}
+
+/**
+ * Plays the frames for the current size from the cache, or starts creating
+ * them if they are not cached
+ */
+void WeatherWidget::requestFrames ()
+{
+	if (!showingMovie () && !showingFrames ()) return;
+
+	QSize size=contentsRect ().size ();
+	if (size.isEmpty ()) return;
+
+	if (frameCache.contains (cacheKey (size)))
+		playFrames (*frameCache.object (cacheKey (size)));
+	else
+		frameScaler->scale (newMovie.getFileName (), size);
+}
+
+void WeatherWidget::framesScaled (QString fileName, QSize size, AnimationFrames scaledFrames)
+{
+	// Ignore the frames if the movie or the size changed in the meantime, or
+	// if something else is displayed now
+	if (fileName!=newMovie.getFileName ()) return;
+	if (size!=contentsRect ().size ()) return;
+	if (!showingMovie () && !showingFrames ()) return;
+
+	scaledFrames.convertToPixmaps ();
+	frameCache.insert (cacheKey (size), new AnimationFrames (scaledFrames), scaledFrames.byteCount ()/1024);
+
+	playFrames (scaledFrames);
+}
+
+/**
+ * Replaces the movie with the frames, continuing with the frame the movie or
+ * the previous frames are currently showing
+ */
+void WeatherWidget::playFrames (const AnimationFrames &newFrames)
+{
+	if (newFrames.isEmpty ()) return;
+
+	int frameNumber=currentFrame;
+	if (showingMovie ())
+	{
+		frameNumber=newMovie.getMovie ()->currentFrameNumber ();
+		newMovie.getMovie ()->stop ();
+		SkLabel::setMovie (NULL);
+	}
+
+	frames=newFrames;
+	currentFrame=qBound (0, frameNumber, frames.size ()-1);
+
+	// The frames already have the size of the widget
+	setScaledContents (false);
+	setPixmap (frames.pixmaps[currentFrame]);
+
+	frameTimer->start (frameDelay (currentFrame));
+}
+
+void WeatherWidget::nextFrame ()
+{
+	// Stop if something else is displayed now
+	if (!showingFrames ())
+	{
+		stopFrames ();
+		return;
+	}
+
+	currentFrame=(currentFrame+1)%frames.size ();
+	setPixmap (frames.pixmaps[currentFrame]);
+
+	frameTimer->start (frameDelay (currentFrame));
+}
+
+/**
+ * Returns the time to display a frame, in milliseconds, taking the speed of
+ * the movie into account like QMovie does
+ */
+int WeatherWidget::frameDelay (int frame) const
+{
+	int delay=frames.delays[frame];
+
+	int speed=newMovie.getMovie ()->speed ();
+	if (speed>0) delay=delay*100/speed;
+
+	return qMax (delay, 10);
+}
+
+void WeatherWidget::stopFrames ()
+{
+	frameTimer->stop ();
+	resizeTimer->stop ();
+	frames=AnimationFrames ();
+	currentFrame=0;
+	setScaledContents (true);
+}
@@ -3,14 +3,29 @@
 
 #include <QPixmap>
 #include <QImageReader>
+#include <QCache>
 
 #include "src/graphics/SkMovie.h"
+#include "src/graphics/AnimationFrames.h"
 #include "src/gui/widgets/SkLabel.h"
 
 class QImage;
 class QMovie;
 class QTemporaryFile;
+class QTimer;
+class FrameScaler;
 
+/**
+ * A label for displaying the output of a weather plugin
+ *
+ * Animations are first played as a QMovie, which decodes and scales each frame
+ * every time it is displayed. In the background, the frames are decoded and
+ * scaled to the size of the widget once (see FrameScaler). As soon as they are
+ * available, the animation is replayed from these frames. The frames for
+ * recently used sizes are kept in a cache, limited to maxCacheCost kilobytes,
+ * so the frames are only created again when the size of the widget changes to
+ * a new size.
+ */
 class WeatherWidget:public SkLabel
 {
 	Q_OBJECT
@@ -32,8 +47,32 @@ class WeatherWidget:public SkLabel
 		virtual void mouseDoubleClickEvent (QMouseEvent *e);
 		virtual void resizeEvent (QResizeEvent *);
 
+	protected slots:
+		void requestFrames ();
+		void framesScaled (QString fileName, QSize size, AnimationFrames frames);
+		void nextFrame ();
+
 	private:
+		// The maximum memory used by the cached frames, in kilobytes
+		static const int maxCacheCost=64*1024;
+		static QString cacheKey (const QSize &size);
+
+		bool showingMovie () const;
+		bool showingFrames () const;
+		int frameDelay (int frame) const;
+		void playFrames (const AnimationFrames &frames);
+		void stopFrames ();
+
 		SkMovie newMovie;
+
+		FrameScaler *frameScaler;
+		QTimer *frameTimer;
+		QTimer *resizeTimer;
+
+		// The frames of newMovie for different sizes
+		QCache<QString, AnimationFrames> frameCache;
+		AnimationFrames frames;
+		int currentFrame;
 };
 
 #endif
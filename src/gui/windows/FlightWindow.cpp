@@ -1637,6 +1637,13 @@ dbId FlightWindow::determineAndEnterPerson (bool active, QString lastName, QStri
 
 void FlightWindow::cacheChanged (DbEvent event)
 {
+	if (event.getType ()==DbEvent::typeBatch)
+	{
+		foreach (const DbEvent &batchEvent, event.getEvents ())
+			cacheChanged (batchEvent);
+		return;
+	}
+
 	if (mode==modeEdit && event.hasTable<Flight> () && event.getId ()==originalFlightId)
 	{
 		// The flight we are currently editing...
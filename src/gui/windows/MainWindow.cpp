@@ -26,6 +26,9 @@
 #include <QStatusBar>
 #include <QCloseEvent>
 #include <QScrollBar>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSet>
 #include <QWidget> // remove
 
 // TODO many dependencies - split
@@ -55,6 +58,7 @@
 #include "src/plugin/info/InfoPlugin.h"
 #include "src/plugin/weather/WeatherPlugin.h"
 #include "src/plugin/factory/PluginFactory.h"
+#include "src/plugin/PluginHost.h"
 #include "src/statistics/LaunchMethodStatistics.h"
 #include "src/statistics/PilotLog.h"
 #include "src/statistics/PlaneLog.h"
@@ -65,9 +69,13 @@
 #include "src/util/qDate.h"
 #include "src/concurrent/monitor/OperationCanceledException.h"
 #include "src/db/cache/Cache.h"
+#include "src/db/interface/QueryProfiler.h"
+#include "src/net/LinkHealth.h"
+#include "src/net/TcpProxy.h"
 #include "src/text.h"
 #include "src/i18n/TranslationManager.h"
 #include "src/version.h"
+#include "src/logging/Trace.h"
 
 template <class T> class MutableObjectList;
 
@@ -206,6 +214,7 @@ MainWindow::MainWindow (QWidget *parent):
 
 	connect (&dbManager, SIGNAL (readTimeout ()), this, SLOT (readTimeout ()));
 	connect (&dbManager, SIGNAL (readResumed ()), this, SLOT (readResumed ()));
+	connect (&dbManager, SIGNAL (journalConflicts (QStringList)), this, SLOT (journalConflicts (QStringList)));
 
 	connect (&dbManager, SIGNAL (stateChanged (DbManager::State)), this, SLOT (databaseStateChanged (DbManager::State)));
 	databaseStateChanged (dbManager.getState ());
@@ -224,6 +233,9 @@ MainWindow::~MainWindow ()
 	// TODO make sure this also applies to flightList
 
 	terminatePlugins ();
+
+	// Join the plugin worker threads while the application still exists
+	PluginHost::destroyInstance ();
 }
 
 void MainWindow::setupLabels ()
@@ -292,8 +304,6 @@ void MainWindow::setupLayout ()
 
 void MainWindow::setupPlugin (InfoPlugin *plugin, QGridLayout *pluginLayout)
 {
-	connect (this, SIGNAL (minuteChanged ()), plugin, SLOT (minuteChanged ()));
-
 	SkLabel *captionLabel = new SkLabel ("", ui.pluginPane);
 	SkLabel *valueLabel = new SkLabel (notr ("..."), ui.pluginPane);
 
@@ -317,12 +327,15 @@ void MainWindow::setupPlugin (InfoPlugin *plugin, QGridLayout *pluginLayout)
 		valueLabel ->setAutoFillBackground (true);
 	}
 
+	// The plugin may run on a worker thread; the text output is queued to the
+	// GUI thread automatically.
 	connect (plugin, SIGNAL (textOutput (QString, Qt::TextFormat)), valueLabel, SLOT (setText (QString, Qt::TextFormat)));
 
-	QObject::connect (captionLabel, SIGNAL (doubleClicked (QMouseEvent *)), plugin, SLOT (restart ()));
-	QObject::connect (valueLabel, SIGNAL (doubleClicked (QMouseEvent *)), plugin, SLOT (restart ()));
-
-	plugin->start ();
+	PluginHost &host=PluginHost::instance ();
+	host.add (plugin);
+	host.addRestartTrigger (captionLabel, SIGNAL (doubleClicked (QMouseEvent *)), plugin);
+	host.addRestartTrigger (valueLabel, SIGNAL (doubleClicked (QMouseEvent *)), plugin);
+	host.start (plugin);
 }
 
 void MainWindow::setupPlugins ()
@@ -351,6 +364,7 @@ void MainWindow::setupPlugins ()
 
 	ui.pluginPane->setVisible (!infoPlugins.isEmpty ());
 
+	connect (this, SIGNAL (minuteChanged ()), &PluginHost::instance (), SLOT (minuteChanged ()), Qt::UniqueConnection);
 	foreach (InfoPlugin *plugin, infoPlugins)
 		if (plugin->isEnabled ())
 			setupPlugin (plugin, pluginLayout);
@@ -394,7 +408,8 @@ void MainWindow::terminatePlugins ()
 	foreach (InfoPlugin *plugin, infoPlugins)
 	{
 		//std::cout << "Terminating plugin " << plugin->get_caption () << std::endl;
-		plugin->terminate ();
+		// Terminates the plugin and moves it back to the GUI thread
+		PluginHost::instance ().remove (plugin);
 		QThread::yieldCurrentThread ();
 	}
 
@@ -414,11 +429,10 @@ void MainWindow::restartPlugins ()
 	if (weatherPlugin) weatherPlugin->restart ();
 	if (weatherDialog) weatherDialog->restartPlugin ();
 
+	// The info plugins may run on worker threads; only the host may access
+	// them.
 	foreach (InfoPlugin *plugin, infoPlugins)
-	{
-		plugin->terminate ();
-		plugin->start ();
-	}
+		PluginHost::instance ().restart (plugin);
 }
 
 
@@ -546,8 +560,6 @@ void MainWindow::settingsChanged ()
 	ui.changeLanguageAction          ->setEnabled (s.enableDebug);
 	ui.timerBasedLanguageChangeAction->setEnabled (s.enableDebug);
 
-	ui.actionNetworkDiagnostics     ->setVisible (!isBlank (s.diagCommand));
-
 	// Plugins
 	setupPlugins ();
 }
@@ -582,6 +594,8 @@ void MainWindow::updateDisplayDateLabel (const QDate &today)
  */
 void MainWindow::refreshFlights ()
 {
+	TRACE_SPAN ("MainWindow::refreshFlights");
+
 	// Fetch the current date to avoid it changing during the operation
 	// TODO time zone safety: should be local today
 	QDate today=QDate::currentDate ();
@@ -762,6 +776,14 @@ void MainWindow::flightListChanged ()
 
 void MainWindow::updateFlight (const Flight &flight)
 {
+	// Departures and landings are displayed immediately and written in the
+	// background
+	if (Settings::instance ().optimisticUpdates)
+	{
+		dbManager.updateFlightOptimistic (flight);
+		return;
+	}
+
 	try
 	{
 		dbManager.updateObject (flight, this);
@@ -1003,6 +1025,27 @@ void MainWindow::on_actionEdit_triggered ()
 
 	if (idInvalid (id)) return;
 
+	// A change of the flight could not be written (see
+	// DbManager::updateFlightOptimistic)
+	if (dbManager.getCache ().getFlightConflict (id, NULL))
+	{
+		QMessageBox::StandardButton answer=yesNoCancelQuestion (this, tr ("Change not written"),
+			tr ("The last change of this flight could not be written to the database"
+			" and has been reverted. Write the change again?\n\n"
+			"Select \"No\" to discard the change and edit the flight as it is in"
+			" the database."));
+
+		if (answer==QMessageBox::Yes)
+		{
+			dbManager.resolveFlightConflict (id, true);
+			return;
+		}
+		else if (answer==QMessageBox::No)
+			dbManager.resolveFlightConflict (id, false);
+		else
+			return;
+	}
+
 	try
 	{
 		Flight flight = dbManager.getCache ().getObject<Flight> (id);
@@ -1318,12 +1361,41 @@ void MainWindow::on_actionInfo_triggered ()
 void MainWindow::on_actionNetworkDiagnostics_triggered ()
 {
 	QString command=Settings::instance ().diagCommand;
-	if (isBlank (command)) return;
+	QueryProfiler &profiler=QueryProfiler::instance ();
+
+	LinkHealth &linkHealth=LinkHealth::instance ();
+
+	// Show the link health and the query profile; the details contain the
+	// full report.
+	QMessageBox messageBox (QMessageBox::Information, tr ("Network diagnostics"),
+		tr ("Connection quality: %1\n\nThe details contain the connection statistics, the query profile and the slow query log.")
+		.arg (LinkHealth::qualityText (linkHealth.quality ())),
+		QMessageBox::Close, this);
+	messageBox.setDetailedText (linkHealth.report ()+notr ("\n")+TcpProxy::statisticsReport ()
+		+notr ("\n")+dbManager.getCache ().getDateStatistics ().toString ()
+		+notr ("\n\n")+profiler.report ());
+
+	QPushButton *resetButton=messageBox.addButton (tr ("&Reset profile"), QMessageBox::ResetRole);
+	QPushButton *commandButton=NULL;
+	if (!isBlank (command))
+		commandButton=messageBox.addButton (tr ("Run &diagnostics command"), QMessageBox::ActionRole);
+
+	messageBox.exec ();
 
-	// TODO: use QProcess and make sure it's in the background
-	if (system (command.toUtf8 ().constData ())!=0)
-		showWarning (tr ("Error"),
-			tr ("An error occured while executing the network diagnostics command."), this);
+	if (messageBox.clickedButton ()==resetButton)
+	{
+		profiler.reset ();
+		linkHealth.reset ();
+		TcpProxy::resetAllStatistics ();
+		dbManager.getCache ().resetDateStatistics ();
+	}
+	else if (commandButton && messageBox.clickedButton ()==commandButton)
+	{
+		// TODO: use QProcess and make sure it's in the background
+		if (system (command.toUtf8 ().constData ())!=0)
+			showWarning (tr ("Error"),
+				tr ("An error occured while executing the network diagnostics command."), this);
+	}
 }
 
 // ************
@@ -1466,20 +1538,35 @@ void MainWindow::timeTimer_timeout ()
 	// Some things are done on the beginning of a new minute.
 	if (second<lastSecond)
 	{
-		QModelIndex oldIndex=ui.flightTable->currentIndex ();
-		QPersistentModelIndex focusWidgetIndex=ui.flightTable->findButton (
-			dynamic_cast<TableButton *> (QApplication::focusWidget ()));
+		// Only the durations of flights (and towflights) which have not landed
+		// yet change with the time.
+		QList<int> runningRows;
+		int numRows=proxyList->size ();
+		for (int row=0; row<numRows; ++row)
+			if (proxyList->at (row).durationRunning ())
+				runningRows.append (row);
 
-		int durationColumn=flightModel->durationColumn ();
-		flightListModel->columnChanged (durationColumn);
+		if (!runningRows.isEmpty ())
+		{
+			QModelIndex oldIndex=ui.flightTable->currentIndex ();
+			QPersistentModelIndex focusWidgetIndex=ui.flightTable->findButton (
+				dynamic_cast<TableButton *> (QApplication::focusWidget ()));
 
-		ui.flightTable->setCurrentIndex (oldIndex);
-		ui.flightTable->focusWidgetAt (focusWidgetIndex);
+			int durationColumn=flightModel->durationColumn ();
+			flightListModel->columnChanged (durationColumn, runningRows);
+
+			ui.flightTable->setCurrentIndex (oldIndex);
+			ui.flightTable->focusWidgetAt (focusWidgetIndex);
+		}
 
 		emit minuteChanged ();
 	}
 
 	lastSecond=second;
+
+	// The link quality changes with every query, so update it regularly
+	ui.databaseStateLabel->setToolTip (tr ("Connection quality: %1")
+		.arg (LinkHealth::qualityText (LinkHealth::instance ().quality ())));
 }
 
 void MainWindow::weatherWidget_doubleClicked ()
@@ -1582,7 +1669,7 @@ void MainWindow::setDisplayDate (QDate newDisplayDate, bool force)
 		{
 			// If the new displayed date is not in the cache, fetch it.
 			// TODO move that to fetchFlights() (with force flag)
-			if (newDisplayDate!=dbManager.getCache ().getOtherDate ())
+			if (!dbManager.getCache ().selectOtherDate (newDisplayDate))
 				dbManager.fetchFlights (newDisplayDate, this);
 
 			// Now the displayed date is the one in the cache (which should be
@@ -1595,6 +1682,11 @@ void MainWindow::setDisplayDate (QDate newDisplayDate, bool force)
 		}
 	}
 
+	// Fetch the surrounding dates in the background, so they can be
+	// displayed without waiting for the database
+	if (dbManager.getState ()==DbManager::stateConnected)
+		dbManager.prefetchFlights (displayDate);
+
 	// Update the display
 	refreshFlights ();
 }
@@ -1757,6 +1849,9 @@ void MainWindow::cacheChanged (DbEvent event)
 				case DbEvent::typeDelete:
 					flightList->removeById (event.getId ());
 					break;
+				case DbEvent::typeBatch:
+					applyFlightBatch (event.getEvents ());
+					break;
 			}
 		}
 	}
@@ -1769,6 +1864,63 @@ void MainWindow::cacheChanged (DbEvent event)
 	int numFlights=flightList->size ();
 	for (int i=0; i<numFlights; ++i)
 		flightList->at (i).databaseChanged (event);
+
+	// Changes of flights are reported by the flight list; other changes may
+	// affect the flights' errors.
+	if (!event.hasTable<Flight> ())
+		proxyModel->invalidateFlightData ();
+}
+
+/**
+ * Applies the flight changes of a batch event to the flight list
+ *
+ * Adjacent changes which keep or add a flight in the list are applied
+ * together, as are adjacent changes which remove a flight from the list, so
+ * the list emits a few range signals instead of one signal per flight.
+ *
+ * Unlike for a single added flight, the display date is not reset for flights
+ * added in a batch.
+ */
+void MainWindow::applyFlightBatch (const QList<DbEvent> &events)
+{
+	QList<Flight> flights;
+	QSet<dbId> ids;
+
+	foreach (const DbEvent &event, events)
+	{
+		bool remove=true;
+		if (event.getType ()==DbEvent::typeAdd || event.getType ()==DbEvent::typeChange)
+		{
+			Flight flight=event.getValue<Flight> ();
+			if (flight.isPrepared () || flight.effdatum ()==displayDate)
+			{
+				flightList->removeByIds (ids);
+				ids.clear ();
+				flights.append (flight);
+				remove=false;
+			}
+		}
+		else if (event.getType ()==DbEvent::typeBatch)
+		{
+			flightList->removeByIds (ids);
+			ids.clear ();
+			flightList->replaceOrAddList (flights);
+			flights.clear ();
+			applyFlightBatch (event.getEvents ());
+			remove=false;
+		}
+
+		if (remove)
+		{
+			flightList->replaceOrAddList (flights);
+			flights.clear ();
+			ids.insert (event.getId ());
+		}
+	}
+
+	// At most one of them is not empty
+	flightList->removeByIds (ids);
+	flightList->replaceOrAddList (flights);
 }
 
 void MainWindow::updateDatabaseStateLabel (DbManager::State state)
@@ -1842,6 +1994,22 @@ void MainWindow::readResumed ()
 {
 	ui.databaseStateLabel->resetDefaultForegroundColor ();
 	ui.databaseStateLabel->setText (databaseOkText);
+
+	// Write the changes made while the connection was down. The connection
+	// may return while a monitor dialog is open, so we don't show another
+	// one.
+	dbManager.replayJournalInBackground ();
+}
+
+void MainWindow::journalConflicts (QStringList conflicts)
+{
+	// Don't block the GUI (we may be in another dialog's event loop)
+	QMessageBox *messageBox=new QMessageBox (QMessageBox::Warning, tr ("Conflicting changes"),
+		tr ("Some of the changes made while the connection was down conflict"
+		" with changes by other users:\n\n%1").arg (conflicts.join (notr ("\n"))),
+		QMessageBox::Ok, this);
+	messageBox->setAttribute (Qt::WA_DeleteOnClose);
+	messageBox->show ();
 }
 
 
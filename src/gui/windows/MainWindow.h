@@ -89,6 +89,7 @@ class MainWindow: public SkMainWindow<Ui::MainWindowClass>
 		void setDisplayDate (QDate displayDate, bool force);
 		void setDisplayDateCurrent (bool force) { setDisplayDate (QDate::currentDate (), force); }
 		void updateFlight (const Flight &flight);
+		void applyFlightBatch (const QList<DbEvent> &events);
 
 		dbId currentFlightId (bool *isTowflight=NULL);
 		bool selectFlight (dbId id, bool selectTowflight, int column);
@@ -127,6 +128,7 @@ class MainWindow: public SkMainWindow<Ui::MainWindowClass>
 		void databaseStateChanged (DbManager::State state);
 		void readTimeout ();
 		void readResumed ();
+		void journalConflicts (QStringList conflicts);
 
 		void migrationStarted () { oldLogVisible=ui.logDockWidget->isVisible (); ui.logDockWidget->setVisible (true); }
 		void migrationEnded () { ui.logDockWidget->setVisible (oldLogVisible); }
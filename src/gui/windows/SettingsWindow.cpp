@@ -62,8 +62,6 @@ SettingsWindow::SettingsWindow (QWidget *parent):
 	prepareText ();
 	setupText ();
 
-	ui.dbTypePane->setVisible (false);
-
 	ui.languageInput->setSizeAdjustPolicy (QComboBox::AdjustToContents);
 	ui.languageInput->setLanguageItems (TranslationManager::instance ().listLanguages ());
 
@@ -95,6 +93,10 @@ void SettingsWindow::prepareText ()
 	weatherPlugins=PluginFactory::getInstance ().getDescriptors<WeatherPlugin> ();
 	qSort (weatherPlugins.begin (), weatherPlugins.end (), WeatherPlugin::Descriptor::nameLessThanP);
 
+	// Database types
+	ui.dbTypeInput->addItem ("", (int)DatabaseInfo::typeMysql);
+	ui.dbTypeInput->addItem ("", (int)DatabaseInfo::typeSqlite);
+
 	// Weather plugin lists
 	ui.weatherPluginInput      ->addItem (notr ("-"), QString ());
 	ui.weatherWindowPluginInput->addItem (notr ("-"), QString ());
@@ -116,6 +118,10 @@ void SettingsWindow::setupText ()
 		" the configuration file or registry key %1.")
 		.arg (QSettings ().fileName ()));
 
+	// Database types
+	ui.dbTypeInput->setItemText (ui.dbTypeInput->findData ((int)DatabaseInfo::typeMysql ), tr ("MySQL server"));
+	ui.dbTypeInput->setItemText (ui.dbTypeInput->findData ((int)DatabaseInfo::typeSqlite), tr ("Local SQLite database"));
+
 	// Weather plugin lists
 	foreach (const WeatherPlugin::Descriptor *descriptor, weatherPlugins)
 	{
@@ -155,6 +161,7 @@ void SettingsWindow::readSettings ()
 	DatabaseInfo &info=s.databaseInfo;
 
 	// *** Database
+	ui.dbTypeInput             ->setCurrentIndex (ui.dbTypeInput->findData ((int)info.type));
 	ui.mysqlServerInput        ->setText    (info.server);
 	ui.mysqlDefaultPortCheckBox->setChecked (info.defaultPort);
 	ui.mysqlPortInput          ->setValue   (info.port);
@@ -169,6 +176,7 @@ void SettingsWindow::readSettings ()
 	ui.locationInput         ->setText    (s.location);
 	ui.recordTowpilotCheckbox->setChecked (s.recordTowpilot);
 	ui.checkMedicalsCheckbox ->setChecked (s.checkMedicals);
+	ui.optimisticUpdatesCheckbox->setChecked (s.optimisticUpdates);
 	// Permissions
 	ui.protectSettingsCheckbox      ->setChecked (s.protectSettings);
 	ui.protectLaunchMethodsCheckbox ->setChecked (s.protectLaunchMethods);
@@ -232,6 +240,7 @@ void SettingsWindow::writeSettings ()
 	DatabaseInfo oldInfo=info;
 
 	// *** Database
+	info.type       =(DatabaseInfo::Type)ui.dbTypeInput->itemData (ui.dbTypeInput->currentIndex ()).toInt ();
 	info.server     =ui.mysqlServerInput        ->text ();
 	info.defaultPort=ui.mysqlDefaultPortCheckBox->isChecked ();
 	info.port       =ui.mysqlPortInput          ->value ();
@@ -246,6 +255,7 @@ void SettingsWindow::writeSettings ()
 	s.location      =ui.locationInput         ->text ();
 	s.recordTowpilot=ui.recordTowpilotCheckbox->isChecked ();
 	s.checkMedicals =ui.checkMedicalsCheckbox ->isChecked ();
+	s.optimisticUpdates=ui.optimisticUpdatesCheckbox->isChecked ();
 	// Permissions
 	s.protectSettings      =ui.protectSettingsCheckbox      ->isChecked ();
 	s.protectLaunchMethods =ui.protectLaunchMethodsCheckbox ->isChecked ();
@@ -638,6 +648,14 @@ void SettingsWindow::on_languageInput_activated (int index)
 }
 void SettingsWindow::updateWidgets ()
 {
-	ui.mysqlPortInput->setEnabled (!ui.mysqlDefaultPortCheckBox->isChecked ());
+	// For SQLite, only the database name (which specifies the file) is used
+	int typeData=ui.dbTypeInput->itemData (ui.dbTypeInput->currentIndex ()).toInt ();
+	bool mysql=(typeData==(int)DatabaseInfo::typeMysql);
+
+	ui.mysqlServerInput        ->setEnabled (mysql);
+	ui.mysqlDefaultPortCheckBox->setEnabled (mysql);
+	ui.mysqlPortInput          ->setEnabled (mysql && !ui.mysqlDefaultPortCheckBox->isChecked ());
+	ui.mysqlUserInput          ->setEnabled (mysql);
+	ui.mysqlPasswordInput      ->setEnabled (mysql);
 }
 
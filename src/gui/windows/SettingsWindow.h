@@ -42,6 +42,7 @@ class SettingsWindow: public SkDialog<Ui::SettingsWindowClass>
 
 	private slots:
 		void on_mysqlDefaultPortCheckBox_toggled () { updateWidgets (); }
+		void on_dbTypeInput_activated () { updateWidgets (); }
 
 		void on_languageInput_activated (int index);
 
@@ -18,6 +18,7 @@
 #include <QSortFilterProxyModel>
 #include <QKeyEvent>
 #include <QPushButton>
+#include <QSet>
 
 #include "src/gui/windows/objectEditor/ObjectEditorWindow.h"
 #include "src/model/objectList/ObjectListModel.h"
@@ -235,53 +236,76 @@ template<class T> int ObjectListWindow<T>::editObject (const T &object)
 }
 
 /**
+ * Deletes an object, or shows a message if the object is in use
  *
- * @param id
+ * An object which was not in use when it was checked may have been used in
+ * the meantime (e. g. while the user confirmed the deletion), so it is
+ * checked again right before deleting it.
+ *
+ * @param object the object to delete
+ * @param objectUsed whether the object is in use, as determined by
+ *                   DbManager::usedObjects
  * @return false if canceled
  */
-template<class T> bool ObjectListWindow<T>::checkAndDelete (const T &object)
+/**
+ * Tells the user that an object is in use and cannot be deleted
+ *
+ * @return true to continue with the next object, false to cancel
+ */
+template<class T> bool ObjectListWindow<T>::showObjectUsed (const T &object)
+{
+	QString title=firstToUpper (
+		qApp->translate ("ObjectListWindow<T>", "%1 in use")
+			.arg (T::objectTypeDescription ()));
+	QString text=firstToUpper (
+		qApp->translate ("ObjectListWindow<T>", "%1 %2 is in use and cannot be deleted.")
+			.arg (T::objectTypeDescriptionDefinite (), object.getDisplayName ()));
+
+	QMessageBox::StandardButtons buttons=QMessageBox::Ok;
+
+	if (QMessageBox::critical (this, title, text, buttons, QMessageBox::Ok)==QMessageBox::Ok)
+		// Continue
+		return true;
+	else
+		// Canceled
+		return false;
+}
+
+/**
+ * Deletes the objects the user confirmed the deletion of
+ *
+ * Another station may have started using one of the objects while the user
+ * was answering the questions, so all objects are checked again, with a
+ * single query, right before deleting them with a single operation. Objects
+ * which are now in use are reported and not deleted.
+ *
+ * @param objects the objects selected for deletion
+ * @param ids the IDs of the objects to delete
+ */
+template<class T> void ObjectListWindow<T>::deleteConfirmed (const QList<T> &objects, QList<dbId> ids)
 {
-	bool objectUsed=true;
+	if (ids.isEmpty ())
+		return;
 
 	try
 	{
-		objectUsed=manager.objectUsed<T> (object.getId (), this);
-	}
-	catch (OperationCanceledException &)
-	{
-		return false;
-	}
+		QSet<dbId> usedIds=manager.usedObjects<T> (ids, this);
 
-	if (objectUsed)
-	{
-		QString title=firstToUpper (
-			qApp->translate ("ObjectListWindow<T>", "%1 in use")
-				.arg (T::objectTypeDescription ()));
-		QString text=firstToUpper (
-			qApp->translate ("ObjectListWindow<T>", "%1 %2 is in use and cannot be deleted.")
-				.arg (T::objectTypeDescriptionDefinite (), object.getDisplayName ()));
-
-		QMessageBox::StandardButtons buttons=QMessageBox::Ok;
-
-		if (QMessageBox::critical (this, title, text, buttons, QMessageBox::Ok)==QMessageBox::Ok)
-			// Continue
-			return true;
-		else
-			// Canceled
-			return false;
-	}
-	else
-	{
-		try
+		foreach (const T &object, objects)
 		{
-			manager.deleteObject<T> (object.getId (), this);
-			return true;
-		}
-		catch (OperationCanceledException &)
-		{
-			// TODO the cache may now be inconsistent
-			return false;
+			if (ids.contains (object.getId ()) && usedIds.contains (object.getId ()))
+			{
+				ids.removeAll (object.getId ());
+				showObjectUsed (object);
+			}
 		}
+
+		if (!ids.isEmpty ())
+			manager.deleteObjects<T> (ids, this);
+	}
+	catch (OperationCanceledException &)
+	{
+		// TODO the cache may now be inconsistent
 	}
 }
 
@@ -305,10 +329,38 @@ template<class T> void ObjectListWindow<T>::on_actionDelete_triggered ()
 	//   - the first (top) one selected (they may be selected out of order)
 	QModelIndex previousIndex=ui.table->currentIndex ();
 
+	// Determine which of the objects are in use with a single check for all
+	// objects instead of one check per object
+	QList<dbId> ids;
+	foreach (const T &object, objects)
+		ids.append (object.getId ());
+
+	QSet<dbId> usedIds;
+	try
+	{
+		usedIds=manager.usedObjects<T> (ids, this);
+	}
+	catch (OperationCanceledException &)
+	{
+		return;
+	}
+
+	// The objects are deleted after all questions have been answered
+	QList<dbId> confirmedIds;
+
 	for (int i=0; i<objects.size (); ++i)
 	{
 		const T &object=objects.at (i);
 
+		// Objects in use cannot be deleted, so don't ask
+		if (usedIds.contains (object.getId ()))
+		{
+			if (!showObjectUsed (object))
+				break;
+
+			continue;
+		}
+
 		QString title=qApp->translate ("ObjectListWindow<T>", "Delete %1?").arg (T::objectTypeDescription ());
 		QString question=qApp->translate ("ObjectListWindow<T>", "Do you want to delete %1 %2?").arg (T::objectTypeDescriptionDefinite (), object.getDisplayName ());
 
@@ -331,8 +383,7 @@ template<class T> void ObjectListWindow<T>::on_actionDelete_triggered ()
 
 		if (confirmDelete)
 		{
-			if (!checkAndDelete (object))
-				break;
+			confirmedIds.append (object.getId ());
 		}
 		else if (cancel)
 		{
@@ -341,6 +392,8 @@ template<class T> void ObjectListWindow<T>::on_actionDelete_triggered ()
 		// else: No
 	}
 
+	deleteConfirmed (objects, confirmedIds);
+
 	// Don't make any change if there are still selected rows
 	if (!ui.table->selectionModel ()->hasSelection ())
 	{
@@ -53,7 +53,8 @@ template <class T> class ObjectListWindow: public ObjectListWindowBase
 
 	private:
 		void appendObjectTo (QList<T> &list, const QModelIndex &tableIndex);
-		bool checkAndDelete (const T &object);
+		bool showObjectUsed (const T &object);
+		void deleteConfirmed (const QList<T> &objects, QList<dbId> ids);
 		void setupText ();
 
 		MutableObjectList<T> *list;
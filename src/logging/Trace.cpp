@@ -0,0 +1,281 @@
+#include "Trace.h"
+
+#ifdef SK_TRACE
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QThread>
+
+#include "src/concurrent/synchronized.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+/*
+ * The events are written in the JSON array format: an opening bracket
+ * followed by one object per event. The closing bracket is optional, so the
+ * trace can still be read if the program crashes.
+ *
+ * Each span is written as a complete event ("X"). A hop between threads is
+ * written as a flow ("s" on the sending thread, "f" on the receiving thread),
+ * which is shown as an arrow, and an asynchronous event ("b"/"e") for the
+ * time the operation was queued, which does not have to nest with the spans
+ * of the receiving thread.
+ *
+ * Timestamps are in microseconds since the start of the trace.
+ */
+
+Trace *Trace::theInstance=NULL;
+
+// **********
+// ** Span **
+// **********
+
+Trace::Span::Span (const char *name):
+	name (name), start (Trace::instance ().now ())
+{
+}
+
+Trace::Span::~Span ()
+{
+	Trace &trace=Trace::instance ();
+	trace.complete (name, start, trace.now ());
+}
+
+
+// ******************
+// ** Construction **
+// ******************
+
+Trace::Trace ():
+	empty (true), pid (QCoreApplication::applicationPid ()), lastFlowId (0)
+{
+	timer.start ();
+}
+
+Trace::~Trace ()
+{
+	stop ();
+}
+
+/**
+ * Returns the only instance, creating it on first use
+ *
+ * The instance is created by TRACE_START in main, before any other threads
+ * are started.
+ */
+Trace &Trace::instance ()
+{
+	if (!theInstance)
+		theInstance=new Trace ();
+
+	return *theInstance;
+}
+
+
+// *************
+// ** Control **
+// *************
+
+/**
+ * Opens the trace file; events are only recorded after this method has been
+ * called
+ */
+void Trace::start ()
+{
+	synchronized (mutex)
+	{
+		if (file.isOpen ()) return;
+
+		QString fileName=qnotr ("startkladde-trace-%1-%2.json")
+			.arg (QDateTime::currentDateTime ().toString (notr ("yyyyMMdd-hhmmss")))
+			.arg (pid);
+		file.setFileName (QDir::temp ().filePath (fileName));
+
+		if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			std::cout << qnotr ("Cannot open trace file %1: %2").arg (file.fileName (), file.errorString ()) << std::endl;
+			return;
+		}
+
+		std::cout << qnotr ("Writing trace to %1").arg (file.fileName ()) << std::endl;
+		file.write ("[");
+		empty=true;
+	}
+}
+
+/**
+ * Writes the remaining events and closes the trace file
+ */
+void Trace::stop ()
+{
+	synchronized (mutex)
+	{
+		if (!file.isOpen ()) return;
+
+		flush ();
+		file.write ("\n]\n");
+		file.close ();
+
+		threadIds.clear ();
+		hops.clear ();
+	}
+}
+
+
+// ************
+// ** Events **
+// ************
+
+qint64 Trace::now () const
+{
+	return timer.nsecsElapsed ()/1000;
+}
+
+void Trace::complete (const char *name, qint64 start, qint64 end)
+{
+	synchronized (mutex)
+	{
+		if (!file.isOpen ()) return;
+
+		append (QByteArray ("{\"name\":\"")+name+"\",\"cat\":\"span\",\"ph\":\"X\""
+			",\"ts\":"+QByteArray::number (start)+
+			",\"dur\":"+QByteArray::number (end-start)+
+			",\"pid\":"+QByteArray::number (pid)+
+			",\"tid\":"+QByteArray::number (threadId ())+"}");
+	}
+}
+
+/**
+ * Records that the operation identified by key is queued for another thread
+ */
+void Trace::enqueued (const void *key, const char *name)
+{
+	qint64 time=now ();
+
+	synchronized (mutex)
+	{
+		if (!file.isOpen ()) return;
+
+		discardStaleHops (key, time);
+
+		Hop hop;
+		hop.name=name;
+		hop.time=time;
+		hop.flowId=++lastFlowId;
+		hops.insert (key, hop);
+
+		append (QByteArray ("{\"name\":\"")+name+"\",\"cat\":\"hop\",\"ph\":\"s\""
+			",\"id\":"+QByteArray::number (hop.flowId)+
+			",\"ts\":"+QByteArray::number (time)+
+			",\"pid\":"+QByteArray::number (pid)+
+			",\"tid\":"+QByteArray::number (threadId ())+"}");
+	}
+}
+
+/**
+ * Records that the operation identified by key has been taken from the queue
+ * by the current thread; does nothing if the operation has not been recorded
+ * by #enqueued
+ */
+void Trace::dequeued (const void *key)
+{
+	qint64 time=now ();
+
+	synchronized (mutex)
+	{
+		if (!file.isOpen ()) return;
+		if (!hops.contains (key)) return;
+
+		Hop hop=hops.take (key);
+
+		// The key has been reused by an operation which was not recorded
+		if (time-hop.time>(qint64)maxHopAge*1000*1000) return;
+		QByteArray name (hop.name);
+		QByteArray common=
+			",\"id\":"+QByteArray::number (hop.flowId)+
+			",\"pid\":"+QByteArray::number (pid)+
+			",\"tid\":"+QByteArray::number (threadId ());
+
+		append ("{\"name\":\""+name+"\",\"cat\":\"queue\",\"ph\":\"b\""
+			",\"ts\":"+QByteArray::number (hop.time)+common+"}");
+		append ("{\"name\":\""+name+"\",\"cat\":\"queue\",\"ph\":\"e\""
+			",\"ts\":"+QByteArray::number (time)+common+
+			",\"args\":{\"wait_us\":"+QByteArray::number (time-hop.time)+"}}");
+		append ("{\"name\":\""+name+"\",\"cat\":\"hop\",\"ph\":\"f\",\"bp\":\"e\""
+			",\"ts\":"+QByteArray::number (time)+common+"}");
+	}
+}
+
+
+// ***************
+// ** Internals **
+// ***************
+
+/**
+ * Removes the hop recorded for a key which is enqueued again, and all hops
+ * which have not been dequeued within maxHopAge
+ *
+ * A hop is never dequeued if the receiver does not call TRACE_DEQUEUE. Its
+ * key, e. g. the address of a Returner on the stack, may then be reused by an
+ * unrelated operation. Must be called with the mutex locked.
+ */
+void Trace::discardStaleHops (const void *key, qint64 time)
+{
+	hops.remove (key);
+
+	QMutableHashIterator<const void *, Hop> it (hops);
+	while (it.hasNext ())
+		if (time-it.next ().value ().time>(qint64)maxHopAge*1000*1000)
+			it.remove ();
+}
+
+/**
+ * Returns a small number identifying the current thread; when a thread is
+ * first seen, its name is recorded
+ */
+int Trace::threadId ()
+{
+	Qt::HANDLE handle=QThread::currentThreadId ();
+
+	int id=threadIds.value (handle, 0);
+	if (id) return id;
+
+	id=threadIds.size ()+1;
+	threadIds.insert (handle, id);
+
+	QString threadName=QThread::currentThread ()->objectName ();
+	if (threadName.isEmpty ())
+		threadName=qnotr ("Thread %1").arg (id);
+	threadName.replace (notr ("\\"), notr ("\\\\"));
+	threadName.replace (notr ("\""), notr ("\\\""));
+
+	append ("{\"name\":\"thread_name\",\"ph\":\"M\""
+		",\"pid\":"+QByteArray::number (pid)+
+		",\"tid\":"+QByteArray::number (id)+
+		",\"args\":{\"name\":\""+threadName.toUtf8 ()+"\"}}");
+
+	return id;
+}
+
+void Trace::append (const QByteArray &event)
+{
+	if (!empty) buffer.append (",");
+	buffer.append ("\n");
+	buffer.append (event);
+	empty=false;
+
+	if (buffer.size ()>flushSize)
+		flush ();
+}
+
+void Trace::flush ()
+{
+	file.write (buffer);
+	file.flush ();
+	buffer.clear ();
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Trace.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*
+ * Tracing of the hot paths: database operations, the hops between the GUI
+ * thread and the worker threads, cache updates and the flight list.
+ *
+ * The trace is written to a file in the temporary directory, one file per
+ * session, in the Chrome trace event format. It can be viewed with
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Tracing is only compiled in if SK_TRACE is defined (cmake -DTRACE=ON).
+ * Otherwise, all of the macros expand to nothing, so they can be left in hot
+ * code.
+ *
+ * Use:
+ *   TRACE_SPAN (name)
+ *     Records the time from here to the end of the enclosing scope. name
+ *     must be a string literal.
+ *   TRACE_ENQUEUE (key, name)
+ *     Records that an operation is handed to another thread. key identifies
+ *     the operation (e. g. the Returner of a call) until TRACE_DEQUEUE (key)
+ *     is called on the receiving thread, which records the time the
+ *     operation spent in the queue. TRACE_DEQUEUE should be called after
+ *     TRACE_SPAN, so the arrow between the threads ends at the span. The key
+ *     may be reused (e. g. a Returner on the stack) after the operation has
+ *     been dequeued or if the receiver does not call TRACE_DEQUEUE; a hop
+ *     is discarded when its key is enqueued again or after maxHopAge.
+ *   TRACE_START (), TRACE_STOP ()
+ *     Opens and closes the trace file; called by main.
+ *
+ * The threads are named after the objectName of their QThread.
+ */
+
+#ifdef SK_TRACE
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+
+class Trace
+{
+	public:
+		/**
+		 * Records a span from construction to destruction
+		 */
+		class Span
+		{
+			public:
+				Span (const char *name);
+				~Span ();
+
+			private:
+				const char *name;
+				qint64 start;
+		};
+
+		static Trace &instance ();
+		~Trace ();
+
+		void start ();
+		void stop ();
+
+		void enqueued (const void *key, const char *name);
+		void dequeued (const void *key);
+
+	private:
+		class Hop
+		{
+			public:
+				const char *name;
+				qint64 time;
+				int flowId;
+		};
+
+		// The buffer is written to the file when it exceeds this size
+		static const int flushSize=64*1024;
+		// Hops which have not been dequeued after this time are discarded, in
+		// seconds
+		static const int maxHopAge=60;
+
+		Trace ();
+		static Trace *theInstance;
+
+		qint64 now () const;
+		void discardStaleHops (const void *key, qint64 time);
+		void complete (const char *name, qint64 start, qint64 end);
+
+		// These methods must be called with the mutex locked
+		int threadId ();
+		void append (const QByteArray &event);
+		void flush ();
+
+		QMutex mutex;
+		QElapsedTimer timer;
+		QFile file;
+		QByteArray buffer;
+		bool empty;
+		qint64 pid;
+		QHash<Qt::HANDLE, int> threadIds;
+		QHash<const void *, Hop> hops;
+		int lastFlowId;
+};
+
+#define TRACE_CONCAT_(a, b) a ## b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_ (a, b)
+
+#define TRACE_SPAN(name) Trace::Span TRACE_CONCAT (_traceSpan_, __LINE__) (name)
+#define TRACE_ENQUEUE(key, name) Trace::instance ().enqueued (key, name)
+#define TRACE_DEQUEUE(key) Trace::instance ().dequeued (key)
+#define TRACE_START() Trace::instance ().start ()
+#define TRACE_STOP() Trace::instance ().stop ()
+
+#else
+
+#define TRACE_SPAN(name) do {} while (0)
+#define TRACE_ENQUEUE(key, name) do {} while (0)
+#define TRACE_DEQUEUE(key) do {} while (0)
+#define TRACE_START() do {} while (0)
+#define TRACE_STOP() do {} while (0)
+
+#endif
+
+#endif
@@ -100,6 +100,38 @@ int Flight::sort (const Flight *other) const
 	return 0;
 }
 
+/**
+ * Returns a key which orders flights the same way as #sort: for two flights a
+ * and b, a.sortKey ()<b.sortKey () exactly if a.sort (&b)<0.
+ *
+ * Comparing keys is much cheaper than calling sort, which determines the
+ * effective times of both flights, so callers sorting frequently can store the
+ * key (it only changes when the flight changes).
+ */
+qint64 Flight::sortKey () const
+{
+	// The category is stored in the upper bits, the effective time (for
+	// flights which are not prepared) in the lower 32 bits.
+	//   - 0: not prepared
+	//   - 1: prepared, incoming
+	//   - 2: prepared, departing locally
+	qint64 category;
+	if (!isPrepared ())
+		category=0;
+	else if (!departsHere ())
+		category=1;
+	else
+		category=2;
+
+	// An invalid effective time sorts before all valid times, like in #sort
+	qint64 time=0;
+	QDateTime effective=effectiveTime ();
+	if (category==0 && effective.isValid ())
+		time=effective.toTime_t ();
+
+	return (category<<32) | time;
+}
+
 
 // ************
 // ** Status **
@@ -1131,11 +1163,15 @@ Query Flight::referencesLaunchMethodCondition (dbId id)
  *
  * First and last date are inclusive.
  *
+ * The superset is specified as a list of conditions which have to be
+ * combined with UNION ALL (see Database#getObjects).
+ *
  * @param first the first date
  * @param last the last date
- * @return a list of candidate flights, to be filtered through dateRangeSupersetFilter
+ * @return the conditions for a list of candidate flights, to be filtered
+ *         through dateRangeSupersetFilter
  */
-Query Flight::dateRangeSupersetCondition (const QDate &first, const QDate &last)
+QList<Query> Flight::dateRangeSupersetConditions (const QDate &first, const QDate &last)
 {
 	// The correct criterion for flights in a given date range is:
 	//     happened and (effective_date in range)
@@ -1161,18 +1197,25 @@ Query Flight::dateRangeSupersetCondition (const QDate &first, const QDate &last)
 	QDateTime firstMidnight (first,            QTime (0, 0, 0)); // Start of the first day
 	QDateTime lastMidnight  (last.addDays (1), QTime (0, 0, 0)); // Start of the day after the last
 
-	Query condition (notr ("(departure_time>=? AND departure_time<?) OR (landing_time>=? AND landing_time<?)"));
-	condition.bind (firstMidnight); condition.bind (lastMidnight);
-	condition.bind (firstMidnight); condition.bind (lastMidnight);
+	// The database cannot use the indexes on departure_time and landing_time
+	// for an OR of the two ranges, so we use one condition per range. The
+	// second condition excludes the flights selected by the first one, so
+	// the results are disjoint.
+	Query departureCondition (notr ("departure_time>=? AND departure_time<?"));
+	departureCondition.bind (firstMidnight); departureCondition.bind (lastMidnight);
+
+	Query landingCondition (notr ("landing_time>=? AND landing_time<? AND (departure_time IS NULL OR departure_time<? OR departure_time>=?)"));
+	landingCondition.bind (firstMidnight); landingCondition.bind (lastMidnight);
+	landingCondition.bind (firstMidnight); landingCondition.bind (lastMidnight);
 
-	return condition;
+	return QList<Query> () << departureCondition << landingCondition;
 }
 
 QList<Flight> Flight::dateRangeSupersetFilter (const QList<Flight> &superset, const QDate &first, const QDate &last)
 {
 	QList<Flight> result;
 
-	// See dateRangeSupersetCondition for details
+	// See dateRangeSupersetConditions for details
 	foreach (const Flight &flight, superset)
 	{
 		QDate effectiveDate=flight.effdatum ();
@@ -1184,15 +1227,15 @@ QList<Flight> Flight::dateRangeSupersetFilter (const QList<Flight> &superset, co
 }
 
 /**
- * A frontend to dateRangeSupersetCondition for a single date
+ * A frontend to dateRangeSupersetConditions for a single date
  *
  * @param date
- * @return a list of candidate flights, to be filtered through
- *         dateSupersetFilter
+ * @return the conditions for a list of candidate flights, to be filtered
+ *         through dateSupersetFilter
  */
-Query Flight::dateSupersetCondition (const QDate &date)
+QList<Query> Flight::dateSupersetConditions (const QDate &date)
 {
-	return dateRangeSupersetCondition (date, date);
+	return dateRangeSupersetConditions (date, date);
 }
 
 /**
@@ -1226,6 +1269,13 @@ void Flight::dataChanged () const
 
 void Flight::databaseChanged (const DbEvent &event) const
 {
+	if (event.getType ()==DbEvent::typeBatch)
+	{
+		foreach (const DbEvent &batchEvent, event.getEvents ())
+			databaseChanged (batchEvent);
+		return;
+	}
+
 	// TODO: this does not catch a change of the plane associated with the
 	// launch method
 	switch (event.getTable ())
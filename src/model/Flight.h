@@ -75,6 +75,7 @@ class Flight: public FlightBase
 		virtual bool operator< (const Flight &o) const;
 		static bool lessThan (Flight *a, Flight *b) { return *a < *b; }
 		virtual int sort (const Flight *other) const;
+		virtual qint64 sortKey () const;
 
 
 		// *** Status
@@ -157,6 +158,7 @@ class Flight: public FlightBase
 
 		// TODO not good - hasDepartureTime and canHaveLandingTime; flying flights already have a duration!
 		virtual bool hasDuration () const { return hasDepartureTime () && canHaveLandingTime (); }
+		virtual bool durationRunning () const { return hasDuration () && !getLanded (); }
 		virtual bool hasTowflightDuration () const { return hasDepartureTime () && canHaveTowflightLandingTime (); }
 
 
@@ -233,10 +235,10 @@ class Flight: public FlightBase
 		static Query referencesPersonCondition (dbId id);
 		static Query referencesPlaneCondition (dbId id);
 		static Query referencesLaunchMethodCondition (dbId id);
-		static Query         dateSupersetCondition (                               const QDate &date);
-		static QList<Flight> dateSupersetFilter    (const QList<Flight> &superset, const QDate &date);
-		static Query         dateRangeSupersetCondition (                               const QDate &first, const QDate &last);
-		static QList<Flight> dateRangeSupersetFilter    (const QList<Flight> &superset, const QDate &first, const QDate &last);
+		static QList<Query>  dateSupersetConditions (                               const QDate &date);
+		static QList<Flight> dateSupersetFilter     (const QList<Flight> &superset, const QDate &date);
+		static QList<Query>  dateRangeSupersetConditions (                               const QDate &first, const QDate &last);
+		static QList<Flight> dateRangeSupersetFilter     (const QList<Flight> &superset, const QDate &first, const QDate &last);
 
 	private:
 		void initialize ();
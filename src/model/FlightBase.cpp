@@ -1,24 +1,23 @@
 #include "FlightBase.h"
 
 
-FlightBase::FlightBase ()
+FlightBase::FlightBase ():
+	d (new Data (invalidId))
 {
-	initialize (invalidId);
 }
 
-FlightBase::FlightBase (dbId id)
+FlightBase::FlightBase (dbId id):
+	d (new Data (id))
 {
-	initialize (id);
 }
 
 FlightBase::~FlightBase ()
 {
 }
 
-void FlightBase::initialize (dbId id)
+FlightBase::Data::Data (dbId id):
+	id (id)
 {
-	this->id=id;
-
 	planeId         =invalidId;
 	numLandings     =invalidId;
 	pilotId         =invalidId;
@@ -3,13 +3,15 @@
 
 #include <QString>
 #include <QDateTime>
+#include <QSharedData>
+#include <QSharedDataPointer>
 
 #include "src/db/dbId.h"
 
 #define flight_value_accessor(type, capitalName, name) \
-	type get ## capitalName () const { return name; } \
-	void set ## capitalName (const type &name) { this->name=name; dataChanged (); } \
-	type &refTo ## capitalName () { return name; }
+	type get ## capitalName () const { return d->name; } \
+	void set ## capitalName (const type &name) { d->name=name; dataChanged (); } \
+	type &refTo ## capitalName () { return d->name; }
 
 // TODO: inherit from Entity
 /**
@@ -19,6 +21,12 @@
  * from Flight's methods itself, and allow access to them only via accessors,
  * in order to ensure that cached values are properly invalidated/updated on
  * every property change.
+ *
+ * The properties are implicitly shared (like Qt's container classes): copies
+ * of a flight share the same data until one of them is modified. Flights are
+ * copied a lot (to the cache, the flight lists, the DbEvent signals and by
+ * lookups), and a copy only increments a reference count instead of copying
+ * all properties.
  */
 class FlightBase
 {
@@ -40,8 +48,8 @@ class FlightBase
 		virtual ~FlightBase ();
 
 		// *** Attribute accessors
-		virtual dbId getId () const { return id; }
-		virtual void setId (dbId id) { this->id=id; } // TODO can we do without this?
+		virtual dbId getId () const { return d->id; }
+		virtual void setId (dbId id) { d->id=id; } // TODO can we do without this?
 
 		flight_value_accessor (dbId, PlaneId, planeId);
 		flight_value_accessor (dbId, PilotId, pilotId);
@@ -77,38 +85,45 @@ class FlightBase
 		flight_value_accessor (QString, AccountingNotes, accountingNotes);
 
 	private:
-		void initialize (dbId id);
+		class Data: public QSharedData
+		{
+			public:
+				Data (dbId id);
+
+				dbId id;
+
+				dbId planeId, pilotId, copilotId;
+				Type type;
+				Mode mode;
+
+				bool departed, landed, towflightLanded;
+				dbId launchMethodId;
+				QString departureLocation;
+				QString landingLocation;
+
+				QDateTime departureTime;
+				QDateTime landingTime;
+				int numLandings;
+
+				dbId towplaneId;
+				Mode towflightMode;
+				QString towflightLandingLocation;
+				QDateTime towflightLandingTime;
+				dbId towpilotId;
+
+				// Incomplete names
+				QString pilotLastName   , pilotFirstName   ;
+				QString copilotLastName , copilotFirstName ;
+				QString towpilotLastName, towpilotFirstName;
+
+				QString comments;
+				QString accountingNotes;
+		};
+
 		virtual void dataChanged () const=0;
 
 		// *** Data
-		dbId id;
-
-		dbId planeId, pilotId, copilotId;
-		Type type;
-		Mode mode;
-
-		bool departed, landed, towflightLanded;
-		dbId launchMethodId;
-		QString departureLocation;
-		QString landingLocation;
-
-		QDateTime departureTime;
-		QDateTime landingTime;
-		int numLandings;
-
-		dbId towplaneId;
-		Mode towflightMode;
-		QString towflightLandingLocation;
-		QDateTime towflightLandingTime;
-		dbId towpilotId;
-
-		// Incomplete names
-		QString pilotLastName   , pilotFirstName   ;
-		QString copilotLastName , copilotFirstName ;
-		QString towpilotLastName, towpilotFirstName;
-
-		QString comments;
-		QString accountingNotes;
+		QSharedDataPointer<Data> d;
 };
 
 #undef flight_value_accessor
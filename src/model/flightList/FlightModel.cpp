@@ -5,6 +5,7 @@
 
 #include <QApplication>
 #include <QBrush>
+#include <QFont>
 
 #include "src/itemDataRoles.h"
 #include "src/model/Flight.h"
@@ -176,6 +177,34 @@ QVariant FlightModel::data (const Flight &flight, int column, int role) const
 		else
 			return QVariant ();
 	}
+	else if (role==Qt::FontRole)
+	{
+		// Flights which have not been written to the database yet
+		if (cache.getFlightWriteState (flight.getId ())==Cache::writePending)
+		{
+			QFont font;
+			font.setItalic (true);
+			return font;
+		}
+		return QVariant ();
+	}
+	else if (role==Qt::ForegroundRole)
+	{
+		if (cache.getFlightWriteState (flight.getId ())==Cache::writeConflict)
+			return QBrush (Qt::red);
+		return QVariant ();
+	}
+	else if (role==Qt::ToolTipRole)
+	{
+		switch (cache.getFlightWriteState (flight.getId ()))
+		{
+			case Cache::writeConfirmed: return QVariant ();
+			case Cache::writePending  : return qApp->translate ("FlightModel", "The flight is being written to the database");
+			case Cache::writeConflict : return qApp->translate ("FlightModel", "The change could not be written to the database and has been reverted. Edit the flight to write it again or to discard it.");
+			// no default
+		}
+		return QVariant ();
+	}
 	else if (role==isButtonRole)
 	{
 		// Only show buttons for prepared flights and today's flights
@@ -9,7 +9,8 @@
 FlightProxyList::FlightProxyList (Cache &cache, AbstractObjectList<Flight> &sourceModel, QObject *parent):
 	AbstractObjectList<Flight> (parent),
 	cache (cache),
-	sourceModel (sourceModel)
+	sourceModel (sourceModel),
+	flightIndexesValid (false)
 {
 	// TODO: if there is no self launch method, the flight will be red
 	// in the table, but not show an error in the editor (no longer true?)
@@ -65,48 +66,60 @@ bool FlightProxyList::isAirtow (const Flight &flight, LaunchMethod *launchMethod
 	}
 }
 
-void FlightProxyList::addTowflightFor (const Flight &flight, const LaunchMethod &launchMethod)
+dbId FlightProxyList::towplaneIdFor (const Flight &flight, const LaunchMethod &launchMethod) const
 {
-	// Determine the ID of the towplane
-	// TODO code duplication with updateTowflight
-	dbId towplaneId=invalidId;
-
 	if (launchMethod.towplaneKnown ())
-		towplaneId=cache.getPlaneIdByRegistration (launchMethod.towplaneRegistration);
+		return cache.getPlaneIdByRegistration (launchMethod.towplaneRegistration);
 	else
-		towplaneId=flight.getTowplaneId ();
+		return flight.getTowplaneId ();
+}
+
+/**
+ * Appends the towflight for a flight to the towflight list. This does not
+ * notify listeners.
+ */
+void FlightProxyList::addTowflightFor (const Flight &flight, const LaunchMethod &launchMethod)
+{
+	dbId towplaneId=towplaneIdFor (flight, launchMethod);
 
 	// For the launch method, use an invalid ID. The FlightModel recognizes
 	// towflights by their type and displays the launch method as self launch
+	towflightIndexes.insert (flight.getId (), towflights.size ());
 	towflights.append (flight.makeTowflight (towplaneId, invalidId));
 }
 
-void FlightProxyList::updateTowflight (dbId id, int towflightIndex)
+/**
+ * Replaces the towflight at the given index with the towflight for a flight.
+ * This does not notify listeners.
+ */
+void FlightProxyList::updateTowflight (const Flight &flight, const LaunchMethod &launchMethod, int towflightIndex)
 {
-	try
-	{
-		Flight flight=cache.getObject<Flight> (id);
-		LaunchMethod launchMethod;
-		if (isAirtow (flight, &launchMethod)) // TODO log error if not
-		{
-			// Determine the ID of the towplane
-			// TODO code duplication with addTowflightFor
-			dbId towplaneId=invalidId;
+	dbId towplaneId=towplaneIdFor (flight, launchMethod);
+	dbId selfLaunchId=cache.getLaunchMethodByType (LaunchMethod::typeSelf);
 
-			if (launchMethod.towplaneKnown ())
-				towplaneId=cache.getPlaneIdByRegistration (launchMethod.towplaneRegistration);
-			else
-				towplaneId=flight.getTowplaneId ();
+	towflights.replace (towflightIndex, flight.makeTowflight (towplaneId, selfLaunchId));
+}
 
-			dbId selfLaunchId=cache.getLaunchMethodByType (LaunchMethod::typeSelf);
+/**
+ * Removes the towflight at the given index, notifying listeners
+ */
+void FlightProxyList::removeTowflight (int towflightIndex, const QModelIndex &parent)
+{
+	int modelIndex=towflightIndexToModelIndex (towflightIndex);
 
-			towflights.replace (towflightIndex, flight.makeTowflight (towplaneId, selfLaunchId));
-		}
-	}
-	catch (Cache::NotFoundException &)
+	beginRemoveRows (parent, modelIndex, modelIndex);
+	towflightIndexes.remove (towflights.at (towflightIndex).getId ());
+	towflights.removeAt (towflightIndex);
+
+	// The following towflights moved up by one
+	QMutableHashIterator<dbId, int> it (towflightIndexes);
+	while (it.hasNext ())
 	{
-		// Do nothing // TODO log error
+		it.next ();
+		if (it.value ()>towflightIndex)
+			--it.value ();
 	}
+	endRemoveRows ();
 }
 
 /**
@@ -116,11 +129,10 @@ void FlightProxyList::updateTowflight (dbId id, int towflightIndex)
  */
 int FlightProxyList::findFlight (dbId id) const
 {
-	for (int i=0; i<sourceModel.size (); ++i)
-		if (sourceModel.at (i).getId ()==id)
-			return i;
+	if (!flightIndexesValid)
+		rebuildFlightIndexes ();
 
-	return -1;
+	return flightIndexes.value (id, -1);
 }
 
 /**
@@ -130,11 +142,18 @@ int FlightProxyList::findFlight (dbId id) const
  */
 int FlightProxyList::findTowflight (dbId id) const
 {
-	for (int i=0; i<towflights.size (); ++i)
-		if (towflights[i].getId ()==id)
-			return i;
+	return towflightIndexes.value (id, -1);
+}
+
+void FlightProxyList::rebuildFlightIndexes () const
+{
+	flightIndexes.clear ();
+
+	int numFlights=sourceModel.size ();
+	for (int i=0; i<numFlights; ++i)
+		flightIndexes.insert (sourceModel.at (i).getId (), i);
 
-	return -1;
+	flightIndexesValid=true;
 }
 
 bool FlightProxyList::modelIndexIsFlight (int index) const
@@ -256,6 +275,10 @@ void FlightProxyList::sourceModel_dataChanged (const QModelIndex &topLeft, const
 		const Flight &flight=sourceModel.at (i);
 		dbId id=flight.getId ();
 
+		// The flight may have been replaced by a flight with a different ID
+		if (flightIndexesValid && flightIndexes.value (id, -1)!=i)
+			flightIndexesValid=false;
+
 		// Determine the launch method and whether the flight is an airtow
 		LaunchMethod launchMethod;
 		bool flightIsAirtow=isAirtow (sourceModel.at (i), &launchMethod);
@@ -272,12 +295,10 @@ void FlightProxyList::sourceModel_dataChanged (const QModelIndex &topLeft, const
 			if (towflightIndex>=0)
 			{
 				// Towflight already present
-				updateTowflight (id, towflightIndex);
+				updateTowflight (flight, launchMethod, towflightIndex);
 
 				int modelIndex=towflightIndexToModelIndex (towflightIndex);
-				// TODO is this the correct parent to use?
-				QModelIndex parent=topLeft.parent ();
-				emit dataChanged (createIndex (modelIndex, 0), createIndex (modelIndex, columnCount (parent)-1));
+				emit dataChanged (createIndex (modelIndex, topLeft.column ()), createIndex (modelIndex, bottomRight.column ()));
 			}
 			else
 			{
@@ -297,14 +318,7 @@ void FlightProxyList::sourceModel_dataChanged (const QModelIndex &topLeft, const
 		{
 			// No airtow - make sure that there is no towflight
 			if (towflightIndex>=0)
-			{
-				// We have a towflight for this flight - remove it.
-				int modelIndex=towflightIndexToModelIndex (towflightIndex);
-
-				beginRemoveRows (QModelIndex (), modelIndex, modelIndex);
-				towflights.removeAt (towflightIndex);
-				endRemoveRows ();
-			}
+				removeTowflight (towflightIndex, QModelIndex ());
 		}
 	}
 }
@@ -312,6 +326,8 @@ void FlightProxyList::sourceModel_dataChanged (const QModelIndex &topLeft, const
 void FlightProxyList::sourceModel_modelReset ()
 {
 	towflights.clear ();
+	towflightIndexes.clear ();
+	flightIndexesValid=false;
 
 	LaunchMethod launchMethod;
 
@@ -336,6 +352,13 @@ void FlightProxyList::sourceModel_rowsAboutToBeRemoved (const QModelIndex &paren
 	// rowsRemoved the flights are already gone. We may not call endRemoveRows
 	// for the flights here, because they are still there.
 
+	// If the flights are removed from the end, the indexes of the remaining
+	// flights do not change and we can remove the entries. Otherwise, the
+	// indexes will be rebuilt when needed.
+	bool removeFromEnd=(end==sourceModel.size ()-1);
+	if (!removeFromEnd)
+		flightIndexesValid=false;
+
 	// Iterate over the flights. For each flight, if there is a corresponding
 	// towflight, remove the towflight.
 	for (int i=start; i<=end; ++i)
@@ -343,16 +366,12 @@ void FlightProxyList::sourceModel_rowsAboutToBeRemoved (const QModelIndex &paren
 		// The towflight has the same ID as the flight
 		dbId id=sourceModel.at (i).getId ();
 
+		if (removeFromEnd)
+			flightIndexes.remove (id);
+
 		int towflightIndex=findTowflight (id);
 		if (towflightIndex>=0)
-		{
-			// We have a towflight for this flight - remove it.
-			int modelIndex=towflightIndexToModelIndex (towflightIndex);
-
-			beginRemoveRows (parent, modelIndex, modelIndex);
-			towflights.removeAt (towflightIndex);
-			endRemoveRows ();
-		}
+			removeTowflight (towflightIndex, parent);
 	}
 
 	// Begin the removing of the flights after the towflights have been
@@ -364,6 +383,19 @@ void FlightProxyList::sourceModel_rowsInserted (const QModelIndex &parent, int s
 {
 	endInsertRows ();
 
+	// If the flights were appended, the indexes of the existing flights did
+	// not change and we can add the new flights. Otherwise, the indexes will
+	// be rebuilt when needed.
+	if (flightIndexesValid && end==sourceModel.size ()-1)
+	{
+		for (int i=start; i<=end; ++i)
+			flightIndexes.insert (sourceModel.at (i).getId (), i);
+	}
+	else
+	{
+		flightIndexesValid=false;
+	}
+
 	// Iterate over the inserted flights, adding the corresponding towflights.
 	for (int i=start; i<=end; ++i)
 	{
@@ -8,6 +8,8 @@
 #ifndef FLIGHTPROXYLIST_H_
 #define FLIGHTPROXYLIST_H_
 
+#include <QHash>
+
 #include "src/model/Flight.h"
 #include "src/model/objectList/AbstractObjectList.h"
 #include "src/db/dbId.h"
@@ -33,11 +35,14 @@ class FlightProxyList: public AbstractObjectList<Flight>
 
 	protected:
 		virtual bool isAirtow (const Flight &flight, LaunchMethod *launchMethod) const;
+		virtual dbId towplaneIdFor (const Flight &flight, const LaunchMethod &launchMethod) const;
 		virtual void addTowflightFor (const Flight &flight, const LaunchMethod &launchMethod);
-		virtual void updateTowflight (dbId id, int towflightIndex);
+		virtual void updateTowflight (const Flight &flight, const LaunchMethod &launchMethod, int towflightIndex);
+		virtual void removeTowflight (int towflightIndex, const QModelIndex &parent);
 
 		virtual int findFlight (dbId id) const;
 		virtual int findTowflight (dbId id) const;
+		virtual void rebuildFlightIndexes () const;
 
 		virtual bool modelIndexIsFlight (int index) const;
 		virtual bool modelIndexIsTowflight (int index) const;
@@ -64,6 +69,13 @@ class FlightProxyList: public AbstractObjectList<Flight>
 
 		// The towflights added by this proxy
 		QList<Flight> towflights;
+
+		// Index of the flight (in the source model) and of the towflight (in
+		// the towflight list) by ID. The flight indexes are rebuilt lazily if
+		// flights were inserted or removed other than at the end.
+		mutable QHash<dbId, int> flightIndexes;
+		mutable bool flightIndexesValid;
+		QHash<dbId, int> towflightIndexes;
 };
 
 #endif
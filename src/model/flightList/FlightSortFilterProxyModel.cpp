@@ -10,6 +10,7 @@ FlightSortFilterProxyModel::FlightSortFilterProxyModel (Cache &cache, QObject *p
 	cache (cache),
 	showPreparedFlights (true),
 	hideFinishedFlights (false), alwaysShowExternalFlights (true), alwaysShowErroneousFlights (true),
+	flightList (NULL),
 	customSorting (true)
 {
 }
@@ -18,31 +19,147 @@ FlightSortFilterProxyModel::~FlightSortFilterProxyModel ()
 {
 }
 
+void FlightSortFilterProxyModel::setSourceModel (QAbstractItemModel *sourceModel)
+{
+	if (this->sourceModel ())
+		disconnect (this->sourceModel (), NULL, this, NULL);
+
+	flightList=dynamic_cast<ObjectListModel<Flight> *> (sourceModel);
+	flightDataCache.clear ();
+
+	// The flight data must be updated before QSortFilterProxyModel handles the
+	// change, so we have to connect before calling the base class method (slots
+	// are called in the order they were connected).
+	if (sourceModel)
+	{
+		connect (sourceModel, SIGNAL (dataChanged (const QModelIndex &, const QModelIndex &)), this, SLOT (sourceModel_dataChanged (const QModelIndex &, const QModelIndex &)));
+		connect (sourceModel, SIGNAL (rowsInserted (const QModelIndex &, int, int)), this, SLOT (sourceModel_rowsInserted (const QModelIndex &, int, int)));
+		connect (sourceModel, SIGNAL (rowsRemoved (const QModelIndex &, int, int)), this, SLOT (sourceModel_rowsRemoved (const QModelIndex &, int, int)));
+		connect (sourceModel, SIGNAL (modelReset ()), this, SLOT (sourceModel_reset ()));
+		connect (sourceModel, SIGNAL (layoutChanged ()), this, SLOT (sourceModel_reset ()));
+	}
+
+	QSortFilterProxyModel::setSourceModel (sourceModel);
+}
+
+/**
+ * Discards the stored flight data
+ *
+ * This must be called when data the flights depend on (e. g. people or planes)
+ * changes without the source model reporting a change.
+ */
+void FlightSortFilterProxyModel::invalidateFlightData ()
+{
+	flightDataCache.clear ();
+}
+
+
+// *****************
+// ** Flight data **
+// *****************
+
+const Flight *FlightSortFilterProxyModel::flightAt (int sourceRow) const
+{
+	if (!flightList) return NULL;
+	return &flightList->at (sourceRow);
+}
+
+/**
+ * Returns the flight data for the given source row, determining it if it is
+ * not valid
+ */
+FlightSortFilterProxyModel::FlightData &FlightSortFilterProxyModel::flightData (int sourceRow) const
+{
+	if (sourceRow>=flightDataCache.size ())
+		flightDataCache.resize (sourceRow+1);
+
+	FlightData &data=flightDataCache[sourceRow];
+	if (!data.valid)
+	{
+		const Flight &flight=*flightAt (sourceRow);
+
+		data.sortKey  =flight.sortKey ();
+		data.prepared =flight.isPrepared ();
+		data.towflight=flight.isTowflight ();
+		data.finished =flight.finished ();
+		data.external =flight.isExternal ();
+		data.erroneousValid=false;
+		data.valid=true;
+	}
+
+	return data;
+}
+
+bool FlightSortFilterProxyModel::isErroneous (int sourceRow) const
+{
+	FlightData &data=flightData (sourceRow);
+
+	if (!data.erroneousValid)
+	{
+		data.erroneous=flightAt (sourceRow)->isErroneous (cache);
+		data.erroneousValid=true;
+	}
+
+	return data.erroneous;
+}
+
+void FlightSortFilterProxyModel::sourceModel_dataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+	int last=qMin (bottomRight.row (), flightDataCache.size ()-1);
+	for (int row=topLeft.row (); row<=last; ++row)
+		flightDataCache[row].valid=false;
+}
+
+void FlightSortFilterProxyModel::sourceModel_rowsInserted (const QModelIndex &parent, int start, int end)
+{
+	(void)parent;
+
+	if (start<flightDataCache.size ())
+		flightDataCache.insert (start, end-start+1, FlightData ());
+}
+
+void FlightSortFilterProxyModel::sourceModel_rowsRemoved (const QModelIndex &parent, int start, int end)
+{
+	(void)parent;
+
+	if (start<flightDataCache.size ())
+		flightDataCache.remove (start, qMin (end, flightDataCache.size ()-1)-start+1);
+}
+
+void FlightSortFilterProxyModel::sourceModel_reset ()
+{
+	flightDataCache.clear ();
+}
+
+
+// ***************************
+// ** Filtering and sorting **
+// ***************************
+
 bool FlightSortFilterProxyModel::filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const
 {
 	(void)sourceParent;
 
 	// If the model is not an ObjectListModel<Flight>, the filter is not active
-	ObjectListModel<Flight> *flightList=dynamic_cast<ObjectListModel<Flight> *> (sourceModel ());
 	if (!flightList) return true;
 
-	// Get the flight from the model
-	const Flight &flight=flightList->at (sourceRow);
+	// Get the flight data for the row
+	const FlightData &flight=flightData (sourceRow);
 
-	if (flight.isPrepared ())
+	if (flight.prepared)
 	{
 		// Prepared flights are hidden if one of these is true:
 		//   - showPreparedFlights is false
 		//   - the flight is a towflight
 
 		if (!showPreparedFlights) return false;
-		if (flight.isTowflight ()) return false;
+		if (flight.towflight) return false;
 
 		return true;
 	}
 	else
 	{
-		if (flight.finished ())
+		if (flight.finished)
 		{
 			// Finished flights are shown if one of these is true:
 			//   - hideFinishedFlights is false
@@ -50,8 +167,8 @@ bool FlightSortFilterProxyModel::filterAcceptsRow (int sourceRow, const QModelIn
 			//   - the flight is erroneous and alwaysShowExternalFlights is true
 
 			if (!hideFinishedFlights) return true;
-			if (alwaysShowExternalFlights && flight.isExternal ()) return true;
-			if (alwaysShowErroneousFlights && flight.isErroneous (cache)) return true;
+			if (alwaysShowExternalFlights && flight.external) return true;
+			if (alwaysShowErroneousFlights && isErroneous (sourceRow)) return true;
 
 			return false;
 		}
@@ -70,12 +187,10 @@ bool FlightSortFilterProxyModel::filterAcceptsRow (int sourceRow, const QModelIn
 
 bool FlightSortFilterProxyModel::lessThan (const QModelIndex &left, const QModelIndex &right) const
 {
-	ObjectListModel<Flight> *flightList=dynamic_cast<ObjectListModel<Flight> *> (sourceModel ());
-
 	// If the model is not an ObjectListModel<Flight>, use the default sorting.
 	// The indicies refer to the source model, so we don't remap them.
 	if (customSorting && flightList)
-		return flightList->at (left) < flightList->at (right);
+		return flightData (left.row ()).sortKey < flightData (right.row ()).sortKey;
 	else
 		return QSortFilterProxyModel::lessThan (left, right);
 }
@@ -100,6 +215,12 @@ void FlightSortFilterProxyModel::setCustomSorting (bool customSorting)
 
 void FlightSortFilterProxyModel::sortCustom ()
 {
+	// If custom sorting is already in effect, the dynamic sort filter keeps
+	// the model sorted (after a reset of the source model, it is sorted when
+	// the mapping is recreated), so there is no need to sort it again.
+	if (customSorting && dynamicSortFilter () && sortColumn ()==0 && sortOrder ()==Qt::AscendingOrder)
+		return;
+
 	setCustomSorting (true);
 
 	// The sort column will be ignored for custom sorting
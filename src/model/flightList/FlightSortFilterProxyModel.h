@@ -9,8 +9,26 @@
 #define FLIGHTSORTFILTERPROXYMODEL_H_
 
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 class Cache;
+class Flight;
+template<class T> class ObjectListModel;
+
+/**
+ * A proxy model for filtering and custom sorting the flight list
+ *
+ * Filtering and sorting require several properties of each flight which are
+ * relatively expensive to determine (e. g. the effective time or whether the
+ * flight is erroneous). Since lessThan is called O(n log n) times on sorting,
+ * these properties are stored for each source row and only updated when the
+ * source model reports a change of the row.
+ *
+ * Changed rows are repositioned individually by the dynamic sort filter
+ * (QSortFilterProxyModel removes the rows and inserts them at the position
+ * determined by a binary search), so there is no need to sort the whole model
+ * when a flight changes.
+ */
 
 class FlightSortFilterProxyModel: public QSortFilterProxyModel
 {
@@ -20,6 +38,9 @@ class FlightSortFilterProxyModel: public QSortFilterProxyModel
 		FlightSortFilterProxyModel (Cache &cache, QObject *parent);
 		virtual ~FlightSortFilterProxyModel ();
 
+		virtual void setSourceModel (QAbstractItemModel *sourceModel);
+		virtual void invalidateFlightData ();
+
 	public slots:
 		virtual void setShowPreparedFlights        (bool showPreparedFlights       ) { this->showPreparedFlights       =showPreparedFlights       ; invalidate (); }
 		virtual void setHideFinishedFlights        (bool hideFinishedFlights       ) { this->hideFinishedFlights       =hideFinishedFlights       ; invalidate (); }
@@ -33,8 +54,39 @@ class FlightSortFilterProxyModel: public QSortFilterProxyModel
 		virtual bool filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const;
 		virtual bool lessThan (const QModelIndex &left, const QModelIndex &right) const;
 
+	protected slots:
+		virtual void sourceModel_dataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight);
+		virtual void sourceModel_rowsInserted (const QModelIndex &parent, int start, int end);
+		virtual void sourceModel_rowsRemoved (const QModelIndex &parent, int start, int end);
+		virtual void sourceModel_reset ();
+
 	private:
+		/**
+		 * The properties of a flight relevant for sorting and filtering
+		 */
+		class FlightData
+		{
+			public:
+				FlightData (): valid (false), erroneousValid (false) {}
+
+				bool valid;
+				qint64 sortKey;
+				bool prepared, towflight, finished, external;
+
+				// Only determined if required for filtering
+				bool erroneousValid;
+				bool erroneous;
+		};
+
+		const Flight *flightAt (int sourceRow) const;
+		FlightData &flightData (int sourceRow) const;
+		bool isErroneous (int sourceRow) const;
+
 		Cache &cache;
+		ObjectListModel<Flight> *flightList;
+
+		// Indexed by source row
+		mutable QVector<FlightData> flightDataCache;
 
 		// Filter options
 		bool showPreparedFlights; // TODO: remove this, the main window takes care of that
@@ -38,6 +38,8 @@ template<class T> class AutomaticEntityList: public EntityList<T>, DbEventMonito
 		virtual void dbEvent (DbEvent event);
 
 	protected:
+		virtual void applyBatch (const QList<DbEvent> &events);
+
 		DbEventMonitor monitor;
 };
 
@@ -108,7 +110,56 @@ template<class T> void AutomaticEntityList<T>::dbEvent (DbEvent event)
 				// Should not happen
 				EntityList<T>::append (event.getValue<T> ());
 		} break;
+		case DbEvent::typeBatch:
+		{
+			applyBatch (event.getEvents ());
+		} break;
 	}
 }
 
+/**
+ * Applies the changes of a batch event
+ *
+ * Adjacent additions and changes are applied together, as are adjacent
+ * deletions, so the list emits a few range signals instead of one signal per
+ * change.
+ *
+ * @param events the events of the batch; all of them must have the table of
+ *               this list
+ */
+template<class T> void AutomaticEntityList<T>::applyBatch (const QList<DbEvent> &events)
+{
+	QList<T> objects;
+	QSet<dbId> ids;
+
+	foreach (const DbEvent &event, events)
+	{
+		switch (event.getType ())
+		{
+			case DbEvent::typeAdd:
+			case DbEvent::typeChange:
+				EntityList<T>::removeByIds (ids);
+				ids.clear ();
+				objects.append (event.getValue<T> ());
+				break;
+			case DbEvent::typeDelete:
+				EntityList<T>::replaceOrAddList (objects);
+				objects.clear ();
+				ids.insert (event.getId ());
+				break;
+			case DbEvent::typeBatch:
+				EntityList<T>::removeByIds (ids);
+				ids.clear ();
+				EntityList<T>::replaceOrAddList (objects);
+				objects.clear ();
+				applyBatch (event.getEvents ());
+				break;
+		}
+	}
+
+	// At most one of them is not empty
+	EntityList<T>::removeByIds (ids);
+	EntityList<T>::replaceOrAddList (objects);
+}
+
 #endif
@@ -8,7 +8,11 @@
 #ifndef ENTITYLIST_H_
 #define ENTITYLIST_H_
 
+#include <QHash>
+#include <QSet>
+
 #include "MutableObjectList.h"
+#include "src/db/dbId.h"
 
 /**
  * A subclass of MutableObjectList which contains Entities and allows access based
@@ -43,6 +47,10 @@ template<class T> class EntityList: public MutableObjectList<T>
 		// TODO: replace method which only takes the object and reads the ID from the object
 		virtual void replaceById (dbId id, const T &object);
 		virtual void replaceOrAdd (dbId id, const T &object);
+
+		// Batch access
+		virtual void removeByIds (const QSet<dbId> &ids);
+		virtual void replaceOrAddList (const QList<T> &objects);
 };
 
 
@@ -147,4 +155,89 @@ template<class T> void EntityList<T>::replaceOrAdd (dbId id, const T &object)
 		append (object);
 }
 
+
+
+// ******************
+// ** Batch access **
+// ******************
+
+/**
+ * Removes all elements with any of the given IDs
+ *
+ * Unlike calling removeById for each ID, this emits one signal for each range
+ * of adjacent removed elements rather than one signal for each element.
+ *
+ * @param ids the IDs of the objects to remove
+ */
+template<class T> void EntityList<T>::removeByIds (const QSet<dbId> &ids)
+{
+	if (ids.isEmpty ()) return;
+
+	// Iterate backwards so removing a range does not affect the indexes of
+	// the elements still to be checked
+	int i=MutableObjectList<T>::size ()-1;
+	while (i>=0)
+	{
+		if (!ids.contains (MutableObjectList<T>::at (i).getId ()))
+		{
+			--i;
+			continue;
+		}
+
+		// Find the first element of the range
+		int last=i;
+		while (i>0 && ids.contains (MutableObjectList<T>::at (i-1).getId ()))
+			--i;
+
+		MutableObjectList<T>::removeRange (i, last);
+		--i;
+	}
+}
+
+/**
+ * Replaces the elements with the IDs of the given objects; objects whose ID
+ * is not in the list are appended to the list
+ *
+ * Unlike calling replaceOrAdd for each object, this emits a single
+ * dataChanged signal for all replaced elements and a single signal for all
+ * appended elements.
+ *
+ * @param objects the new objects
+ */
+template<class T> void EntityList<T>::replaceOrAddList (const QList<T> &objects)
+{
+	if (objects.isEmpty ()) return;
+
+	QHash<dbId, int> indexes;
+	for (int i=0; i<this->list.size (); ++i)
+		indexes.insertMulti (this->list.at (i).getId (), i);
+
+	QList<T> newObjects;
+	int first=-1, last=-1;
+
+	foreach (const T &object, objects)
+	{
+		QList<int> objectIndexes=indexes.values (object.getId ());
+
+		if (objectIndexes.isEmpty ())
+		{
+			newObjects.append (object);
+		}
+		else
+		{
+			foreach (int index, objectIndexes)
+			{
+				this->list.replace (index, object);
+				if (first<0 || index<first) first=index;
+				if (last <0 || index>last ) last =index;
+			}
+		}
+	}
+
+	if (first>=0)
+		QAbstractItemModel::dataChanged (QAbstractItemModel::createIndex (first, 0), QAbstractItemModel::createIndex (last, 0));
+
+	MutableObjectList<T>::appendList (newObjects);
+}
+
 #endif
@@ -41,8 +41,9 @@ template<class T> class MutableObjectList: public AbstractObjectList<T>
 		virtual void replace (int index, const T &object);
 		virtual void clear ();
 		virtual void replaceList (const QList<T> &newList);
-//		virtual void appendList (const QList<T> &other);
+		virtual void appendList (const QList<T> &other);
 //		virtual void appendList (const AbstractObjectList<T> &other);
+		virtual void removeRange (int first, int last);
 
 
 		// AbstractObjectList methods
@@ -129,6 +130,20 @@ template<class T> void MutableObjectList<T>::removeAt (int index)
 	QAbstractItemModel::endRemoveRows ();
 }
 
+/**
+ * Removes the objects in a range of positions and emits the appropriate
+ * signals. The signals are only emitted once for the range.
+ *
+ * @param first the index of the first object to be removed
+ * @param last the index of the last object to be removed (inclusive)
+ */
+template<class T> void MutableObjectList<T>::removeRange (int first, int last)
+{
+	QAbstractItemModel::beginRemoveRows (QModelIndex (), first, last);
+	list.erase (list.begin ()+first, list.begin ()+last+1);
+	QAbstractItemModel::endRemoveRows ();
+}
+
 /**
  * Appends an object to the list and emits the appropriate signals.
  *
@@ -208,15 +223,20 @@ template<class T> void MutableObjectList<T>::replaceList (const QList<T> &newLis
 	QAbstractItemModel::reset ();
 }
 
-///**
-// * This is probably slow as a copy of the lists has to be made.
-// */
-//template<class T> void MutableObjectList<T>::appendList (const QList<T> &other)
-//{
-//	// TODO Qt 4.6: use beginResetModel and endResetModel
-//	list+=other;
-//	QAbstractItemModel::reset ();
-//}
+/**
+ * Appends several objects to the list and emits the appropriate signals. The
+ * signals are only emitted once for all objects.
+ *
+ * @param other the objects to append. Copies of the objects will be made.
+ */
+template<class T> void MutableObjectList<T>::appendList (const QList<T> &other)
+{
+	if (other.isEmpty ()) return;
+
+	QAbstractItemModel::beginInsertRows (QModelIndex (), list.size (), list.size ()+other.size ()-1);
+	list+=other;
+	QAbstractItemModel::endInsertRows ();
+}
 
 ///**
 // * This is probably slow as a copy of the lists has to be made.
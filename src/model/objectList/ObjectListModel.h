@@ -78,6 +78,7 @@ template<class T> class ObjectListModel: public ObjectListModelBase
 		virtual void listDataChanged (const QModelIndex &topLeft, const QModelIndex &bottomRight);
 
 		virtual void columnChanged (int column);
+		virtual void columnChanged (int column, const QList<int> &rows);
 
 	protected:
 		const AbstractObjectList<T> *list ; bool  listOwned;
@@ -255,4 +256,29 @@ template<class T> void ObjectListModel<T>::columnChanged (int column)
 	emit dataChanged (topLeft, bottomRight);
 }
 
+/**
+ * Emits a change of the values of the specified column in the specified rows.
+ * Adjacent rows are combined to a single range, so this is less expensive
+ * than emitting a change for each row individually.
+ *
+ * @param column the number of the column; must be >=0 and <columnCount
+ * @param rows the rows, in ascending order
+ */
+template<class T> void ObjectListModel<T>::columnChanged (int column, const QList<int> &rows)
+{
+	int i=0;
+	while (i<rows.size ())
+	{
+		int first=rows.at (i);
+		int last=first;
+
+		// Extend the range as long as the rows are adjacent
+		++i;
+		while (i<rows.size () && rows.at (i)==last+1)
+			last=rows.at (i++);
+
+		emit dataChanged (createIndex (first, column), createIndex (last, column));
+	}
+}
+
 #endif
@@ -0,0 +1,69 @@
+#include "DownloadCheck.h"
+
+#include <QTextStream>
+#include <QNetworkRequest>
+
+#include "src/net/Downloader.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+DownloadCheck::DownloadCheck (QTextStream &output):
+	output (output), success (false)
+{
+}
+
+DownloadCheck::~DownloadCheck ()
+{
+}
+
+/**
+ * Downloads a URL a number of times, one download after the other
+ *
+ * @return true if all downloads succeeded
+ */
+bool DownloadCheck::run (const QString &url, int count)
+{
+	Downloader downloader;
+	downloader.connectSignals (this);
+
+	bool allSucceeded=true;
+	for (int i=1; i<=count; ++i)
+	{
+		success=false;
+		timer.start ();
+		downloader.startDownload (i, url);
+		loop.exec ();
+
+		if (!success) allSucceeded=false;
+	}
+
+	return allSucceeded;
+}
+
+void DownloadCheck::downloadSucceeded (int state, QNetworkReply *reply)
+{
+	int status=reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+	bool fromCache=reply->attribute (QNetworkRequest::SourceIsFromCacheAttribute).toBool ();
+	int size=reply->readAll ().size ();
+
+	output << qnotr ("fetch\t%1\t%2\t%3\t%4 bytes\t%5 ms\tETag: %6\tLast-Modified: %7")
+		.arg (state).arg (status)
+		.arg (fromCache?qnotr ("cache"):qnotr ("network"))
+		.arg (size).arg (timer.elapsed ())
+		.arg (QString::fromLatin1 (reply->rawHeader (notr ("ETag"))))
+		.arg (QString::fromLatin1 (reply->rawHeader (notr ("Last-Modified"))))
+		<< endl;
+
+	success=true;
+	loop.quit ();
+}
+
+void DownloadCheck::downloadFailed (int state, QNetworkReply *reply, QNetworkReply::NetworkError code)
+{
+	output << qnotr ("fetch\t%1\terror %2\t%3")
+		.arg (state).arg (code).arg (reply->errorString ())
+		<< endl;
+
+	success=false;
+	loop.quit ();
+}
@@ -0,0 +1,47 @@
+/*
+ * DownloadCheck.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef DOWNLOADCHECK_H_
+#define DOWNLOADCHECK_H_
+
+#include <QObject>
+#include <QEventLoop>
+#include <QTime>
+#include <QNetworkReply> // Required for QNetworkReply::NetworkError
+
+class QTextStream;
+
+/**
+ * Downloads a URL repeatedly with the Downloader and writes the result of
+ * each download, including whether the data was taken from the cache
+ *
+ * This is used for checking the network cache against a local HTTP server
+ * (e. g. "python3 -m http.server"): the first download is loaded from the
+ * network; subsequent downloads are conditional requests and should be
+ * answered from the cache.
+ */
+class DownloadCheck: public QObject
+{
+	Q_OBJECT
+
+	public:
+		DownloadCheck (QTextStream &output);
+		virtual ~DownloadCheck ();
+
+		bool run (const QString &url, int count);
+
+	public slots:
+		void downloadSucceeded (int state, QNetworkReply *reply);
+		void downloadFailed    (int state, QNetworkReply *reply, QNetworkReply::NetworkError code);
+
+	private:
+		QTextStream &output;
+		QEventLoop loop;
+		QTime timer;
+		bool success;
+};
+
+#endif
@@ -61,7 +61,9 @@ void Downloader::startDownload (int state, const QUrl &url)
 	// Get the manager
 	QNetworkAccessManager *manager=Network::getNetworkAccessManager ();
 
-	// Set up the request
+	// Set up the request. If the URL is in the cache, the manager sends a
+	// conditional request and uses the cached data if it is not modified
+	// (this is the default cache load control, PreferNetwork).
 	QNetworkRequest request;
 	request.setUrl (QUrl (url));
 
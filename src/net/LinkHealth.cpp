@@ -0,0 +1,327 @@
+#include "LinkHealth.h"
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QtAlgorithms>
+
+#include "src/concurrent/synchronized.h"
+#include "src/util/qString.h"
+#include "src/i18n/notr.h"
+
+// Statically allocated so it exists before any proxy threads are started
+LinkHealth LinkHealth::theInstance;
+
+// Definitions for the constants passed by reference to qBound
+const int LinkHealth::minReadTimeout, LinkHealth::maxReadTimeout;
+const int LinkHealth::minPingInterval, LinkHealth::maxPingInterval;
+
+// ******************
+// ** Construction **
+// ******************
+
+LinkHealth::Statistics::Statistics ():
+	samples (0), smoothedRtt (0), rttVariation (0), minRtt (0), maxRtt (0),
+	medianRtt (0), percentile95Rtt (0),
+	pings (0), smoothedPingRtt (0),
+	timeouts (0), resumes (0), totalOutage (0),
+	connects (0), reconnects (0)
+{
+}
+
+LinkHealth::LinkHealth ():
+	down (false)
+{
+}
+
+LinkHealth::~LinkHealth ()
+{
+}
+
+LinkHealth &LinkHealth::instance ()
+{
+	return theInstance;
+}
+
+
+// ***************
+// ** Recording **
+// ***************
+
+/**
+ * Records the time from a request to the first data of the reply, in
+ * milliseconds
+ *
+ * @param ping true if the request was a keepalive ping; pings are not used
+ *             for the read timeout
+ */
+void LinkHealth::recordRoundTrip (int rtt, bool ping)
+{
+	synchronized (mutex)
+	{
+		if (ping)
+		{
+			if (statistics.pings==0)
+				statistics.smoothedPingRtt=rtt;
+			else
+				statistics.smoothedPingRtt=0.875*statistics.smoothedPingRtt+0.125*rtt;
+			++statistics.pings;
+			return;
+		}
+
+		// RFC 6298, with alpha=1/8 and beta=1/4
+		if (statistics.samples==0)
+		{
+			statistics.smoothedRtt=rtt;
+			statistics.rttVariation=rtt/2.0;
+			statistics.minRtt=rtt;
+			statistics.maxRtt=rtt;
+		}
+		else
+		{
+			statistics.rttVariation=0.75*statistics.rttVariation+0.25*qAbs (statistics.smoothedRtt-rtt);
+			statistics.smoothedRtt =0.875*statistics.smoothedRtt+0.125*rtt;
+			statistics.minRtt=qMin (statistics.minRtt, rtt);
+			statistics.maxRtt=qMax (statistics.maxRtt, rtt);
+		}
+		++statistics.samples;
+
+		recentSamples.append (rtt);
+		if (recentSamples.size ()>maxRecentSamples)
+			recentSamples.removeFirst ();
+	}
+}
+
+void LinkHealth::recordTimeout ()
+{
+	bool wasDown=false;
+
+	synchronized (mutex)
+	{
+		wasDown=down;
+		if (!down)
+		{
+			down=true;
+			outageTimer.start ();
+			++statistics.timeouts;
+			statistics.lastTimeout=QDateTime::currentDateTime ();
+		}
+	}
+
+	if (!wasDown)
+		std::cout << notr ("Link health: read timeout; ") << getStatistics ().toString () << std::endl;
+}
+
+void LinkHealth::recordResumed ()
+{
+	int outage=-1;
+
+	synchronized (mutex)
+	{
+		if (down)
+		{
+			down=false;
+			outage=outageTimer.elapsed ();
+			statistics.totalOutage+=outage;
+			++statistics.resumes;
+		}
+	}
+
+	if (outage>=0)
+		std::cout << qnotr ("Link health: resumed after %1 ms; ").arg (outage) << getStatistics ().toString () << std::endl;
+}
+
+/**
+ * Records that a connection to the server has been established. Every
+ * connection after the first one is counted as a reconnect.
+ */
+void LinkHealth::recordConnect ()
+{
+	synchronized (mutex)
+	{
+		if (statistics.connects>0)
+			++statistics.reconnects;
+		++statistics.connects;
+	}
+}
+
+
+// ********************
+// ** Derived values **
+// ********************
+
+/**
+ * Calculates a percentile of the recent samples; the mutex must be locked
+ */
+int LinkHealth::recentPercentile (int percent) const
+{
+	if (recentSamples.isEmpty ()) return 0;
+
+	QList<int> sorted=recentSamples;
+	qSort (sorted);
+	int index=(sorted.size ()-1)*percent/100;
+	return sorted.at (index);
+}
+
+/**
+ * Determines whether there was a timeout recently; the mutex must be locked
+ */
+bool LinkHealth::recentTimeout () const
+{
+	return down || (statistics.lastTimeout.isValid () &&
+		statistics.lastTimeout.secsTo (QDateTime::currentDateTime ())<unstableTime);
+}
+
+int LinkHealth::readTimeoutImpl (int defaultTimeout) const
+{
+	if (statistics.samples<minSamples)
+		return defaultTimeout;
+
+	int rto=(int)(statistics.smoothedRtt+4*statistics.rttVariation);
+	int timeout=qMax (rto, 2*recentPercentile (95));
+	return qBound (minReadTimeout, timeout, maxReadTimeout);
+}
+
+/**
+ * Determines the time after which a request without a reply is considered a
+ * connection failure
+ *
+ * @param defaultTimeout the timeout to use as long as there are not enough
+ *                       samples, in milliseconds
+ * @return the read timeout in milliseconds
+ */
+int LinkHealth::readTimeout (int defaultTimeout) const
+{
+	synchronizedReturn (mutex, readTimeoutImpl (defaultTimeout));
+}
+
+/**
+ * Determines the interval of keepalive pings
+ *
+ * A failure is detected within the ping interval plus the read timeout. On a
+ * stable link, the interval is equal to the read timeout (slow links are
+ * pinged less often). After a recent timeout, the link is pinged at the
+ * minimum interval, so a recovery (or another failure) is noticed quickly.
+ *
+ * @param defaultInterval the interval to use as long as there are not enough
+ *                        samples, in milliseconds
+ * @return the ping interval in milliseconds
+ */
+int LinkHealth::pingInterval (int defaultInterval) const
+{
+	synchronized (mutex)
+	{
+		if (statistics.samples<minSamples)
+			return defaultInterval;
+
+		if (recentTimeout ())
+			return minPingInterval;
+
+		return qBound (minPingInterval, readTimeoutImpl (defaultInterval), maxPingInterval);
+	}
+
+	// Not reached
+	return defaultInterval;
+}
+
+/**
+ * Estimates the quality of the link from the round trip times and the recent
+ * timeouts
+ */
+LinkHealth::Quality LinkHealth::quality () const
+{
+	synchronized (mutex)
+	{
+		if (down) return qualityDown;
+		if (statistics.samples<minSamples) return qualityUnknown;
+
+		if (recentTimeout () || statistics.smoothedRtt>1000)
+			return qualityPoor;
+		else if (statistics.smoothedRtt>300 || statistics.rttVariation>statistics.smoothedRtt)
+			return qualityFair;
+		else
+			return qualityGood;
+	}
+
+	// Not reached
+	return qualityUnknown;
+}
+
+QString LinkHealth::qualityText (Quality quality)
+{
+	switch (quality)
+	{
+		case qualityUnknown: return QCoreApplication::translate ("LinkHealth", "unknown");
+		case qualityGood   : return QCoreApplication::translate ("LinkHealth", "good");
+		case qualityFair   : return QCoreApplication::translate ("LinkHealth", "fair");
+		case qualityPoor   : return QCoreApplication::translate ("LinkHealth", "poor");
+		case qualityDown   : return QCoreApplication::translate ("LinkHealth", "no reply");
+		// no default
+	}
+
+	return notr ("?");
+}
+
+
+// ************
+// ** Access **
+// ************
+
+LinkHealth::Statistics LinkHealth::getStatistics () const
+{
+	synchronized (mutex)
+	{
+		Statistics result=statistics;
+		result.medianRtt      =recentPercentile (50);
+		result.percentile95Rtt=recentPercentile (95);
+		return result;
+	}
+
+	// Not reached
+	return Statistics ();
+}
+
+QString LinkHealth::Statistics::toString () const
+{
+	return qnotr (
+		"Query RTT %1 samples, smoothed %2 ms, variation %3 ms, min/median/95%/max %4/%5/%6/%7 ms; "
+		"ping RTT %8 samples, smoothed %9 ms; "
+		"%10 timeouts, %11 resumed, total outage %12 ms; %13 connects, %14 reconnects")
+		.arg (samples)
+		.arg (smoothedRtt, 0, 'f', 0)
+		.arg (rttVariation, 0, 'f', 0)
+		.arg (minRtt).arg (medianRtt).arg (percentile95Rtt).arg (maxRtt)
+		.arg (pings).arg (smoothedPingRtt, 0, 'f', 0)
+		.arg (timeouts).arg (resumes).arg (totalOutage)
+		.arg (connects).arg (reconnects);
+}
+
+/**
+ * Generates a plain text report of the link health
+ */
+QString LinkHealth::report () const
+{
+	Statistics stats=getStatistics ();
+
+	QStringList lines;
+	lines.append (qnotr ("Link quality: %1").arg (qualityText (quality ())));
+	lines.append (qnotr ("Read timeout: %1 ms, ping interval: %2 ms (defaults are used with fewer than %3 samples)")
+		.arg (readTimeout (0)).arg (pingInterval (0)).arg (minSamples));
+	lines.append (stats.toString ());
+	if (stats.lastTimeout.isValid ())
+		lines.append (qnotr ("Last timeout: %1").arg (stats.lastTimeout.toString (Qt::ISODate)));
+
+	return lines.join (notr ("\n"));
+}
+
+void LinkHealth::reset ()
+{
+	synchronized (mutex)
+	{
+		bool wasDown=down;
+		statistics=Statistics ();
+		recentSamples.clear ();
+		down=wasDown;
+	}
+}
@@ -0,0 +1,122 @@
+/*
+ * LinkHealth.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef LINKHEALTH_H_
+#define LINKHEALTH_H_
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QDateTime>
+#include <QTime>
+
+/**
+ * Tracks the health of the connection to the database server
+ *
+ * The round trip times measured by the TcpProxy (from a request of the client
+ * to the first data from the server) are used to derive the read timeout
+ * (see #readTimeout) and the keepalive interval (see #pingInterval), so they
+ * adapt to the link: on a fast link, a failure is detected quickly; on a slow
+ * or variable link (e. g. GSM), slow replies are not mistaken for a failure.
+ *
+ * The round trip time of a query includes the time the server takes to
+ * execute it. Keepalive pings are much cheaper and much more frequent than
+ * queries, so they are recorded separately and not used for the read
+ * timeout; otherwise, the timeout would be fitted to the pings and slow
+ * queries would time out.
+ *
+ * The read timeout is calculated like the TCP retransmission timeout (RFC
+ * 6298) from the smoothed round trip time and its variation, but it is at
+ * least twice the 95th percentile of the recent round trip times, so a single
+ * outlier does not cause false alarms.
+ *
+ * Additionally, timeouts, outages and reconnects are counted, and the link
+ * quality is estimated (see #quality).
+ *
+ * There is only one instance for all connections, see #instance. This class
+ * is thread safe.
+ */
+class LinkHealth
+{
+	public:
+		enum Quality { qualityUnknown, qualityGood, qualityFair, qualityPoor, qualityDown };
+
+		/** A snapshot of the link statistics */
+		class Statistics
+		{
+			public:
+				Statistics ();
+				QString toString () const;
+
+				// Round trip times of queries, in milliseconds
+				int samples;
+				double smoothedRtt, rttVariation;
+				int minRtt, maxRtt;
+				int medianRtt, percentile95Rtt; // Of the recent samples
+
+				// Round trip times of pings, in milliseconds
+				int pings;
+				double smoothedPingRtt;
+
+				// Outages
+				int timeouts;
+				int resumes;
+				qint64 totalOutage; // Milliseconds
+				QDateTime lastTimeout;
+
+				// Connections
+				int connects;
+				int reconnects;
+		};
+
+		static LinkHealth &instance ();
+		virtual ~LinkHealth ();
+
+		// *** Recording
+		void recordRoundTrip (int rtt, bool ping=false);
+		void recordTimeout ();
+		void recordResumed ();
+		void recordConnect ();
+
+		// *** Derived values
+		int readTimeout (int defaultTimeout) const;
+		int pingInterval (int defaultInterval) const;
+		Quality quality () const;
+		static QString qualityText (Quality quality);
+
+		// *** Access
+		Statistics getStatistics () const;
+		QString report () const;
+		void reset ();
+
+	private:
+		LinkHealth ();
+		static LinkHealth theInstance;
+
+		// Number of samples before the derived values are used
+		static const int minSamples=8;
+		// Number of recent samples kept for the percentiles
+		static const int maxRecentSamples=64;
+		// Limits for the read timeout and the ping interval, in milliseconds
+		// The minimum read timeout is the old fixed timeout.
+		static const int minReadTimeout=5000, maxReadTimeout=60000;
+		static const int minPingInterval=1000, maxPingInterval=15000;
+		// Timeouts within this time (in seconds) make the link unstable
+		static const int unstableTime=300;
+
+		int readTimeoutImpl (int defaultTimeout) const;
+		bool recentTimeout () const;
+		int recentPercentile (int percent) const;
+
+		mutable QMutex mutex;
+
+		Statistics statistics;
+		QList<int> recentSamples; // Most recent last
+		bool down;
+		QTime outageTimer;
+};
+
+#endif
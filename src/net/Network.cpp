@@ -8,6 +8,10 @@
 #include "Network.h"
 
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QDesktopServices>
+
+#include "src/i18n/notr.h"
 
 QNetworkAccessManager *Network::networkAccessManager;
 
@@ -19,10 +23,27 @@ Network::~Network ()
 {
 }
 
+/**
+ * Returns the QNetworkAccessManager shared by all downloads, creating it on
+ * first use
+ *
+ * The manager uses a disk cache. With a cached response, the manager sends
+ * the ETag and the modification time of the cached response (If-None-Match
+ * and If-Modified-Since), and if the server replies with "304 Not modified",
+ * the cached data is returned without downloading it again. The cache is
+ * kept across program runs.
+ */
 QNetworkAccessManager *Network::getNetworkAccessManager ()
 {
 	if (!Network::networkAccessManager)
+	{
 		Network::networkAccessManager=new QNetworkAccessManager ();
 
+		QNetworkDiskCache *cache=new QNetworkDiskCache (Network::networkAccessManager);
+		cache->setCacheDirectory (QDesktopServices::storageLocation (QDesktopServices::CacheLocation)+notr ("/network"));
+		cache->setMaximumCacheSize (maxCacheSize);
+		Network::networkAccessManager->setCache (cache);
+	}
+
 	return Network::networkAccessManager;
 }
@@ -1,6 +1,8 @@
 #ifndef NETWORK_H_
 #define NETWORK_H_
 
+#include <QtGlobal>
+
 class QNetworkAccessManager;
 
 class Network
@@ -12,6 +14,9 @@ class Network
 		static QNetworkAccessManager *getNetworkAccessManager ();
 
 	private:
+		// The size of the disk cache, in bytes
+		static const qint64 maxCacheSize=20*1024*1024;
+
 		static QNetworkAccessManager *networkAccessManager;
 };
 
@@ -0,0 +1,280 @@
+#include "RefreshScheduler.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QMetaObject>
+
+RefreshScheduler *RefreshScheduler::theInstance=NULL;
+
+// ******************
+// ** Construction **
+// ******************
+
+RefreshScheduler::Entry::Entry ():
+	interval (0), failures (0)
+{
+}
+
+RefreshScheduler::RefreshScheduler ():
+	timer (new QTimer (this))
+{
+	// Seed the random number generator for the jitter, so the instances on
+	// different computers don't use the same sequence of intervals
+	qsrand (QDateTime::currentDateTime ().toTime_t () ^ (uint)QCoreApplication::applicationPid ());
+
+	timer->setSingleShot (true);
+	connect (timer, SIGNAL (timeout ()), this, SLOT (timeout ()));
+}
+
+RefreshScheduler::~RefreshScheduler ()
+{
+}
+
+/**
+ * Returns the only instance, creating it on first use (the QTimer cannot be
+ * created before the application)
+ */
+RefreshScheduler &RefreshScheduler::instance ()
+{
+	if (!theInstance)
+		theInstance=new RefreshScheduler ();
+
+	return *theInstance;
+}
+
+
+// *************
+// ** Clients **
+// *************
+
+/**
+ * Registers a client for periodic refreshes
+ *
+ * The first refresh is performed as soon as possible, but not closer than
+ * staggerInterval to any other scheduled refresh. If the client is already
+ * registered, its schedule is replaced.
+ *
+ * The client is removed automatically when it is destroyed.
+ *
+ * @param client the object to refresh
+ * @param member the slot to invoke for refreshing, as returned by the SLOT
+ *               macro; the slot must not take any parameters
+ * @param interval the refresh interval in seconds, or 0 for a single refresh
+ */
+void RefreshScheduler::add (QObject *client, const char *member, int interval)
+{
+	// Convert "1refresh()" to "refresh" for QMetaObject::invokeMethod
+	QByteArray method (member+1);
+	method=method.left (method.indexOf ('('));
+
+	// Remove the old schedule first, so it does not conflict with the new one
+	entries.remove (client);
+
+	Entry entry;
+	entry.member=method;
+	entry.interval=qMax (interval, 0);
+	entry.due=nextFreeSlot ();
+	entries.insert (client, entry);
+
+	connect (client, SIGNAL (destroyed (QObject *)), this, SLOT (clientDestroyed (QObject *)), Qt::UniqueConnection);
+	schedule ();
+}
+
+/**
+ * Removes a client; no more refreshes will be performed for this client. Does
+ * nothing if the client is not registered.
+ */
+void RefreshScheduler::remove (QObject *client)
+{
+	if (!entries.contains (client)) return;
+
+	entries.remove (client);
+	disconnect (client, SIGNAL (destroyed (QObject *)), this, SLOT (clientDestroyed (QObject *)));
+	schedule ();
+}
+
+/**
+ * Called by a client after a refresh succeeded; restores the regular refresh
+ * interval after failures, or removes the client if it only requested a
+ * single refresh
+ */
+void RefreshScheduler::refreshSucceeded (QObject *client)
+{
+	if (!entries.contains (client)) return;
+
+	if (entries[client].interval==0)
+	{
+		remove (client);
+		return;
+	}
+
+	// The next refresh was scheduled with the regular interval when the
+	// refresh was started
+	entries[client].failures=0;
+}
+
+/**
+ * Called by a client after a refresh failed; the refresh will be retried
+ * after a delay which grows with the number of consecutive failures
+ */
+void RefreshScheduler::refreshFailed (QObject *client)
+{
+	if (!entries.contains (client)) return;
+
+	Entry &entry=entries[client];
+	++entry.failures;
+	entry.due=QDateTime::currentDateTime ().addMSecs (1000*retryDelay (entry.failures));
+
+	schedule ();
+}
+
+void RefreshScheduler::clientDestroyed (QObject *client)
+{
+	entries.remove (client);
+	schedule ();
+}
+
+
+// ****************
+// ** Scheduling **
+// ****************
+
+/**
+ * Determines the earliest time for a new refresh which is at least
+ * staggerInterval away from the last refresh and from all scheduled refreshes
+ */
+QDateTime RefreshScheduler::nextFreeSlot () const
+{
+	QDateTime slot=QDateTime::currentDateTime ();
+	if (lastRefresh.isValid () && lastRefresh.msecsTo (slot)<staggerInterval)
+		slot=lastRefresh.addMSecs (staggerInterval);
+
+	// Move the slot behind each conflicting refresh until there is no more
+	// conflict. Each entry can cause at most one move.
+	bool conflict=true;
+	for (int i=0; conflict && i<=entries.size (); ++i)
+	{
+		conflict=false;
+		foreach (const Entry &entry, entries)
+		{
+			if (entry.due.isValid () && qAbs (entry.due.msecsTo (slot))<staggerInterval)
+			{
+				slot=entry.due.addMSecs (staggerInterval);
+				conflict=true;
+			}
+		}
+	}
+
+	return slot;
+}
+
+/**
+ * Starts the timer for the next due refresh
+ */
+void RefreshScheduler::schedule ()
+{
+	if (entries.isEmpty ())
+	{
+		timer->stop ();
+		return;
+	}
+
+	QDateTime now=QDateTime::currentDateTime ();
+
+	QDateTime next;
+	foreach (const Entry &entry, entries)
+		if (entry.due.isValid () && (!next.isValid () || entry.due<next))
+			next=entry.due;
+
+	// Only single refreshes which are waiting for their result
+	if (!next.isValid ())
+	{
+		timer->stop ();
+		return;
+	}
+
+	qint64 delay=now.msecsTo (next);
+	if (lastRefresh.isValid ())
+		delay=qMax (delay, staggerInterval-lastRefresh.msecsTo (now));
+
+	timer->start ((int)qMax (delay, (qint64)0));
+}
+
+/**
+ * Performs the refresh which is due next, if it is due
+ *
+ * Only one refresh is started at a time, so refreshes which are due at the
+ * same time (e. g. after the computer has been suspended) are still
+ * staggered.
+ */
+void RefreshScheduler::timeout ()
+{
+	QDateTime now=QDateTime::currentDateTime ();
+
+	QObject *client=NULL;
+	QDateTime next;
+	QHash<QObject *, Entry>::const_iterator end=entries.constEnd ();
+	for (QHash<QObject *, Entry>::const_iterator it=entries.constBegin (); it!=end; ++it)
+	{
+		if (!it.value ().due.isValid ())
+			continue;
+
+		if (!client || it.value ().due<next)
+		{
+			client=it.key ();
+			next=it.value ().due;
+		}
+	}
+
+	if (!client || next>now)
+	{
+		schedule ();
+		return;
+	}
+
+	// Schedule the next refresh before invoking the client, the client may
+	// remove itself or report a failure. A single refresh is not scheduled
+	// again, but the entry is kept until the refresh succeeds, so a failure
+	// can still be retried.
+	Entry &entry=entries[client];
+	QByteArray member=entry.member;
+	if (entry.interval>0)
+	{
+		int interval=1000*entry.interval;
+		entry.due=now.addMSecs (interval+jitter (interval/100*maxJitter));
+	}
+	else
+	{
+		entry.due=QDateTime ();
+	}
+
+	lastRefresh=now;
+	QMetaObject::invokeMethod (client, member.constData ());
+
+	schedule ();
+}
+
+/**
+ * Returns a random value between -milliseconds and +milliseconds
+ */
+int RefreshScheduler::jitter (int milliseconds)
+{
+	if (milliseconds<=0) return 0;
+	return qrand ()%(2*milliseconds+1)-milliseconds;
+}
+
+/**
+ * Determines the delay before retrying after a number of consecutive
+ * failures, in seconds
+ */
+int RefreshScheduler::retryDelay (int failures)
+{
+	int delay=minRetryDelay;
+	for (int i=1; i<failures && delay<maxRetryDelay; ++i)
+		delay*=2;
+
+	if (delay>maxRetryDelay)
+		return maxRetryDelay;
+	else
+		return delay;
+}
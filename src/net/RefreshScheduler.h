@@ -0,0 +1,91 @@
+/*
+ * RefreshScheduler.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef REFRESHSCHEDULER_H_
+#define REFRESHSCHEDULER_H_
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+
+class QTimer;
+
+/**
+ * Schedules the periodic refreshes of the plugins which download data from
+ * the internet
+ *
+ * Instead of each plugin running its own timer, the plugins register with the
+ * scheduler (see #add), which invokes a slot of the plugin when a refresh is
+ * due. The refreshes are staggered: the first refreshes of plugins started at
+ * the same time (e. g. after restarting the plugins) are spread out, refreshes
+ * are never started closer than staggerInterval to each other, and the
+ * interval of each plugin is varied randomly by up to maxJitter percent, so
+ * the plugins don't stay synchronized.
+ *
+ * If a plugin reports a failed refresh (see #refreshFailed), the next refresh
+ * is retried after minRetryDelay, and the delay is doubled for each further
+ * failure, up to maxRetryDelay. A successful refresh (see #refreshSucceeded)
+ * restores the regular interval. A single refresh (interval 0) stays
+ * registered until it succeeds.
+ *
+ * The downloads themselves are performed by the Downloader, which uses the
+ * shared, disk-cached QNetworkAccessManager (see Network).
+ *
+ * There is only one instance, see #instance. This class must only be used on
+ * the GUI thread.
+ */
+class RefreshScheduler: public QObject
+{
+	Q_OBJECT
+
+	public:
+		static RefreshScheduler &instance ();
+		virtual ~RefreshScheduler ();
+
+		void add (QObject *client, const char *member, int interval);
+		void remove (QObject *client);
+
+		void refreshSucceeded (QObject *client);
+		void refreshFailed (QObject *client);
+
+	private:
+		class Entry
+		{
+			public:
+				Entry ();
+
+				QByteArray member;
+				int interval; // Seconds, 0 for a single refresh
+				QDateTime due; // Invalid while a single refresh is running
+				int failures;
+		};
+
+		RefreshScheduler ();
+		static RefreshScheduler *theInstance;
+
+		// The minimum time between two refreshes, in milliseconds
+		static const int staggerInterval=2000;
+		// The maximum random variation of the interval, in percent
+		static const int maxJitter=10;
+		// The delays for retrying after failures, in seconds
+		static const int minRetryDelay=60, maxRetryDelay=3600;
+
+		void schedule ();
+		QDateTime nextFreeSlot () const;
+		static int jitter (int milliseconds);
+		static int retryDelay (int failures);
+
+		QTimer *timer;
+		QHash<QObject *, Entry> entries;
+		QDateTime lastRefresh;
+
+	private slots:
+		void timeout ();
+		void clientDestroyed (QObject *client);
+};
+
+#endif
@@ -11,6 +11,10 @@
 
 #include <iostream>
 
+#include <QTimerEvent>
+#include <QStringList>
+
+#include "src/net/LinkHealth.h"
 #include "src/concurrent/synchronized.h"
 #include "src/util/qString.h"
 #include "src/concurrent/Returner.h"
@@ -19,21 +23,32 @@
 //#define DEBUG(stuff) do { std::cout << stuff << std::endl; } while (0)
 #define DEBUG(stuff)
 
+QMutex TcpProxy::instancesMutex;
+QList<TcpProxy *> TcpProxy::instances;
+
 TcpProxy::TcpProxy ():
 	server (NULL), serverSocket (NULL), clientSocket (NULL),
-	readTimedOut (false), readTimeoutMs (0)
+	readTimedOut (false), readTimeoutMs (0),
+	awaitingResponse (false), requestTime (0), requestIsPing (false),
+	lastPumpTime (0), toServerBudget (0), fromServerBudget (0)
 {
 	DEBUG (notr ("Creating a TcpProxy on thread ") << QThread::currentThreadId ());
 
+	clock.start ();
+
 	connect (this, SIGNAL (sig_open (Returner<quint16> *, QString, quint16)), this, SLOT (slot_open (Returner<quint16> *, QString, quint16)));
 	connect (this, SIGNAL (sig_close ()), this, SLOT (slot_close ()));
 
 	moveToThread (&proxyThread);
 	proxyThread.start ();
+
+	synchronized (instancesMutex) instances.append (this);
 }
 
 TcpProxy::~TcpProxy ()
 {
+	synchronized (instancesMutex) instances.removeAll (this);
+
 	proxyThread.quit ();
 
 	std::cout << notr ("Waiting for proxy thread to terminate...");
@@ -65,6 +80,211 @@ void TcpProxy::setReadTimeout (int timeout)
 	readTimeoutMs=timeout;
 }
 
+
+// ****************
+// ** Statistics **
+// ****************
+
+/**
+ * Returns a snapshot of the traffic statistics. This method is thread safe.
+ */
+TcpProxy::Statistics TcpProxy::getStatistics ()
+{
+	synchronizedReturn (mutex, statistics);
+}
+
+/**
+ * Returns the total number of bytes received from the server. This method is
+ * thread safe.
+ */
+qint64 TcpProxy::getBytesFromServer ()
+{
+	synchronizedReturn (mutex, statistics.fromServer.bytes);
+}
+
+void TcpProxy::resetStatistics ()
+{
+	synchronized (mutex) statistics=Statistics ();
+}
+
+/**
+ * Returns the traffic statistics of all proxies, one line per connection.
+ * This method is thread safe.
+ */
+QString TcpProxy::statisticsReport ()
+{
+	QStringList lines;
+
+	synchronized (instancesMutex)
+	{
+		foreach (TcpProxy *proxy, instances)
+		{
+			Statistics statistics=proxy->getStatistics ();
+
+			QString server;
+			synchronized (proxy->mutex)
+				server=qnotr ("%1:%2").arg (proxy->serverHost).arg (proxy->serverPort);
+
+			lines << qnotr ("Connection to %1: %2").arg (server, statistics.toString ());
+		}
+	}
+
+	if (lines.isEmpty ())
+		return notr ("No connections");
+
+	return lines.join (notr ("\n"));
+}
+
+/**
+ * Resets the traffic statistics of all proxies. This method is thread safe.
+ */
+void TcpProxy::resetAllStatistics ()
+{
+	synchronized (instancesMutex)
+		foreach (TcpProxy *proxy, instances)
+			proxy->resetStatistics ();
+}
+
+QString TcpProxy::DirectionStatistics::toString () const
+{
+	return qnotr ("%1 bytes in %2 packets").arg (bytes).arg (packets);
+}
+
+QString TcpProxy::Statistics::toString () const
+{
+	QString latencyText;
+	if (latencyCount>0)
+		latencyText=qnotr ("latency min/avg/max %1/%2/%3 ms (%4 requests)")
+			.arg (latencyMin).arg (latencyTotal/latencyCount).arg (latencyMax).arg (latencyCount);
+	else
+		latencyText=notr ("no latency measured");
+
+	return qnotr ("to server: %1; from server: %2; %3")
+		.arg (toServer.toString (), fromServer.toString (), latencyText);
+}
+
+
+// *************
+// ** Shaping **
+// *************
+
+/**
+ * Sets the shaping parameters. This is intended for testing the behavior of
+ * the program on a slow link. This method is thread safe.
+ *
+ * Since the proxy forwards a TCP stream, no data can actually be lost.
+ * Instead, a "lost" packet is delayed by a retransmission timeout, which is
+ * how a lost packet affects the stream.
+ */
+void TcpProxy::setShaping (const Shaping &shaping)
+{
+	synchronized (mutex) this->shaping=shaping;
+}
+
+TcpProxy::Shaping TcpProxy::getShaping ()
+{
+	synchronizedReturn (mutex, shaping);
+}
+
+/**
+ * Writes data to a socket, or queues it for later writing if shaping is
+ * enabled
+ */
+void TcpProxy::forward (QTcpSocket *target, const QByteArray &data)
+{
+	Shaping shaping=getShaping ();
+
+	if (!shaping.isEnabled ())
+	{
+		target->write (data);
+		return;
+	}
+
+	int now=clock.elapsed ();
+
+	DelayedData delayed;
+	delayed.target=target;
+	delayed.data=data;
+	delayed.due=now+shaping.latency;
+
+	// Retransmission timeout for a lost packet
+	if (shaping.loss>0 && (qrand ()%100)<shaping.loss)
+		delayed.due+=qMax (200, 2*shaping.latency);
+
+	QQueue<DelayedData> &queue=(target==serverSocket)?toServerQueue:fromServerQueue;
+
+	// Data may not overtake earlier data
+	if (!queue.isEmpty () && delayed.due<queue.last ().due)
+		delayed.due=queue.last ().due;
+
+	queue.enqueue (delayed);
+
+	if (!shapingTimer.isActive ())
+	{
+		lastPumpTime=now;
+		shapingTimer.start (10, this);
+	}
+}
+
+void TcpProxy::pumpShapingQueues ()
+{
+	int now=clock.elapsed ();
+	int bandwidth=getShaping ().bandwidth;
+
+	pumpShapingQueue (toServerQueue  , toServerBudget  , now, bandwidth);
+	pumpShapingQueue (fromServerQueue, fromServerBudget, now, bandwidth);
+	lastPumpTime=now;
+
+	if (toServerQueue.isEmpty () && fromServerQueue.isEmpty ())
+		shapingTimer.stop ();
+}
+
+/**
+ * Writes the data from a queue which is due, limited by the bandwidth
+ */
+void TcpProxy::pumpShapingQueue (QQueue<DelayedData> &queue, double &budget, int now, int bandwidth)
+{
+	if (bandwidth>0)
+	{
+		// Allow bursts of at most 100 ms worth of data, but at least one
+		// byte, or very low bandwidths would never write anything
+		budget+=bandwidth*(now-lastPumpTime)/1000.0;
+		budget=qMin (budget, qMax (1.0, bandwidth/10.0));
+	}
+
+	while (!queue.isEmpty () && queue.head ().due<=now)
+	{
+		DelayedData &head=queue.head ();
+
+		int size=head.data.size ();
+		if (bandwidth>0)
+			size=qMin (size, (int)budget);
+
+		if (size<=0) return;
+
+		head.target->write (head.data.left (size));
+		head.data.remove (0, size);
+		if (bandwidth>0) budget-=size;
+
+		if (head.data.isEmpty ())
+			queue.dequeue ();
+	}
+}
+
+/**
+ * Writes all queued data for a socket, ignoring the shaping. Used before
+ * closing the socket.
+ */
+void TcpProxy::flushShapingQueue (QQueue<DelayedData> &queue, QTcpSocket *target)
+{
+	while (!queue.isEmpty ())
+	{
+		DelayedData delayed=queue.dequeue ();
+		if (target && delayed.target==target)
+			target->write (delayed.data);
+	}
+}
+
 // ***************
 // ** Frontends **
 // ***************
@@ -144,6 +364,7 @@ quint16 TcpProxy::openImpl (QString serverHost, quint16 serverPort)
 void TcpProxy::slot_close ()
 {
 	readTimer.stop ();
+	shapingTimer.stop ();
 	doClose ();
 }
 
@@ -162,6 +383,7 @@ void TcpProxy::closeClientSocket ()
 	DEBUG (notr ("close client socket"));
 	if (!clientSocket) return;
 
+	flushShapingQueue (fromServerQueue, clientSocket);
 	if (serverSocket) clientSocket->write (serverSocket->read (serverSocket->bytesAvailable ()));
 	clientSocket->flush ();
 
@@ -177,6 +399,7 @@ void TcpProxy::closeServerSocket ()
 
 	if (!serverSocket) return;
 
+	flushShapingQueue (toServerQueue, serverSocket);
 	if (clientSocket) serverSocket->write (clientSocket->read (clientSocket->bytesAvailable ()));
 	serverSocket->flush ();
 
@@ -191,6 +414,10 @@ void TcpProxy::newConnection ()
 	DEBUG (notr ("new connection on thread ") << QThread::currentThreadId ());
 	DEBUG (notr ("connecting to %1:%2").arg (serverHost).arg (serverPort));
 
+	// Delayed data for the previous connection is discarded
+	toServerQueue.clear ();
+	fromServerQueue.clear ();
+
 	delete serverSocket;
 	serverSocket=new QTcpSocket (this);
 	serverSocket->connectToHost (serverHost, serverPort);
@@ -210,11 +437,41 @@ void TcpProxy::newConnection ()
 	resetTimer ();
 }
 
+/**
+ * Determines whether data from the client is a MySQL ping (COM_PING). A
+ * MySQL packet consists of a 3 byte length, a sequence number and, for
+ * commands, the command byte.
+ */
+bool TcpProxy::isPing (const QByteArray &data)
+{
+	const quint8 comPing=0x0E;
+	return data.size ()>=5 && (quint8)data.at (4)==comPing;
+}
+
 void TcpProxy::clientRead ()
 {
 	DEBUG (notr ("write to server...") << clientSocket->bytesAvailable ());
 
-	if (serverSocket) serverSocket->write (clientSocket->readAll ());
+	if (serverSocket)
+	{
+		QByteArray data=clientSocket->readAll ();
+
+		synchronized (mutex)
+		{
+			statistics.toServer.bytes+=data.size ();
+			++statistics.toServer.packets;
+
+			// Start of a request
+			if (!awaitingResponse)
+			{
+				awaitingResponse=true;
+				requestTime=clock.elapsed ();
+				requestIsPing=isPing (data);
+			}
+		}
+
+		forward (serverSocket, data);
+	}
 
 	DEBUG (notr ("done"));
 }
@@ -226,12 +483,42 @@ void TcpProxy::serverRead ()
 	if (readTimedOut)
 	{
 		readTimedOut=false;
+		LinkHealth::instance ().recordResumed ();
 		emit readResumed ();
 	}
 
 	resetTimer ();
 
-	if (clientSocket) clientSocket->write (serverSocket->readAll ());
+	if (clientSocket)
+	{
+		QByteArray data=serverSocket->readAll ();
+		int latency=-1;
+		bool ping=false;
+
+		synchronized (mutex)
+		{
+			statistics.fromServer.bytes+=data.size ();
+			++statistics.fromServer.packets;
+
+			// First response to a request
+			if (awaitingResponse)
+			{
+				awaitingResponse=false;
+
+				latency=clock.elapsed ()-requestTime;
+				ping=requestIsPing;
+				if (statistics.latencyCount==0 || latency<statistics.latencyMin) statistics.latencyMin=latency;
+				if (statistics.latencyCount==0 || latency>statistics.latencyMax) statistics.latencyMax=latency;
+				statistics.latencyTotal+=latency;
+				++statistics.latencyCount;
+			}
+		}
+
+		if (latency>=0)
+			LinkHealth::instance ().recordRoundTrip (latency, ping);
+
+		forward (clientSocket, data);
+	}
 
 
 	DEBUG (notr ("done"));
@@ -268,12 +555,16 @@ void TcpProxy::serverError ()
 
 void TcpProxy::timerEvent (QTimerEvent *event)
 {
-	// Multiple timers: event->timerId == readTimer.timerId ()
-	(void)event;
+	if (event->timerId ()==shapingTimer.timerId ())
+	{
+		pumpShapingQueues ();
+		return;
+	}
 
 	if (!readTimedOut)
 	{
 		readTimedOut=true;
+		LinkHealth::instance ().recordTimeout ();
 		emit readTimeout ();
 	}
 }
@@ -282,6 +573,8 @@ void TcpProxy::resetTimer ()
 {
 	readTimer.stop ();
 
+	// The configured timeout is used until the link health has enough
+	// samples to determine a timeout from the round trip times
 	if (readTimeoutMs!=0)
-		readTimer.start (readTimeoutMs, this);
+		readTimer.start (LinkHealth::instance ().readTimeout (readTimeoutMs), this);
 }
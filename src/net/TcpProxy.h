@@ -15,16 +15,71 @@
 #include <QThread>
 #include <QMutex>
 #include <QBasicTimer>
+#include <QTime>
+#include <QQueue>
+#include <QByteArray>
+#include <QList>
 
 #include "src/concurrent/synchronized.h"
 
 template<class T> class Returner;
 
+/**
+ * Forwards a TCP connection from a port on localhost to a server, allowing
+ * the connection to be closed from another thread (see DefaultInterface)
+ *
+ * The proxy keeps traffic statistics for both directions (see
+ * #getStatistics). For testing, the connection can be shaped to resemble a
+ * slow link (see #setShaping).
+ */
 class TcpProxy: public QObject
 {
 	Q_OBJECT
 
 	public:
+		/** Traffic counters for one direction */
+		class DirectionStatistics
+		{
+			public:
+				DirectionStatistics (): bytes (0), packets (0) {}
+				QString toString () const;
+
+				qint64 bytes;
+				qint64 packets; // Number of reads from the socket
+		};
+
+		/** A snapshot of the traffic statistics */
+		class Statistics
+		{
+			public:
+				Statistics (): latencyCount (0), latencyTotal (0), latencyMin (0), latencyMax (0) {}
+				QString toString () const;
+
+				DirectionStatistics toServer;
+				DirectionStatistics fromServer;
+
+				// Time from a request of the client to the first data from the
+				// server, in milliseconds
+				int latencyCount;
+				qint64 latencyTotal;
+				int latencyMin, latencyMax;
+		};
+
+		/**
+		 * Parameters for simulating a slow link. The default values disable
+		 * shaping.
+		 */
+		class Shaping
+		{
+			public:
+				Shaping (): bandwidth (0), latency (0), loss (0) {}
+				bool isEnabled () const { return bandwidth>0 || latency>0 || loss>0; }
+
+				int bandwidth; // Bytes per second and direction, 0 for unlimited
+				int latency;   // One-way delay in milliseconds
+				int loss;      // Percentage of packets to be "lost"
+		};
+
 		TcpProxy ();
 		virtual ~TcpProxy ();
 
@@ -35,6 +90,17 @@ class TcpProxy: public QObject
 
 		void setReadTimeout (int timeout);
 
+		// *** Statistics
+		Statistics getStatistics ();
+		qint64 getBytesFromServer ();
+		void resetStatistics ();
+		static QString statisticsReport ();
+		static void resetAllStatistics ();
+
+		// *** Shaping
+		void setShaping (const Shaping &shaping);
+		Shaping getShaping ();
+
 	signals:
 		void sig_open (Returner<quint16> *returner, QString serverHost, quint16 serverPort);
 		void sig_close ();
@@ -66,9 +132,18 @@ class TcpProxy: public QObject
 		void timerEvent (QTimerEvent *event);
 		void resetTimer ();
 
+		void forward (QTcpSocket *target, const QByteArray &data);
+		void pumpShapingQueues ();
+
 		void doClose ();
 
+		static bool isPing (const QByteArray &data);
+
 	private:
+		// All proxies, for the statistics report
+		static QMutex instancesMutex;
+		static QList<TcpProxy *> instances;
+
 		QMutex mutex;
 
 		QTcpServer *server;
@@ -84,6 +159,34 @@ class TcpProxy: public QObject
 		QBasicTimer readTimer;
 		bool readTimedOut;
 		int readTimeoutMs;
+
+		// Statistics, protected by the mutex
+		Statistics statistics;
+		QTime clock;
+		bool awaitingResponse;
+		int requestTime;
+		bool requestIsPing;
+
+		// Shaping, protected by the mutex
+		Shaping shaping;
+
+		/** Data delayed by the shaping, to be written to a socket */
+		class DelayedData
+		{
+			public:
+				QTcpSocket *target;
+				QByteArray data;
+				int due; // Relative to the clock
+		};
+
+		// Only accessed on the proxy thread
+		QQueue<DelayedData> toServerQueue;
+		QQueue<DelayedData> fromServerQueue;
+		QBasicTimer shapingTimer;
+		int lastPumpTime;
+		double toServerBudget, fromServerBudget; // Bytes
+		void pumpShapingQueue (QQueue<DelayedData> &queue, double &budget, int now, int bandwidth);
+		void flushShapingQueue (QQueue<DelayedData> &queue, QTcpSocket *target);
 };
 
 #endif
@@ -102,6 +102,16 @@ class Plugin: public QObject
 
 		virtual QString configText () const=0;
 
+		/**
+		 * Whether the plugin can be run on a worker thread (see PluginHost)
+		 *
+		 * A plugin which returns true must not use objects belonging to the
+		 * GUI thread, like widgets, the shared QNetworkAccessManager or the
+		 * RefreshScheduler, and must only communicate with the GUI by
+		 * signals.
+		 */
+		virtual bool canRunOnWorkerThread () const { return false; }
+
 		static bool filenameIsAbsolute (const QString &filename);
 		static QString resolveFilename (const QString &filename, const QStringList &pluginPaths);
 		static QString browse (const QString &currentFile, const QString &filter, const QStringList &pluginPaths, QWidget *parent=NULL);
@@ -0,0 +1,323 @@
+#include "PluginHost.h"
+
+#include <QThread>
+#include <QUuid>
+
+#include "src/plugin/Plugin.h"
+#include "src/plugin/PluginWorker.h"
+#include "src/concurrent/synchronized.h"
+#include "src/i18n/notr.h"
+
+PluginHost *PluginHost::theInstance=NULL;
+
+// ******************
+// ** Construction **
+// ******************
+
+PluginHost::Statistics::Statistics ():
+	count (0), last (0), max (0), total (0)
+{
+}
+
+void PluginHost::Statistics::add (int milliseconds)
+{
+	++count;
+	last=milliseconds;
+	if (milliseconds>max) max=milliseconds;
+	total+=milliseconds;
+}
+
+PluginHost::PluginHost ():
+	guiWorker (new PluginWorker ()),
+	nextWorker (0)
+{
+	guiWorker->setParent (this);
+
+	for (int i=0; i<numThreads; ++i)
+	{
+		QThread *thread=new QThread (this);
+		PluginWorker *worker=new PluginWorker ();
+		worker->moveToThread (thread);
+		thread->start ();
+
+		threads.append (thread);
+		workers.append (worker);
+	}
+}
+
+PluginHost::~PluginHost ()
+{
+	// Join the worker threads before deleting the workers. All plugins have
+	// been removed, so the threads are idle.
+	foreach (QThread *thread, threads)
+	{
+		thread->quit ();
+		thread->wait ();
+	}
+
+	foreach (PluginWorker *worker, workers)
+		delete worker;
+}
+
+/**
+ * Returns the only instance, creating it on first use
+ */
+PluginHost &PluginHost::instance ()
+{
+	if (!theInstance)
+		theInstance=new PluginHost ();
+
+	return *theInstance;
+}
+
+/**
+ * Destroys the instance, if it has been created, and joins the worker threads
+ *
+ * All plugins must have been removed before. This must be called before the
+ * application is destroyed.
+ */
+void PluginHost::destroyInstance ()
+{
+	delete theInstance;
+	theInstance=NULL;
+}
+
+
+// *************
+// ** Plugins **
+// *************
+
+/**
+ * Adds a plugin to the host
+ *
+ * If the plugin can run on a worker thread, it is moved to a worker thread.
+ * After that, the plugin must not be accessed directly any more, except for
+ * reading constant properties like the name. The configuration must not be
+ * accessed, the plugin may change it on its own thread. Use #start and #restart instead, and #remove
+ * before deleting the plugin.
+ *
+ * The plugin must not have a parent.
+ */
+void PluginHost::add (Plugin *plugin)
+{
+	if (pluginWorkers.contains (plugin)) return;
+
+	// Determine the key on the GUI thread, before the plugin is moved. After
+	// that, the plugin's configuration must not be read any more.
+	QString key=timingKey (plugin);
+	synchronized (timingMutex)
+		pluginKeys.insert (plugin, key);
+
+	if (plugin->canRunOnWorkerThread () && !workers.isEmpty ())
+	{
+		// Distribute the plugins evenly among the workers
+		PluginWorker *worker=workers[nextWorker];
+		nextWorker=(nextWorker+1)%workers.size ();
+
+		plugin->moveToThread (worker->thread ());
+		pluginWorkers.insert (plugin, worker);
+	}
+	else
+	{
+		pluginWorkers.insert (plugin, guiWorker);
+	}
+}
+
+/**
+ * Terminates a plugin and removes it from the host
+ *
+ * The plugin is moved back to the GUI thread, so it can be deleted by the
+ * caller. If the plugin has not been added, it is only terminated.
+ */
+void PluginHost::remove (Plugin *plugin)
+{
+	PluginWorker *worker=pluginWorkers.take (plugin);
+	synchronized (timingMutex)
+		pluginKeys.remove (plugin);
+
+	foreach (QObject *trigger, restartTriggers.keys (plugin))
+		restartTriggers.remove (trigger);
+
+	if (worker && worker!=guiWorker)
+		// Wait until the plugin has been terminated and moved back. Any
+		// operations on the plugin which are still pending are executed
+		// before.
+		QMetaObject::invokeMethod (worker, notr ("release"), Qt::BlockingQueuedConnection, Q_ARG (Plugin *, plugin));
+	else
+		plugin->terminate ();
+}
+
+/**
+ * Starts a plugin on its thread
+ *
+ * If the plugin runs on a worker thread, this method returns immediately.
+ */
+void PluginHost::start (Plugin *plugin)
+{
+	PluginWorker *worker=workerFor (plugin);
+	if (!worker) return;
+
+	QMetaObject::invokeMethod (worker, notr ("start"), Qt::AutoConnection, Q_ARG (Plugin *, plugin));
+}
+
+/**
+ * Restarts a plugin on its thread
+ *
+ * If the plugin runs on a worker thread, this method returns immediately.
+ */
+void PluginHost::restart (Plugin *plugin)
+{
+	PluginWorker *worker=workerFor (plugin);
+	if (!worker) return;
+
+	QMetaObject::invokeMethod (worker, notr ("restart"), Qt::AutoConnection, Q_ARG (Plugin *, plugin));
+}
+
+/**
+ * Performs the minute update of all plugins, each on its thread
+ */
+void PluginHost::minuteChanged ()
+{
+	QHash<Plugin *, PluginWorker *>::const_iterator end=pluginWorkers.constEnd ();
+	for (QHash<Plugin *, PluginWorker *>::const_iterator it=pluginWorkers.constBegin (); it!=end; ++it)
+		QMetaObject::invokeMethod (it.value (), notr ("minuteChanged"), Qt::AutoConnection, Q_ARG (Plugin *, it.key ()));
+}
+
+/**
+ * Restarts a plugin when a signal is emitted
+ *
+ * This is used instead of connecting the signal to the restart slot of the
+ * plugin directly, so the restart is timed.
+ *
+ * @param sender the object emitting the signal
+ * @param signal the signal, as returned by the SIGNAL macro
+ * @param plugin the plugin to restart; it must have been added
+ */
+void PluginHost::addRestartTrigger (QObject *sender, const char *signal, Plugin *plugin)
+{
+	restartTriggers.insert (sender, plugin);
+	connect (sender, signal, this, SLOT (restartTriggered ()));
+	connect (sender, SIGNAL (destroyed (QObject *)), this, SLOT (triggerDestroyed (QObject *)), Qt::UniqueConnection);
+}
+
+void PluginHost::restartTriggered ()
+{
+	Plugin *plugin=restartTriggers.value (sender ());
+	if (plugin) restart (plugin);
+}
+
+void PluginHost::triggerDestroyed (QObject *trigger)
+{
+	restartTriggers.remove (trigger);
+}
+
+PluginWorker *PluginHost::workerFor (Plugin *plugin) const
+{
+	return pluginWorkers.value (plugin);
+}
+
+
+// ************
+// ** Timing **
+// ************
+
+/**
+ * Determines the key for the timing of a plugin; plugins with the same key
+ * share their timing
+ */
+QString PluginHost::timingKey (const Plugin *plugin)
+{
+	return qnotr ("%1 %2").arg (plugin->getId ().toString (), plugin->configText ());
+}
+
+/**
+ * Determines the timing key of a plugin without accessing a plugin which has
+ * been added
+ *
+ * For a plugin which has been added, the key determined by #add is used, the
+ * plugin may be changing its settings on its own thread. For other plugins,
+ * like the copies edited in the settings window, the key is determined from
+ * the plugin.
+ */
+QString PluginHost::currentTimingKey (const Plugin *plugin) const
+{
+	synchronized (timingMutex)
+	{
+		// QHash::value requires a non-const key; the plugin is not accessed.
+		Plugin *key=const_cast<Plugin *> (plugin);
+		if (pluginKeys.contains (key))
+			return pluginKeys.value (key);
+	}
+
+	return timingKey (plugin);
+}
+
+/**
+ * Records the duration of a start or restart of a plugin
+ *
+ * This method is thread safe.
+ */
+void PluginHost::recordStart (Plugin *plugin, int milliseconds)
+{
+	synchronized (timingMutex)
+	{
+		if (pluginKeys.contains (plugin))
+			timings[pluginKeys.value (plugin)].start.add (milliseconds);
+	}
+}
+
+/**
+ * Records the duration of a minute update of a plugin
+ *
+ * This method is thread safe.
+ */
+void PluginHost::recordUpdate (Plugin *plugin, int milliseconds)
+{
+	synchronized (timingMutex)
+	{
+		if (pluginKeys.contains (plugin))
+			timings[pluginKeys.value (plugin)].update.add (milliseconds);
+	}
+}
+
+/**
+ * Determines whether a timing has been recorded for a plugin with the same
+ * configuration as the given plugin
+ */
+bool PluginHost::hasTiming (const Plugin *plugin) const
+{
+	QString key=currentTimingKey (plugin);
+	synchronizedReturn (timingMutex, timings.contains (key));
+}
+
+/**
+ * Returns the timing recorded for a plugin with the same configuration as the
+ * given plugin
+ */
+PluginHost::Timing PluginHost::getTiming (const Plugin *plugin) const
+{
+	QString key=currentTimingKey (plugin);
+	synchronizedReturn (timingMutex, timings.value (key));
+}
+
+/**
+ * Creates a string describing the timing of a plugin, suitable for display to
+ * the user
+ *
+ * @return the timing description, or an empty string if no timing has been
+ *         recorded for the plugin
+ */
+QString PluginHost::formatTiming (const Plugin *plugin) const
+{
+	if (!hasTiming (plugin)) return QString ();
+	Timing timing=getTiming (plugin);
+
+	QString text=tr ("Start: %1 ms (slowest %2 ms, %3 times)")
+		.arg (timing.start.last).arg (timing.start.max).arg (timing.start.count);
+
+	if (timing.update.count>0)
+		text+=notr ("\n")+tr ("Update: %1 ms (slowest %2 ms, %3 times)")
+			.arg (timing.update.last).arg (timing.update.max).arg (timing.update.count);
+
+	return text;
+}
@@ -0,0 +1,143 @@
+/*
+ * PluginHost.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef PLUGINHOST_H_
+#define PLUGINHOST_H_
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+class QThread;
+class Plugin;
+class PluginWorker;
+
+/**
+ * Runs the plugins displayed in the main window, on worker threads where
+ * possible, and records how long the plugin operations take
+ *
+ * Plugins which can run on a worker thread (see
+ * Plugin::canRunOnWorkerThread) are moved to one of a small number of worker
+ * threads when they are added (see #add); all other plugins stay on the GUI
+ * thread. Starting, restarting and the minute updates are performed on the
+ * thread of the plugin, so a plugin that blocks only delays the other plugins
+ * on the same worker thread, but not the GUI. The text output of a plugin is
+ * delivered to the GUI by its textOutput signal, which is queued
+ * automatically.
+ *
+ * The duration of the start and update operations is recorded for each
+ * plugin configuration (plugin type and configuration text), so it can be
+ * displayed for a different instance of the plugin with the same
+ * configuration, e. g. in the plugin settings dialog (see #formatTiming).
+ *
+ * The configuration text of a plugin is determined when the plugin is added,
+ * before it is moved to its thread, and the host only uses this copy
+ * afterwards. The plugin may change its settings on its own thread at any
+ * time, so neither the host nor the GUI must access them while the plugin is
+ * added.
+ *
+ * There is only one instance, see #instance. The public methods must only be
+ * called on the GUI thread, except for recordStart and recordUpdate. The
+ * worker threads run until the instance is destroyed by #destroyInstance,
+ * which must be called after all plugins have been removed.
+ */
+class PluginHost: public QObject
+{
+	Q_OBJECT
+
+	public:
+		// ***********
+		// ** Types **
+		// ***********
+
+		class Statistics
+		{
+			public:
+				Statistics ();
+				void add (int milliseconds);
+
+				int count;
+				int last; // Milliseconds
+				int max; // Milliseconds
+				qint64 total; // Milliseconds
+		};
+
+		class Timing
+		{
+			public:
+				Statistics start; // Including restarts
+				Statistics update; // Minute updates
+		};
+
+
+		// ******************
+		// ** Construction **
+		// ******************
+
+		static PluginHost &instance ();
+		static void destroyInstance ();
+		virtual ~PluginHost ();
+
+
+		// *************
+		// ** Plugins **
+		// *************
+
+		void add (Plugin *plugin);
+		void remove (Plugin *plugin);
+
+		void start (Plugin *plugin);
+		void restart (Plugin *plugin);
+		void addRestartTrigger (QObject *sender, const char *signal, Plugin *plugin);
+
+
+		// ************
+		// ** Timing **
+		// ************
+
+		void recordStart (Plugin *plugin, int milliseconds);
+		void recordUpdate (Plugin *plugin, int milliseconds);
+
+		bool hasTiming (const Plugin *plugin) const;
+		Timing getTiming (const Plugin *plugin) const;
+		QString formatTiming (const Plugin *plugin) const;
+
+	public slots:
+		void minuteChanged ();
+
+	private slots:
+		void restartTriggered ();
+		void triggerDestroyed (QObject *trigger);
+
+	private:
+		// The number of worker threads
+		static const int numThreads=2;
+
+		PluginHost ();
+		static PluginHost *theInstance;
+
+		static QString timingKey (const Plugin *plugin);
+		QString currentTimingKey (const Plugin *plugin) const;
+		PluginWorker *workerFor (Plugin *plugin) const;
+
+		QList<QThread *> threads;
+		QList<PluginWorker *> workers; // One for each thread
+		PluginWorker *guiWorker;
+		int nextWorker;
+
+		QHash<Plugin *, PluginWorker *> pluginWorkers;
+		QHash<QObject *, Plugin *> restartTriggers;
+
+		// Protects pluginKeys and timings, which are accessed on the worker
+		// threads
+		mutable QMutex timingMutex;
+		QHash<Plugin *, QString> pluginKeys;
+		QHash<QString, Timing> timings;
+};
+
+#endif
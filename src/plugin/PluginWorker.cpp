@@ -0,0 +1,52 @@
+#include "PluginWorker.h"
+
+#include <QTime>
+#include <QCoreApplication>
+
+#include "src/plugin/Plugin.h"
+#include "src/plugin/PluginHost.h"
+
+PluginWorker::PluginWorker ()
+{
+}
+
+PluginWorker::~PluginWorker ()
+{
+}
+
+void PluginWorker::start (Plugin *plugin)
+{
+	QTime time;
+	time.start ();
+	plugin->start ();
+	PluginHost::instance ().recordStart (plugin, time.elapsed ());
+}
+
+void PluginWorker::restart (Plugin *plugin)
+{
+	QTime time;
+	time.start ();
+	plugin->restart ();
+	PluginHost::instance ().recordStart (plugin, time.elapsed ());
+}
+
+void PluginWorker::minuteChanged (Plugin *plugin)
+{
+	QTime time;
+	time.start ();
+	plugin->minuteChanged ();
+	PluginHost::instance ().recordUpdate (plugin, time.elapsed ());
+}
+
+/**
+ * Terminates the plugin and moves it back to the GUI thread
+ *
+ * After this method returns, the plugin can be deleted on the GUI thread.
+ */
+void PluginWorker::release (Plugin *plugin)
+{
+	plugin->terminate ();
+
+	if (plugin->thread ()!=QCoreApplication::instance ()->thread ())
+		plugin->moveToThread (QCoreApplication::instance ()->thread ());
+}
@@ -0,0 +1,38 @@
+/*
+ * PluginWorker.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef PLUGINWORKER_H_
+#define PLUGINWORKER_H_
+
+#include <QObject>
+
+class Plugin;
+
+/**
+ * Performs the operations of the PluginHost on the plugins of one thread and
+ * records how long they take
+ *
+ * There is one PluginWorker for each worker thread and one for the GUI
+ * thread. The slots are invoked (see QMetaObject::invokeMethod) by the
+ * PluginHost and executed on the thread of the worker, which is also the
+ * thread of the plugin.
+ */
+class PluginWorker: public QObject
+{
+	Q_OBJECT
+
+	public:
+		PluginWorker ();
+		virtual ~PluginWorker ();
+
+	public slots:
+		void start (Plugin *plugin);
+		void restart (Plugin *plugin);
+		void minuteChanged (Plugin *plugin);
+		void release (Plugin *plugin);
+};
+
+#endif
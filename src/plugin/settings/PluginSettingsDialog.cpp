@@ -4,6 +4,7 @@
 #include <QDebug>
 
 #include "src/plugin/Plugin.h"
+#include "src/plugin/PluginHost.h"
 #include "src/plugin/settings/PluginSettingsPane.h"
 
 /**
@@ -36,6 +37,11 @@ void PluginSettingsDialog::setupText ()
 
 	ui.nameLabel       ->setText (plugin->getName        ());
 	ui.descriptionLabel->setText (plugin->getDescription ());
+
+	// Only plugins that have been running in the main window have a timing
+	QString timing=PluginHost::instance ().formatTiming (plugin);
+	ui.timingLabel->setText (timing);
+	ui.timingLabel->setVisible (!timing.isEmpty ());
 }
 
 /**
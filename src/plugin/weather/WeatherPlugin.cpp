@@ -7,13 +7,11 @@
 
 #include "WeatherPlugin.h"
 
-#include <QTimer>
+#include "src/net/RefreshScheduler.h"
 
 WeatherPlugin::WeatherPlugin ():
-	refreshTimer (new QTimer (this)),
 	refreshEnabled (true), refreshInterval (0)
 {
-	connect (refreshTimer, SIGNAL (timeout ()), this, SLOT (refresh ()));
 }
 
 WeatherPlugin::~WeatherPlugin ()
@@ -35,19 +33,22 @@ void WeatherPlugin::outputMovie (SkMovie &movie)
 	emit movieOutput (movie);
 }
 
+/**
+ * Schedules the refreshes with the RefreshScheduler: a single refresh if the
+ * refresh is disabled, periodic refreshes else
+ */
 void WeatherPlugin::start ()
 {
-	refresh ();
-	updateRefreshTimer ();
+	unsigned int interval=refreshEnabled?refreshInterval:0;
+	RefreshScheduler::instance ().add (this, SLOT (refresh ()), interval);
 }
 
 void WeatherPlugin::terminate ()
 {
-	abort ();
-
 	// Don't call disableRefresh - keep the refresh interval
-	if (refreshTimer->isActive ())
-		refreshTimer->stop ();
+	RefreshScheduler::instance ().remove (this);
+
+	abort ();
 }
 
 void WeatherPlugin::enableRefresh (unsigned int seconds)
@@ -61,20 +62,6 @@ void WeatherPlugin::disableRefresh ()
 	refreshEnabled=false;
 }
 
-void WeatherPlugin::updateRefreshTimer ()
-{
-	if (refreshEnabled)
-	{
-		if (refreshInterval>0)
-			refreshTimer->start (refreshInterval*1000);
-	}
-	else
-	{
-		if (refreshTimer->isActive ())
-			refreshTimer->stop ();
-	}
-}
-
 // ****************
 // ** Descriptor **
 // ****************
@@ -7,13 +7,16 @@
 #include "src/accessor.h"
 
 class QImage;
-class QTimer;
 class QTemporaryFile;
 
 class SkMovie;
 
 /**
  * A plugin which displays a weather image (or an error message text)
+ *
+ * The plugin is refreshed by the RefreshScheduler. Implementations should
+ * report the result of a refresh to the scheduler (see
+ * RefreshScheduler::refreshSucceeded and RefreshScheduler::refreshFailed).
  */
 class WeatherPlugin: public Plugin
 {
@@ -86,12 +89,8 @@ class WeatherPlugin: public Plugin
 		void outputMovie (SkMovie &movie);
 
 	private:
-		QTimer *refreshTimer;
-
 		bool refreshEnabled;
 		unsigned int refreshInterval; // In seconds
-
-		void updateRefreshTimer ();
 };
 
 #endif
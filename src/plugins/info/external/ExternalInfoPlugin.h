@@ -21,6 +21,7 @@ class ExternalInfoPlugin: public InfoPlugin
 
 		virtual void start ();
 		virtual void terminate ();
+		virtual bool canRunOnWorkerThread () const { return true; }
 
 		virtual PluginSettingsPane *infoPluginCreateSettingsPane (QWidget *parent=NULL);
 
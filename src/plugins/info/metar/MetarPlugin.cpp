@@ -19,6 +19,7 @@
 #include "src/util/qString.h"
 #include "src/util/io.h"
 #include "src/net/Downloader.h"
+#include "src/net/RefreshScheduler.h"
 #include "src/i18n/notr.h"
 
 REGISTER_PLUGIN (InfoPlugin, MetarPlugin)
@@ -31,10 +32,9 @@ SK_PLUGIN_DEFINITION (
 MetarPlugin::MetarPlugin (const QString &caption, bool enabled, const QString &airport, int refreshInterval):
 	InfoPlugin (caption, enabled),
 	airport (airport), refreshInterval (refreshInterval),
-	timer (new QTimer (this)), downloader (new Downloader (this))
+	downloader (new Downloader (this))
 {
 	downloader->connectSignals (this);
-	connect (timer, SIGNAL (timeout ()), this, SLOT (refresh ()));
 }
 
 MetarPlugin::~MetarPlugin ()
@@ -60,16 +60,13 @@ void MetarPlugin::infoPluginWriteSettings (QSettings &settings)
 
 void MetarPlugin::start ()
 {
-	refresh ();
-
-	if (timer->isActive ()) timer->stop ();
-	timer->start (1000*refreshInterval);
+	RefreshScheduler::instance ().add (this, SLOT (refresh ()), refreshInterval);
 }
 
 void MetarPlugin::terminate ()
 {
+	RefreshScheduler::instance ().remove (this);
 	downloader->abort ();
-	timer->stop ();
 }
 
 QString MetarPlugin::configText () const
@@ -109,6 +106,8 @@ void MetarPlugin::downloadSucceeded (int state, QNetworkReply *reply)
 {
 	(void)state; // There is only one download
 
+	RefreshScheduler::instance ().refreshSucceeded (this);
+
 	QString metar=extractMetar (*reply);
 
 	if (metar.isEmpty ())
@@ -121,6 +120,8 @@ void MetarPlugin::downloadFailed (int state, QNetworkReply *reply, QNetworkReply
 {
 	(void)state; // There is only one download
 
+	RefreshScheduler::instance ().refreshFailed (this);
+
 	if (code==QNetworkReply::ContentNotFoundError)
 		outputText (tr ("Error: METAR page not found (404)"));
 	else
@@ -4,7 +4,6 @@
 #include "src/plugin/info/InfoPlugin.h"
 
 #include <QNetworkReply> // Required for QNetworkReply::NetworkError
-#include <QTimer>
 
 class Downloader;
 
@@ -14,6 +13,8 @@ class Downloader;
  * Settings:
  *  - airport: the ICAO code of the airport to display the METAR of
  *  - refreshInterval: the interval for refreshing METAR messages in minutes
+ *
+ * The plugin is refreshed by the RefreshScheduler.
  */
 class MetarPlugin: public InfoPlugin
 {
@@ -43,7 +44,6 @@ class MetarPlugin: public InfoPlugin
 	private:
 		QString airport;
 		int refreshInterval; // seconds
-		QTimer *timer;
 
 		Downloader *downloader;
 
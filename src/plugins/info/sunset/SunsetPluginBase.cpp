@@ -9,10 +9,11 @@
 
 #include <QDebug>
 #include <QSettings>
-#include <QRegExp>
 #include <QFile>
 
 #include "SunsetPluginSettingsPane.h"
+#include "SunsetTable.h"
+#include "src/SunCalculator.h"
 #include "src/text.h"
 #include "src/util/file.h"
 #include "src/util/qString.h"
@@ -27,8 +28,11 @@
 
 SunsetPluginBase::SunsetPluginBase (QString caption, bool enabled, const QString &filename):
 	InfoPlugin (caption, enabled),
+	useDataFile (false),
 	filename (filename),
-	longitudeCorrection (false)
+	longitudeCorrection (false),
+	latitude (51+20/(double)60),
+	civilTwilight (false)
 {
 }
 
@@ -49,25 +53,98 @@ PluginSettingsPane *SunsetPluginBase::infoPluginCreateSettingsPane (QWidget *par
 void SunsetPluginBase::infoPluginReadSettings (const QSettings &settings)
 {
 	filename=settings.value (notr ("filename"), filename).toString ();
+
+	// Settings written by versions without the built-in calculation have no
+	// useDataFile key; keep using the configured file for them.
+	if (settings.contains (notr ("useDataFile")))
+		useDataFile=settings.value (notr ("useDataFile")).toBool ();
+	else if (settings.contains (notr ("filename")))
+		useDataFile=!isBlank (filename);
 	longitude=Longitude (settings.value (notr ("longitude"), Longitude (9, 27, 0, true).getValue ()).toDouble ());
+	latitude=settings.value (notr ("latitude"), latitude).toDouble ();
 	longitudeCorrection=settings.value (notr ("longitudeCorrection"), false).toBool ();
+	civilTwilight=settings.value (notr ("civilTwilight"), civilTwilight).toBool ();
 }
 
 void SunsetPluginBase::infoPluginWriteSettings (QSettings &settings)
 {
+	settings.setValue (notr ("useDataFile"), useDataFile);
 	settings.setValue (notr ("filename"), filename);
 	settings.setValue (notr ("longitude"), longitude.getValue ());
+	settings.setValue (notr ("latitude"), latitude);
 	settings.setValue (notr ("longitudeCorrection"), longitudeCorrection);
+	settings.setValue (notr ("civilTwilight"), civilTwilight);
 }
 
 QString SunsetPluginBase::configText () const
 {
-	if (longitudeCorrection)
+	if (!useDataFile)
+	{
+		QString location=qnotr ("%1, %2").arg (longitude.format (), formatLatitude (latitude));
+		if (civilTwilight)
+			return tr ("%1, civil twilight").arg (location);
+		else
+			return location;
+	}
+	else if (longitudeCorrection)
 		return qnotr ("%1, %2").arg (longitude.format (), filename);
 	else
 		return filename;
 }
 
+/**
+ * Determines the sunset for the current date, either by calculating it or by
+ * reading it from the data file
+ *
+ * If this fails, the sunset is set to invalid and an error message is output.
+ */
+void SunsetPluginBase::start ()
+{
+	resolvedFilename=QString ();
+	rawSunset=correctedSunset=calculatedSunset=QTime ();
+	referenceLongitude=Longitude ();
+
+	if (useDataFile)
+		readDataFile ();
+	else
+		calculate ();
+}
+
+/**
+ * Discards the values read from the time
+ */
+void SunsetPluginBase::terminate ()
+{
+	rawSunset=QTime ();
+	correctedSunset=QTime ();
+	calculatedSunset=QTime ();
+}
+
+
+// **********
+// ** Data **
+// **********
+
+/**
+ * Calculates the sunset or the end of civil twilight for the current date at
+ * the configured location
+ */
+void SunsetPluginBase::calculate ()
+{
+	if (!longitude.isValid ()) OUTPUT_AND_RETURN (tr ("Invalid longitude"));
+	if (latitude<-90 || latitude>90) OUTPUT_AND_RETURN (tr ("Invalid latitude"));
+
+	SunCalculator calculator (longitude, latitude);
+	QDate today=QDate::currentDate ();
+
+	if (civilTwilight)
+		calculatedSunset=calculator.civilTwilightEnd (today);
+	else
+		calculatedSunset=calculator.sunset (today);
+
+	if (!calculatedSunset.isValid ()) OUTPUT_AND_RETURN (tr ("No sunset on the current date"));
+}
+
 /**
  * Reads the required data from the data file
  *
@@ -75,18 +152,17 @@ QString SunsetPluginBase::configText () const
  *   - the sunset for the current date
  *   - the reference longitude, if longitude correction is activated
  *
+ * The file is only read if it was not read before or has been modified (see
+ * SunsetTable::load).
+ *
  * If the reading fails, the correspondig values are set to invalid
  * (invalid sunset to or referenceLongitude) and an error message
  * is output.
  */
-void SunsetPluginBase::start ()
+void SunsetPluginBase::readDataFile ()
 {
 	QString filename=getFilename ();
 
-	resolvedFilename=QString ();
-	rawSunset=correctedSunset=QTime ();
-	referenceLongitude=Longitude ();
-
 	if (isBlank (filename)) OUTPUT_AND_RETURN (tr ("No file specified"));
 
 	resolvedFilename=resolveFilename (filename, Settings::instance ().pluginPaths);
@@ -96,9 +172,10 @@ void SunsetPluginBase::start ()
 	try
 	{
 		// The file is OK
+		SunsetTable table=SunsetTable::load (resolvedFilename);
 
 		// Find the sunset for today
-		QString sunsetString=readSunsetString (resolvedFilename);
+		QString sunsetString=table.sunsetString (QDate::currentDate ());
 		if (isBlank (sunsetString)) OUTPUT_AND_RETURN (tr ("Time for current date not found in data file"));
 
 		rawSunset=QTime::fromString (sunsetString, notr ("hh:mm"));
@@ -106,7 +183,7 @@ void SunsetPluginBase::start ()
 
 		if (longitudeCorrection)
 		{
-			QString referenceLongitudeString=readReferenceLongitudeString (resolvedFilename);
+			QString referenceLongitudeString=table.getReferenceLongitudeString ();
 			if (referenceLongitudeString.isEmpty ()) OUTPUT_AND_RETURN (tr ("No reference longitude found in data file"));
 
 			referenceLongitude=Longitude::parse (referenceLongitudeString);
@@ -122,98 +199,35 @@ void SunsetPluginBase::start ()
 	}
 }
 
-/**
- * Discards the values read from the time
- */
-void SunsetPluginBase::terminate ()
-{
-	rawSunset=QTime ();
-	correctedSunset=QTime ();
-}
-
-
-// ******************
-// ** File reading **
-// ******************
-
-/**
- * Reads the sunset from a file as a string
- *
- * The file must contain a line with the current date and the sunset time,
- * separated by whitespace. Example
- *   08-15  18:43
- *
- * If there is no entry for the current date in the file, an empty string is
- * returned.
- *
- * @param filename the file to read from
- * @return the sunset string
- * @throw FileOpenError if the file cannot be opened
- */
-QString SunsetPluginBase::readSunsetString (const QString &filename)
-{
-	QString dateString=QDate::currentDate ().toString (notr ("MM-dd"));
-	// TODO does not escape dateString
-	QRegExp regexp (qnotr ("^%1\\s*(\\S*)").arg (dateString));
-
-	return findInFile (filename, regexp, 1);
-}
-
-/**
- * Reads the reference longitude from a file
- *
- * The file must contain a line with the following format:
- *   ReferenceLongitude: +9 27 00
- *
- * If there is no entry for the reference longitude in the file, an invalid
- * Longitude is returned.
- *
- * @param filename the file to read from
- * @param ok set to true on success or false if there was no reference
- *           longitude entry or it could not be parsed
- * @return the reference longitude
- * @throw FileOpenError if the file cannot be opened
- */
-QString SunsetPluginBase::readReferenceLongitudeString (const QString &filename)
-{
-	return findInFile (filename, QRegExp (notr ("^ReferenceLongitude: (.*)")), 1);
-}
-
-/**
- * Reads the source from a file
- *
- * The file must contain a line with the following format:
- *   Source: xyz
- *
- * If there is no entry for the source in the file, an empty
- * string is returned.
- *
- * @param filename the file to read from
- * @return the source
- * @throw FileOpenError if the file cannot be opened
- */
-QString SunsetPluginBase::readSource (const QString &filename)
-{
-	QRegExp regexp (notr ("^Source: (.*)"));
-
-	return findInFile (filename, regexp, 1);
-}
-
 
 // **********
 // ** Misc **
 // **********
 
 /**
- * Returns the raw or corrected sunset time, depending on the longitude
- * correction setting
+ * Returns the calculated, raw or corrected sunset time, depending on the
+ * data file and longitude correction settings
  *
  * @return the sunset time to use
  */
 QTime SunsetPluginBase::getEffectiveSunset ()
 {
-	if (longitudeCorrection)
+	if (!useDataFile)
+		return getCalculatedSunset ();
+	else if (longitudeCorrection)
 		return getCorrectedSunset ();
 	else
 		return getRawSunset ();
 }
+
+/**
+ * Creates a string suitable for display to the user, e. g. "51.33° N"
+ *
+ * @param latitude the latitude in degrees; positive values are north
+ */
+QString SunsetPluginBase::formatLatitude (double latitude)
+{
+	return qnotrUtf8 ("%1° %2")
+		.arg (qAbs (latitude), 0, 'f', 2)
+		.arg (latitude>=0?tr ("N", "north"):tr ("S", "south"));
+}
@@ -8,11 +8,22 @@
 #include "src/i18n/notr.h"
 
 /**
- * A plugin which displays the sunset time for the current date, read from a
- * data file
+ * A plugin which displays the sunset time for the current date
+ *
+ * By default, the sunset (or the end of civil twilight) is calculated for the
+ * configured location (see SunCalculator). Alternatively, the sunset can be
+ * read from a data file (see SunsetTable), optionally corrected for the
+ * difference between the configured longitude and the reference longitude of
+ * the file.
  *
  * Settings:
+ *  - useDataFile: whether to read the sunset from the data file instead of
+ *    calculating it
  *  - filename: the name of the file to read the data from
+ *  - longitude, latitude: the location
+ *  - longitudeCorrection: whether to correct the times read from the data file
+ *  - civilTwilight: whether to calculate the end of civil twilight instead of
+ *    the sunset
  */
 class SunsetPluginBase: public InfoPlugin
 {
@@ -29,36 +40,45 @@ class SunsetPluginBase: public InfoPlugin
 		virtual void infoPluginReadSettings (const QSettings &settings);
 		virtual void infoPluginWriteSettings (QSettings &settings);
 
+		value_accessor (bool, UseDataFile, useDataFile);
 		value_accessor (QString, Filename, filename);
 		value_accessor (Longitude, Longitude, longitude);
+		value_accessor (double, Latitude, latitude);
 		value_accessor (bool, LongitudeCorrection, longitudeCorrection);
+		value_accessor (bool, CivilTwilight, civilTwilight);
 
 		virtual QString configText () const;
 
 		virtual void start ();
 		virtual void terminate ();
+		virtual bool canRunOnWorkerThread () const { return true; }
 
-
-		static QString readSunsetString (const QString &filename);
-		static QString readSource (const QString &filename);
-		static QString readReferenceLongitudeString (const QString &filename);
+		static QString formatLatitude (double latitude);
 
 	protected:
 		value_reader (QTime, RawSunset, rawSunset);
 		value_reader (QTime, CorrectedSunset, correctedSunset);
+		value_reader (QTime, CalculatedSunset, calculatedSunset);
 		virtual QTime getEffectiveSunset ();
 
 	private:
+		void calculate ();
+		void readDataFile ();
+
 		// Settings
+		bool useDataFile;
 		QString filename;
 		bool longitudeCorrection;
 		Longitude longitude;
+		double latitude;
+		bool civilTwilight;
 
 		// Runtime data
 		QString resolvedFilename;
 		Longitude referenceLongitude;
 		QTime rawSunset; // UTC
 		QTime correctedSunset; // UTC
+		QTime calculatedSunset; // UTC
 };
 
 #endif
@@ -4,6 +4,7 @@
 #include <QFileInfo>
 
 #include "src/plugins/info/sunset/SunsetPluginBase.h"
+#include "src/plugins/info/sunset/SunsetTable.h"
 #include "src/util/qString.h"
 #include "src/util/file.h"
 #include "src/text.h"
@@ -31,22 +32,29 @@ SunsetPluginSettingsPane::~SunsetPluginSettingsPane()
 
 void SunsetPluginSettingsPane::readSettings ()
 {
+	ui.modeInput->setCurrentIndex (plugin->getUseDataFile ()?1:0);
 	ui.filenameInput->setText (plugin->getFilename ());
 	ui.longitudeInput->setLongitude (plugin->getLongitude ());
+	ui.latitudeInput->setValue (plugin->getLatitude ());
 	ui.longitudeCorrectionCheckbox->setChecked (plugin->getLongitudeCorrection ());
+	ui.civilTwilightCheckbox->setChecked (plugin->getCivilTwilight ());
 
 	SunsetTimePlugin *sunsetTimePlugin=dynamic_cast<SunsetTimePlugin *> (plugin);
 	if (sunsetTimePlugin)
 		ui.timeZoneInput->setCurrentIndex (sunsetTimePlugin->getDisplayUtc ()?0:1);
 
 	on_filenameInput_editingFinished ();
+	updateEnabledWidgets ();
 }
 
 bool SunsetPluginSettingsPane::writeSettings ()
 {
+	plugin->setUseDataFile (ui.modeInput->currentIndex ()==1);
 	plugin->setFilename (ui.filenameInput->text ());
 	plugin->setLongitude (ui.longitudeInput->getLongitude ());
+	plugin->setLatitude (ui.latitudeInput->value ());
 	plugin->setLongitudeCorrection (ui.longitudeCorrectionCheckbox->isChecked ());
+	plugin->setCivilTwilight (ui.civilTwilightCheckbox->isChecked ());
 
 	SunsetTimePlugin *sunsetTimePlugin=dynamic_cast<SunsetTimePlugin *> (plugin);
 	if (sunsetTimePlugin)
@@ -55,6 +63,11 @@ bool SunsetPluginSettingsPane::writeSettings ()
 	return true;
 }
 
+void SunsetPluginSettingsPane::on_modeInput_currentIndexChanged ()
+{
+	updateEnabledWidgets ();
+}
+
 void SunsetPluginSettingsPane::on_longitudeCorrectionCheckbox_toggled ()
 {
 	updateReferenceLongitudeNoteLabel ();
@@ -88,9 +101,10 @@ void SunsetPluginSettingsPane::on_filenameInput_editingFinished ()
 
 				try
 				{
-					source=SunsetPluginBase::readSource (resolved);
+					SunsetTable table=SunsetTable::load (resolved);
+					source=table.getSource ();
 
-					QString referenceLongitudeString=SunsetPluginBase::readReferenceLongitudeString (resolved);
+					QString referenceLongitudeString=table.getReferenceLongitudeString ();
 					referenceLongitudeFound=!referenceLongitudeString.isEmpty ();
 					referenceLongitude=Longitude::parse (referenceLongitudeString);
 
@@ -185,6 +199,22 @@ void SunsetPluginSettingsPane::updateReferenceLongitudeNoteLabel ()
 	}
 }
 
+/**
+ * Enables the widgets for the data file or for the calculation, depending on
+ * the selected mode
+ */
+void SunsetPluginSettingsPane::updateEnabledWidgets ()
+{
+	bool useDataFile=(ui.modeInput->currentIndex ()==1);
+
+	ui.filenameInput              ->setEnabled ( useDataFile);
+	ui.findFileButton             ->setEnabled ( useDataFile);
+	ui.longitudeCorrectionCheckbox->setEnabled ( useDataFile);
+	ui.referenceLongitudeNoteLabel->setEnabled ( useDataFile);
+	ui.latitudeInput              ->setEnabled (!useDataFile);
+	ui.civilTwilightCheckbox      ->setEnabled (!useDataFile);
+}
+
 void SunsetPluginSettingsPane::changeEvent (QEvent *event)
 {
 	if (event->type () == QEvent::LanguageChange)
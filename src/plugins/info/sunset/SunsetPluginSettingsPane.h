@@ -21,6 +21,7 @@ class SunsetPluginSettingsPane: public PluginSettingsPane
 		virtual bool writeSettings ();
 
 	private slots:
+		virtual void on_modeInput_currentIndexChanged ();
 		virtual void on_filenameInput_editingFinished ();
 		virtual void on_findFileButton_clicked ();
 		virtual void on_longitudeCorrectionCheckbox_toggled ();
@@ -29,6 +30,7 @@ class SunsetPluginSettingsPane: public PluginSettingsPane
 		virtual void updateSourceLabel ();
 		virtual void updateReferenceLongitudeLabel ();
 		virtual void updateReferenceLongitudeNoteLabel ();
+		virtual void updateEnabledWidgets ();
 
 	protected:
 		virtual void changeEvent (QEvent *event);
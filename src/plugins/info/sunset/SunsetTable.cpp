@@ -0,0 +1,122 @@
+#include "SunsetTable.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+
+#include "src/util/file.h"
+#include "src/util/io.h"
+#include "src/concurrent/synchronized.h"
+#include "src/i18n/notr.h"
+
+// ******************
+// ** Construction **
+// ******************
+
+SunsetTable::SunsetTable ()
+{
+}
+
+SunsetTable::~SunsetTable ()
+{
+}
+
+
+// *************
+// ** Reading **
+// *************
+
+/**
+ * Returns the table for a file
+ *
+ * The file is only read if it has not been read before or if it has been
+ * modified since. This method is thread safe.
+ *
+ * @param filename the file to read from
+ * @return the contents of the file
+ * @throw FileOpenError if the file cannot be opened
+ */
+SunsetTable SunsetTable::load (const QString &filename)
+{
+	static QMutex mutex;
+	static QHash<QString, SunsetTable> cache;
+
+	QString key=QFileInfo (filename).absoluteFilePath ();
+	QDateTime lastModified=QFileInfo (filename).lastModified ();
+
+	synchronized (mutex)
+	{
+		if (cache.contains (key) && cache.value (key).lastModified==lastModified)
+			return cache.value (key);
+	}
+
+	SunsetTable table=read (filename);
+	table.lastModified=lastModified;
+
+	synchronized (mutex)
+		cache.insert (key, table);
+
+	return table;
+}
+
+/**
+ * Reads a data file
+ *
+ * If there are multiple entries for a date, the first one is used.
+ *
+ * @throw FileOpenError if the file cannot be opened
+ */
+SunsetTable SunsetTable::read (const QString &filename)
+{
+	QFile file (filename);
+	if (!file.open (QIODevice::ReadOnly))
+		throw FileOpenError (filename, file.error (), file.errorString ());
+
+	QRegExp sunsetRegexp             (notr ("^(\\d\\d-\\d\\d)\\s*(\\S*)"));
+	QRegExp sourceRegexp             (notr ("^Source: (.*)"));
+	QRegExp referenceLongitudeRegexp (notr ("^ReferenceLongitude: (.*)"));
+
+	SunsetTable table;
+	bool sourceFound=false, referenceLongitudeFound=false;
+
+	while (!file.atEnd ())
+	{
+		QString line=readLineUtf8 (file).trimmed ();
+
+		if (sunsetRegexp.indexIn (line)>=0)
+		{
+			if (!table.sunsetStrings.contains (sunsetRegexp.cap (1)))
+				table.sunsetStrings.insert (sunsetRegexp.cap (1), sunsetRegexp.cap (2));
+		}
+		else if (!sourceFound && sourceRegexp.indexIn (line)>=0)
+		{
+			table.source=sourceRegexp.cap (1);
+			sourceFound=true;
+		}
+		else if (!referenceLongitudeFound && referenceLongitudeRegexp.indexIn (line)>=0)
+		{
+			table.referenceLongitudeString=referenceLongitudeRegexp.cap (1);
+			referenceLongitudeFound=true;
+		}
+	}
+
+	return table;
+}
+
+
+// ************
+// ** Lookup **
+// ************
+
+/**
+ * Returns the sunset time for a date as a string
+ *
+ * Only the month and the day of the date are used.
+ *
+ * @return the sunset time as it is specified in the file, or an empty string
+ *         if there is no entry for the date
+ */
+QString SunsetTable::sunsetString (const QDate &date) const
+{
+	return sunsetStrings.value (date.toString (notr ("MM-dd")));
+}
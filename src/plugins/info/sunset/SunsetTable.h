@@ -0,0 +1,54 @@
+/*
+ * SunsetTable.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SUNSETTABLE_H_
+#define SUNSETTABLE_H_
+
+#include <QString>
+#include <QHash>
+#include <QDate>
+#include <QDateTime>
+
+#include "src/accessor.h"
+
+/**
+ * The contents of a sunset data file
+ *
+ * A data file contains one line per date with the date and the sunset time in
+ * UTC, separated by whitespace, and optionally the source of the data and the
+ * longitude for which the times are valid. Example:
+ *   Source: xyz
+ *   ReferenceLongitude: +9 27 00
+ *   08-15  18:43
+ *
+ * The file is read completely once and the entries are stored by date, so
+ * looking up a date does not access the file. The tables are cached by file
+ * name (see #load); a file is only read again if it has been modified.
+ */
+class SunsetTable
+{
+	public:
+		SunsetTable ();
+		virtual ~SunsetTable ();
+
+		static SunsetTable load (const QString &filename);
+
+		QString sunsetString (const QDate &date) const;
+		value_reader (QString, Source, source);
+		value_reader (QString, ReferenceLongitudeString, referenceLongitudeString);
+
+	private:
+		static SunsetTable read (const QString &filename);
+
+		QHash<QString, QString> sunsetStrings; // "MM-dd" -> "hh:mm"
+		QString source;
+		QString referenceLongitudeString;
+
+		// The modification time of the file when it was read
+		QDateTime lastModified;
+};
+
+#endif
@@ -32,6 +32,7 @@ class TestPlugin: public InfoPlugin
 
 		virtual void start ();
 		virtual void terminate ();
+		virtual bool canRunOnWorkerThread () const { return true; }
 
 		virtual PluginSettingsPane *infoPluginCreateSettingsPane (QWidget *parent=NULL);
 
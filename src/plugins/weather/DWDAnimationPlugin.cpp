@@ -12,6 +12,7 @@
 
 #include "src/plugin/factory/PluginFactory.h"
 #include "src/net/Downloader.h"
+#include "src/net/RefreshScheduler.h"
 #include "src/util/qString.h"
 #include "src/util/io.h"
 #include "src/text.h"
@@ -52,6 +53,8 @@ void DWDAnimationPlugin::abort ()
 
 void DWDAnimationPlugin::downloadSucceeded (int state __attribute__((unused)), QNetworkReply *reply)
 {
+	RefreshScheduler::instance ().refreshSucceeded (this);
+
 	outputText (tr ("Saving radar animation"));
 	SkMovie movie (reply);
 	if (!movie.getMovie ()->isValid ()) OUTPUT_AND_RETURN (tr ("Error reading the animation"));
@@ -61,6 +64,8 @@ void DWDAnimationPlugin::downloadSucceeded (int state __attribute__((unused)), Q
 
 void DWDAnimationPlugin::downloadFailed (int state __attribute__((unused)), QNetworkReply *reply, QNetworkReply::NetworkError code)
 {
+	RefreshScheduler::instance ().refreshFailed (this);
+
 	if (code==QNetworkReply::ContentNotFoundError)
 	{
 		outputText (tr ("Error: radar animation not found (404)"));
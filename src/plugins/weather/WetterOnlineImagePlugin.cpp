@@ -12,6 +12,7 @@
 
 #include "src/plugin/factory/PluginFactory.h"
 #include "src/net/Downloader.h"
+#include "src/net/RefreshScheduler.h"
 #include "src/util/qString.h"
 #include "src/util/io.h"
 #include "src/text.h"
@@ -63,6 +64,8 @@ void WetterOnlineImagePlugin::downloadSucceeded (int state, QNetworkReply *reply
 		} break;
 		case stateImage:
 		{
+			RefreshScheduler::instance ().refreshSucceeded (this);
+
 			QByteArray data=reply->readAll ();
 			QImage image=QImage::fromData (data);
 			if (image.isNull ()) OUTPUT_AND_RETURN (tr ("Error: invalid radar image"));
@@ -73,6 +76,8 @@ void WetterOnlineImagePlugin::downloadSucceeded (int state, QNetworkReply *reply
 
 void WetterOnlineImagePlugin::downloadFailed (int state, QNetworkReply *reply, QNetworkReply::NetworkError code)
 {
+	RefreshScheduler::instance ().refreshFailed (this);
+
 	if (code==QNetworkReply::ContentNotFoundError)
 	{
 		switch ((State)state)
@@ -5,22 +5,34 @@
 #include <ios>
 #include <string>
 
+#include <cstdio>
+
 #include <QApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QScopedPointer>
 
 #include "src/config/Settings.h"
 #include "src/gui/windows/MainWindow.h"
 #include "src/db/Database.h"
 #include "src/db/interface/DefaultInterface.h"
+#include "src/db/interface/SqliteInterface.h"
 #include "src/db/migration/Migrator.h"
 #include "src/db/migration/MigrationFactory.h"
 #include "src/db/schema/SchemaDumper.h"
+#include "src/concurrent/monitor/SimpleOperationMonitor.h"
+#include "src/benchmark/SyntheticClub.h"
+#include "src/benchmark/Benchmark.h"
 #include "src/util/qString.h"
 #include "src/db/interface/exceptions/SqlException.h"
 #include "src/db/event/DbEvent.h" // For qRegisterMetaType
+#include "src/graphics/AnimationFrames.h" // For qRegisterMetaType
+#include "src/plugin/Plugin.h" // For qRegisterMetaType
 #include "src/net/TcpProxy.h" // remove
 #include "src/i18n/notr.h"
 #include "src/version.h"
 #include "src/i18n/TranslationManager.h"
+#include "src/logging/Trace.h"
 
 // For test_database
 //#include "src/model/Plane.h"
@@ -268,8 +280,14 @@ int doStuff (const QStringList &nonOptions)
 {
 	Settings &s=Settings::instance ();
 
-	// We don't need the ORM or thread safety, so we use a DefaultInterface.
-	DefaultInterface db (s.databaseInfo);
+	// We don't need the ORM or thread safety, so we use a DefaultInterface
+	// (or a SqliteInterface for an SQLite database).
+	QScopedPointer<Interface> interface;
+	if (s.databaseInfo.type==DatabaseInfo::typeSqlite)
+		interface.reset (new SqliteInterface (s.databaseInfo));
+	else
+		interface.reset (new DefaultInterface (s.databaseInfo));
+	Interface &db=*interface;
 
 	// Tests ahead
 	bool ok=db.open ();
@@ -280,12 +298,15 @@ int doStuff (const QStringList &nonOptions)
 		return 1;
 	}
 
+	// Prints the progress of chunked data changes in migrations
+	SimpleOperationMonitor monitor;
+
 	if (nonOptions[0]==notr ("db:up"))
-		Migrator (db).up ();
+		Migrator (db).up (monitor.interface ());
 	else if (nonOptions[0]==notr ("db:down"))
-		Migrator (db).down ();
+		Migrator (db).down (monitor.interface ());
 	else if (nonOptions[0]==notr ("db:migrate"))
-		Migrator (db).migrate ();
+		Migrator (db).migrate (monitor.interface ());
 	else if (nonOptions[0]==notr ("db:version"))
 		std::cout << notr ("Version is ") << Migrator (db).currentVersion () << std::endl;
 	else if (nonOptions[0]==notr ("db:load"))
@@ -332,6 +353,93 @@ int doStuff (const QStringList &nonOptions)
 			std::cout << d.dumpSchema () << std::endl;
 		}
 	}
+	else if (nonOptions[0]==notr ("bench:generate"))
+	{
+		// bench:generate [years [flights_per_day]] [name=value...]
+		// Names: years, flights, gliders, towplanes, people, airtow (percent),
+		// seed, end (yyyy-mm-dd)
+		if (!Migrator (db).isCurrent ())
+		{
+			std::cout << notr ("The database is not current, run db:load first") << std::endl;
+			return 1;
+		}
+
+		SyntheticClub club;
+		int position=0;
+		for (int i=1; i<nonOptions.size (); ++i)
+		{
+			QString argument=nonOptions[i];
+			QString name =argument.section ('=', 0, 0);
+			QString value=argument.section ('=', 1);
+
+			// Arguments without a name are years and flights per day
+			if (!argument.contains ('='))
+			{
+				++position;
+				if      (position==1) name=notr ("years");
+				else if (position==2) name=notr ("flights");
+				value=argument;
+			}
+
+			if      (name==notr ("years"    )) club.numYears        =value.toInt ();
+			else if (name==notr ("flights"  )) club.flightsPerDay   =value.toInt ();
+			else if (name==notr ("gliders"  )) club.numGliders      =value.toInt ();
+			else if (name==notr ("towplanes")) club.numTowplanes    =value.toInt ();
+			else if (name==notr ("people"   )) club.numPeople       =value.toInt ();
+			else if (name==notr ("airtow"   )) club.airtowPercentage=value.toInt ();
+			else if (name==notr ("seed"     )) club.seed            =value.toUInt ();
+			else if (name==notr ("end"      )) club.endDate         =QDate::fromString (value, Qt::ISODate);
+			else
+			{
+				std::cout << qnotr ("Invalid argument: %1").arg (argument) << std::endl;
+				return 1;
+			}
+		}
+
+		if (!club.endDate.isValid () || club.numYears<1 || club.numGliders<1 || club.numTowplanes<1 || club.numPeople<1)
+		{
+			std::cout << notr ("Invalid parameters") << std::endl;
+			return 1;
+		}
+
+		std::cout << qnotr ("Generating %1 gliders, %2 towplanes, %3 people and %4 seasons of flights from %5 to %6")
+			.arg (club.numGliders).arg (club.numTowplanes).arg (club.numPeople)
+			.arg (club.numYears)
+			.arg (club.firstDate ().toString (Qt::ISODate), club.lastDate ().toString (Qt::ISODate))
+			<< std::endl;
+
+		Database database (db);
+		club.generate (db, database);
+	}
+	else if (nonOptions[0]==notr ("bench:run"))
+	{
+		// bench:run [filename]
+		QFile file;
+		if (nonOptions.size ()>1)
+		{
+			file.setFileName (nonOptions[1]);
+			if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+			{
+				std::cout << qnotr ("Cannot open %1: %2").arg (nonOptions[1], file.errorString ()) << std::endl;
+				return 1;
+			}
+		}
+		else
+		{
+			file.open (stdout, QIODevice::WriteOnly);
+		}
+
+		QTextStream output (&file);
+		Benchmark (db, output).run ();
+	}
+	else if (nonOptions[0]==notr ("bench:explain"))
+	{
+		// Fails if any of the frequent flight queries scans the table
+		QFile file;
+		file.open (stdout, QIODevice::WriteOnly);
+		QTextStream output (&file);
+		return Benchmark (db, output).checkQueryPlans ()?0:1;
+	}
 	else
 	{
 		std::cout << notr ("Unrecognized") << std::endl;
@@ -362,6 +470,31 @@ void plugins_test ()
 	std::cout << notr ("End plugin test") << std::endl;
 }
 
+#include "src/net/DownloadCheck.h"
+
+/**
+ * net:fetch url [count]
+ *
+ * Downloads a URL repeatedly (twice by default) through the network cache.
+ * Fails if any of the downloads fails.
+ */
+int net_fetch (const QStringList &nonOptions)
+{
+	if (nonOptions.size ()<2)
+	{
+		std::cout << notr ("Usage: net:fetch url [count]") << std::endl;
+		return 1;
+	}
+
+	int count=2;
+	if (nonOptions.size ()>2) count=nonOptions[2].toInt ();
+
+	QFile file;
+	file.open (stdout, QIODevice::WriteOnly);
+	QTextStream output (&file);
+	return DownloadCheck (output).run (nonOptions[1], count)?0:1;
+}
+
 #include "src/concurrent/Waiter.h"
 #include "src/model/LaunchMethod.h" //remove
 #include "src/db/migrations/Migration_20100216135637_add_launch_methods.h"
@@ -379,12 +512,17 @@ int main (int argc, char **argv)
 	qRegisterMetaType<DbEvent> (notr ("DbEvent"));
 	qRegisterMetaType<Query> (notr ("Query"));
 	qRegisterMetaType<DatabaseInfo> (notr ("DatabaseInfo"));
+	qRegisterMetaType<AnimationFrames> (notr ("AnimationFrames"));
+	qRegisterMetaType<Plugin *> (notr ("Plugin*"));
 
 	// For QSettings
 	QCoreApplication::setOrganizationName (notr ("startkladde"));
 	QCoreApplication::setOrganizationDomain(notr ("startkladde.sf.net"));
 	QCoreApplication::setApplicationName(notr ("startkladde"));
 
+	application.thread ()->setObjectName (notr ("GUI"));
+	TRACE_START ();
+
 	QStringList args;
 	for (int i=0; i<argc; ++i) args << argv[i];
 
@@ -434,6 +572,8 @@ int main (int argc, char **argv)
 				proxy_test ();
 			else if (nonOptions[0]==notr ("plugins"))
 				plugins_test ();
+			else if (nonOptions[0]==notr ("net:fetch"))
+				ret=net_fetch (nonOptions);
 			else
 				ret=doStuff (nonOptions);
 		}
@@ -441,9 +581,11 @@ int main (int argc, char **argv)
 	catch (SqlException &ex)
 	{
 		std::cout << ex.colorizedString () << std::endl;
+		TRACE_STOP ();
 		return 1;
 	}
 
+	TRACE_STOP ();
 	std::cout << notr ("Regular program end with exit code ") << ret << std::endl;
 	return ret;
 }
@@ -0,0 +1,136 @@
+/*
+ * DatabaseTest.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "DatabaseTest.h"
+
+#include <QDateTime>
+#include <QList>
+
+#include "test/TestDatabase.h"
+#include "src/db/interface/Interface.h"
+#include "src/db/Database.h"
+#include "src/db/Query.h"
+#include "src/model/Person.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (DatabaseTest);
+
+// The tests are run on SQLite and, if configured, on MySQL (see
+// TestDatabase).
+
+static dbId createPerson (Database &db, const QString &lastName)
+{
+	Person person;
+	person.lastName=lastName;
+	return db.createObject (person);
+}
+
+static int countTombstones (Interface &interface, dbId objectId)
+{
+	return interface.countQuery (Query::count (Database::deletionsTableName,
+		Query ("table_name=? AND object_id=?").bind (Person::dbTableName ()).bind (objectId)));
+}
+
+void DatabaseTest::testDeleteRecordsTombstone ()
+{
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		Database &db=testDb.getDatabase ();
+
+		dbId id=createPerson (db, "Alpha");
+		CPPUNIT_ASSERT_EQUAL (0, countTombstones (testDb.getInterface (), id));
+
+		db.deleteObject<Person> (id);
+		CPPUNIT_ASSERT_EQUAL (1, countTombstones (testDb.getInterface (), id));
+	}
+}
+
+/**
+ * Tombstones older than the retention time are removed when the next deletion
+ * is recorded
+ */
+void DatabaseTest::testOldTombstonesPruned ()
+{
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		Interface &interface=testDb.getInterface ();
+		Database &db=testDb.getDatabase ();
+
+		// An old tombstone and one within the retention time
+		dbId oldId=1000, recentId=1001;
+		interface.executeQuery (
+			Query ("INSERT INTO %1 (table_name,object_id,deleted_at) VALUES (?,?,?)")
+			.arg (Database::deletionsTableName)
+			.bind (Person::dbTableName ()).bind (oldId).bind ("2000-01-01 00:00:00"));
+		interface.executeQuery (
+			Query ("INSERT INTO %1 (table_name,object_id) VALUES (?,?)")
+			.arg (Database::deletionsTableName)
+			.bind (Person::dbTableName ()).bind (recentId));
+
+		dbId id=createPerson (db, "Alpha");
+		db.deleteObject<Person> (id);
+
+		CPPUNIT_ASSERT_EQUAL (0, countTombstones (interface, oldId));
+		CPPUNIT_ASSERT_EQUAL (1, countTombstones (interface, recentId));
+		CPPUNIT_ASSERT_EQUAL (1, countTombstones (interface, id));
+	}
+}
+
+void DatabaseTest::testChangesContainDeletedIds ()
+{
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		Database &db=testDb.getDatabase ();
+
+		dbId deletedId=createPerson (db, "Alpha");
+		dbId keptId   =createPerson (db, "Bravo");
+
+		QList<Person> changed;
+		QList<dbId> deletedIds;
+		QDateTime timestamp=db.getChanges (QDateTime (), changed, deletedIds);
+		CPPUNIT_ASSERT_EQUAL (2, changed.size ());
+		CPPUNIT_ASSERT (deletedIds.isEmpty ());
+
+		db.deleteObject<Person> (deletedId);
+
+		db.getChanges (timestamp, changed, deletedIds);
+		CPPUNIT_ASSERT_EQUAL (1, deletedIds.size ());
+		CPPUNIT_ASSERT_EQUAL (deletedId, deletedIds[0]);
+
+		// The remaining person may be returned again because of the overlap
+		foreach (const Person &person, changed)
+			CPPUNIT_ASSERT_EQUAL (keptId, person.getId ());
+	}
+}
+
+/**
+ * If the changes since the given time may no longer be complete because
+ * tombstones have been pruned, all objects are returned
+ */
+void DatabaseTest::testExpiredChanges ()
+{
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		Database &db=testDb.getDatabase ();
+
+		createPerson (db, "Alpha");
+		createPerson (db, "Bravo");
+
+		QList<Person> changed;
+		QList<dbId> deletedIds;
+		QDateTime timestamp=db.getChanges (QDateTime (), changed, deletedIds);
+
+		QDateTime since=timestamp.addDays (-8);
+		CPPUNIT_ASSERT (Database::changesExpired (since, timestamp));
+
+		db.getChanges (since, changed, deletedIds);
+		CPPUNIT_ASSERT_EQUAL (2, changed.size ());
+		CPPUNIT_ASSERT (deletedIds.isEmpty ());
+	}
+}
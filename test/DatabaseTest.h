@@ -0,0 +1,28 @@
+/*
+ * DatabaseTest.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef DATABASETEST_H_
+#define DATABASETEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DatabaseTest: public CppUnit::TestFixture
+{
+	public:
+		void testDeleteRecordsTombstone ();
+		void testOldTombstonesPruned ();
+		void testChangesContainDeletedIds ();
+		void testExpiredChanges ();
+
+		CPPUNIT_TEST_SUITE (DatabaseTest);
+		CPPUNIT_TEST (testDeleteRecordsTombstone);
+		CPPUNIT_TEST (testOldTombstonesPruned);
+		CPPUNIT_TEST (testChangesContainDeletedIds);
+		CPPUNIT_TEST (testExpiredChanges);
+		CPPUNIT_TEST_SUITE_END ();
+};
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * FlightTest.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "FlightTest.h"
+
+#include <QDateTime>
+#include <QList>
+
+#include "src/model/Flight.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (FlightTest);
+
+// ******************
+// ** Test flights **
+// ******************
+
+static QDateTime utc (int hour, int minute)
+{
+	return QDateTime (QDate (2026, 10, 18), QTime (hour, minute), Qt::UTC);
+}
+
+static Flight prepared (FlightBase::Mode mode)
+{
+	Flight flight;
+	flight.setMode (mode);
+	return flight;
+}
+
+static Flight departed (FlightBase::Mode mode, const QDateTime &departureTime)
+{
+	Flight flight;
+	flight.setMode (mode);
+	flight.setDeparted (true);
+	flight.setDepartureTime (departureTime);
+	return flight;
+}
+
+static Flight landed (const QDateTime &landingTime)
+{
+	Flight flight;
+	flight.setMode (FlightBase::modeComing);
+	flight.setLanded (true);
+	flight.setLandingTime (landingTime);
+	return flight;
+}
+
+static int sign (qint64 value)
+{
+	if (value>0) return 1;
+	if (value<0) return -1;
+	return 0;
+}
+
+
+// ***********
+// ** Tests **
+// ***********
+
+/**
+ * For every pair of flights, comparing the sort keys gives the same result as
+ * Flight::sort
+ */
+void FlightTest::testSortKeyMatchesSort ()
+{
+	QList<Flight> flights;
+	flights << prepared (FlightBase::modeLocal);
+	flights << prepared (FlightBase::modeComing);
+	flights << prepared (FlightBase::modeLeaving);
+	flights << departed (FlightBase::modeLocal  , utc (10,  0));
+	flights << departed (FlightBase::modeLocal  , utc (10,  0));
+	flights << departed (FlightBase::modeLocal  , utc ( 9, 30));
+	flights << departed (FlightBase::modeLeaving, utc (11, 15));
+	flights << departed (FlightBase::modeLocal  , QDateTime ());
+	flights << landed (utc (10, 5));
+	flights << landed (utc (8, 0));
+
+	for (int i=0; i<flights.size (); ++i)
+	{
+		for (int j=0; j<flights.size (); ++j)
+		{
+			const Flight &a=flights[i];
+			const Flight &b=flights[j];
+
+			CPPUNIT_ASSERT_EQUAL (a.sort (&b), sign (a.sortKey ()-b.sortKey ()));
+		}
+	}
+}
+
+void FlightTest::testSortKeyTimeOrder ()
+{
+	Flight early=departed (FlightBase::modeLocal, utc (9, 0));
+	Flight late =departed (FlightBase::modeLocal, utc (9, 1));
+	Flight coming=landed (utc (9, 0));
+
+	CPPUNIT_ASSERT (early.sortKey ()<late.sortKey ());
+
+	// A landed incoming flight is sorted by its landing time
+	CPPUNIT_ASSERT (coming.sortKey ()==early.sortKey ());
+	CPPUNIT_ASSERT (coming.sortKey ()<late.sortKey ());
+}
+
+void FlightTest::testSortKeyPreparedLast ()
+{
+	Flight latest=departed (FlightBase::modeLocal, utc (23, 59));
+
+	CPPUNIT_ASSERT (latest.sortKey ()<prepared (FlightBase::modeLocal  ).sortKey ());
+	CPPUNIT_ASSERT (latest.sortKey ()<prepared (FlightBase::modeComing ).sortKey ());
+	CPPUNIT_ASSERT (latest.sortKey ()<prepared (FlightBase::modeLeaving).sortKey ());
+}
+
+void FlightTest::testSortKeyIncomingBeforeDeparting ()
+{
+	Flight coming =prepared (FlightBase::modeComing );
+	Flight local  =prepared (FlightBase::modeLocal  );
+	Flight leaving=prepared (FlightBase::modeLeaving);
+
+	CPPUNIT_ASSERT (coming.sortKey ()<local.sortKey ());
+	CPPUNIT_ASSERT (coming.sortKey ()<leaving.sortKey ());
+
+	// Locally departing prepared flights are equal
+	CPPUNIT_ASSERT (local.sortKey ()==leaving.sortKey ());
+}
+
+void FlightTest::testSortKeyInvalidTimeFirst ()
+{
+	Flight invalid=departed (FlightBase::modeLocal, QDateTime ());
+	Flight valid  =departed (FlightBase::modeLocal, utc (0, 0));
+
+	CPPUNIT_ASSERT (invalid.sortKey ()<valid.sortKey ());
+	CPPUNIT_ASSERT (invalid.sortKey ()<prepared (FlightBase::modeComing).sortKey ());
+}
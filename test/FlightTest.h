@@ -0,0 +1,30 @@
+/*
+ * FlightTest.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef FLIGHTTEST_H_
+#define FLIGHTTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class FlightTest: public CppUnit::TestFixture
+{
+	public:
+		void testSortKeyMatchesSort ();
+		void testSortKeyTimeOrder ();
+		void testSortKeyPreparedLast ();
+		void testSortKeyIncomingBeforeDeparting ();
+		void testSortKeyInvalidTimeFirst ();
+
+		CPPUNIT_TEST_SUITE (FlightTest);
+		CPPUNIT_TEST (testSortKeyMatchesSort);
+		CPPUNIT_TEST (testSortKeyTimeOrder);
+		CPPUNIT_TEST (testSortKeyPreparedLast);
+		CPPUNIT_TEST (testSortKeyIncomingBeforeDeparting);
+		CPPUNIT_TEST (testSortKeyInvalidTimeFirst);
+		CPPUNIT_TEST_SUITE_END ();
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * MigrationTest.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "MigrationTest.h"
+
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include "test/TestDatabase.h"
+#include "src/db/interface/Interface.h"
+#include "src/db/migration/Migration.h"
+#include "src/db/result/Result.h"
+#include "src/db/schema/spec/ColumnSpec.h"
+#include "src/db/Query.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MigrationTest);
+
+// The chunked column change copies the table using MySQL specific statements
+// (on SQLite, it changes the column directly), so these tests are only run
+// if a MySQL test database is configured (see TestDatabase).
+
+static const QString tableName  ="chunked_test";
+static const QString shadowTable="chunked_test_shadow";
+static const QString oldTable   ="chunked_test_old";
+static const int numRows=25;
+static const int chunkSize=10;
+
+/**
+ * Changes the value column of the test table from integer to string, in
+ * chunks of 10 rows
+ */
+class ChunkedColumnChange: public Migration
+{
+	public:
+		ChunkedColumnChange (Interface &interface): Migration (interface) {}
+
+		virtual void up ()
+		{
+			changeColumnTypeChunked (tableName, "value", dataTypeString (), "", chunkSize);
+		}
+
+		virtual void down ()
+		{
+			changeColumnTypeChunked (tableName, "value", dataTypeInteger (), "", chunkSize);
+		}
+
+		static QString checkpointKey ()
+		{
+			return QString ("%1: %2 to %3").arg (tableName, "value", dataTypeString ());
+		}
+};
+
+
+// *************
+// ** Helpers **
+// *************
+
+void MigrationTest::setUp ()
+{
+	testDb=NULL;
+	interface=NULL;
+
+	DatabaseInfo info;
+	if (TestDatabase::mysqlInfo (&info))
+	{
+		testDb=new TestDatabase (info);
+		interface=&testDb->getInterface ();
+	}
+}
+
+void MigrationTest::tearDown ()
+{
+	delete testDb;
+}
+
+/**
+ * Creates the test table with an integer column and 25 rows
+ */
+void MigrationTest::createTestTable ()
+{
+	QList<ColumnSpec> columns;
+	columns << interface->idColumn ();
+	columns << ColumnSpec ("value", Interface::dataTypeInteger ());
+	interface->createTable (tableName, columns);
+
+	for (int i=1; i<=numRows; ++i)
+		interface->executeQuery (
+			Query ("INSERT INTO %1 (id,value) VALUES (?,?)").arg (tableName)
+			.bind (i).bind (i*10));
+}
+
+void MigrationTest::runMigration ()
+{
+	ChunkedColumnChange migration (*interface);
+	migration.up ();
+}
+
+/**
+ * Checks that the column has been changed, the data has been preserved and
+ * no temporary tables or checkpoints are left
+ */
+void MigrationTest::checkResult ()
+{
+	QSharedPointer<Result> result=interface->executeQueryResult (
+		Query ("SHOW COLUMNS FROM %1 WHERE Field='value'").arg (tableName));
+	CPPUNIT_ASSERT (result->next ());
+	CPPUNIT_ASSERT (result->value (1).toString ().startsWith ("varchar"));
+
+	result=interface->executeQueryResult (
+		Query ("SELECT id,value FROM %1 ORDER BY id").arg (tableName));
+	int rows=0;
+	while (result->next ())
+	{
+		++rows;
+		CPPUNIT_ASSERT_EQUAL (rows, result->value (0).toInt ());
+		CPPUNIT_ASSERT (result->value (1).toString ()==QString::number (rows*10));
+	}
+	CPPUNIT_ASSERT_EQUAL (numRows, rows);
+
+	CPPUNIT_ASSERT (!interface->tableExists (shadowTable));
+	CPPUNIT_ASSERT (!interface->tableExists (oldTable));
+	CPPUNIT_ASSERT (!interface->tableExists (Migration::backfillProgressTableName));
+}
+
+
+// ***********
+// ** Tests **
+// ***********
+
+void MigrationTest::testChangeColumnTypeChunked ()
+{
+	if (!testDb) return;
+
+	createTestTable ();
+	runMigration ();
+	checkResult ();
+}
+
+/**
+ * The migration was interrupted after the first chunk had been copied to the
+ * shadow table
+ */
+void MigrationTest::testResumeFromCheckpoint ()
+{
+	if (!testDb) return;
+
+	createTestTable ();
+
+	interface->executeQuery (Query ("CREATE TABLE %1 LIKE %2").arg (shadowTable, tableName));
+	interface->executeQuery (Query ("ALTER TABLE %1 MODIFY value %2")
+		.arg (shadowTable, Interface::dataTypeString ()));
+	interface->executeQuery (Query ("INSERT INTO %1 (id,value) SELECT id,value FROM %2 WHERE id<=?")
+		.arg (shadowTable, tableName).bind (chunkSize));
+
+	interface->createTable (Migration::backfillProgressTableName, QList<ColumnSpec> ()
+		<< ColumnSpec ("name"   , Interface::dataTypeString  (), "NOT NULL PRIMARY KEY")
+		<< ColumnSpec ("last_id", Interface::dataTypeInteger (), "NOT NULL"));
+	interface->executeQuery (Query ("INSERT INTO %1 (name,last_id) VALUES (?,?)")
+		.arg (Migration::backfillProgressTableName)
+		.bind (ChunkedColumnChange::checkpointKey ()).bind (chunkSize));
+
+	runMigration ();
+	checkResult ();
+}
+
+/**
+ * The migration was interrupted after the tables had been swapped, before
+ * the original table had been dropped
+ */
+void MigrationTest::testResumeAfterSwap ()
+{
+	if (!testDb) return;
+
+	createTestTable ();
+	runMigration ();
+
+	interface->executeQuery (Query ("CREATE TABLE %1 LIKE %2").arg (oldTable, tableName));
+	runMigration ();
+	checkResult ();
+}
@@ -0,0 +1,40 @@
+/*
+ * MigrationTest.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef MIGRATIONTEST_H_
+#define MIGRATIONTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestDatabase;
+class Interface;
+
+class MigrationTest: public CppUnit::TestFixture
+{
+	public:
+		void setUp ();
+		void tearDown ();
+
+		void testChangeColumnTypeChunked ();
+		void testResumeFromCheckpoint ();
+		void testResumeAfterSwap ();
+
+		CPPUNIT_TEST_SUITE (MigrationTest);
+		CPPUNIT_TEST (testChangeColumnTypeChunked);
+		CPPUNIT_TEST (testResumeFromCheckpoint);
+		CPPUNIT_TEST (testResumeAfterSwap);
+		CPPUNIT_TEST_SUITE_END ();
+
+	private:
+		void createTestTable ();
+		void runMigration ();
+		void checkResult ();
+
+		TestDatabase *testDb;
+		Interface *interface;
+};
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * QueryPlanTest.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "QueryPlanTest.h"
+
+#include <iostream>
+
+#include <QList>
+#include <QRegExp>
+#include <QSet>
+#include <QSharedPointer>
+#include <QSqlRecord>
+#include <QStringList>
+#include <QTime>
+
+#include "test/TestDatabase.h"
+#include "src/benchmark/SyntheticClub.h"
+#include "src/db/interface/Interface.h"
+#include "src/db/result/Result.h"
+#include "src/db/Database.h"
+#include "src/db/Query.h"
+#include "src/model/Flight.h"
+#include "src/util/qString.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (QueryPlanTest);
+
+// The tests are run on SQLite and, if configured, on MySQL (see
+// TestDatabase). The flights are generated by SyntheticClub (one season),
+// with some prepared flights added.
+
+// *************
+// ** Helpers **
+// *************
+
+/**
+ * The relevant parts of the query plan of a query on the flights table
+ */
+class QueryPlan
+{
+	public:
+		QueryPlan (): fullScan (false), estimatedRows (0) {}
+
+		QStringList indexes;
+		bool fullScan;
+		qint64 estimatedRows; // MySQL only
+		QStringList details;
+};
+
+static QueryPlan queryPlan (Interface &interface, const Query &condition)
+{
+	QueryPlan plan;
+
+	Query select=Query::select (Flight::dbTableName (), Flight::selectColumnList ())
+		.condition (condition);
+
+	if (interface.isSqlite ())
+	{
+		// E. g. "SEARCH TABLE flights USING INDEX mode_status_index (...)"
+		// or "SCAN TABLE flights"
+		QRegExp indexRegexp ("USING (COVERING )?INDEX (\\w+)");
+
+		QSharedPointer<Result> result=interface.executeQueryResult (Query ("EXPLAIN QUERY PLAN ")+select);
+		while (result->next ())
+		{
+			QString detail=result->record ().value ("detail").toString ();
+			if (detail.startsWith ("SCAN")) plan.fullScan=true;
+			if (indexRegexp.indexIn (detail)>=0) plan.indexes.append (indexRegexp.cap (2));
+			plan.details.append (detail);
+		}
+	}
+	else
+	{
+		// The columns depend on the MySQL version, so access them by name
+		QSharedPointer<Result> result=interface.executeQueryResult (Query ("EXPLAIN ")+select);
+		while (result->next ())
+		{
+			QSqlRecord record=result->record ();
+			QString type=record.value ("type").toString ();
+			QString key =record.value ("key" ).toString ();
+			if (type=="ALL" || type=="index") plan.fullScan=true;
+			if (!key.isEmpty ()) plan.indexes.append (key);
+			plan.estimatedRows+=record.value ("rows").toLongLong ();
+			plan.details.append (QString ("type=%1, key=%2, rows=%3")
+				.arg (type, key, record.value ("rows").toString ()));
+		}
+	}
+
+	return plan;
+}
+
+/**
+ * The condition for prepared flights which was used before it was split into
+ * the conditions of Database::preparedFlightsConditions. The database cannot
+ * use an index for it.
+ */
+static Query orPreparedCondition ()
+{
+	return Query (
+		"NOT (mode=? AND NOT (departed=0 AND landed=0)) AND "
+		"NOT (mode=? AND departed<>0) AND "
+		"NOT (mode=? AND landed<>0)")
+		.bind (Flight::modeToDb (Flight::modeLocal  ))
+		.bind (Flight::modeToDb (Flight::modeLeaving))
+		.bind (Flight::modeToDb (Flight::modeComing ));
+}
+
+static QSet<dbId> flightIds (const QList<Flight> &flights)
+{
+	QSet<dbId> ids;
+	foreach (const Flight &flight, flights)
+		ids.insert (flight.getId ());
+	return ids;
+}
+
+/**
+ * Generates the flights and updates the statistics used by the query planner
+ *
+ * @return the last date with flights
+ */
+static QDate populate (TestDatabase &testDb)
+{
+	Interface &interface=testDb.getInterface ();
+	Database &db=testDb.getDatabase ();
+
+	SyntheticClub club;
+	club.numPeople=30;
+	club.numYears=1;
+	club.flightsPerDay=10;
+	club.generate (interface, db);
+
+	// Prepared flights of all modes, and some which happened
+	Flight::Mode modes[]={ Flight::modeLocal, Flight::modeLeaving, Flight::modeComing };
+	for (int i=0; i<30; ++i)
+	{
+		Flight flight;
+		flight.setMode (modes[i%3]);
+		flight.setDeparted (i%5==0 && modes[i%3]!=Flight::modeComing);
+		flight.setLanded   (i%7==0 && modes[i%3]!=Flight::modeLeaving);
+		db.createObject (flight);
+	}
+
+	if (interface.isSqlite ())
+		interface.executeQuery (Query ("ANALYZE"));
+	else
+		interface.executeQuery (Query ("ANALYZE TABLE %1").arg (Flight::dbTableName ()));
+
+	return club.lastDate ();
+}
+
+static void assertIndex (const QueryPlan &plan, const QStringList &acceptedIndexes)
+{
+	std::cout << plan.details.join ("; ") << std::endl;
+
+	CPPUNIT_ASSERT (!plan.fullScan);
+	CPPUNIT_ASSERT (!plan.indexes.isEmpty ());
+	foreach (const QString &index, plan.indexes)
+		CPPUNIT_ASSERT (acceptedIndexes.contains (index));
+}
+
+
+// ***********
+// ** Tests **
+// ***********
+
+void QueryPlanTest::testDateConditionsUseIndexes ()
+{
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		QDate date=populate (testDb);
+
+		QList<Query> conditions=Flight::dateSupersetConditions (date);
+		CPPUNIT_ASSERT_EQUAL (2, conditions.size ());
+
+		assertIndex (queryPlan (testDb.getInterface (), conditions[0]), QStringList () << "departure_time_index");
+		assertIndex (queryPlan (testDb.getInterface (), conditions[1]), QStringList () << "landing_time_index");
+	}
+}
+
+void QueryPlanTest::testPreparedConditionsUseIndexes ()
+{
+	QStringList compositeIndexes;
+	compositeIndexes << "mode_status_index" << "mode_landed_index";
+
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		populate (testDb);
+
+		// One condition per valid mode (using the composite indexes), and
+		// four conditions for invalid modes (using any index on mode)
+		QList<Query> conditions=Database::preparedFlightsConditions ();
+		CPPUNIT_ASSERT_EQUAL (7, conditions.size ());
+
+		// Local: mode, departed and landed
+		assertIndex (queryPlan (testDb.getInterface (), conditions[0]), QStringList () << "mode_status_index");
+
+		for (int i=1; i<conditions.size (); ++i)
+			assertIndex (queryPlan (testDb.getInterface (), conditions[i]), compositeIndexes);
+	}
+}
+
+/**
+ * The split conditions select the same flights as the condition they replaced
+ */
+void QueryPlanTest::testPreparedConditionsMatchOrCondition ()
+{
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		populate (testDb);
+		Database &db=testDb.getDatabase ();
+
+		QSet<dbId> unionIds=flightIds (db.getPreparedFlights ());
+		QSet<dbId> orIds   =flightIds (db.getObjects<Flight> (orPreparedCondition ()));
+
+		CPPUNIT_ASSERT (!unionIds.isEmpty ());
+		CPPUNIT_ASSERT (unionIds==orIds);
+
+		foreach (const Flight &flight, db.getPreparedFlights ())
+			CPPUNIT_ASSERT (flight.isPrepared ());
+	}
+}
+
+/**
+ * Compares the time for reading the prepared flights with the split
+ * conditions and with the condition they replaced. This does not fail; the
+ * results are written to standard output.
+ */
+void QueryPlanTest::testPreparedConditionsTiming ()
+{
+	const int iterations=50;
+
+	foreach (const DatabaseInfo &info, TestDatabase::allInfos ())
+	{
+		TestDatabase testDb (info);
+		populate (testDb);
+		Interface &interface=testDb.getInterface ();
+		Database &db=testDb.getDatabase ();
+
+		QTime timer;
+
+		timer.start ();
+		for (int i=0; i<iterations; ++i)
+			db.getPreparedFlights ();
+		int unionTime=timer.elapsed ();
+
+		timer.start ();
+		for (int i=0; i<iterations; ++i)
+			db.getObjects<Flight> (orPreparedCondition ());
+		int orTime=timer.elapsed ();
+
+		qint64 unionRows=0;
+		foreach (const Query &condition, Database::preparedFlightsConditions ())
+			unionRows+=queryPlan (interface, condition).estimatedRows;
+		qint64 orRows=queryPlan (interface, orPreparedCondition ()).estimatedRows;
+
+		std::cout << QString ("Prepared flights on %1, %2 iterations: UNION ALL %3 ms, OR %4 ms")
+			.arg (info.toString ()).arg (iterations).arg (unionTime).arg (orTime) << std::endl;
+		if (!interface.isSqlite ())
+			std::cout << QString ("Estimated rows examined: UNION ALL %1, OR %2")
+				.arg (unionRows).arg (orRows) << std::endl;
+	}
+}
@@ -0,0 +1,28 @@
+/*
+ * QueryPlanTest.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef QUERYPLANTEST_H_
+#define QUERYPLANTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class QueryPlanTest: public CppUnit::TestFixture
+{
+	public:
+		void testDateConditionsUseIndexes ();
+		void testPreparedConditionsUseIndexes ();
+		void testPreparedConditionsMatchOrCondition ();
+		void testPreparedConditionsTiming ();
+
+		CPPUNIT_TEST_SUITE (QueryPlanTest);
+		CPPUNIT_TEST (testDateConditionsUseIndexes);
+		CPPUNIT_TEST (testPreparedConditionsUseIndexes);
+		CPPUNIT_TEST (testPreparedConditionsMatchOrCondition);
+		CPPUNIT_TEST (testPreparedConditionsTiming);
+		CPPUNIT_TEST_SUITE_END ();
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * SunCalculatorTest.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "SunCalculatorTest.h"
+
+#include <cstdlib>
+
+#include <QDate>
+#include <QTime>
+
+#include "src/SunCalculator.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (SunCalculatorTest);
+
+// The expected times are from published sunset tables (timeanddate.com),
+// converted to UTC. The tables are rounded to the minute and include the
+// elevation of the observer, so we allow a difference of 3 minutes.
+
+static const int toleranceSeconds=3*60;
+
+static void assertTime (const QTime &expected, const QTime &actual)
+{
+	CPPUNIT_ASSERT (actual.isValid ());
+	CPPUNIT_ASSERT (std::abs (expected.secsTo (actual))<=toleranceSeconds);
+}
+
+static SunCalculator london ()
+{
+	return SunCalculator (Longitude (-0.1278), 51.5074);
+}
+
+static SunCalculator sydney ()
+{
+	return SunCalculator (Longitude (151.2093), -33.8688);
+}
+
+static SunCalculator tromso ()
+{
+	return SunCalculator (Longitude (18.9553), 69.6492);
+}
+
+
+// ***********
+// ** Tests **
+// ***********
+
+void SunCalculatorTest::testSunsetNorthernHemisphere ()
+{
+	assertTime (QTime (18, 13), london ().sunset (QDate (2021,  3, 20)));
+	assertTime (QTime (20, 21), london ().sunset (QDate (2021,  6, 21)));
+	assertTime (QTime (18,  1), london ().sunset (QDate (2021,  9, 22)));
+	assertTime (QTime (15, 53), london ().sunset (QDate (2021, 12, 21)));
+}
+
+/**
+ * The sun sets in the morning UTC; the date is the same in UTC and local
+ * time
+ */
+void SunCalculatorTest::testSunsetSouthernHemisphere ()
+{
+	assertTime (QTime (6, 54), sydney ().sunset (QDate (2021,  6, 21)));
+	assertTime (QTime (9,  5), sydney ().sunset (QDate (2021, 12, 21)));
+}
+
+void SunCalculatorTest::testCivilTwilightEnd ()
+{
+	QDate date (2021, 6, 21);
+
+	assertTime (QTime (21, 11), london ().civilTwilightEnd (date));
+	CPPUNIT_ASSERT (london ().sunset (date)<london ().civilTwilightEnd (date));
+}
+
+/**
+ * North of the arctic circle, the sun does not set at midsummer and does not
+ * rise at midwinter
+ */
+void SunCalculatorTest::testPolarDayAndNight ()
+{
+	CPPUNIT_ASSERT (!tromso ().sunset (QDate (2021,  6, 21)).isValid ());
+	CPPUNIT_ASSERT (!tromso ().sunset (QDate (2021, 12, 21)).isValid ());
+}
@@ -0,0 +1,28 @@
+/*
+ * SunCalculatorTest.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SUNCALCULATORTEST_H_
+#define SUNCALCULATORTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SunCalculatorTest: public CppUnit::TestFixture
+{
+	public:
+		void testSunsetNorthernHemisphere ();
+		void testSunsetSouthernHemisphere ();
+		void testCivilTwilightEnd ();
+		void testPolarDayAndNight ();
+
+		CPPUNIT_TEST_SUITE (SunCalculatorTest);
+		CPPUNIT_TEST (testSunsetNorthernHemisphere);
+		CPPUNIT_TEST (testSunsetSouthernHemisphere);
+		CPPUNIT_TEST (testCivilTwilightEnd);
+		CPPUNIT_TEST (testPolarDayAndNight);
+		CPPUNIT_TEST_SUITE_END ();
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * TestDatabase.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "TestDatabase.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+
+#include "src/db/interface/Interface.h"
+#include "src/db/interface/DefaultInterface.h"
+#include "src/db/interface/SqliteInterface.h"
+#include "src/db/migration/Migrator.h"
+#include "src/db/Database.h"
+#include "src/util/environment.h"
+#include "src/i18n/notr.h"
+
+int TestDatabase::nextNumber=0;
+
+/**
+ * Opens the database, drops all tables and loads the current schema
+ *
+ * @throw OperationCanceledException or QueryFailedException if the database
+ *        cannot be opened or the schema cannot be loaded
+ */
+TestDatabase::TestDatabase (const DatabaseInfo &info):
+	info (info), interface (NULL), database (NULL)
+{
+	if (info.type==DatabaseInfo::typeSqlite)
+		interface=new SqliteInterface (info);
+	else
+		interface=new DefaultInterface (info);
+
+	interface->open ();
+
+	foreach (const QString &table, interface->showTables ())
+		interface->dropTable (table);
+
+	Migrator (*interface).loadSchema ();
+
+	database=new Database (*interface);
+}
+
+TestDatabase::~TestDatabase ()
+{
+	delete database;
+
+	interface->close ();
+	delete interface;
+
+	if (info.type==DatabaseInfo::typeSqlite)
+		removeSqliteFile (info);
+}
+
+/**
+ * Returns the info for a new temporary SQLite database
+ */
+DatabaseInfo TestDatabase::sqliteInfo ()
+{
+	QString fileName=qnotr ("startkladde_test_%1_%2.sqlite")
+		.arg (QCoreApplication::applicationPid ()).arg (nextNumber++);
+
+	DatabaseInfo info;
+	info.type=DatabaseInfo::typeSqlite;
+	info.database=QDir::temp ().absoluteFilePath (fileName);
+	return info;
+}
+
+/**
+ * Reads the MySQL test database from STARTKLADDE_TEST_MYSQL
+ *
+ * @return true if the variable is set and valid
+ */
+bool TestDatabase::mysqlInfo (DatabaseInfo *info)
+{
+	QString value=getEnvironmentVariable (notr ("STARTKLADDE_TEST_MYSQL"));
+	if (value.isEmpty ())
+		return false;
+
+	// user:password@server[:port]/database
+	QRegExp regexp (notr ("^([^:@]*)(:([^@]*))?@([^:/]+)(:(\\d+))?/(\\w+)$"));
+	if (!regexp.exactMatch (value))
+		return false;
+
+	info->type       =DatabaseInfo::typeMysql;
+	info->username   =regexp.cap (1);
+	info->password   =regexp.cap (3);
+	info->server     =regexp.cap (4);
+	info->defaultPort=regexp.cap (6).isEmpty ();
+	info->port       =regexp.cap (6).toInt ();
+	info->database   =regexp.cap (7);
+	return true;
+}
+
+/**
+ * Returns a new SQLite database and, if configured, the MySQL database
+ */
+QList<DatabaseInfo> TestDatabase::allInfos ()
+{
+	QList<DatabaseInfo> infos;
+	infos << sqliteInfo ();
+
+	DatabaseInfo mysql;
+	if (mysqlInfo (&mysql))
+		infos << mysql;
+
+	return infos;
+}
+
+/**
+ * Removes an SQLite database file, including the WAL files
+ */
+void TestDatabase::removeSqliteFile (const DatabaseInfo &info)
+{
+	QString fileName=info.sqliteFileName ();
+	QFile::remove (fileName);
+	QFile::remove (fileName+notr ("-wal"));
+	QFile::remove (fileName+notr ("-shm"));
+}
@@ -0,0 +1,52 @@
+/*
+ * TestDatabase.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef TESTDATABASE_H_
+#define TESTDATABASE_H_
+
+#include <QList>
+#include <QString>
+
+#include "src/db/DatabaseInfo.h"
+
+class Interface;
+class Database;
+
+/**
+ * A database for the unit tests, with the current schema loaded
+ *
+ * SQLite databases are created as temporary files, which are removed when the
+ * TestDatabase is destroyed.
+ *
+ * The MySQL tests are only run if the environment variable
+ * STARTKLADDE_TEST_MYSQL is set to "user:password@server[:port]/database".
+ * All tables in the database are dropped, so it must be a dedicated test
+ * database.
+ */
+class TestDatabase
+{
+	public:
+		TestDatabase (const DatabaseInfo &info);
+		virtual ~TestDatabase ();
+
+		Interface &getInterface () { return *interface; }
+		Database &getDatabase () { return *database; }
+
+		static DatabaseInfo sqliteInfo ();
+		static bool mysqlInfo (DatabaseInfo *info);
+		static QList<DatabaseInfo> allInfos ();
+
+		static void removeSqliteFile (const DatabaseInfo &info);
+
+	private:
+		DatabaseInfo info;
+		Interface *interface;
+		Database *database;
+
+		static int nextNumber;
+};
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * WriteJournalTest.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "WriteJournalTest.h"
+
+#include <QList>
+#include <QStringList>
+
+#include "test/TestDatabase.h"
+#include "src/db/journal/WriteJournal.h"
+#include "src/db/Database.h"
+#include "src/model/Person.h"
+#include "src/model/Plane.h"
+#include "src/model/Flight.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (WriteJournalTest);
+
+// The journal is replayed to an SQLite database; the replay only uses the
+// Database interface, so the behavior is the same for MySQL.
+
+void WriteJournalTest::setUp ()
+{
+	target=new TestDatabase (TestDatabase::sqliteInfo ());
+
+	journalInfo=TestDatabase::sqliteInfo ();
+	journal=new WriteJournal (journalInfo);
+	journal->open ();
+}
+
+void WriteJournalTest::tearDown ()
+{
+	delete journal;
+	TestDatabase::removeSqliteFile (journalInfo);
+
+	delete target;
+}
+
+Database &WriteJournalTest::db ()
+{
+	return target->getDatabase ();
+}
+
+static Person person (const QString &lastName, const QString &firstName)
+{
+	Person person;
+	person.lastName=lastName;
+	person.firstName=firstName;
+	return person;
+}
+
+
+// ***************
+// ** Recording **
+// ***************
+
+void WriteJournalTest::testTemporaryIds ()
+{
+	Person a=person ("Alpha", "Anna");
+	Person b=person ("Bravo", "Bert");
+
+	dbId idA=journal->recordCreate (a, QString ());
+	dbId idB=journal->recordCreate (b, QString ());
+
+	CPPUNIT_ASSERT (WriteJournal::isTemporaryId (idA));
+	CPPUNIT_ASSERT (WriteJournal::isTemporaryId (idB));
+	CPPUNIT_ASSERT (idA!=idB);
+	CPPUNIT_ASSERT_EQUAL (idA, a.getId ());
+	CPPUNIT_ASSERT_EQUAL (2, journal->size ());
+}
+
+void WriteJournalTest::testUpdateMergedIntoCreate ()
+{
+	Person created=person ("Alpha", "Anna");
+	journal->recordCreate (created, QString ());
+
+	Person changed=created;
+	changed.firstName="Anne";
+	journal->recordUpdate (changed, &created);
+
+	// The update is written by the create
+	CPPUNIT_ASSERT_EQUAL (1, journal->size ());
+
+	QStringList conflicts=journal->replay (db ());
+	CPPUNIT_ASSERT (conflicts.isEmpty ());
+	CPPUNIT_ASSERT (journal->isEmpty ());
+
+	QList<Person> people=db ().getObjects<Person> ();
+	CPPUNIT_ASSERT_EQUAL (1, people.size ());
+	CPPUNIT_ASSERT (people[0].firstName=="Anne");
+	CPPUNIT_ASSERT (!WriteJournal::isTemporaryId (people[0].getId ()));
+}
+
+void WriteJournalTest::testDeleteRemovesCreate ()
+{
+	Person created=person ("Alpha", "Anna");
+	dbId id=journal->recordCreate (created, QString ());
+	journal->recordDelete<Person> (id, &created);
+
+	// The object has never been written, so there is nothing to do
+	CPPUNIT_ASSERT (journal->isEmpty ());
+
+	journal->replay (db ());
+	CPPUNIT_ASSERT_EQUAL (0, db ().countObjects<Person> ());
+}
+
+void WriteJournalTest::testDeleteReplacesUpdate ()
+{
+	Person base=person ("Alpha", "Anna");
+	dbId id=db ().createObject (base);
+
+	Person changed=base;
+	changed.firstName="Anne";
+	journal->recordUpdate (changed, &base);
+	journal->recordDelete<Person> (id, &base);
+
+	CPPUNIT_ASSERT_EQUAL (1, journal->size ());
+
+	QStringList conflicts=journal->replay (db ());
+	CPPUNIT_ASSERT (conflicts.isEmpty ());
+	CPPUNIT_ASSERT (!db ().objectExists<Person> (id));
+}
+
+
+// ***************
+// ** Replaying **
+// ***************
+
+void WriteJournalTest::testReplayMapsTemporaryIds ()
+{
+	Person pilot=person ("Alpha", "Anna");
+	dbId temporaryPilotId=journal->recordCreate (pilot, QString ());
+
+	Plane plane;
+	plane.registration="D-1234";
+	dbId temporaryPlaneId=journal->recordCreate (plane, QString ());
+
+	Flight flight;
+	flight.setPilotId (temporaryPilotId);
+	flight.setPlaneId (temporaryPlaneId);
+	journal->recordCreate (flight, QString ());
+
+	CPPUNIT_ASSERT_EQUAL (3, journal->size ());
+	journal->replay (db ());
+	CPPUNIT_ASSERT (journal->isEmpty ());
+
+	QList<Person> people=db ().getObjects<Person> ();
+	QList<Plane > planes=db ().getObjects<Plane > ();
+	QList<Flight> flights=db ().getObjects<Flight> ();
+	CPPUNIT_ASSERT_EQUAL (1, people .size ());
+	CPPUNIT_ASSERT_EQUAL (1, planes .size ());
+	CPPUNIT_ASSERT_EQUAL (1, flights.size ());
+
+	// The flight refers to the created objects, not to the temporary IDs
+	CPPUNIT_ASSERT_EQUAL (people[0].getId (), flights[0].getPilotId ());
+	CPPUNIT_ASSERT_EQUAL (planes[0].getId (), flights[0].getPlaneId ());
+	CPPUNIT_ASSERT (!WriteJournal::isTemporaryId (flights[0].getId ()));
+}
+
+/**
+ * A create which was sent to the database before the connection was lost is
+ * not performed again
+ */
+void WriteJournalTest::testReplayCreationKey ()
+{
+	QString creationKey="test-creation-key";
+
+	Person sent=person ("Alpha", "Anna");
+	dbId id=db ().createObject (sent, creationKey);
+
+	Person journaled=person ("Alpha", "Anne");
+	journal->recordCreate (journaled, creationKey);
+	journal->replay (db ());
+
+	QList<Person> people=db ().getObjects<Person> ();
+	CPPUNIT_ASSERT_EQUAL (1, people.size ());
+	CPPUNIT_ASSERT_EQUAL (id, people[0].getId ());
+	CPPUNIT_ASSERT (people[0].firstName=="Anne");
+}
+
+/**
+ * An update of an object changed by another user is written, but reported
+ */
+void WriteJournalTest::testUpdateConflict ()
+{
+	Person base=person ("Alpha", "Anna");
+	dbId id=db ().createObject (base);
+
+	Person local=base;
+	local.firstName="Anne";
+	journal->recordUpdate (local, &base);
+
+	Person remote=base;
+	remote.firstName="Annette";
+	db ().updateObject (remote);
+
+	QStringList conflicts=journal->replay (db ());
+	CPPUNIT_ASSERT_EQUAL (1, conflicts.size ());
+	CPPUNIT_ASSERT (db ().getObject<Person> (id).firstName=="Anne");
+}
+
+/**
+ * A delete of an object changed by another user is not written
+ */
+void WriteJournalTest::testDeleteConflict ()
+{
+	Person base=person ("Alpha", "Anna");
+	dbId id=db ().createObject (base);
+
+	journal->recordDelete<Person> (id, &base);
+
+	Person remote=base;
+	remote.firstName="Annette";
+	db ().updateObject (remote);
+
+	QStringList conflicts=journal->replay (db ());
+	CPPUNIT_ASSERT_EQUAL (1, conflicts.size ());
+	CPPUNIT_ASSERT (db ().objectExists<Person> (id));
+}
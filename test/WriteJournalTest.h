@@ -0,0 +1,52 @@
+/*
+ * WriteJournalTest.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef WRITEJOURNALTEST_H_
+#define WRITEJOURNALTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "src/db/DatabaseInfo.h"
+
+class TestDatabase;
+class WriteJournal;
+class Database;
+
+class WriteJournalTest: public CppUnit::TestFixture
+{
+	public:
+		void setUp ();
+		void tearDown ();
+
+		void testTemporaryIds ();
+		void testUpdateMergedIntoCreate ();
+		void testDeleteRemovesCreate ();
+		void testDeleteReplacesUpdate ();
+		void testReplayMapsTemporaryIds ();
+		void testReplayCreationKey ();
+		void testUpdateConflict ();
+		void testDeleteConflict ();
+
+		CPPUNIT_TEST_SUITE (WriteJournalTest);
+		CPPUNIT_TEST (testTemporaryIds);
+		CPPUNIT_TEST (testUpdateMergedIntoCreate);
+		CPPUNIT_TEST (testDeleteRemovesCreate);
+		CPPUNIT_TEST (testDeleteReplacesUpdate);
+		CPPUNIT_TEST (testReplayMapsTemporaryIds);
+		CPPUNIT_TEST (testReplayCreationKey);
+		CPPUNIT_TEST (testUpdateConflict);
+		CPPUNIT_TEST (testDeleteConflict);
+		CPPUNIT_TEST_SUITE_END ();
+
+	private:
+		Database &db ();
+
+		TestDatabase *target;
+		DatabaseInfo journalInfo;
+		WriteJournal *journal;
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+/*
+ * Runs the unit tests. Build with -DTESTS=ON and run startkladde_test (or
+ * ctest) from the build directory.
+ *
+ * The database tests run on a temporary SQLite database. They are also run on
+ * MySQL if STARTKLADDE_TEST_MYSQL is set, see TestDatabase.
+ */
+
+#include <QCoreApplication>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "src/db/event/DbEvent.h"
+#include "src/db/DatabaseInfo.h"
+#include "src/db/Query.h"
+#include "src/i18n/notr.h"
+
+int main (int argc, char **argv)
+{
+	QCoreApplication application (argc, argv);
+
+	// For ThreadSafeInterface (used by WriteJournal)
+	qRegisterMetaType<DbEvent> (notr ("DbEvent"));
+	qRegisterMetaType<Query> (notr ("Query"));
+	qRegisterMetaType<DatabaseInfo> (notr ("DatabaseInfo"));
+
+	// Don't use the settings of the program
+	QCoreApplication::setOrganizationName (notr ("startkladde"));
+	QCoreApplication::setApplicationName (notr ("startkladde_test"));
+
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest (CppUnit::TestFactoryRegistry::getRegistry ().makeTest ());
+
+	bool success=runner.run ();
+	return success?0:1;
+}